@@ -56,7 +56,7 @@ namespace BTool
             typedef boost::beast::websocket::stream<boost::beast::tcp_stream>       websocket_stream_type;
             typedef websocket_stream_type::next_layer_type::socket_type             socket_type;
             typedef BoostNet::ReadBuffer                                            ReadBufferType;
-            typedef BoostNet::WriteBuffer<1024>                                     WriteBufferType;
+            typedef BoostNet::ConcurrentWriteBuffer<1024>                           WriteBufferType;
             typedef WriteBufferType::WriteMemoryStreamPtr                           WriteMemoryStreamPtr;
             typedef BoostNet::NetCallBack::SessionID                                SessionID;
 
@@ -73,9 +73,11 @@ namespace BTool
             // max_rbuffer_size: ζȡ󻺳С
             WebsocketSession(boost::asio::ip::tcp::socket&& socket, size_t max_wbuffer_size, size_t max_rbuffer_size)
                 : m_resolver(socket.get_executor())
-                , m_socket(std::move(socket))
+                , m_socket(BindStrand(std::move(socket)))
                 , m_session_id(GetNextSessionID())
                 , m_max_rbuffer_size(max_rbuffer_size)
+                , m_writing(false)
+                , m_write_pending(false)
                 , m_current_send_msg(nullptr)
                 , m_max_wbuffer_size(max_wbuffer_size)
                 , m_connect_port(0)
@@ -89,6 +91,8 @@ namespace BTool
                 , m_socket(boost::asio::make_strand(ioc))
                 , m_session_id(GetNextSessionID())
                 , m_max_rbuffer_size(max_rbuffer_size)
+                , m_writing(false)
+                , m_write_pending(false)
                 , m_current_send_msg(nullptr)
                 , m_max_wbuffer_size(max_wbuffer_size)
                 , m_connect_port(0)
@@ -211,9 +215,9 @@ namespace BTool
                 close(ec);
             }
 
-            // ˳д
+            // ˳д, , ɶ߳ͬʱ
+            // дк, ͱ־߳̽ͲͶstrand(BindStrand), ͬһʱһ
             bool write(const char* send_msg, size_t size) {
-                std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
                 if (!m_atomic_switch.has_started()) {
                     return false;
                 }
@@ -223,35 +227,26 @@ namespace BTool
                 if (!m_write_buf.append(send_msg, size)) {
                     return false;
                 }
-                // Ƿڷ״̬
-                if (m_current_send_msg) {
-                    return true;
-                }
 
-                write();
+                post_write();
                 return true;
             }
 
-            // ڵǰϢβ׷
-            // max_package_size: Ϣ
+            // ڵǰϢβ׷, , ɶ߳ͬʱ
+            // ǰһϢδʱϲΪͬһwebsocketϢ, ΪϢ
+            // max_package_size: Ϣ, ϲﵽóʱΪϢ
             bool write_tail(const char* send_msg, size_t size, size_t max_package_size = 65535) {
-                std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
                 if (!m_atomic_switch.has_started()) {
                     return false;
                 }
-
-                if (m_max_wbuffer_size > NOLIMIT_WRITE_BUFFER_SIZE&& m_write_buf.size() + size > m_max_wbuffer_size) {
+                if (m_max_wbuffer_size > NOLIMIT_WRITE_BUFFER_SIZE && m_write_buf.size() + size > m_max_wbuffer_size) {
                     return false;
                 }
                 if (!m_write_buf.append_tail(send_msg, size, max_package_size)) {
                     return false;
                 }
-                // Ƿڷ״̬
-                if (m_current_send_msg) {
-                    return true;
-                }
 
-                write();
+                post_write();
                 return true;
             }
 
@@ -265,6 +260,26 @@ namespace BTool
             }
 
         protected:
+            // ȷsocketִΪstrand: beastҪϵȫ(ڲʱʱ)ͬһstrandִ, Ͷִ
+            // make_strandʱ; socketǨ½strand, Ǩʧʱԭִ, ɵ÷֤߳
+            static boost::asio::ip::tcp::socket BindStrand(boost::asio::ip::tcp::socket&& socket) {
+                auto executor = socket.get_executor();
+                // Ͱ汾boostany_io_executor::target<T>()У, target_type()ж
+                if (!socket.is_open()
+                    || executor.target_type() == typeid(boost::asio::strand<boost::asio::io_context::executor_type>)
+                    || executor.target_type() == typeid(boost::asio::strand<boost::asio::any_io_executor>)) {
+                    return std::move(socket);
+                }
+                boost::system::error_code ec;
+                auto protocol = socket.local_endpoint(ec).protocol();
+                if (!ec) {
+                    auto handle = socket.release(ec);
+                    if (!ec)
+                        return boost::asio::ip::tcp::socket(boost::asio::make_strand(executor), protocol, handle);
+                }
+                return std::move(socket);
+            }
+
             static SessionID GetNextSessionID() {
                 static std::atomic<SessionID> next_session_id(BoostNet::NetCallBack::InvalidSessionID);
                 return ++next_session_id;
@@ -294,9 +309,40 @@ namespace BTool
                 // }
             }
 
-            // 첽д
+            // ǼǷռͱ־, ɹͶݷͲ
+            // Ӻ, ͱ־ͷű־ݷǷͶ
+            void post_write() {
+                m_write_pending.exchange(true);
+                if (m_writing.exchange(true))
+                    return;
+                start_write();
+            }
+
+            // ͶݷͲstrand, ȡbeastڲ, ɷͱ־ߵ
+            void start_write() {
+                auto self = this->shared_from_this();
+                boost::asio::post(m_socket.get_executor(), [self]() { self->write(); });
+            }
+
+            // 첽д, ɷͱ־ߵ
             void write() {
-                m_current_send_msg = m_write_buf.pop_front();
+                if (m_atomic_switch.has_stoped()) {
+                    clear_write();
+                    return;
+                }
+
+                // , ǰǼݾɻȡ
+                m_write_pending.exchange(false);
+                m_current_send_msg = m_write_buf.pop_front_merged();
+                if (!m_current_send_msg) {
+                    // ͷű־ٴȷ, ֹڴڼǼ־δͷŶδͶ
+                    // δǼɺͶ, ѯȴ
+                    m_writing.store(false);
+                    if (m_write_pending.load() && !m_writing.exchange(true))
+                        start_write();
+                    return;
+                }
+
                 if constexpr (IsReadSome) {
                     m_socket.async_write(boost::asio::buffer(m_current_send_msg->data(), m_current_send_msg->size()), boost::beast::bind_front_handler(&WebsocketSessionType::handle_write, this->shared_from_this()));
                 }
@@ -317,7 +363,7 @@ namespace BTool
             }
 
             // ӻص
-            void handle_connect(const boost::beast::error_code& ec, const boost::asio::ip::tcp::resolver::results_type::endpoint_type& end_point)
+            void handle_connect(const boost::beast::error_code& ec, const boost::asio::ip::tcp::resolver::results_type::endpoint_type& /*end_point*/)
             {
                 if (ec) {
                     close(ec);
@@ -401,13 +447,15 @@ namespace BTool
             }
 
             // дص
-            void handle_write(const boost::beast::error_code& ec, size_t bytes_transferred)
+            void handle_write(const boost::beast::error_code& ec, size_t /*bytes_transferred*/)
             {
                 if (ec) {
                     shutdown(ec);
+                    clear_write();
                     return;
                 }
                 if (m_atomic_switch.has_stoped()) {
+                    clear_write();
                     return;
                 }
 
@@ -415,18 +463,20 @@ namespace BTool
                     m_handler.write_cbk_(m_session_id, m_current_send_msg->data(), m_current_send_msg->size());
                 }
 
-                std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
                 m_write_buf.release(m_current_send_msg);
-                if (m_write_buf.empty()) {
-                    return;
-                }
                 write();
             }
 
+            // մݲͷŷͱ־, ɷͱ־ߵ
+            void clear_write() {
+                m_write_buf.release(m_current_send_msg);
+                m_write_buf.clear();
+                m_writing.store(false);
+            }
+
             void close(const boost::beast::error_code& ec) {
                 {
                     boost::beast::error_code ignored_ec;
-                    std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
 
                     get_socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored_ec);
                     if(m_atomic_switch.has_init())
@@ -434,8 +484,7 @@ namespace BTool
                     m_read_buf.consume(m_read_buf.size());
 
                     m_atomic_switch.reset();
-                    m_write_buf.clear();
-                    m_current_send_msg.reset();
+                    // ɷͱ־ڷͻص
                 }
 
                 if (m_handler.close_cbk_) {
@@ -456,10 +505,12 @@ namespace BTool
             // С
             size_t                  m_max_rbuffer_size;
 
-            // дݱ
-            std::recursive_mutex    m_write_mtx;
             // д
             WriteBufferType         m_write_buf;
+            // Ƿзڷ
+            std::atomic<bool>       m_writing;
+            // ǷӴ͵ݵǼ˷
+            std::atomic<bool>       m_write_pending;
             // ǰڷ͵Ļ
             WriteMemoryStreamPtr    m_current_send_msg;
             // дС
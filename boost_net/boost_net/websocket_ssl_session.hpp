@@ -60,7 +60,7 @@ namespace BTool
             typedef websocket_ssl_stream_type::next_layer_type::next_layer_type::socket_type                ssl_socket_type;
             typedef boost::asio::ssl::context                                       ssl_context_type;
             typedef BoostNet::ReadBuffer                                            ReadBufferType;
-            typedef BoostNet::WriteBuffer<1024>                                     WriteBufferType;
+            typedef BoostNet::ConcurrentWriteBuffer<1024>                           WriteBufferType;
             typedef WriteBufferType::WriteMemoryStreamPtr                           WriteMemoryStreamPtr;
             typedef BoostNet::NetCallBack::SessionID                                SessionID;
 
@@ -77,9 +77,11 @@ namespace BTool
             // max_rbuffer_size: ζȡ󻺳С
             WebsocketSslSession(boost::asio::ip::tcp::socket&& socket, ssl_context_type& ctx, size_t max_wbuffer_size = NOLIMIT_WRITE_BUFFER_SIZE, size_t max_rbuffer_size = MAX_READSINGLE_BUFFER_SIZE)
                 : m_resolver(socket.get_executor())
-                , m_socket(std::move(socket), ctx)
+                , m_socket(BindStrand(std::move(socket)), ctx)
                 , m_session_id(GetNextSessionID())
                 , m_max_rbuffer_size(max_rbuffer_size)
+                , m_writing(false)
+                , m_write_pending(false)
 				, m_max_wbuffer_size(max_wbuffer_size)
                 , m_current_send_msg(nullptr)
                 , m_connect_port(0)
@@ -93,6 +95,8 @@ namespace BTool
                 , m_socket(boost::asio::make_strand(ioc), ctx)
                 , m_session_id(GetNextSessionID())
                 , m_max_rbuffer_size(max_rbuffer_size)
+                , m_writing(false)
+                , m_write_pending(false)
                 , m_max_wbuffer_size(max_wbuffer_size)
                 , m_current_send_msg(nullptr)
                 , m_connect_port(0)
@@ -236,9 +240,9 @@ namespace BTool
                 close(ec);
             }
 
-            // ˳д
+            // ˳д, , ɶ߳ͬʱ
+            // дк, ͱ־߳̽ͲͶstrand(BindStrand), ͬһʱһ
             bool write(const char* send_msg, size_t size) {
-                std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
                 if (!m_atomic_switch.has_started()) {
                     return false;
                 }
@@ -248,19 +252,15 @@ namespace BTool
                 if (!m_write_buf.append(send_msg, size)) {
                     return false;
                 }
-                // Ƿڷ״̬
-                if (m_current_send_msg) {
-                    return true;
-                }
 
-                write();
+                post_write();
                 return true;
             }
 
-            // ڵǰϢβ׷
-            // max_package_size: Ϣ
+            // ڵǰϢβ׷, , ɶ߳ͬʱ
+            // ǰһϢδʱϲΪͬһwebsocketϢ, ΪϢ
+            // max_package_size: Ϣ, ϲﵽóʱΪϢ
             bool write_tail(const char* send_msg, size_t size, size_t max_package_size = 65535) {
-                std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
                 if (!m_atomic_switch.has_started()) {
                     return false;
                 }
@@ -270,12 +270,8 @@ namespace BTool
                 if (!m_write_buf.append_tail(send_msg, size, max_package_size)) {
                     return false;
                 }
-                // Ƿڷ״̬
-                if (m_current_send_msg) {
-                    return true;
-                }
 
-                write();
+                post_write();
                 return true;
             }
 
@@ -289,6 +285,26 @@ namespace BTool
             }
 
         protected:
+            // ȷsocketִΪstrand: beastҪϵȫ(ڲʱʱ)ͬһstrandִ, Ͷִ
+            // make_strandʱ; socketǨ½strand, Ǩʧʱԭִ, ɵ÷֤߳
+            static boost::asio::ip::tcp::socket BindStrand(boost::asio::ip::tcp::socket&& socket) {
+                auto executor = socket.get_executor();
+                // Ͱ汾boostany_io_executor::target<T>()У, target_type()ж
+                if (!socket.is_open()
+                    || executor.target_type() == typeid(boost::asio::strand<boost::asio::io_context::executor_type>)
+                    || executor.target_type() == typeid(boost::asio::strand<boost::asio::any_io_executor>)) {
+                    return std::move(socket);
+                }
+                boost::system::error_code ec;
+                auto protocol = socket.local_endpoint(ec).protocol();
+                if (!ec) {
+                    auto handle = socket.release(ec);
+                    if (!ec)
+                        return boost::asio::ip::tcp::socket(boost::asio::make_strand(executor), protocol, handle);
+                }
+                return std::move(socket);
+            }
+
             static SessionID GetNextSessionID() {
                 static std::atomic<SessionID> next_session_id(BoostNet::NetCallBack::InvalidSessionID);
                 return ++next_session_id;
@@ -316,9 +332,40 @@ namespace BTool
                 // }
             }
 
-            // 첽д
+            // ǼǷռͱ־, ɹͶݷͲ
+            // Ӻ, ͱ־ͷű־ݷǷͶ
+            void post_write() {
+                m_write_pending.exchange(true);
+                if (m_writing.exchange(true))
+                    return;
+                start_write();
+            }
+
+            // ͶݷͲstrand, ȡbeastڲ, ɷͱ־ߵ
+            void start_write() {
+                auto self = this->shared_from_this();
+                boost::asio::post(m_socket.get_executor(), [self]() { self->write(); });
+            }
+
+            // 첽д, ɷͱ־ߵ
             void write() {
-                m_current_send_msg = m_write_buf.pop_front();
+                if (m_atomic_switch.has_stoped()) {
+                    clear_write();
+                    return;
+                }
+
+                // , ǰǼݾɻȡ
+                m_write_pending.exchange(false);
+                m_current_send_msg = m_write_buf.pop_front_merged();
+                if (!m_current_send_msg) {
+                    // ͷű־ٴȷ, ֹڴڼǼ־δͷŶδͶ
+                    // δǼɺͶ, ѯȴ
+                    m_writing.store(false);
+                    if (m_write_pending.load() && !m_writing.exchange(true))
+                        start_write();
+                    return;
+                }
+
                 if constexpr (IsReadSome) {
                     m_socket.async_write(boost::asio::buffer(m_current_send_msg->data(), m_current_send_msg->size()), boost::beast::bind_front_handler(&WebsocketSslSessionType::handle_write, this->shared_from_this()));
                 }
@@ -438,13 +485,15 @@ namespace BTool
             }
 
             // дص
-            void handle_write(const boost::system::error_code& ec, size_t bytes_transferred)
+            void handle_write(const boost::system::error_code& ec, size_t /*bytes_transferred*/)
             {
                 if (ec) {
                     shutdown(ec);
+                    clear_write();
                     return;
                 }
                 if (m_atomic_switch.has_stoped()) {
+                    clear_write();
                     return;
                 }
 
@@ -452,18 +501,20 @@ namespace BTool
                     m_handler.write_cbk_(m_session_id, m_current_send_msg->data(), m_current_send_msg->size());
                 }
 
-                std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
                 m_write_buf.release(m_current_send_msg);
-                if (m_write_buf.empty()) {
-                    return;
-                }
                 write();
             }
 
+            // մݲͷŷͱ־, ɷͱ־ߵ
+            void clear_write() {
+                m_write_buf.release(m_current_send_msg);
+                m_write_buf.clear();
+                m_writing.store(false);
+            }
+
             void close(const boost::beast::error_code& ec) {
                 {
                     boost::beast::error_code ignored_ec;
-                    std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
 
                     get_socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored_ec);
                     if(m_atomic_switch.has_init())
@@ -471,8 +522,7 @@ namespace BTool
                     m_read_buf.consume(m_read_buf.size());
 
                     m_atomic_switch.reset();
-                    m_write_buf.clear();
-                    m_current_send_msg.reset();
+                    // ɷͱ־ڷͻص
                 }
 
                 if (m_handler.close_cbk_) {
@@ -493,10 +543,12 @@ namespace BTool
             // С
             size_t                  m_max_rbuffer_size;
 
-            // дݱ
-            std::recursive_mutex    m_write_mtx;
             // д
             WriteBufferType         m_write_buf;
+            // Ƿзڷ
+            std::atomic<bool>       m_writing;
+            // ǷӴ͵ݵǼ˷
+            std::atomic<bool>       m_write_pending;
             // дС
             size_t                  m_max_wbuffer_size;
             // ǰڷ͵Ļ
@@ -0,0 +1,198 @@
+/******************************************************************************
+File name:  frame_decoder.hpp
+Author:	    AChar
+Purpose:    ݷ֡
+Note:       ǩ: long long(const char* data, size_t len, std::string_view& body)
+            ֵ0: ѽ֡, ֡(֡ͷ/ָ), bodyΪ֡
+            ֵ0: ݲ, ȴ
+            ֵС0: ݷǷ, ӽر
+            ɴ״̬, ÿӳж, ״̬Ľṩreset(), ӿʱResetFrameDecoderλ
+            ԶĴ״̬뾭MakeFrameDecoderװע, ֱӸֵFrameDecoderʱ޷ʶreset(), ؿӺ󲻻Ḵλ
+*****************************************************************************/
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <boost/endian/conversion.hpp>
+
+namespace BTool
+{
+    namespace BoostNet
+    {
+        typedef std::function<long long(const char* data, size_t len, std::string_view& body)> FrameDecoder;
+
+        // ǰ׺֡, ֡ͷΪHeadType͵֡峤
+        template<typename HeadType = uint32_t>
+        class LengthFrameDecoder
+        {
+        public:
+            // max_body_size: ֡󳤶, 0ʾ, ʱΪǷ
+            // include_head: ֶǷ֡ͷ
+            // big_endian: ֶǷΪֽ
+            LengthFrameDecoder(size_t max_body_size = 0, bool include_head = false, bool big_endian = false)
+                : m_max_body_size(max_body_size)
+                , m_include_head(include_head)
+                , m_big_endian(big_endian)
+            {
+            }
+
+            long long operator()(const char* data, size_t len, std::string_view& body) const {
+                if (len < sizeof(HeadType))
+                    return 0;
+
+                HeadType head;
+                memcpy(&head, data, sizeof(HeadType));
+                if (m_big_endian)
+                    boost::endian::big_to_native_inplace(head);
+
+                size_t body_size = static_cast<size_t>(head);
+                if (m_include_head) {
+                    if (body_size < sizeof(HeadType))
+                        return -1;
+                    body_size -= sizeof(HeadType);
+                }
+                if (m_max_body_size != 0 && body_size > m_max_body_size)
+                    return -1;
+
+                if (len < sizeof(HeadType) + body_size)
+                    return 0;
+
+                body = std::string_view(data + sizeof(HeadType), body_size);
+                return static_cast<long long>(sizeof(HeadType) + body_size);
+            }
+
+        private:
+            size_t  m_max_body_size;
+            bool    m_include_head;
+            bool    m_big_endian;
+        };
+
+        // ָ֡, ֡岻ָ
+        class DelimiterFrameDecoder
+        {
+        public:
+            // delimiter: ָ, Ϊ
+            // max_body_size: ֡󳤶, 0ʾ, ʱΪǷ
+            DelimiterFrameDecoder(std::string delimiter = "\r\n", size_t max_body_size = 0)
+                : m_delimiter(std::move(delimiter))
+                , m_max_body_size(max_body_size)
+                , m_scan_offset(0)
+            {
+            }
+
+            // λ״̬, δ֡(ؿ)
+            void reset() {
+                m_scan_offset = 0;
+            }
+
+            long long operator()(const char* data, size_t len, std::string_view& body) {
+                if (m_delimiter.empty())
+                    return -1;
+
+                // δ˵ѱⲿ, ϴβλʧЧ
+                if (len <= m_scan_offset)
+                    m_scan_offset = 0;
+
+                // ϴδƥ䴦, ظɨ
+                std::string_view view(data, len);
+                size_t pos = view.find(m_delimiter, m_scan_offset);
+                if (pos == std::string_view::npos) {
+                    if (m_max_body_size != 0 && len >= m_max_body_size + m_delimiter.length())
+                        return -1;
+                    m_scan_offset = len >= m_delimiter.length() ? len - m_delimiter.length() + 1 : 0;
+                    return 0;
+                }
+
+                m_scan_offset = 0;
+                if (m_max_body_size != 0 && pos > m_max_body_size)
+                    return -1;
+
+                body = view.substr(0, pos);
+                return static_cast<long long>(pos + m_delimiter.length());
+            }
+
+        private:
+            std::string m_delimiter;
+            size_t      m_max_body_size;
+            // ´βʼλ
+            size_t      m_scan_offset;
+        };
+
+        // ɸλװ, ͺԿɾResetFrameDecoderreset()
+        // ʱڲ, Ӹ״̬໥
+        class ResettableFrameDecoder
+        {
+            struct Holder {
+                virtual ~Holder() {}
+                virtual Holder* clone() const = 0;
+                virtual long long decode(const char* data, size_t len, std::string_view& body) = 0;
+                virtual void reset() = 0;
+            };
+
+            template<typename Decoder>
+            struct DecoderHolder : public Holder {
+                DecoderHolder(Decoder decoder) : m_decoder(std::move(decoder)) {}
+                Holder* clone() const override { return new DecoderHolder(m_decoder); }
+                long long decode(const char* data, size_t len, std::string_view& body) override { return m_decoder(data, len, body); }
+                void reset() override { m_decoder.reset(); }
+                Decoder m_decoder;
+            };
+
+        public:
+            template<typename Decoder>
+            explicit ResettableFrameDecoder(Decoder decoder)
+                : m_holder(new DecoderHolder<Decoder>(std::move(decoder)))
+            {
+            }
+            ResettableFrameDecoder(const ResettableFrameDecoder& rhs)
+                : m_holder(rhs.m_holder->clone())
+            {
+            }
+            ResettableFrameDecoder(ResettableFrameDecoder&& rhs) = default;
+            ResettableFrameDecoder& operator=(const ResettableFrameDecoder& rhs) {
+                if (this != &rhs)
+                    m_holder.reset(rhs.m_holder->clone());
+                return *this;
+            }
+            ResettableFrameDecoder& operator=(ResettableFrameDecoder&& rhs) = default;
+
+            long long operator()(const char* data, size_t len, std::string_view& body) {
+                return m_holder->decode(data, len, body);
+            }
+
+            void reset() {
+                m_holder->reset();
+            }
+
+        private:
+            std::unique_ptr<Holder> m_holder;
+        };
+
+        template<typename Decoder, typename = void>
+        struct has_frame_decoder_reset : std::false_type {};
+        template<typename Decoder>
+        struct has_frame_decoder_reset<Decoder, std::void_t<decltype(std::declval<Decoder&>().reset())>> : std::true_type {};
+
+        // ɷ֡, ṩreset()ĽԶװΪResettableFrameDecoder
+        template<typename Decoder>
+        FrameDecoder MakeFrameDecoder(Decoder decoder) {
+            if constexpr (has_frame_decoder_reset<Decoder>::value 
+                && !std::is_same_v<Decoder, DelimiterFrameDecoder> && !std::is_same_v<Decoder, ResettableFrameDecoder>)
+                return FrameDecoder(ResettableFrameDecoder(std::move(decoder)));
+            else
+                return FrameDecoder(std::move(decoder));
+        }
+
+        // λ״̬, ʶDelimiterFrameDecoderMakeFrameDecoder/ResettableFrameDecoderװĽ, 
+        inline void ResetFrameDecoder(FrameDecoder& decoder) {
+            if (auto delimiter_decoder = decoder.target<DelimiterFrameDecoder>())
+                delimiter_decoder->reset();
+            else if (auto resettable_decoder = decoder.target<ResettableFrameDecoder>())
+                resettable_decoder->reset();
+        }
+    }
+}
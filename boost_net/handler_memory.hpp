@@ -0,0 +1,131 @@
+/******************************************************************************
+File name:  handler_memory.hpp
+Author:	    AChar
+Purpose:    첽Ķڴ鼰
+Note:       ͬһڴͬһʱ̽һ;첽ʹ(ӵĶ/д/Ͷݸһ),
+            asioڵɻصǰͷŲڴ, ʻصзһͬɸͬһڴ;
+            ڴ鱻ռûСʱ˻operator new, Ӱȷ
+            صڴ(ӵshared_ptr), ҲֱͶstrand: io߳Ͷʱstrand
+            ͬһ, ò, ͷ, ӦͶio_contextɷstrand
+*****************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace BTool
+{
+    namespace BoostNet
+    {
+        // 첽Ķڴ, ʱһԷ, ͷſλڲͬ߳
+        class HandlerMemory
+        {
+        public:
+            explicit HandlerMemory(size_t capacity)
+                : m_storage(new std::max_align_t[(capacity + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)])
+                , m_capacity(capacity)
+                , m_in_use(false)
+            {
+            }
+
+            HandlerMemory(const HandlerMemory&) = delete;
+            HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+            void* allocate(size_t size) {
+                if (size <= m_capacity && !m_in_use.exchange(true, std::memory_order_acquire))
+                    return m_storage.get();
+                return ::operator new(size);
+            }
+
+            void deallocate(void* ptr) {
+                if (ptr == m_storage.get()) {
+                    m_in_use.store(false, std::memory_order_release);
+                    return;
+                }
+                ::operator delete(ptr);
+            }
+
+        private:
+            std::unique_ptr<std::max_align_t[]> m_storage;
+            size_t                              m_capacity;
+            std::atomic<bool>                   m_in_use;
+        };
+
+        // HandlerMemoryķ, ΪɻصĹasioڴ
+        template<typename T>
+        class HandlerAllocator
+        {
+        public:
+            typedef T value_type;
+
+            explicit HandlerAllocator(HandlerMemory& memory) noexcept
+                : m_memory(&memory)
+            {
+            }
+
+            template<typename U>
+            HandlerAllocator(const HandlerAllocator<U>& other) noexcept
+                : m_memory(other.m_memory)
+            {
+            }
+
+            T* allocate(size_t n) const {
+                return static_cast<T*>(m_memory->allocate(sizeof(T) * n));
+            }
+
+            void deallocate(T* ptr, size_t) const {
+                m_memory->deallocate(ptr);
+            }
+
+            template<typename U>
+            bool operator==(const HandlerAllocator<U>& other) const noexcept {
+                return m_memory == other.m_memory;
+            }
+
+            template<typename U>
+            bool operator!=(const HandlerAllocator<U>& other) const noexcept {
+                return m_memory != other.m_memory;
+            }
+
+        private:
+            template<typename> friend class HandlerAllocator;
+            HandlerMemory*  m_memory;
+        };
+
+        // HandlerMemoryɻص, پbind_executorִ, ֮
+        template<typename Handler>
+        class AllocHandler
+        {
+        public:
+            typedef HandlerAllocator<Handler> allocator_type;
+
+            AllocHandler(HandlerMemory& memory, Handler handler)
+                : m_memory(memory)
+                , m_handler(std::move(handler))
+            {
+            }
+
+            allocator_type get_allocator() const noexcept {
+                return allocator_type(m_memory);
+            }
+
+            template<typename... Args>
+            void operator()(Args&&... args) {
+                m_handler(std::forward<Args>(args)...);
+            }
+
+        private:
+            HandlerMemory&  m_memory;
+            Handler         m_handler;
+        };
+
+        template<typename Handler>
+        inline AllocHandler<std::decay_t<Handler>> MakeAllocHandler(HandlerMemory& memory, Handler&& handler) {
+            return AllocHandler<std::decay_t<Handler>>(memory, std::forward<Handler>(handler));
+        }
+    }
+}
@@ -9,6 +9,9 @@ Note:    
 #pragma once
 
 #include <memory>
+#include <tuple>
+#include <vector>
+#include <string>
 #if defined(_HAS_CXX17) || (__cplusplus >= 201703L)
 # include <string_view>
 #endif
@@ -38,7 +41,39 @@ namespace BTool {
                                         || std::is_same_v<typename std::decay_t<T>, std::string_view>
 #endif
                                         ;
-    
+
+    // ṹֶб, ڽṹ嶨, Ϊʱֶл, ڴ濽
+    // ֶΰԳȽ, ޹; ֶοΪstd::string, std::string_view, std::vectorṹ
+    // ֶṹϣ, MemoryStream::get_args_schema
+    // : struct order { int64_t id; double price; std::string symbol; BTOOL_MEMORY_FIELDS(id, price, symbol) };
+#define BTOOL_MEMORY_FIELDS(...)                                                                \
+    auto memory_fields() { return std::tie(__VA_ARGS__); }                                      \
+    auto memory_fields() const { return std::tie(__VA_ARGS__); }                                \
+    static constexpr std::string_view memory_field_names() { return #__VA_ARGS__; }
+
+    template <typename T, typename = void>
+    struct has_memory_fields : std::false_type {};
+    template <typename T>
+    struct has_memory_fields<T, std::void_t<decltype(std::declval<const T&>().memory_fields())>> : std::true_type {};
+    template <typename T>
+    inline constexpr bool has_memory_fields_v = has_memory_fields<std::decay_t<T>>::value;
+
+    // ṹֶ, std::tuple<ֶ...>
+    template <typename T>
+    struct memory_fields_tuple;
+    template <typename ...T>
+    struct memory_fields_tuple<std::tuple<T...>> {
+        typedef std::tuple<std::decay_t<T>...> type;
+    };
+    template <typename T>
+    using memory_fields_t = typename memory_fields_tuple<decltype(std::declval<std::decay_t<T>&>().memory_fields())>::type;
+
+    // 䳤, лΪ Ԫ(uint32_t) + Ԫ...
+    template <typename> struct is_memory_vector : std::false_type {};
+    template <typename T, typename Alloc> struct is_memory_vector<std::vector<T, Alloc>> : std::true_type {};
+    template <typename T>
+    inline constexpr bool is_memory_vector_v = is_memory_vector<std::decay_t<T>>::value;
+
     class MemoryStream
     {
     public:
@@ -153,7 +188,7 @@ namespace BTool {
         }
 
     public:
-        const char* const data() const {
+        const char* data() const {
             return m_buffer;
         }
 
@@ -270,7 +305,8 @@ namespace BTool {
         // ʱԭ,Ҽغ󲻻Ưλýλ
         void load(const char* buffer, size_t len) {
             reset_capacity(len);
-            memcpy(m_buffer, buffer, len);
+            if (len > 0)
+                memcpy(m_buffer, buffer, len);
             m_buffer_size = len;
             m_offset = 0;
         }
@@ -279,7 +315,8 @@ namespace BTool {
         void load(const char* buffer, size_t len, size_t capacity) {
             capacity = std::max(capacity, len);
             reset_capacity(capacity);
-            memcpy(m_buffer, buffer, len);
+            if (len > 0)
+                memcpy(m_buffer, buffer, len);
             m_buffer_size = len;
             m_offset = 0;
         }
@@ -315,7 +352,24 @@ namespace BTool {
         }
         template<typename Type>
         void append(Type&& src) {
-            append(&src, sizeof(Type));
+            typedef std::decay_t<Type> value_type;
+            if constexpr (has_memory_fields_v<value_type>) {
+                append_args(src.memory_fields());
+            }
+            else if constexpr (is_memory_vector_v<value_type>) {
+                typedef typename value_type::value_type elem_type;
+                static_assert(!std::is_same_v<elem_type, bool>, "std::vector<bool> is not supported");
+                append(uint32_t(src.size()));
+                if constexpr (is_raw_type<elem_type>())
+                    append(src.data(), src.size() * sizeof(elem_type));
+                else {
+                    for (auto& item : src)
+                        append(item);
+                }
+            }
+            else {
+                append(&src, sizeof(Type));
+            }
         }
         void append(const std::string& data) {
             append(uint32_t(data.length())); // һ㲻ᳬֵ
@@ -393,7 +447,15 @@ namespace BTool {
         // offset_flag : ǷҪƯƵǰƯλ
         template<typename Type>
         void read(Type* pDst, bool offset_flag) {
-            read(pDst, sizeof(Type), offset_flag);
+            if constexpr (has_memory_fields_v<Type> || is_memory_vector_v<Type>) {
+                size_t cur_offset(m_offset);
+                read_memory(pDst);
+                if (!offset_flag)
+                    m_offset = cur_offset;
+            }
+            else {
+                read(pDst, sizeof(Type), offset_flag);
+            }
         }
         void read(MemoryStream* pDst, bool offset_flag) {
             uint32_t length = 0;
@@ -478,6 +540,28 @@ namespace BTool {
             return rslt;
         }
 
+        // У鵱ǰƯλʣݿΪType, ֮read_argsԽ
+        // 䳤Աʱ賤ڱ, Ƚһ; У鳤ǰ׺, 
+        template <typename Type>
+        bool check_args() const {
+            size_t length = get_res_length();
+            if constexpr (!args_has_memory<Type>()) {
+                return length >= get_args_sizeof<Type>();
+            }
+            else {
+                size_t pos = 0;
+                return check_arg<Type>(m_buffer + m_offset, pos, length);
+            }
+        }
+
+        // ṹϣ(FNV-1a), ȡлıĽṹ: (//ֽڿ/䳤ڴ//ṹ), ṹֶ
+        // std::tupleչΪԪ, ͬ; Ͳַ, öͬ
+        template <typename...Args>
+        static constexpr uint32_t get_args_schema(uint32_t hash = 2166136261u) {
+            ((hash = get_type_schema<Args>(hash)), ...);
+            return hash;
+        }
+
         // tuple -> args...
         template<typename Type, typename... Args, typename type_is_tuple = typename std::enable_if<!is_tuple_v<Type>, void >::type>
         static std::tuple<Type, typename std::decay_t<Args>...> tuple_merge(Type&& type, std::tuple<Args...>&& tp) {
@@ -526,9 +610,12 @@ namespace BTool {
         template <typename Type>
         static constexpr typename std::enable_if<!is_tuple_v<Type>, size_t>::type
             get_args_sizeof() {
-            if constexpr (is_memory_type<Type>)
+            if constexpr (is_memory_type<Type> || is_memory_vector_v<Type>)
                 return sizeof(uint32_t);// ԴڴĬϳΪ0, Ҫע
-            return sizeof(Type);
+            else if constexpr (has_memory_fields_v<Type>)
+                return get_args_sizeof<memory_fields_t<Type>>();
+            else
+                return sizeof(Type);
         }
         template <typename Type>
         static constexpr typename std::enable_if<is_tuple_v<Type>, size_t>::type
@@ -546,9 +633,30 @@ namespace BTool {
         template <typename Type>
         static typename std::enable_if<!is_tuple_v<Type>, size_t>::type
             get_args_length(const typename std::decay_t<Type>& type){
-            if constexpr (is_memory_type<Type>)
+            typedef std::decay_t<Type> value_type;
+            if constexpr (is_memory_type<Type>) {
                 return sizeof(uint32_t) + type.length();
-            return sizeof(Type);
+            }
+            else if constexpr (has_memory_fields_v<value_type>) {
+                if constexpr (!args_has_memory<value_type>())
+                    return get_args_sizeof<value_type>();
+                else
+                    return get_tp_length(type.memory_fields());
+            }
+            else if constexpr (is_memory_vector_v<value_type>) {
+                typedef typename value_type::value_type elem_type;
+                if constexpr (!args_has_memory<elem_type>())
+                    return sizeof(uint32_t) + type.size() * get_args_sizeof<elem_type>();
+                else {
+                    size_t length = sizeof(uint32_t);
+                    for (auto& item : type)
+                        length += get_args_length<elem_type>(item);
+                    return length;
+                }
+            }
+            else {
+                return sizeof(Type);
+            }
         }
         template <typename Type>
         static typename std::enable_if<is_tuple_v<Type>, size_t>::type
@@ -566,7 +674,10 @@ namespace BTool {
         template <typename Type=void>
         static constexpr typename std::enable_if<!is_tuple_v<Type>, bool>::type
             args_has_memory() {
-            return is_memory_type<Type>;
+            if constexpr (has_memory_fields_v<Type>)
+                return args_has_memory<memory_fields_t<Type>>();
+            else
+                return is_memory_type<Type> || is_memory_vector_v<Type>;
         }
         template <typename Type>
         static constexpr typename std::enable_if<is_tuple_v<Type>, bool>::type
@@ -647,6 +758,138 @@ namespace BTool {
             return args_has_memory<typename std::tuple_element<Indexes, Tuple>::type...>();
         }
 
+        // лʽڴ, 忽
+        template <typename Type>
+        static constexpr bool is_raw_type() {
+            return std::is_trivially_copyable_v<Type> && !has_memory_fields_v<Type> && !is_memory_type<Type>;
+        }
+
+        // ȡṹ弰
+        template <typename Type>
+        void read_memory(Type* pDst) {
+            if constexpr (has_memory_fields_v<Type>) {
+                std::apply([this](auto&... fields) { (read(&fields), ...); }, pDst->memory_fields());
+            }
+            else {
+                typedef typename Type::value_type elem_type;
+                uint32_t count = 0;
+                read(&count, sizeof(count), true);
+                pDst->resize(count);
+                if constexpr (is_raw_type<elem_type>())
+                    read(pDst->data(), count * sizeof(elem_type), true);
+                else {
+                    for (auto& item : *pDst)
+                        read(&item);
+                }
+            }
+        }
+
+        // У鵥, posΪУ鳤
+        template <typename Type>
+        static bool check_arg(const char* data, size_t& pos, size_t length) {
+            typedef std::decay_t<Type> value_type;
+            if constexpr (is_tuple_v<value_type>) {
+                return check_tp<value_type>(data, pos, length, std::make_index_sequence<std::tuple_size<value_type>::value>{});
+            }
+            else if constexpr (!args_has_memory<value_type>()) {
+                constexpr size_t size = get_args_sizeof<value_type>();
+                if (length - pos < size)
+                    return false;
+                pos += size;
+                return true;
+            }
+            else if constexpr (has_memory_fields_v<value_type>) {
+                return check_arg<memory_fields_t<value_type>>(data, pos, length);
+            }
+            else {
+                uint32_t count = 0;
+                if (length - pos < sizeof(count))
+                    return false;
+                memcpy(&count, data + pos, sizeof(count));
+                pos += sizeof(count);
+                if constexpr (is_memory_type<value_type>) {
+                    if (length - pos < count)
+                        return false;
+                    pos += count;
+                    return true;
+                }
+                else {
+                    typedef typename value_type::value_type elem_type;
+                    if constexpr (!args_has_memory<elem_type>()) {
+                        constexpr size_t size = get_args_sizeof<elem_type>();
+                        if (size != 0 && (length - pos) / size < count)
+                            return false;
+                        pos += count * size;
+                        return true;
+                    }
+                    else {
+                        for (uint32_t i = 0; i < count; ++i) {
+                            if (!check_arg<elem_type>(data, pos, length))
+                                return false;
+                        }
+                        return true;
+                    }
+                }
+            }
+        }
+        template <typename Tuple, size_t... Indexes>
+        static bool check_tp(const char* data, size_t& pos, size_t length, std::index_sequence<Indexes...>) {
+            return (check_arg<typename std::tuple_element<Indexes, Tuple>::type>(data, pos, length) && ...);
+        }
+
+        // ṹϣ
+        static constexpr uint32_t schema_mix(uint32_t hash, uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                hash ^= (value >> (i * 8)) & 0xFF;
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+        // ֶԿհ, Զŷָ
+        static constexpr uint32_t schema_mix(uint32_t hash, std::string_view names) {
+            for (char c : names) {
+                if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+                    continue;
+                hash ^= (uint8_t)c;
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+        template <typename Type>
+        static constexpr uint32_t get_type_schema(uint32_t hash) {
+            typedef std::decay_t<Type> value_type;
+            if constexpr (is_tuple_v<value_type>) {
+                return get_tp_schema<value_type>(hash, std::make_index_sequence<std::tuple_size<value_type>::value>{});
+            }
+            else if constexpr (has_memory_fields_v<value_type>) {
+                hash = schema_mix(hash, value_type::memory_field_names());
+                hash = schema_mix(hash, uint32_t('{'));
+                hash = get_type_schema<memory_fields_t<value_type>>(hash);
+                return schema_mix(hash, uint32_t('}'));
+            }
+            else if constexpr (is_memory_type<value_type>) {
+                return schema_mix(hash, uint32_t('s'));
+            }
+            else if constexpr (is_memory_vector_v<value_type>) {
+                hash = schema_mix(hash, uint32_t('v'));
+                return get_type_schema<typename value_type::value_type>(hash);
+            }
+            else if constexpr (std::is_floating_point_v<value_type>) {
+                return schema_mix(schema_mix(hash, uint32_t('f')), uint32_t(sizeof(value_type)));
+            }
+            else if constexpr (std::is_integral_v<value_type> || std::is_enum_v<value_type>) {
+                return schema_mix(schema_mix(hash, uint32_t('i')), uint32_t(sizeof(value_type)));
+            }
+            else {
+                return schema_mix(schema_mix(hash, uint32_t('b')), uint32_t(sizeof(value_type)));
+            }
+        }
+        template <typename Tuple, size_t... Indexes>
+        static constexpr uint32_t get_tp_schema(uint32_t hash, std::index_sequence<Indexes...>) {
+            ((hash = get_type_schema<typename std::tuple_element<Indexes, Tuple>::type>(hash)), ...);
+            return hash;
+        }
+
     private:
         size_t      m_buffer_size;  // ǰܳ
         size_t      m_offset;       // ǰڴƯλ
@@ -1,9 +1,18 @@
 #pragma once
 
 #include <queue>
+#include <vector>
+#include <atomic>
+#include <limits>
 #include <boost/asio.hpp>
 #include "memory_stream.hpp"
 
+#ifdef __linux__
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/syscall.h>
+#endif
+
 namespace BTool
 {
     namespace BoostNet
@@ -75,6 +84,165 @@ namespace BTool
             streambuf_type m_buf;
         };
 
+        // νջ
+        // Linux½ͬһmemfdڴӳ, Խβַ, 追ȡ;
+        // ƽ̨ӳʧʱ˻ΪͨԻ, ʣβռ䲻ʱǰ
+        // ̶, Զ, ⲿ輰ʱconsume
+        class MirrorReadBuffer
+        {
+        public:
+            typedef size_t size_type;
+            typedef boost::asio::mutable_buffer mutable_buffers_type;
+            typedef boost::asio::const_buffer   const_buffers_type;
+
+        public:
+            // capacity: С, ʵȡΪϵͳҳС
+            MirrorReadBuffer(size_type capacity)
+                : m_data(nullptr)
+                , m_capacity(0)
+                , m_read_offset(0)
+                , m_size(0)
+                , m_mirrored(false)
+            {
+                size_type page_size = GetPageSize();
+                m_capacity = (std::max<size_type>(capacity, 1) + page_size - 1) / page_size * page_size;
+                m_mirrored = create_mirror();
+                if (!m_mirrored) {
+                    m_data = (char*)malloc(m_capacity);
+                    if (!m_data)
+                        throw std::bad_alloc();
+                }
+            }
+            ~MirrorReadBuffer() {
+#ifdef __linux__
+                if (m_mirrored) {
+                    munmap(m_data, m_capacity * 2);
+                    return;
+                }
+#endif
+                free(m_data);
+            }
+
+            MirrorReadBuffer(const MirrorReadBuffer&) = delete;
+            MirrorReadBuffer& operator=(const MirrorReadBuffer&) = delete;
+
+        public:
+            // ȡ
+            size_type capacity() const {
+                return m_capacity;
+            }
+
+            // ȡʣдֽ
+            size_type free_size() const {
+                return m_capacity - m_size;
+            }
+
+            // ȡoutput_sizeд뻺
+            mutable_buffers_type prepare(size_type output_size) {
+                output_size = std::min(output_size, free_size());
+                if (m_mirrored) {
+                    return mutable_buffers_type(m_data + (m_read_offset + m_size) % m_capacity, output_size);
+                }
+
+                // βռ䲻ʱǰ
+                if (m_read_offset + m_size + output_size > m_capacity) {
+                    memmove(m_data, m_data + m_read_offset, m_size);
+                    m_read_offset = 0;
+                }
+                return mutable_buffers_type(m_data + m_read_offset + m_size, output_size);
+            }
+
+            // дnֽɶ
+            void commit(size_type n) {
+                m_size += std::min(n, free_size());
+            }
+
+            // ȡɶֽ
+            size_type size() const {
+                return m_size;
+            }
+
+            // ȡɶ׵ַ, ɶʼ
+            const char* peek() const {
+                return m_data + m_read_offset;
+            }
+
+            // ȡɶ
+            const_buffers_type data() const {
+                return const_buffers_type(peek(), m_size);
+            }
+
+            // Ƴɶͷnֽ
+            void consume(size_type n) {
+                n = std::min(n, m_size);
+                m_size -= n;
+                if (m_size == 0) {
+                    m_read_offset = 0;
+                    return;
+                }
+                m_read_offset = (m_read_offset + n) % m_capacity;
+            }
+
+        private:
+            static size_type GetPageSize() {
+#ifdef __linux__
+                long page_size = sysconf(_SC_PAGESIZE);
+                return page_size > 0 ? (size_type)page_size : 4096;
+#else
+                return 4096;
+#endif
+            }
+
+            // ˫ӳ, ʧܷfalse
+            bool create_mirror() {
+#if defined(__linux__) && defined(SYS_memfd_create)
+                int fd = (int)syscall(SYS_memfd_create, "btool_read_buffer", 0);
+                if (fd < 0)
+                    return false;
+
+                if (ftruncate(fd, m_capacity) != 0) {
+                    close(fd);
+                    return false;
+                }
+
+                // ռСַ, ٽmemfd̶ֱӳǰ
+                void* base = mmap(nullptr, m_capacity * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (base == MAP_FAILED) {
+                    close(fd);
+                    return false;
+                }
+
+                char* addr = static_cast<char*>(base);
+                if (mmap(addr, m_capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+                    || mmap(addr + m_capacity, m_capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+                {
+                    munmap(base, m_capacity * 2);
+                    close(fd);
+                    return false;
+                }
+
+                // ӳ佨󼴿ɹر, ռ
+                close(fd);
+                m_data = addr;
+                return true;
+#else
+                return false;
+#endif
+            }
+
+        private:
+            // ׵ַ
+            char*       m_data;
+            // 
+            size_type   m_capacity;
+            // ɶʼƫ, ʼСm_capacity
+            size_type   m_read_offset;
+            // ɶֽ
+            size_type   m_size;
+            // ǷΪ˫ӳ
+            bool        m_mirrored;
+        };
+
         // ͻ
         template<size_t DEFAULT_SIZE = 1024>
         class WriteBuffer
@@ -140,6 +308,28 @@ namespace BTool
                 return msg;
             }
 
+            // ȡƳ, ٻȡһ, ھۺϷ
+            // items: ݼ, ׷ĩβ
+            // max_count: ȡ
+            // max_bytes: ȡֽ, ʱɻȡ
+            // رλȡֽ
+            size_t pop_front(std::vector<WriteMemoryStreamPtr>& items, size_t max_count, size_t max_bytes) {
+                size_t bytes = 0;
+                size_t count = 0;
+                while (!m_send_items.empty() && count < max_count) {
+                    auto& msg = m_send_items.front();
+                    if (count > 0 && bytes + msg->size() > max_bytes)
+                        break;
+
+                    bytes += msg->size();
+                    ++count;
+                    items.push_back(std::move(msg));
+                    m_send_items.pop_front();
+                }
+                m_all_len -= bytes;
+                return bytes;
+            }
+
             // 
             void clear() {
                 while (!m_send_items.empty()) {
@@ -159,6 +349,14 @@ namespace BTool
                     m_free_pool.push(std::move(obj));
                 }
             }
+            // 黹, 黹objs
+            void release(std::vector<WriteMemoryStreamPtr>& objs) {
+                for (auto& obj : objs) {
+                    if (obj)
+                        m_free_pool.push(std::move(obj));
+                }
+                objs.clear();
+            }
 
             WriteMemoryStreamPtr acquire(const char* const msg, size_t len) {
                 if (!m_free_pool.empty()) {
@@ -190,5 +388,319 @@ namespace BTool
             // ǰܵȴݳ
             size_t                              m_all_len;
         };
+
+        // н߶߶, ȡΪ2
+        // ڶ̼߳黹/ȡл
+        template<typename Type>
+        class BoundedMpmcQueue
+        {
+            struct Cell {
+                std::atomic<size_t> sequence_;
+                Type                data_;
+            };
+
+        public:
+            BoundedMpmcQueue(size_t capacity)
+                : m_mask(RoundUpPow2(capacity) - 1)
+                , m_cells(new Cell[m_mask + 1])
+                , m_enqueue_pos(0)
+                , m_dequeue_pos(0)
+            {
+                for (size_t i = 0; i <= m_mask; ++i) {
+                    m_cells[i].sequence_.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            // д, ʱfalse
+            bool push(const Type& data) {
+                Cell* cell = nullptr;
+                size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                for (;;) {
+                    cell = &m_cells[pos & m_mask];
+                    size_t seq = cell->sequence_.load(std::memory_order_acquire);
+                    intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+                    if (diff == 0) {
+                        if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else if (diff < 0) {
+                        return false;
+                    }
+                    else {
+                        pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+                cell->data_ = data;
+                cell->sequence_.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            // ȡ, Ϊʱfalse
+            bool pop(Type& data) {
+                Cell* cell = nullptr;
+                size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                for (;;) {
+                    cell = &m_cells[pos & m_mask];
+                    size_t seq = cell->sequence_.load(std::memory_order_acquire);
+                    intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+                    if (diff == 0) {
+                        if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else if (diff < 0) {
+                        return false;
+                    }
+                    else {
+                        pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+                data = std::move(cell->data_);
+                cell->sequence_.store(pos + m_mask + 1, std::memory_order_release);
+                return true;
+            }
+
+        private:
+            static size_t RoundUpPow2(size_t value) {
+                size_t rslt = 2;
+                while (rslt < value)
+                    rslt <<= 1;
+                return rslt;
+            }
+
+        private:
+            // ±
+            const size_t                m_mask;
+            std::unique_ptr<Cell[]>     m_cells;
+            alignas(64) std::atomic<size_t> m_enqueue_pos;
+            alignas(64) std::atomic<size_t> m_dequeue_pos;
+        };
+
+        // ͻ, ߵ
+        // append/acquire/release߳е;
+        // pop_front/clear/emptyΨһķߵ, ͨⲿԭӱ־ȷͬһʱһ
+        // WriteBufferͬ, ӵݲ޸, append_tailǽڵ, pop_front_mergedʱǰһϢ
+        template<size_t DEFAULT_SIZE = 1024>
+        class ConcurrentWriteBuffer
+        {
+        public:
+            // ͻڵ, Դʽָ
+            class WriteMemoryNode : public MemoryStream
+            {
+            public:
+                WriteMemoryNode() : m_next(nullptr), m_merge_limit(0) {}
+                WriteMemoryNode(size_t capacity) : MemoryStream(capacity), m_next(nullptr), m_merge_limit(0) {}
+
+            private:
+                friend class ConcurrentWriteBuffer;
+                std::atomic<WriteMemoryNode*> m_next;
+                // ǰһϢİ, 0ʾϢ
+                size_t                        m_merge_limit;
+            };
+
+            typedef WriteMemoryNode                         WriteMemoryStream;
+            typedef std::unique_ptr<WriteMemoryNode>        WriteMemoryStreamPtr;
+
+            enum {
+                DEFAULT_POOL_SIZE = 64,     // ĬϿл
+            };
+
+            // pool_size: л, 治Ԥȷ, ȡʱؿ½, 黹ʱͷ
+            ConcurrentWriteBuffer(size_t pool_size = DEFAULT_POOL_SIZE)
+                : m_free_pool(pool_size)
+                , m_head(&m_stub)
+                , m_tail(&m_stub)
+                , m_count(0)
+                , m_all_len(0)
+            {
+            }
+            ~ConcurrentWriteBuffer() {
+                destroy();
+            }
+
+        public:
+            // ȡݴС
+            size_t size() const {
+                return m_all_len.load(std::memory_order_relaxed);
+            }
+
+            // д, ɶ߳ͬʱ
+            bool append(const char* const msg, size_t len) {
+                WriteMemoryStreamPtr memory_stream = acquire(msg, len);
+                if (!memory_stream)
+                    return false;
+                return append(std::move(memory_stream));
+            }
+            bool append(WriteMemoryStreamPtr&& memory_stream) {
+                if (!memory_stream)
+                    return false;
+                // ȼ, ȷݿɼǰͨempty()֪
+                m_count.fetch_add(1);
+                m_all_len.fetch_add(memory_stream->size(), std::memory_order_relaxed);
+                push(memory_stream.release());
+                return true;
+            }
+
+            // ڵǰϢβ׷, ɶ߳ͬʱ
+            // ǰһϢδȡʱ, pop_front_mergedϲΪͬһϢ, ΪϢ
+            // max_package_size:,0ʾ
+            bool append_tail(const char* const msg, size_t len, size_t max_package_size = 0) {
+                WriteMemoryStreamPtr memory_stream = acquire(msg, len);
+                if (!memory_stream)
+                    return false;
+                memory_stream->m_merge_limit = max_package_size == 0 ? (std::numeric_limits<size_t>::max)() : max_package_size;
+                return append(std::move(memory_stream));
+            }
+
+            // ȡƳ, ߵ
+            WriteMemoryStreamPtr pop_front() {
+                WriteMemoryStreamPtr msg(pop());
+                if (msg) {
+                    m_count.fetch_sub(1);
+                    m_all_len.fetch_sub(msg->size(), std::memory_order_relaxed);
+                }
+                return msg;
+            }
+
+            // ȡƳ, ٻȡһ, ߵ
+            // деݿʱȡ, ʱ0empty()Ϊfalse
+            // رλȡֽ
+            size_t pop_front(std::vector<WriteMemoryStreamPtr>& items, size_t max_count, size_t max_bytes) {
+                size_t bytes = 0;
+                size_t count = 0;
+                while (count < max_count) {
+                    if (!m_pending_front)
+                        m_pending_front = pop_front();
+                    if (!m_pending_front)
+                        break;
+                    if (count > 0 && bytes + m_pending_front->size() > max_bytes)
+                        break;
+
+                    bytes += m_pending_front->size();
+                    ++count;
+                    items.push_back(std::move(m_pending_front));
+                }
+                return bytes;
+            }
+
+            // ȡƳ, ͬʱappend_tail׷ӵݲϢ, ߵ
+            // ϲﵽӦmax_package_sizeʱֹͣ, ʣΪһϢ
+            WriteMemoryStreamPtr pop_front_merged() {
+                WriteMemoryStreamPtr msg = m_pending_front ? std::move(m_pending_front) : pop_front();
+                if (!msg)
+                    return msg;
+                while (true) {
+                    m_pending_front = pop_front();
+                    if (!m_pending_front)
+                        break;
+                    if (m_pending_front->m_merge_limit == 0 || msg->size() + m_pending_front->size() >= m_pending_front->m_merge_limit)
+                        break;
+                    msg->append(m_pending_front->data(), m_pending_front->size(), msg->size());
+                    release(m_pending_front);
+                }
+                return msg;
+            }
+
+            // , ߵ
+            void clear() {
+                release(m_pending_front);
+                while (auto msg = pop_front()) {
+                    release(msg);
+                }
+            }
+
+            // ǷΪ, д
+            bool empty() const {
+                return m_count.load() == 0 && !m_pending_front;
+            }
+
+            void release(WriteMemoryStreamPtr& obj) {
+                if (obj && m_free_pool.push(obj.get())) {
+                    obj.release();
+                }
+                obj.reset();
+            }
+            // 黹, 黹objs
+            void release(std::vector<WriteMemoryStreamPtr>& objs) {
+                for (auto& obj : objs) {
+                    release(obj);
+                }
+                objs.clear();
+            }
+
+            WriteMemoryStreamPtr acquire(const char* const msg, size_t len) {
+                WriteMemoryNode* node = nullptr;
+                if (m_free_pool.pop(node)) {
+                    WriteMemoryStreamPtr obj(node);
+                    obj->m_merge_limit = 0;
+                    if (len > 0)
+                        obj->load(msg, len);
+                    else
+                        obj->clear();
+                    return obj;
+                }
+                WriteMemoryStreamPtr obj = std::make_unique<WriteMemoryNode>();
+                obj->load(msg, len, DEFAULT_SIZE);
+                return obj;
+            }
+
+        private:
+            // VyukovʽMPSC
+            void push(WriteMemoryNode* node) {
+                node->m_next.store(nullptr, std::memory_order_relaxed);
+                WriteMemoryNode* prev = m_head.exchange(node, std::memory_order_acq_rel);
+                prev->m_next.store(node, std::memory_order_release);
+            }
+
+            WriteMemoryNode* pop() {
+                WriteMemoryNode* tail = m_tail;
+                WriteMemoryNode* next = tail->m_next.load(std::memory_order_acquire);
+                if (tail == &m_stub) {
+                    if (!next)
+                        return nullptr;
+                    m_tail = next;
+                    tail = next;
+                    next = next->m_next.load(std::memory_order_acquire);
+                }
+                if (next) {
+                    m_tail = next;
+                    return tail;
+                }
+                // ѽͷδ, ݲɶ
+                if (tail != m_head.load(std::memory_order_acquire))
+                    return nullptr;
+
+                push(&m_stub);
+                next = tail->m_next.load(std::memory_order_acquire);
+                if (next) {
+                    m_tail = next;
+                    return tail;
+                }
+                return nullptr;
+            }
+
+            void destroy() {
+                clear();
+                WriteMemoryNode* node = nullptr;
+                while (m_free_pool.pop(node)) {
+                    delete node;
+                }
+            }
+
+        private:
+            // δʹõĿж
+            BoundedMpmcQueue<WriteMemoryNode*>  m_free_pool;
+            // ڱڵ
+            WriteMemoryNode                     m_stub;
+            // д
+            alignas(64) std::atomic<WriteMemoryNode*>   m_head;
+            // ߶ȡ
+            alignas(64) WriteMemoryNode*        m_tail;
+            // 򳬳ξۺ޶ݴ
+            WriteMemoryStreamPtr                m_pending_front;
+            // ǰд뼰д
+            std::atomic<size_t>                 m_count;
+            // ǰܵȴݳ
+            std::atomic<size_t>                 m_all_len;
+        };
     }
 }
\ No newline at end of file
@@ -5,7 +5,9 @@ Purpose:    
 *****************************************************************************/
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <string_view>
 #include <boost/lexical_cast.hpp>
 
 namespace BTool
@@ -20,6 +22,8 @@ namespace BTool
             typedef std::function<void(const SessionID& session_id, const char* const msg, size_t bytes_transferred)> close_cbk;
             typedef std::function<void(const SessionID& session_id, const char* const msg, size_t bytes_transferred)> read_cbk;
             typedef std::function<void(const SessionID& session_id, const char* const msg, size_t bytes_transferred)> write_cbk;
+            // ֡ȡص, frameΪڵ֡ͼ, ڻصڼЧ
+            typedef std::function<void(const SessionID& session_id, std::string_view frame)> frame_cbk;
 
             typedef std::function<void()> server_error_cbk;
 
@@ -27,6 +31,12 @@ namespace BTool
                 InvalidSessionID = 0,
             };
 
+            // ɽΨһID, asioio_uring˵ӹ, ʱIDͻ
+            static SessionID GetNextSessionID() {
+                static std::atomic<SessionID> next_session_id(InvalidSessionID);
+                return ++next_session_id;
+            }
+
             // ӻص
             open_cbk open_cbk_ = nullptr;
             // رӻص
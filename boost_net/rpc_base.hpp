@@ -118,16 +118,90 @@
         }
     };
 
+ID模式:
+    以 IdProxyPkgHandle 替换 DefaultProxyPkgHandle, 报文头以32位方法ID代替方法名, 方法名仅在连接建立时的协商包中传输
+    typedef RpcClient<TcpSession, IdProxyPkgHandle, DefaultProxyMsgHandle, 30000>    rpc_client;
+    // 方法名于构造时哈希为ID, 声明为constexpr时在编译期完成
+    constexpr RpcMethod add_method("add");
+    auto [rsp_status, rsp_rslt] = m_rpc_client.call<int>(add_method, 1, 2);
+
+协程(C++20):
+    // 服务端协程处理函数, 参数按值传递, co_return结果即应答
+    m_rpc_service.bind_co("add", [](NetCallBack::SessionID session_id, int a, int b) -> rpc_task<int> { co_return a + b; });
+    // 调用方协程, 挂起等待应答而不阻塞线程, 可经resume_on指定恢复执行器
+    auto foo = [&]() -> rpc_task<> {
+        auto [rsp_status, rsp_rslt] = co_await m_rpc_client.co_call<int>("add", 1, 2).resume_on(ioc.get_executor());
+    };
+    foo().start();
+
+工作线程执行:
+    // bind_auto默认于io线程执行, 耗时方法可改为投递至工作线程, 同一会话的请求按顺序执行, 待处理请求超过1000个时应答overload
+    m_rpc_service.bind_auto("query", &query);
+    m_rpc_service.set_dispatch("query", rpc_dispatch::session_serial, 1000);
+    // 不要求顺序的方法投递至共享线程池
+    m_rpc_service.set_dispatch_threads(8);
+    m_rpc_service.set_dispatch("report", rpc_dispatch::shared_pool);
+
+结构体参数:
+    // 以BTOOL_MEMORY_FIELDS声明序列化字段, 可嵌套, 支持std::string与std::vector成员
+    struct order_st { int id_; double price_; std::string symbol_; BTOOL_MEMORY_FIELDS(id_, price_, symbol_) };
+    m_rpc_service.bind_auto("order", [](NetCallBack::SessionID session_id, order_st order) { return order.id_; });
+    // ID模式下协商包携带各方法参数及返回值的结构哈希, 两端定义不一致时调用直接返回schema_error而不发送
+    auto [rsp_status, rsp_rslt] = m_rpc_client.call<int>("order", order_st{ 1, 10.5, "ab" });
+
+流式应答:
+    // 应答端经rpc_stream多次写入元素, 每次消耗一个额度, 额度耗尽时write返回false, 可wait_credit等待或经on_credit于额度恢复时续写
+    // 句柄可复制保存后于其他线程写入, finish(status)或全部句柄释放时结束
+    m_rpc_server.bind_stream("subscribe", [&](NetCallBack::SessionID session_id, rpc_stream<snapshot_st> stream, std::string symbol) {
+        m_subscribers[symbol].push_back(stream);
+    });
+    // 请求端逐个回调元素, 每处理约半个窗口(默认64)归还一次额度, 慢速请求端不会撑满应答端的发送缓存
+    uint32_t stream_id = m_rpc_client.call_stream<256>("subscribe", std::string("IF2401"))(
+        [](NetCallBack::SessionID session_id, snapshot_st snapshot) {},
+        [](NetCallBack::SessionID session_id, msg_status status) {});
+    // 取消后应答端写入返回false, 结束回调以msg_status::fail执行
+    m_rpc_client.cancel_stream(stream_id);
+
+同主机共享内存:
+    // 以ShmServer/ShmSession替换TcpServer/TcpSession(见shm_server.hpp/shm_session.hpp), 接口不变
+    // 客户端连接本机地址时经共享内存环形缓存通讯, 非本机或服务端未开启共享内存时自动回落为tcp
+    typedef RpcService<ShmServer, IdProxyPkgHandle, DefaultProxyMsgHandle, 30000>   rpc_server;
+    typedef RpcClient<ShmSession, IdProxyPkgHandle, DefaultProxyMsgHandle, 30000>   rpc_client;
+    // 读取无数据时忙轮询20微秒后再休眠, 以CPU占用换取更低延迟, 需在监听/连接前设置
+    m_rpc_server.set_busy_poll(20);
+    m_rpc_client.set_busy_poll(20);
+
 */
 
 #pragma once
 #include <memory>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <tuple>
 #include <functional>
 #include <future>
+#include <string_view>
+#include <unordered_map>
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+# include <coroutine>
+// 以C++20及以上编译时提供协程接口: rpc_task, co_call/co_push及bind_co
+# ifndef BTOOL_RPC_COROUTINE
+#  define BTOOL_RPC_COROUTINE
+# endif
+#endif
+// 回调类调用(call_back/pipeline/call_batch/co_call)的在途请求上限为2^BTOOL_RPC_CALLBACK_SLOT_BITS, 默认16即65536个
+// 可于包含本文件前定义, 取值1~23; 槽位按上限预先分配, 每个约128字节(含空闲队列), 默认约8MB; 已满时新请求不发送, 回调立即以wait_error执行
+#ifndef BTOOL_RPC_CALLBACK_SLOT_BITS
+# define BTOOL_RPC_CALLBACK_SLOT_BITS 16
+#endif
 #include "../timer_manager.hpp"
+#include "../task_pool.hpp"
+#include "net_buffer.hpp"
 
 namespace BTool
 {
@@ -140,20 +214,33 @@ namespace BTool
             timeout,        // 等待应答超时
             unpack_error,   // 解析数据失败
             send_error,     // 发送失败
-            wait_error      // 等待失败
+            wait_error,     // 等待失败
+            schema_error,   // 与对端协商的方法参数或返回值结构不一致, 未发送
+            overload        // 应答端该方法待处理请求数已达上限, 请求被拒绝
         };
 
         // 调用远程服务模式
         enum class rpc_model : uint8_t {
             future,         // 请求端同步等待请求结果, 应答端同步执行并自动返回函数返回值
             callback,       // 请求端异步返回请求结果, 应答端同步执行并自动返回函数返回值
-            bind            // bind_auto:应答端同步执行订阅, 自动返回函数 / bind:应答端异步执行订阅, 需主动显式返回
+            bind,           // bind_auto:应答端同步执行订阅, 自动返回函数 / bind:应答端异步执行订阅, 需主动显式返回
+            stream          // 流式调用, 应答端经rpc_stream多次写入元素, 最终以应答结束
+        };
+
+        // 应答端请求执行方式, 见RpcBase::set_dispatch
+        enum class rpc_dispatch : uint8_t {
+            inline_call,    // 于io线程直接执行, 默认方式
+            shared_pool,    // 投递至共享工作线程池, 不保证执行顺序
+            session_serial, // 同一会话的请求按到达顺序串行执行, 不同会话间并行
         };
 
         // 请求应答模式
         enum class comm_model : uint8_t {
             request,
             rsponse,
+            negotiate,      // 方法表协商, 仅ID模式使用
+            stream_item,    // 流式元素, 应答端至请求端
+            stream_credit,  // 流式额度归还(msg_status::ok)或取消(其余状态), 请求端至应答端
         };
 
         struct error {
@@ -165,6 +252,142 @@ namespace BTool
             std::string_view    msg_;
         };
 
+        // 方法名哈希(FNV-1a), 0保留为无效ID
+        constexpr uint32_t RpcMethodID(std::string_view rpc_name) {
+            uint32_t hash = 2166136261u;
+            for (char c : rpc_name) {
+                hash ^= (uint8_t)c;
+                hash *= 16777619u;
+            }
+            return hash == 0 ? 1 : hash;
+        }
+
+        // 远程方法标识, 构造时即完成哈希
+        // 仅引用方法名而不持有, 需保证其在调用期间有效
+        struct RpcMethod {
+            constexpr RpcMethod(const char* rpc_name) : RpcMethod(std::string_view(rpc_name)) {}
+            constexpr RpcMethod(std::string_view rpc_name) : name_(rpc_name), id_(RpcMethodID(rpc_name)) {}
+            RpcMethod(const std::string& rpc_name) : RpcMethod(std::string_view(rpc_name)) {}
+            constexpr RpcMethod(uint32_t id, std::string_view rpc_name) : name_(rpc_name), id_(id) {}
+
+            std::string_view    name_;
+            uint32_t            id_;
+        };
+
+        // 方法结构哈希, 由参数及返回值的序列化结构求得, 经ID模式的协商包交换, 调用前比对以尽早发现两端定义不一致
+        // 任一端为0表示未知, 不参与比对
+        struct RpcSchema {
+            uint32_t    params_ = 0;
+            uint32_t    result_ = 0;
+        };
+
+        // 类型列表的结构哈希, std::tuple展开为其元素, 见MemoryStream::get_args_schema
+        template<typename... Types>
+        constexpr uint32_t RpcSchemaID() {
+            uint32_t hash = MemoryStream::get_args_schema<Types...>();
+            return hash == 0 ? 1 : hash;
+        }
+
+        // 调用端结构哈希, 未指定返回类型(void)时不比对返回值
+        template<typename TReturn, typename... Args>
+        constexpr RpcSchema RpcCallSchema() {
+            if constexpr (std::is_void<TReturn>::value)
+                return RpcSchema{ RpcSchemaID<Args...>(), 0 };
+            else
+                return RpcSchema{ RpcSchemaID<Args...>(), RpcSchemaID<TReturn>() };
+        }
+
+        // 协商包中的方法项
+        struct RpcMethodInfo {
+            RpcMethod   method_;
+            RpcSchema   schema_;
+        };
+
+        // 方法ID完美哈希表, 于绑定时(启动期)构建
+        // 查找仅需一次乘法、移位及比较, 不涉及字符串操作
+        template<typename TValue>
+        class RpcMethodTable {
+        public:
+            struct entry {
+                uint32_t        id_;
+                std::string     name_;
+                TValue          value_;
+            };
+
+        public:
+            // 插入或覆盖, 不同方法名ID冲突时返回false
+            bool insert(uint32_t id, std::string_view rpc_name, TValue value) {
+                for (auto& item : m_entries) {
+                    if (item.id_ != id)
+                        continue;
+                    if (item.name_ != rpc_name)
+                        return false;
+                    item.value_ = std::move(value);
+                    return true;
+                }
+                m_entries.push_back(entry{ id, std::string(rpc_name), std::move(value) });
+                rebuild();
+                return true;
+            }
+
+            const entry* find(uint32_t id) const {
+                if (m_slots.empty())
+                    return nullptr;
+                uint32_t index = m_slots[get_slot(id, m_multiplier, m_shift)];
+                if (index == 0 || m_entries[index - 1].id_ != id)
+                    return nullptr;
+                return &m_entries[index - 1];
+            }
+
+            const std::vector<entry>& entries() const {
+                return m_entries;
+            }
+
+        private:
+            static uint32_t get_slot(uint32_t id, uint32_t multiplier, uint32_t shift) {
+                return (id * multiplier) >> shift;
+            }
+
+            // 搜索可令全部ID无冲突落槽的乘数, 多次尝试失败则扩大槽位
+            void rebuild() {
+                uint32_t bits = 1;
+                while (((size_t)1 << bits) < m_entries.size() * 2)
+                    ++bits;
+
+                uint32_t seed = 0x9E3779B9u;
+                for (;; ++bits) {
+                    std::vector<uint32_t> slots((size_t)1 << bits);
+                    for (int attempt = 0; attempt < 64; ++attempt) {
+                        seed = seed * 1664525u + 1013904223u;
+                        uint32_t multiplier = seed | 1;
+                        std::fill(slots.begin(), slots.end(), 0);
+                        bool perfect = true;
+                        for (size_t i = 0; i < m_entries.size(); ++i) {
+                            uint32_t& slot = slots[get_slot(m_entries[i].id_, multiplier, 32 - bits)];
+                            if (slot != 0) {
+                                perfect = false;
+                                break;
+                            }
+                            slot = uint32_t(i + 1);
+                        }
+                        if (perfect) {
+                            m_slots.swap(slots);
+                            m_multiplier = multiplier;
+                            m_shift = 32 - bits;
+                            return;
+                        }
+                    }
+                }
+            }
+
+        private:
+            std::vector<entry>      m_entries;
+            // 槽位, 存放m_entries下标+1, 0表示空
+            std::vector<uint32_t>   m_slots;
+            uint32_t                m_multiplier = 1;
+            uint32_t                m_shift = 31;
+        };
+
 #pragma pack (1)
         struct message_head {
             comm_model      comm_model_;
@@ -173,6 +396,24 @@ namespace BTool
             uint8_t         title_size_;   // 最多255
             uint32_t        content_size_; // 最多4,294,967,295
         };
+
+        // ID模式报文头, 以方法ID代替方法名
+        struct message_id_head {
+            uint8_t         model_;        // 高4位comm_model, 低4位rpc_model
+            uint32_t        req_id_;
+            uint32_t        method_id_;
+            uint32_t        content_size_;
+
+            static uint8_t make_model(comm_model comm, rpc_model model) {
+                return uint8_t((uint8_t(comm) << 4) | uint8_t(model));
+            }
+            comm_model get_comm_model() const {
+                return comm_model(model_ >> 4);
+            }
+            rpc_model get_rpc_model() const {
+                return rpc_model(model_ & 0x0F);
+            }
+        };
 #pragma pack ()
 
         struct DefaultProxyMsgHandle {
@@ -189,11 +430,16 @@ namespace BTool
             template<typename Type>
             typename std::enable_if<!std::is_void<Type>::value, Type>::type
                 get_req_params(MemoryStream& msg, msg_status& status) {
-                if (msg.size() < MemoryStream::get_args_sizeof<Type>() + sizeof(msg_status)) {
+                if (msg.size() < sizeof(msg_status)) {
                     status = msg_status::unpack_error;
                     return Type();
                 }
                 msg.read(&status);
+                // 定长参数仅于编译期求得长度后比较一次, 变长参数逐项校验长度前缀
+                if (!msg.check_args<Type>()) {
+                    status = msg_status::unpack_error;
+                    return Type();
+                }
                 return msg.read_args<Type>();
             }
 
@@ -214,15 +460,13 @@ namespace BTool
                     return Type();
                 }
                 msg.read(&status);
-                if (status == msg_status::no_bind) {
-                    return Type();
-                }
-
-                if (msg.get_res_length() < MemoryStream::get_args_sizeof<Type>()) {
-                    status = msg_status::unpack_error;
+                // 失败应答不携带有效返回值
+                if (status != msg_status::ok) {
+                    if (status > msg_status::overload)
+                        status = msg_status::unpack_error;
                     return Type();
                 }
-                if (status > msg_status::wait_error) {
+                if (!msg.check_args<Type>()) {
                     status = msg_status::unpack_error;
                     return Type();
                 }
@@ -232,45 +476,19 @@ namespace BTool
 
         template<typename TProxyMsgHandle>
         struct ProxyMsg {
-            template<typename ...Args>
-            ProxyMsg(const std::string& rpc_name, const message_head& head, Args&& ...args)
-                : rpc_name_(rpc_name)
-                , head_(head)
-            {
-                msg_.append_args(std::forward<Args>(args)...);
-                msg_.reset_offset(0);
-            }
-            template<typename ...Args>
-            ProxyMsg(const std::string& rpc_name, comm_model comm_model, rpc_model rpc_model, uint32_t req_id, Args&& ...args)
-                : rpc_name_(rpc_name)
-                , head_({ comm_model, rpc_model, req_id, uint8_t(rpc_name.length()), 0 })
-            {
-                msg_.append_args(std::forward<Args>(args)...);
-                msg_.reset_offset(0);
-                head_.content_size_ = msg_.size();
-            }
-            ProxyMsg(const std::string& rpc_name, const message_head& head, std::string_view&& msg)
+            // 引用解包缓存, 方法名及内容仅在解包回调期间有效
+            ProxyMsg(std::string_view rpc_name, uint32_t method_id, const message_head& head, std::string_view content)
                 : rpc_name_(rpc_name)
+                , method_id_(method_id)
                 , head_(head)
+                , msg_(content.data(), content.size())
             {
-                msg_.load(msg.data(), msg.size());
             }
-            ProxyMsg(const std::string& rpc_name, comm_model comm_model, rpc_model rpc_model, uint32_t req_id, std::string_view&& msg)
-                : rpc_name_(rpc_name)
-                , head_({ comm_model, rpc_model, req_id, uint8_t(rpc_name.length()), uint32_t(msg.length()) })
-            {
-                msg_.load(msg.data(), msg.size());
-            }
-            ProxyMsg(const std::string& rpc_name, const message_head& head, MemoryStream&& msg)
-                : rpc_name_(rpc_name)
-                , head_(head)
-                , msg_(std::move(msg))
-            {
-            }
-            ProxyMsg(const std::string& rpc_name, comm_model comm_model, rpc_model rpc_model, uint32_t req_id, MemoryStream&& msg)
-                : rpc_name_(rpc_name)
-                , head_({ comm_model, rpc_model, req_id, uint8_t(rpc_name.length()), uint32_t(msg.length()) })
-                , msg_(std::move(msg))
+            // 复制内容至独立内存, 用于跨线程传递, 方法名不再保留
+            ProxyMsg(const ProxyMsg& rhs)
+                : method_id_(rhs.method_id_)
+                , head_(rhs.head_)
+                , msg_(rhs.msg_.data(), rhs.msg_.size(), true)
             {
             }
             virtual ~ProxyMsg() {}
@@ -284,9 +502,13 @@ namespace BTool
             inline rpc_model get_rpc_model() const {
                 return head_.rpc_model_;
             }
-            inline const std::string& get_rpc_name()const {
+            // ID模式下为空
+            inline std::string_view get_rpc_name()const {
                 return rpc_name_;
             }
+            inline uint32_t get_method_id() const {
+                return method_id_;
+            }
             inline const message_head& get_message_head() const {
                 return head_;
             }
@@ -308,45 +530,51 @@ namespace BTool
             }
 
         protected:
-            std::string     rpc_name_;
-            message_head    head_;
-            MemoryStream    msg_;
-            TProxyMsgHandle handle_;
+            std::string_view    rpc_name_;
+            uint32_t            method_id_;
+            message_head        head_;
+            MemoryStream        msg_;
+            TProxyMsgHandle     handle_;
         };
 
+        // 预留buffer剩余空间, 避免追加过程中多次扩容
+        inline void ReserveStream(MemoryStream& buffer, size_t length) {
+            if (buffer.get_capacity() < buffer.size() + length)
+                buffer.reset_capacity(buffer.size() + length);
+        }
+
         template<typename TProxyMsgHandle>
         class DefaultProxyPkgHandle {
         public:
-            typedef std::shared_ptr<ProxyMsg<TProxyMsgHandle>> ProxyMsgPtr;
+            typedef ProxyMsg<TProxyMsgHandle> ProxyMsgType;
 
-            // 打包消息
+            // 打包消息, 直接追加至buffer(通常为会话的发送缓存)
             // 此处默认采用 head + title + content(status + data)的内存直接打包
             template<typename... Args>
-            ProxyMsgPtr package_msg(const std::string& rpc_name, comm_model comm_model, rpc_model model, uint32_t req_id, msg_status status, Args&&... args) {
-                uint8_t title_size = (uint8_t)rpc_name.length();
+            void package_msg(MemoryStream& buffer, const RpcMethod& rpc_name, comm_model comm_model, rpc_model model, uint32_t req_id, msg_status status, Args&&... args) {
+                uint8_t title_size = (uint8_t)rpc_name.name_.length();
                 
                 // content长度, content 包含 status + 内容
                 uint32_t content_length = MemoryStream::get_args_length<msg_status, Args...>(status, std::forward<Args>(args)...);
 
-                BTool::MemoryStream write_buffer(sizeof(message_head) + title_size + content_length);
+                ReserveStream(buffer, sizeof(message_head) + title_size + content_length);
 
                 // head
                 message_head head{ comm_model, model, req_id, title_size, content_length };
-                write_buffer.append(head);
+                buffer.append(head);
 
                 // rpc_name
-                write_buffer.append(rpc_name.c_str(), title_size);
+                buffer.append(rpc_name.name_.data(), title_size);
 
                 // content
-                write_buffer.append_args(status, std::forward<Args>(args)...);
-
-                return std::make_shared<ProxyMsg<TProxyMsgHandle>>(rpc_name, head, std::move(write_buffer));
+                buffer.append_args(status, std::forward<Args>(args)...);
             }
             
-            // 解包消息
-            // 此处默认采用 head + title + content(status + data)的内存直接解包
-            std::tuple<std::vector<ProxyMsgPtr>, size_t, error> unpackage_msg(const char* const msg, size_t bytes_transferred) {
-                std::vector<ProxyMsgPtr>  resault;
+            // 解包消息, 逐条回调visitor(ProxyMsgType&), 返回false时停止解包
+            // 此处默认采用 head + title + content(status + data)的内存直接解包, 消息均引用自msg, 不产生拷贝
+            // 返回: 处理长度, 错误信息
+            template<typename TVisitor>
+            std::tuple<size_t, error> unpackage_msg(const char* const msg, size_t bytes_transferred, TVisitor&& visitor) {
                 BTool::MemoryStream read_buffer(msg, bytes_transferred);
                 while (read_buffer.get_res_length() >= sizeof(struct message_head) + sizeof(msg_status)) {
                     // 读取,自带漂移
@@ -356,170 +584,546 @@ namespace BTool
 
                     // 异常包, 此处可依据端口限制大小设置
                     if (cur_head.title_size_ == 0 || cur_head.content_size_ > (uint32_t)(-1) / 2) {
-                        return { std::vector<ProxyMsgPtr>(), 0, error(msg_status::send_error, "异常包") };
+                        return { 0, error(msg_status::send_error, "异常包") };
                     }
 
                     // 断包判断
                     if (read_buffer.get_res_length() < cur_head.title_size_ + cur_head.content_size_) {
-                        return { resault, read_buffer.get_offset() - sizeof(struct message_head), error() };
+                        return { read_buffer.get_offset() - sizeof(struct message_head), error() };
                     }
 
                     // rpc_name
-                    std::string rpc_name(msg + read_buffer.get_offset(), cur_head.title_size_);
+                    std::string_view rpc_name(msg + read_buffer.get_offset(), cur_head.title_size_);
                     read_buffer.add_offset(cur_head.title_size_);
 
                     // content
                     std::string_view content(msg + read_buffer.get_offset(), cur_head.content_size_);
                     read_buffer.add_offset(cur_head.content_size_);
 
-                    auto item = std::make_shared<ProxyMsg<TProxyMsgHandle>>(rpc_name, cur_head, std::move(content));
+                    ProxyMsgType item(rpc_name, RpcMethodID(rpc_name), cur_head, content);
+                    if (!visitor(item))
+                        break;
+                }
+                return { read_buffer.get_offset(), error() };
+            }
+        };
+
+        template<typename TProxyMsgHandle>
+        class IdProxyPkgHandle {
+        public:
+            typedef ProxyMsg<TProxyMsgHandle> ProxyMsgType;
+
+            // 报文头携带方法ID, 需先经协商包交换方法表
+            static constexpr bool use_method_id = true;
+
+            // 打包消息, 直接追加至buffer(通常为会话的发送缓存)
+            // 此处采用 id_head + content(status + data)的内存直接打包
+            template<typename... Args>
+            void package_msg(MemoryStream& buffer, const RpcMethod& rpc_name, comm_model comm_model, rpc_model model, uint32_t req_id, msg_status status, Args&&... args) {
+                // content长度, content 包含 status + 内容
+                uint32_t content_length = MemoryStream::get_args_length<msg_status, Args...>(status, std::forward<Args>(args)...);
+
+                ReserveStream(buffer, sizeof(message_id_head) + content_length);
+
+                // head
+                message_id_head head{ message_id_head::make_model(comm_model, model), req_id, rpc_name.id_, content_length };
+                buffer.append(head);
+
+                // content
+                buffer.append_args(status, std::forward<Args>(args)...);
+            }
+
+            // 打包协商消息
+            // content: status + 方法数 + (方法ID + 参数结构哈希 + 返回值结构哈希 + 名称长度 + 名称)...
+            void package_negotiate(MemoryStream& buffer, const std::vector<RpcMethodInfo>& methods) {
+                uint32_t content_length = sizeof(msg_status) + sizeof(uint32_t);
+                for (auto& item : methods)
+                    content_length += sizeof(uint32_t) * 3 + sizeof(uint8_t) + (uint8_t)item.method_.name_.length();
+
+                ReserveStream(buffer, sizeof(message_id_head) + content_length);
+                message_id_head head{ message_id_head::make_model(comm_model::negotiate, rpc_model::future), 0, 0, content_length };
+                buffer.append(head);
+                buffer.append(msg_status::ok);
+                buffer.append(uint32_t(methods.size()));
+                for (auto& item : methods) {
+                    uint8_t title_size = (uint8_t)item.method_.name_.length();
+                    buffer.append(item.method_.id_);
+                    buffer.append(item.schema_.params_);
+                    buffer.append(item.schema_.result_);
+                    buffer.append(title_size);
+                    buffer.append(item.method_.name_.data(), title_size);
+                }
+            }
+
+            // 解包协商消息, 返回的方法名引用自msg, 异常内容将截断解析
+            std::vector<RpcMethodInfo> unpackage_negotiate(const ProxyMsgType& msg) {
+                std::vector<RpcMethodInfo> methods;
+                BTool::MemoryStream read_buffer(msg.get_package(), msg.get_length());
+                if (read_buffer.get_res_length() < sizeof(msg_status) + sizeof(uint32_t))
+                    return methods;
+
+                msg_status status;
+                uint32_t count = 0;
+                read_buffer.read(&status);
+                read_buffer.read(&count);
+                for (uint32_t i = 0; i < count && read_buffer.get_res_length() >= sizeof(uint32_t) * 3 + sizeof(uint8_t); ++i) {
+                    uint32_t method_id = 0;
+                    RpcSchema schema;
+                    uint8_t title_size = 0;
+                    read_buffer.read(&method_id);
+                    read_buffer.read(&schema.params_);
+                    read_buffer.read(&schema.result_);
+                    read_buffer.read(&title_size);
+                    if (read_buffer.get_res_length() < title_size)
+                        break;
+                    methods.push_back(RpcMethodInfo{ RpcMethod(method_id, std::string_view(read_buffer.data() + read_buffer.get_offset(), title_size)), schema });
+                    read_buffer.add_offset(title_size);
+                }
+                return methods;
+            }
+
+            // 解包消息, 逐条回调visitor(ProxyMsgType&), 返回false时停止解包
+            // 此处采用 id_head + content(status + data)的内存直接解包, 消息均引用自msg, 不产生拷贝
+            // 返回: 处理长度, 错误信息
+            template<typename TVisitor>
+            std::tuple<size_t, error> unpackage_msg(const char* const msg, size_t bytes_transferred, TVisitor&& visitor) {
+                BTool::MemoryStream read_buffer(msg, bytes_transferred);
+                while (read_buffer.get_res_length() >= sizeof(struct message_id_head) + sizeof(msg_status)) {
+                    message_id_head cur_head;
+                    // head 读取, 自带漂移
+                    read_buffer.read(&cur_head);
+
+                    // 异常包, 此处可依据端口限制大小设置
+                    if (cur_head.get_comm_model() > comm_model::stream_credit || cur_head.content_size_ > (uint32_t)(-1) / 2) {
+                        return { 0, error(msg_status::send_error, "异常包") };
+                    }
+
+                    // 断包判断
+                    if (read_buffer.get_res_length() < cur_head.content_size_) {
+                        return { read_buffer.get_offset() - sizeof(struct message_id_head), error() };
+                    }
+
+                    // content
+                    std::string_view content(msg + read_buffer.get_offset(), cur_head.content_size_);
+                    read_buffer.add_offset(cur_head.content_size_);
 
-                    resault.push_back(item);
+                    message_head head{ cur_head.get_comm_model(), cur_head.get_rpc_model(), cur_head.req_id_, 0, cur_head.content_size_ };
+                    ProxyMsgType item(std::string_view(), cur_head.method_id_, head, content);
+                    if (!visitor(item))
+                        break;
                 }
-                return { resault, read_buffer.get_offset(), error() };
+                return { read_buffer.get_offset(), error() };
             }
         };
 
+        // 打包方式是否采用方法ID, 未声明use_method_id时视为名称模式
+        template<typename TPkgHandle, typename = void>
+        struct pkg_use_method_id : std::false_type {};
+        template<typename TPkgHandle>
+        struct pkg_use_method_id<TPkgHandle, std::void_t<decltype(TPkgHandle::use_method_id)>> : std::bool_constant<TPkgHandle::use_method_id> {};
+
         template<template<typename TProxyMsgHandle> typename TProxyPkgHandle, typename TProxyMsgHandle>
         struct ProxyPkg {
-            typedef std::shared_ptr<ProxyMsg<TProxyMsgHandle>> ProxyMsgPtr;
+            typedef ProxyMsg<TProxyMsgHandle> ProxyMsgType;
+
+            static constexpr bool use_method_id = pkg_use_method_id<TProxyPkgHandle<TProxyMsgHandle>>::value;
 
             template<typename... TRspParams>
-            ProxyMsgPtr package_msg(const std::string& rpc_name, comm_model comm_model, rpc_model model, uint32_t req_id, msg_status status, TRspParams&&... args) {
-                return handle_.package_msg(rpc_name, comm_model, model, req_id, status, std::forward<TRspParams>(args)...);
+            void package_msg(MemoryStream& buffer, const RpcMethod& rpc_name, comm_model comm_model, rpc_model model, uint32_t req_id, msg_status status, TRspParams&&... args) {
+                handle_.package_msg(buffer, rpc_name, comm_model, model, req_id, status, std::forward<TRspParams>(args)...);
             }
-            // 返回: 消息集合, 处理长度, 错误信息
-            std::tuple<std::vector<ProxyMsgPtr>, size_t, error> unpackage_msg(const char* const msg, size_t bytes_transferred) {
-                return handle_.unpackage_msg(msg, bytes_transferred);
+            // 返回: 处理长度, 错误信息
+            template<typename TVisitor>
+            std::tuple<size_t, error> unpackage_msg(const char* const msg, size_t bytes_transferred, TVisitor&& visitor) {
+                return handle_.unpackage_msg(msg, bytes_transferred, std::forward<TVisitor>(visitor));
+            }
+            // 以下仅ID模式使用
+            void package_negotiate(MemoryStream& buffer, const std::vector<RpcMethodInfo>& methods) {
+                handle_.package_negotiate(buffer, methods);
+            }
+            std::vector<RpcMethodInfo> unpackage_negotiate(const ProxyMsgType& msg) {
+                return handle_.unpackage_negotiate(msg);
             }
         protected:
             TProxyPkgHandle<TProxyMsgHandle>  handle_;
         };
 
-        template<typename TProxyMsgHandle>
-        class SyncProxy {
-            typedef std::shared_ptr<ProxyMsg<TProxyMsgHandle>>          ProxyMsgPtr;
-            typedef std::shared_ptr<std::promise<ProxyMsgPtr>>         PromisePtr;
+        // 在途请求槽位表, 定长且无锁
+        // req_id = 代数 << SLOT_BITS | 槽位下标, 槽位复用时代数递增, 超时后迟到的应答因代数不符被丢弃
+        // 空闲槽位按先进先出复用, 同一req_id约需经过2^32次请求才会再次出现
+        template<typename TSlot, uint32_t SLOT_BITS>
+        class RpcSlotTable {
+            static_assert(SLOT_BITS > 0 && SLOT_BITS < 24, "SLOT_BITS out of range");
 
         public:
-            void invoke(const ProxyMsgPtr& item) {
-                uint32_t req_id = item->get_req_id();
-                auto promise = get_promise(req_id);
-                if (promise)
-                    promise->set_value(item);
-            }
+            static constexpr uint32_t capacity = 1u << SLOT_BITS;
+            static constexpr uint32_t slot_mask = capacity - 1;
+            static constexpr uint32_t generation_mask = (1u << (32 - SLOT_BITS)) - 1;
+
+            struct slot_st : public TSlot {
+                // 在途时为当前req_id, 空闲或已被认领时为0
+                std::atomic<uint32_t>   req_id_{ 0 };
+                uint32_t                generation_ = 0;
+            };
 
-            uint32_t get_next_promise() {
-                PromisePtr p = std::make_shared<std::promise<ProxyMsgPtr>>();
-                writeLock lock(m_mtx);
-                m_future_map.emplace(++m_cur_req_id, p);
-                return m_cur_req_id;
+        private:
+            // 空闲队列单元(有界MPMC队列)
+            struct cell_st {
+                std::atomic<size_t>     sequence_{ 0 };
+                uint32_t                index_ = 0;
+            };
+
+        public:
+            RpcSlotTable()
+                : m_slots(new slot_st[capacity])
+                , m_cells(new cell_st[capacity])
+                , m_enqueue_pos(capacity)
+                , m_dequeue_pos(0)
+            {
+                for (uint32_t i = 0; i < capacity; ++i) {
+                    m_cells[i].index_ = i;
+                    m_cells[i].sequence_.store(i + 1, std::memory_order_relaxed);
+                }
             }
 
-            std::tuple<msg_status, ProxyMsgPtr> wait_for(uint32_t req_id, size_t milliseconds) {
-                PromisePtr promise = get_promise(req_id);
-                auto future = std::move(promise->get_future());
-                auto future_status = future.wait_for(std::chrono::milliseconds(milliseconds));
-                remove(req_id);
-                if (future_status != std::future_status::ready) {
-                    return std::forward_as_tuple(msg_status::timeout, nullptr);
+            // 申请空闲槽位, 已满时返回nullptr
+            // 槽位内容填充完毕后需调用publish生效
+            slot_st* acquire() {
+                size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                cell_st* cell = nullptr;
+                for (;;) {
+                    cell = &m_cells[pos & slot_mask];
+                    size_t seq = cell->sequence_.load(std::memory_order_acquire);
+                    intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+                    if (dif == 0) {
+                        if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else if (dif < 0) {
+                        return nullptr;
+                    }
+                    else {
+                        pos = m_dequeue_pos.load(std::memory_order_relaxed);
+                    }
                 }
-                return std::forward_as_tuple(msg_status::ok, future.get());
+                uint32_t index = cell->index_;
+                cell->sequence_.store(pos + capacity, std::memory_order_release);
+                return &m_slots[index];
+            }
+
+            // 分配新代数并置为在途, 返回req_id
+            uint32_t publish(slot_st* slot) {
+                slot->generation_ = (slot->generation_ + 1) & generation_mask;
+                if (slot->generation_ == 0)
+                    slot->generation_ = 1;
+                uint32_t req_id = (slot->generation_ << SLOT_BITS) | (uint32_t)(slot - m_slots.get());
+                slot->req_id_.store(req_id, std::memory_order_release);
+                return req_id;
+            }
+
+            // 认领在途槽位, 应答/超时/发送失败等多方中仅一方可认领成功
+            slot_st* claim(uint32_t req_id) {
+                slot_st& slot = at(req_id);
+                uint32_t expected = req_id;
+                if (req_id == 0 || !slot.req_id_.compare_exchange_strong(expected, 0, std::memory_order_acq_rel))
+                    return nullptr;
+                return &slot;
             }
-            void remove(uint32_t req_id) {
-                writeLock lock(m_mtx);
-                m_future_map.erase(req_id);
+
+            bool pending(uint32_t req_id) const {
+                return req_id != 0 && at(req_id).req_id_.load(std::memory_order_acquire) == req_id;
+            }
+
+            slot_st& at(uint32_t req_id) const {
+                return m_slots[req_id & slot_mask];
+            }
+
+            // 归还已认领的槽位
+            void release(slot_st* slot) {
+                uint32_t index = (uint32_t)(slot - m_slots.get());
+                size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                cell_st* cell = nullptr;
+                for (;;) {
+                    cell = &m_cells[pos & slot_mask];
+                    size_t seq = cell->sequence_.load(std::memory_order_acquire);
+                    intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+                    if (dif == 0) {
+                        if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else {
+                        // 槽位总数与队列容量相同, 入队不会失败
+                        pos = m_enqueue_pos.load(std::memory_order_relaxed);
+                    }
+                }
+                cell->index_ = index;
+                cell->sequence_.store(pos + 1, std::memory_order_release);
             }
+
         private:
-            PromisePtr get_promise(uint32_t req_id) {
-                readLock lock(m_mtx);
-                auto iter = m_future_map.find(req_id);
-                if (iter == m_future_map.end()) {
-                    return nullptr;
+            std::unique_ptr<slot_st[]>      m_slots;
+            std::unique_ptr<cell_st[]>      m_cells;
+            alignas(64) std::atomic<size_t> m_enqueue_pos;
+            alignas(64) std::atomic<size_t> m_dequeue_pos;
+        };
+
+        template<typename TProxyMsgHandle>
+        class SyncProxy {
+            typedef ProxyMsg<TProxyMsgHandle>                           ProxyMsgType;
+
+            // 同步等待槽位, 应答内容复制至槽位自有缓存, 缓存容量随槽位复用
+            struct wait_slot_st {
+                std::mutex                  mtx_;
+                std::condition_variable     cv_;
+                bool                        done_ = false;
+                uint32_t                    method_id_ = 0;
+                message_head                head_;
+                std::string                 content_;
+            };
+            // 同步调用阻塞调用线程, 在途数不超过调用线程数, 1024足够
+            typedef RpcSlotTable<wait_slot_st, 10>                      SlotTable;
+
+        public:
+            // 应答需跨线程交由等待方解析, 此处复制至槽位缓存
+            void invoke(const ProxyMsgType& item) {
+                auto slot = m_slots.claim(item.get_req_id());
+                if (!slot)
+                    return;
+                std::lock_guard<std::mutex> lock(slot->mtx_);
+                slot->method_id_ = item.get_method_id();
+                slot->head_ = item.get_message_head();
+                slot->content_.assign(item.get_package(), item.get_length());
+                slot->done_ = true;
+                slot->cv_.notify_one();
+            }
+
+            // 申请等待槽位, 返回0表示在途请求已满
+            uint32_t acquire() {
+                auto slot = m_slots.acquire();
+                return slot ? m_slots.publish(slot) : 0;
+            }
+
+            // 放弃等待, 用于发送失败
+            void cancel(uint32_t req_id) {
+                auto slot = m_slots.claim(req_id);
+                if (slot)
+                    m_slots.release(slot);
+            }
+
+            // 等待应答, 收到后于槽位缓存上调用parse(ProxyMsgType&, msg_status&)解析
+            template<typename TParse>
+            msg_status wait_for(uint32_t req_id, size_t milliseconds, TParse&& parse) {
+                auto& slot = m_slots.at(req_id);
+                std::unique_lock<std::mutex> lock(slot.mtx_);
+                if (!slot.cv_.wait_for(lock, std::chrono::milliseconds(milliseconds), [&slot] { return slot.done_; })) {
+                    if (m_slots.claim(req_id)) {
+                        lock.unlock();
+                        m_slots.release(&slot);
+                        return msg_status::timeout;
+                    }
+                    // 应答方已认领, 等待其写入完成
+                    slot.cv_.wait(lock, [&slot] { return slot.done_; });
                 }
-                return iter->second;
+                lock.unlock();
+
+                msg_status status = msg_status::ok;
+                ProxyMsgType item(std::string_view(), slot.method_id_, slot.head_, slot.content_);
+                parse(item, status);
+                slot.done_ = false;
+                m_slots.release(&slot);
+                return status;
             }
+
         private:
-            rwMutex                                         m_mtx;
-            uint32_t                                        m_cur_req_id = 0;
-            std::unordered_map<uint32_t, PromisePtr>        m_future_map;
+            SlotTable                                       m_slots;
         };
 
         template<typename TProxyMsgHandle>
         class CallbackProxy {
-            typedef std::shared_ptr<ProxyMsg<TProxyMsgHandle>>  ProxyMsgPtr;
+            typedef ProxyMsg<TProxyMsgHandle>                   ProxyMsgType;
             typedef NetCallBack::SessionID                      SessionID;
-            // 回调模式内部解析函数
-            typedef std::function<void(SessionID, msg_status, ProxyMsgPtr)>       rsp_callback_function_type;
 
-            struct session_timer_st {
-                SessionID               session_id_;
-                TimerManager::TimerId   timer_id_;
+            // 回调槽位, 就地保存回调对象, 登记时不产生额外分配
+            struct callback_slot_st {
+                static constexpr size_t MAX_BUFFER_SIZE = 64;
+
+                ~callback_slot_st() {
+                    if (destroy_fn_)
+                        destroy_fn_(&storage_);
+                }
+
+                typename std::aligned_storage<MAX_BUFFER_SIZE, alignof(std::max_align_t)>::type storage_;
+                // 回调模式内部解析函数, 失败时消息为空
+                void(*invoke_fn_)(void*, SessionID, msg_status, ProxyMsgType*) = nullptr;
+                void(*destroy_fn_)(void*) = nullptr;
+                SessionID   session_id_ = 0;
             };
+            // 在途上限见BTOOL_RPC_CALLBACK_SLOT_BITS
+            typedef RpcSlotTable<callback_slot_st, BTOOL_RPC_CALLBACK_SLOT_BITS>  SlotTable;
+            typedef typename SlotTable::slot_st                 slot_type;
+
+            struct deadline_st {
+                uint32_t                                req_id_;
+                std::chrono::steady_clock::time_point   deadline_;
+            };
+            // 单会话超时列表, 由扫描任务统一处理, 已完成的请求于扫描时剔除
+            struct deadline_list_st {
+                std::mutex                  mtx_;
+                std::vector<deadline_st>    items_;
+                // 自上次扫描后是否有新登记, 空闲列表于扫描时回收
+                bool                        touched_ = false;
+            };
+            typedef std::shared_ptr<deadline_list_st>           DeadlineListPtr;
 
         public:
-            CallbackProxy() : m_deadline_timer(1000, 1) { m_deadline_timer.start(); }
+            // 超时扫描间隔, 单位毫秒
+            static constexpr unsigned int SWEEP_INTERVAL_MS = 10;
 
-            void invoke(const ProxyMsgPtr& msg) {
-                std::unique_lock<std::mutex> lock(m_mtx);
-                auto sesson_timer = remove_timer(msg->get_req_id());
+            CallbackProxy() : m_sweep_timer(SWEEP_INTERVAL_MS, 1) {
+                m_sweep_timer.start();
+                m_sweep_timer.insert_now(SWEEP_INTERVAL_MS, 0, [this](TimerManager::TimerId, const TimerManager::system_time_point&) {
+                    sweep();
+                });
+            }
+            ~CallbackProxy() {
+                m_sweep_timer.stop();
+            }
 
-                auto iter = m_callback_map.find(msg->get_req_id());
-                if (iter == m_callback_map.end())
-                    return;
-                iter->second(sesson_timer.session_id_, msg_status::ok, msg);
-                m_callback_map.erase(iter);
+            void invoke(ProxyMsgType& msg) {
+                complete(m_slots.claim(msg.get_req_id()), msg_status::ok, &msg);
             }
 
+            // 登记回调, 返回0表示在途请求已满, 此时回调已以wait_error执行
             template<typename TReturn, typename... TRspParams>
-            inline uint32_t insert(size_t overtime, const std::function<TReturn(SessionID, msg_status, TRspParams...)>& callback) {
-                std::unique_lock<std::mutex> lock(m_mtx);
-                ++m_cur_req_id;
-                m_callback_map.emplace(m_cur_req_id, std::bind(&CallbackProxy::proxy<TRspParams...>, this, callback, m_cur_req_id, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
-                return m_cur_req_id;
+            inline uint32_t insert(SessionID session_id, const std::function<TReturn(SessionID, msg_status, TRspParams...)>& callback) {
+                return insert(session_id, std::function<TReturn(SessionID, msg_status, TRspParams...)>(callback));
             }
             template<typename TReturn, typename... TRspParams>
-            inline uint32_t insert(std::function<TReturn(SessionID, msg_status, TRspParams...)>&& callback) {
-                std::unique_lock<std::mutex> lock(m_mtx);
-                ++m_cur_req_id;
-                m_callback_map.emplace(m_cur_req_id, std::bind(&CallbackProxy::proxy<TRspParams...>, this, std::move(callback), m_cur_req_id, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
-                return m_cur_req_id;
-            }
-
-            void insert_timer(size_t overtime, SessionID session_id, uint32_t req_id) {
-                session_timer_st session_timer = { session_id, 0 };
-                session_timer.timer_id_ = m_deadline_timer.insert_duration_once(overtime, [this, req_id](TimerManager::TimerId, const TimerManager::system_time_point&) {
-                    remove(req_id, msg_status::timeout);
-                });
-                std::unique_lock<std::mutex> lock(m_mtx);
-                m_overtime_reqs.emplace(req_id, std::move(session_timer));
+            inline uint32_t insert(SessionID session_id, std::function<TReturn(SessionID, msg_status, TRspParams...)>&& callback) {
+                typedef std::function<TReturn(SessionID, msg_status, TRspParams...)> function_type;
+                static_assert(sizeof(function_type) <= callback_slot_st::MAX_BUFFER_SIZE, "callback too big for slot");
+
+                auto slot = m_slots.acquire();
+                if (!slot) {
+                    proxy<function_type, TRspParams...>(callback, session_id, msg_status::wait_error, nullptr);
+                    return 0;
+                }
+                new (&slot->storage_) function_type(std::move(callback));
+                slot->invoke_fn_ = [](void* ptr, SessionID session_id, msg_status status, ProxyMsgType* msg) {
+                    proxy<function_type, TRspParams...>(*reinterpret_cast<function_type*>(ptr), session_id, status, msg);
+                };
+                slot->destroy_fn_ = [](void* ptr) {
+                    reinterpret_cast<function_type*>(ptr)->~function_type();
+                };
+                slot->session_id_ = session_id;
+                return m_slots.publish(slot);
+            }
+
+            // 登记超时, 加入所属会话的超时列表
+            void insert_deadline(size_t overtime, SessionID session_id, uint32_t req_id) {
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(overtime);
+                auto list = get_deadline_list(session_id);
+                std::lock_guard<std::mutex> lock(list->mtx_);
+                list->items_.push_back(deadline_st{ req_id, deadline });
+                list->touched_ = true;
             }
 
             void remove(uint32_t req_id, msg_status status) {
-                std::unique_lock<std::mutex> lock(m_mtx);
-                auto sesson_timer = remove_timer(req_id);
+                complete(m_slots.claim(req_id), status, nullptr);
+            }
 
-                auto iter = m_callback_map.find(req_id);
-                if (iter == m_callback_map.end())
-                    return;
-                iter->second(sesson_timer.session_id_, status, nullptr);
-                m_callback_map.erase(iter);
+            // 会话断开, 其在途请求不再可能收到应答, 立即以wait_error结束
+            void close_session(SessionID session_id) {
+                DeadlineListPtr list;
+                {
+                    writeLock lock(m_deadline_mtx);
+                    auto iter = m_deadline_lists.find(session_id);
+                    if (iter == m_deadline_lists.end())
+                        return;
+                    list = std::move(iter->second);
+                    m_deadline_lists.erase(iter);
+                }
+                std::vector<deadline_st> items;
+                {
+                    std::lock_guard<std::mutex> lock(list->mtx_);
+                    items.swap(list->items_);
+                }
+                for (auto& item : items)
+                    remove(item.req_id_, msg_status::wait_error);
             }
 
         private:
-            session_timer_st remove_timer(uint32_t req_id) {
-                session_timer_st sesson_timer = { 0 };
-                auto timer_iter = m_overtime_reqs.find(req_id);
-                if (timer_iter != m_overtime_reqs.end()) {
-                    sesson_timer = std::move(timer_iter->second);
-                    m_deadline_timer.erase(sesson_timer.timer_id_);
-                    m_overtime_reqs.erase(timer_iter);
+            void complete(slot_type* slot, msg_status status, ProxyMsgType* msg) {
+                if (!slot)
+                    return;
+                slot->invoke_fn_(&slot->storage_, slot->session_id_, status, msg);
+                slot->destroy_fn_(&slot->storage_);
+                slot->invoke_fn_ = nullptr;
+                slot->destroy_fn_ = nullptr;
+                m_slots.release(slot);
+            }
+
+            DeadlineListPtr get_deadline_list(SessionID session_id) {
+                {
+                    readLock lock(m_deadline_mtx);
+                    auto iter = m_deadline_lists.find(session_id);
+                    if (iter != m_deadline_lists.end())
+                        return iter->second;
+                }
+                writeLock lock(m_deadline_mtx);
+                auto& list = m_deadline_lists[session_id];
+                if (!list)
+                    list = std::make_shared<deadline_list_st>();
+                return list;
+            }
+
+            // 扫描各会话超时列表, 剔除已完成项, 收集已超时项后于锁外执行回调
+            void sweep() {
+                auto now = std::chrono::steady_clock::now();
+                m_expired.clear();
+                m_idle_sessions.clear();
+                {
+                    readLock lock(m_deadline_mtx);
+                    for (auto& iter : m_deadline_lists) {
+                        auto& list = *iter.second;
+                        std::lock_guard<std::mutex> list_lock(list.mtx_);
+                        auto last = std::remove_if(list.items_.begin(), list.items_.end(), [&](const deadline_st& item) {
+                            if (!m_slots.pending(item.req_id_))
+                                return true;
+                            if (item.deadline_ > now)
+                                return false;
+                            m_expired.push_back(item.req_id_);
+                            return true;
+                        });
+                        list.items_.erase(last, list.items_.end());
+                        if (list.items_.empty() && !list.touched_)
+                            m_idle_sessions.push_back(iter.first);
+                        list.touched_ = false;
+                    }
+                }
+
+                if (!m_idle_sessions.empty()) {
+                    writeLock lock(m_deadline_mtx);
+                    for (auto& session_id : m_idle_sessions) {
+                        auto iter = m_deadline_lists.find(session_id);
+                        if (iter == m_deadline_lists.end())
+                            continue;
+                        bool idle = false;
+                        {
+                            std::lock_guard<std::mutex> list_lock(iter->second->mtx_);
+                            idle = iter->second->items_.empty() && !iter->second->touched_;
+                        }
+                        if (idle)
+                            m_deadline_lists.erase(iter);
+                    }
                 }
-                return sesson_timer;
+
+                for (auto& req_id : m_expired)
+                    remove(req_id, msg_status::timeout);
             }
 
-            template<typename... TRspParams>
-            void proxy(std::function<void(SessionID, msg_status, TRspParams...)>& func, uint32_t req_id, SessionID session_id, msg_status status, ProxyMsgPtr msg) {
+            template<typename TFunction, typename... TRspParams>
+            static void proxy(TFunction& func, SessionID session_id, msg_status status, ProxyMsgType* msg) {
                 if constexpr (sizeof...(TRspParams) == 0) {
                     // 本身发送失败
                     if (status != msg_status::ok || !msg) {
@@ -542,99 +1146,603 @@ namespace BTool
             }
 
         private:
-            // 定时删除任务
-            TimerManager                                                    m_deadline_timer;
-            // 数据安全锁
-            std::mutex                                                      m_mtx;
-            // 当前请求id
-            uint32_t                                                        m_cur_req_id = 0;
-            // req_id, timer_id
-            std::unordered_map<uint32_t, session_timer_st>                  m_overtime_reqs;
-            // callback函数绑定集合
-            std::unordered_map<uint32_t, rsp_callback_function_type>        m_callback_map;
+            // 在途回调槽位
+            SlotTable                                                       m_slots;
+            // 各会话超时列表
+            rwMutex                                                         m_deadline_mtx;
+            std::unordered_map<SessionID, DeadlineListPtr>                  m_deadline_lists;
+            // 扫描临时集合, 仅扫描线程访问
+            std::vector<uint32_t>                                           m_expired;
+            std::vector<SessionID>                                          m_idle_sessions;
+            // 超时扫描定时器, 最后声明以最先析构
+            TimerManager                                                    m_sweep_timer;
+        };
+
+        // 流式调用请求端, 登记各在途流的元素及结束回调
+        // 流长期存在且数量有限, 以读写锁保护的哈希表保存, 不占用回调槽位
+        template<typename TProxyMsgHandle>
+        class StreamProxy {
+            typedef ProxyMsg<TProxyMsgHandle>                   ProxyMsgType;
+            typedef NetCallBack::SessionID                      SessionID;
+
+        public:
+            // 解析元素并回调, 返回解析状态
+            typedef std::function<msg_status(SessionID, ProxyMsgType&)>     item_function_type;
+            typedef std::function<void(SessionID, msg_status)>              end_function_type;
+
+            struct stream_st {
+                SessionID               session_id_ = 0;
+                // 归还额度时使用, 方法名独立保存
+                std::string             rpc_name_;
+                uint32_t                method_id_ = 0;
+                uint32_t                window_ = 1;
+                // 自上次归还额度后已处理元素数, 仅接收线程访问
+                uint32_t                consumed_ = 0;
+                // 已结束(应答、取消或断开), 此后不再回调元素
+                std::atomic<bool>       ended_{ false };
+                item_function_type      item_fn_;
+                end_function_type       end_fn_;
+            };
+            typedef std::shared_ptr<stream_st>                  StreamPtr;
+
+        public:
+            // 登记, 返回流ID(即req_id)
+            uint32_t insert(const StreamPtr& stream) {
+                writeLock lock(m_mtx);
+                uint32_t req_id = 0;
+                do {
+                    req_id = ++m_next_req_id;
+                } while (req_id == 0 || m_streams.count(req_id) != 0);
+                m_streams.emplace(req_id, stream);
+                return req_id;
+            }
+
+            StreamPtr find(uint32_t req_id) const {
+                readLock lock(m_mtx);
+                auto iter = m_streams.find(req_id);
+                return iter == m_streams.end() ? nullptr : iter->second;
+            }
+
+            // 移除并标记结束, 已移除时返回空; 结束回调由调用方执行
+            StreamPtr remove(uint32_t req_id) {
+                StreamPtr stream;
+                {
+                    writeLock lock(m_mtx);
+                    auto iter = m_streams.find(req_id);
+                    if (iter == m_streams.end())
+                        return nullptr;
+                    stream = std::move(iter->second);
+                    m_streams.erase(iter);
+                }
+                stream->ended_.store(true);
+                return stream;
+            }
+
+            // 会话断开, 其在途流不再可能收到元素, 立即以wait_error结束
+            void close_session(SessionID session_id) {
+                std::vector<StreamPtr> streams;
+                {
+                    writeLock lock(m_mtx);
+                    for (auto iter = m_streams.begin(); iter != m_streams.end();) {
+                        if (iter->second->session_id_ == session_id) {
+                            streams.push_back(std::move(iter->second));
+                            iter = m_streams.erase(iter);
+                        }
+                        else {
+                            ++iter;
+                        }
+                    }
+                }
+                for (auto& stream : streams) {
+                    stream->ended_.store(true);
+                    stream->end_fn_(session_id, msg_status::wait_error);
+                }
+            }
+
+        private:
+            mutable rwMutex                                 m_mtx;
+            std::unordered_map<uint32_t, StreamPtr>         m_streams;
+            uint32_t                                        m_next_req_id = 0;
         };
 
         template<template<typename TProxyMsgHandle> typename TProxyPkgHandle, typename TProxyMsgHandle, size_t DEFAULT_TIMEOUT>
         class RpcBase;
 
+        // 会话是否提供可直接序列化的发送缓存节点, 即acquire_buffer(Args...)及write(WriteMemoryStreamPtr&&)
+        template<typename TNet, typename... Args>
+        struct has_acquire_buffer {
+        private:
+            template<typename T>
+            static auto check(int) -> std::is_same<decltype(std::declval<T&>().acquire_buffer(std::declval<Args>()...)), ConcurrentWriteBuffer<>::WriteMemoryStreamPtr>;
+            template<typename T>
+            static std::false_type check(...);
+        public:
+            static constexpr bool value = decltype(check<TNet>(0))::value;
+        };
+
+        // 单次调用结果, 有返回值时为<最终状态, 返回结果>, 否则仅为最终状态
+        template<typename TReturn>
+        struct rpc_result {
+            typedef std::tuple<msg_status, TReturn> type;
+        };
+        template<>
+        struct rpc_result<void> {
+            typedef msg_status type;
+        };
+
+        // 会话是否支持发送合并延时, 即set_flush_delay(unsigned)
+        template<typename TNet>
+        struct has_flush_delay {
+        private:
+            template<typename T>
+            static auto check(int) -> decltype(std::declval<T&>().set_flush_delay(0u), std::true_type());
+            template<typename T>
+            static std::false_type check(...);
+        public:
+            static constexpr bool value = decltype(check<TNet>(0))::value;
+        };
+
+        // 会话是否支持忙轮询, 即set_busy_poll(unsigned)
+        template<typename TNet>
+        struct has_busy_poll {
+        private:
+            template<typename T>
+            static auto check(int) -> decltype(std::declval<T&>().set_busy_poll(0u), std::true_type());
+            template<typename T>
+            static std::false_type check(...);
+        public:
+            static constexpr bool value = decltype(check<TNet>(0))::value;
+        };
+
+#ifdef BTOOL_RPC_COROUTINE
+        // 协程结果存储及完成回调, 区分有无返回值
+        template<typename TReturn>
+        struct rpc_task_promise_base {
+            typedef std::function<void(msg_status, TReturn)> done_type;
+
+            void return_value(TReturn value) {
+                value_ = std::move(value);
+            }
+            void finish() {
+                if (done_)
+                    done_(status_, std::move(value_));
+            }
+
+            done_type   done_;
+            msg_status  status_ = msg_status::ok;
+            TReturn     value_{};
+        };
+        template<>
+        struct rpc_task_promise_base<void> {
+            typedef std::function<void(msg_status)> done_type;
+
+            void return_void() {}
+            void finish() {
+                if (done_)
+                    done_(status_);
+            }
+
+            done_type   done_;
+            msg_status  status_ = msg_status::ok;
+        };
+
+        // 协程任务, 用作bind_co处理函数及调用方协程的返回类型
+        // 创建后挂起, 经start启动, 此后协程帧由其自身管理, co_return时执行完成回调后释放
+        // 协程内抛出未捕获异常时以msg_status::fail结束
+        template<typename TReturn = void>
+        class rpc_task {
+        public:
+            struct promise_type : public rpc_task_promise_base<TReturn> {
+                rpc_task get_return_object() {
+                    return rpc_task(std::coroutine_handle<promise_type>::from_promise(*this));
+                }
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                // 完成回调于协程帧释放前执行
+                std::suspend_never final_suspend() noexcept {
+                    this->finish();
+                    return {};
+                }
+                void unhandled_exception() noexcept {
+                    this->status_ = msg_status::fail;
+                }
+            };
+            typedef typename promise_type::done_type done_type;
+
+            rpc_task(rpc_task&& rhs) noexcept
+                : m_handle(std::exchange(rhs.m_handle, nullptr)) {}
+            rpc_task(const rpc_task&) = delete;
+            rpc_task& operator=(const rpc_task&) = delete;
+            ~rpc_task() {
+                if (m_handle)
+                    m_handle.destroy();
+            }
+
+            // 启动协程, 运行至首个挂起点后返回, 仅首次调用有效
+            // done: 完成回调, 于co_return所在线程执行, 可为空
+            void start(done_type done = nullptr) {
+                if (!m_handle)
+                    return;
+                auto handle = std::exchange(m_handle, nullptr);
+                handle.promise().done_ = std::move(done);
+                handle.resume();
+            }
+
+        private:
+            explicit rpc_task(std::coroutine_handle<promise_type> handle)
+                : m_handle(handle) {}
+
+        private:
+            std::coroutine_handle<promise_type> m_handle;
+        };
+#endif
+
+        // 流式应答端的额度及关闭状态, 与元素类型无关
+        // 请求端每处理约半个窗口的元素归还一次额度, 写入时逐个消耗, 额度耗尽即拒绝写入, 慢速请求端不会撑满发送缓存
+        class RpcStreamControl {
+        public:
+            explicit RpcStreamControl(uint32_t credit) : m_credit(credit), m_closed(false) {}
+            virtual ~RpcStreamControl() {}
+
+            // 剩余额度
+            uint32_t credit() const {
+                return m_credit.load();
+            }
+            // 是否已结束, 含主动结束、请求端取消及会话断开
+            bool is_closed() const {
+                return m_closed.load();
+            }
+
+            // 等待额度, 超时或流已结束时返回false
+            bool wait_credit(size_t milliseconds) {
+                std::unique_lock<std::mutex> lock(m_credit_mtx);
+                m_credit_cv.wait_for(lock, std::chrono::milliseconds(milliseconds), [this] { return m_closed.load() || m_credit.load() > 0; });
+                return !m_closed.load() && m_credit.load() > 0;
+            }
+            // 额度由0恢复时的回调, 于接收线程执行, 可在其中继续写入
+            void on_credit(std::function<void()> cbk) {
+                std::lock_guard<std::mutex> lock(m_credit_mtx);
+                m_credit_cbk = std::move(cbk);
+            }
+
+            // 结束流, status随结束应答返回请求端; 已结束时返回false
+            bool finish(msg_status status) {
+                std::lock_guard<std::mutex> lock(m_send_mtx);
+                if (m_closed.load())
+                    return false;
+                bool rslt = send_end(status);
+                set_closed();
+                return rslt;
+            }
+
+            // 以下由所属RpcBase调用
+            // 请求端归还额度
+            void add_credit(uint32_t credit) {
+                uint32_t prev = m_credit.fetch_add(credit);
+                std::function<void()> cbk;
+                {
+                    // 与wait_credit的条件检查互斥, 避免丢失唤醒
+                    std::lock_guard<std::mutex> lock(m_credit_mtx);
+                    cbk = m_credit_cbk;
+                }
+                m_credit_cv.notify_all();
+                if (prev == 0 && cbk && !m_closed.load())
+                    cbk();
+            }
+            // 请求端取消或会话断开, 不再发送结束应答; 返回后不会再访问所属对象
+            void close() {
+                std::lock_guard<std::mutex> lock(m_send_mtx);
+                set_closed();
+            }
+
+        protected:
+            // 发送结束应答并自所属对象登记中移除, 于m_send_mtx内调用
+            virtual bool send_end(msg_status status) = 0;
+            // 自所属对象登记中移除, 于m_send_mtx内调用
+            virtual void detach() = 0;
+
+            // 占用一个额度, 无额度时返回false
+            bool take_credit() {
+                uint32_t credit = m_credit.load();
+                while (credit > 0) {
+                    if (m_credit.compare_exchange_weak(credit, credit - 1))
+                        return true;
+                }
+                return false;
+            }
+
+            void set_closed() {
+                {
+                    std::lock_guard<std::mutex> lock(m_credit_mtx);
+                    m_closed.store(true);
+                }
+                m_credit_cv.notify_all();
+            }
+
+        protected:
+            // 发送互斥, 保证元素有序且关闭后不再发送
+            std::mutex                  m_send_mtx;
+            std::atomic<uint32_t>       m_credit;
+            std::atomic<bool>           m_closed;
+
+            std::mutex                  m_credit_mtx;
+            std::condition_variable     m_credit_cv;
+            std::function<void()>       m_credit_cbk;
+        };
+
+        template<typename... TItems>
+        class RpcStreamState : public RpcStreamControl {
+        public:
+            explicit RpcStreamState(uint32_t credit) : RpcStreamControl(credit) {}
+
+            // 消耗一个额度并发送, 无额度或已结束时返回false, 元素未发送
+            bool write(const TItems&... items) {
+                std::lock_guard<std::mutex> lock(m_send_mtx);
+                if (m_closed.load() || !take_credit())
+                    return false;
+                if (send_item(items...))
+                    return true;
+                // 发送失败即会话已不可用
+                set_closed();
+                detach();
+                return false;
+            }
+
+        protected:
+            virtual bool send_item(const TItems&... items) = 0;
+        };
+
+        // 流式应答句柄, 作为bind_stream处理函数的参数, 可复制保存后于任意线程写入
+        // 全部句柄释放时若尚未结束, 以msg_status::ok结束
+        // 所属RpcService/RpcClient析构后写入均返回false
+        template<typename... TItems>
+        class rpc_stream {
+        public:
+            rpc_stream() {}
+            explicit rpc_stream(std::shared_ptr<RpcStreamState<TItems...>> state)
+                : m_state(std::move(state)) {}
+
+            // 写入一个元素, 消耗一个额度; 额度耗尽或流已结束时返回false, 元素未发送
+            bool write(const TItems&... items) {
+                return m_state && m_state->write(items...);
+            }
+            // 结束流, status随结束应答返回请求端; 已结束时返回false
+            bool finish(msg_status status = msg_status::ok) {
+                return m_state && m_state->finish(status);
+            }
+
+            // 剩余额度, 即当前可不等待写入的元素数
+            uint32_t credit() const {
+                return m_state ? m_state->credit() : 0;
+            }
+            // 是否已结束, 含主动结束、请求端取消及会话断开
+            bool is_closed() const {
+                return !m_state || m_state->is_closed();
+            }
+            // 阻塞等待额度, 超时或流已结束时返回false
+            bool wait_credit(size_t milliseconds) {
+                return m_state && m_state->wait_credit(milliseconds);
+            }
+            // 设置额度由0恢复时的回调, 于网络线程执行
+            void on_credit(std::function<void()> cbk) {
+                if (m_state)
+                    m_state->on_credit(std::move(cbk));
+            }
+
+        private:
+            std::shared_ptr<RpcStreamState<TItems...>>  m_state;
+        };
+
         template<template<typename TProxyMsgHandle> typename TProxyPkgHandle, typename TProxyMsgHandle, size_t DEFAULT_TIMEOUT = 1000>
         class BindProxy {
-            typedef std::shared_ptr<ProxyMsg<TProxyMsgHandle>>  ProxyMsgPtr;
+            typedef ProxyMsg<TProxyMsgHandle>                   ProxyMsgType;
             typedef NetCallBack::SessionID                      SessionID;
-            // 回调模式内部解析函数
-            typedef std::function<void(SessionID, msg_status, ProxyMsgPtr)>       rsp_callback_function_type;
 
+            // 绑定模式内部解析函数
+            typedef std::function<void(SessionID, ProxyMsgType&)>        bind_function_type;
+            // 方法执行方式, 由工作线程中的任务共同持有
+            struct dispatch_st {
+                rpc_dispatch            policy_ = rpc_dispatch::inline_call;
+                // 待处理(排队及执行中)请求数上限, 0表示不限; 手动应答及协程方法以处理函数返回计
+                size_t                  max_pending_ = 0;
+                std::atomic<size_t>     pending_{ 0 };
+            };
+            struct bind_item_st {
+                // 工作线程中的任务共同持有, 重新绑定不影响已投递请求
+                std::shared_ptr<const bind_function_type>   func_;
+                RpcSchema                                   schema_;
+                std::shared_ptr<dispatch_st>                dispatch_;
+                // 流式方法, 仅接受流式调用
+                bool                                        stream_;
+            };
         public:
-            BindProxy(RpcBase<TProxyPkgHandle, TProxyMsgHandle, DEFAULT_TIMEOUT>* parent) {
-                m_parent = parent;
+            BindProxy(RpcBase<TProxyPkgHandle, TProxyMsgHandle, DEFAULT_TIMEOUT>* parent)
+                : m_parent(parent)
+                , m_dispatch_threads(std::thread::hardware_concurrency())
+            {
             }
 
             // 返回是否已绑定
-            bool invoke(SessionID session_id, const ProxyMsgPtr& msg) {
-                auto iter = m_bind_map.find(msg->get_rpc_name());
-                if (iter == m_bind_map.end())
+            bool invoke(SessionID session_id, ProxyMsgType& msg) {
+                auto item = m_bind_map.find(msg.get_method_id());
+                if (!item)
+                    return false;
+                // 名称模式下校验方法名, 避免哈希冲突误调用
+                if (!msg.get_rpc_name().empty() && item->name_ != msg.get_rpc_name())
+                    return false;
+                // 流式方法与普通方法的调用方式不可混用, 视为未绑定
+                if ((msg.get_rpc_model() == rpc_model::stream) != item->value_.stream_)
+                    return false;
+                if (item->value_.dispatch_->policy_ == rpc_dispatch::inline_call)
+                    (*item->value_.func_)(session_id, msg);
+                else
+                    dispatch(session_id, msg, *item);
+                return true;
+            }
+
+            // 设置方法执行方式, 返回false表示方法未绑定
+            bool set_dispatch(const RpcMethod& rpc_name, rpc_dispatch policy, size_t max_pending) {
+                auto item = m_bind_map.find(rpc_name.id_);
+                if (!item || item->name_ != rpc_name.name_)
                     return false;
-                iter->second(session_id, msg);
+                auto& dispatch = item->value_.dispatch_;
+                dispatch->policy_ = policy;
+                dispatch->max_pending_ = max_pending;
+                // 线程池已开启时不重复开启
+                if (policy == rpc_dispatch::shared_pool)
+                    m_shared_pool.start(m_dispatch_threads);
+                else if (policy == rpc_dispatch::session_serial)
+                    m_serial_pool.start(m_dispatch_threads);
                 return true;
             }
 
+            // 设置工作线程数, 0表示系统CPU核数, 已开启的线程池即时调整
+            void set_dispatch_threads(size_t thread_num) {
+                m_dispatch_threads = thread_num;
+                m_shared_pool.reset_thread_num(thread_num);
+                m_serial_pool.reset_thread_num(thread_num);
+            }
+
+            // 终止工作线程, 等待执行中的请求结束, 未执行的请求被丢弃
+            void stop_dispatch() {
+                m_shared_pool.stop();
+                m_serial_pool.stop();
+            }
+
+            // 返回false表示与已绑定的其他方法名ID冲突
             template<typename TReturn, typename... TRspParams>
-            inline void insert(const std::string& rpc_name, const std::function<TReturn(SessionID, const message_head&, TRspParams...)>& bindfunc) {
-                m_bind_map[rpc_name] = std::bind(&BindProxy::bind_proxy<TReturn, TRspParams...>, this, bindfunc, rpc_name, std::placeholders::_1, std::placeholders::_2);
+            inline bool insert(const RpcMethod& rpc_name, const std::function<TReturn(SessionID, const message_head&, TRspParams...)>& bindfunc) {
+                // 需主动应答, 返回值结构未知
+                RpcSchema schema{ RpcSchemaID<typename std::decay<TRspParams>::type...>(), 0 };
+                return insert_item(rpc_name, std::bind(&BindProxy::bind_proxy<TReturn, TRspParams...>, this, bindfunc, std::string(rpc_name.name_), rpc_name.id_, std::placeholders::_1, std::placeholders::_2), schema);
             }
 
             template<typename TReturn, typename... TRspParams>
-            inline void insert_auto_rsp(const std::string& rpc_name, const std::function<TReturn(SessionID, TRspParams...)>& bindfunc) {
-                m_bind_map[rpc_name] = std::bind(&BindProxy::bind_auto_proxy<TReturn, TRspParams...>, this, bindfunc, rpc_name, std::placeholders::_1, std::placeholders::_2);
+            inline bool insert_auto_rsp(const RpcMethod& rpc_name, const std::function<TReturn(SessionID, TRspParams...)>& bindfunc) {
+                return insert_item(rpc_name, std::bind(&BindProxy::bind_auto_proxy<TReturn, TRspParams...>, this, bindfunc, std::string(rpc_name.name_), rpc_name.id_, std::placeholders::_1, std::placeholders::_2), bind_schema<TReturn, TRspParams...>());
+            }
+
+#ifdef BTOOL_RPC_COROUTINE
+            // 协程挂起期间请求参数需保存于协程帧内, 故参数须按值传递
+            template<typename TReturn, typename... TRspParams>
+            inline bool insert_co(const RpcMethod& rpc_name, const std::function<rpc_task<TReturn>(SessionID, TRspParams...)>& bindfunc) {
+                static_assert(!std::disjunction<std::is_reference<TRspParams>...>::value, "coroutine handler parameters must be passed by value");
+                // 应答时可能已重新绑定, 方法名独立保存
+                auto name = std::make_shared<const std::string>(rpc_name.name_);
+                return insert_item(rpc_name, std::bind(&BindProxy::bind_co_proxy<TReturn, TRspParams...>, this, bindfunc, std::move(name), rpc_name.id_, std::placeholders::_1, std::placeholders::_2), bind_schema<TReturn, TRspParams...>());
+            }
+#endif
+
+            // 流式方法, 请求参数前附带请求端的初始额度
+            template<typename TReturn, typename... TItems, typename... TRspParams>
+            inline bool insert_stream(const RpcMethod& rpc_name, const std::function<TReturn(SessionID, rpc_stream<TItems...>, TRspParams...)>& bindfunc) {
+                // 写入时可能已重新绑定, 方法名独立保存
+                auto name = std::make_shared<const std::string>(rpc_name.name_);
+                uint32_t method_id = rpc_name.id_;
+                RpcSchema schema{ RpcSchemaID<typename std::decay<TRspParams>::type...>(), RpcSchemaID<typename std::decay<TItems>::type...>() };
+                return insert_item(rpc_name, [this, bindfunc, name, method_id](SessionID session_id, ProxyMsgType& msg) {
+                    bind_stream_proxy(bindfunc, name, method_id, session_id, msg);
+                }, schema, true);
+            }
+
+            // 已绑定方法集合, 方法名引用自内部存储, 再次绑定后失效
+            std::vector<RpcMethodInfo> get_methods() const {
+                std::vector<RpcMethodInfo> methods;
+                methods.reserve(m_bind_map.entries().size());
+                for (auto& item : m_bind_map.entries())
+                    methods.push_back(RpcMethodInfo{ RpcMethod(item.id_, item.name_), item.value_.schema_ });
+                return methods;
             }
 
         protected:
+            // 重新绑定时沿用原执行方式
+            bool insert_item(const RpcMethod& rpc_name, bind_function_type&& func, const RpcSchema& schema, bool stream = false) {
+                auto item = m_bind_map.find(rpc_name.id_);
+                auto dispatch = item && item->name_ == rpc_name.name_ ? item->value_.dispatch_ : std::make_shared<dispatch_st>();
+                return m_bind_map.insert(rpc_name.id_, rpc_name.name_, bind_item_st{ std::make_shared<const bind_function_type>(std::move(func)), schema, std::move(dispatch), stream });
+            }
+
+            // 投递至工作线程执行, 请求内容复制至独立内存
+            template<typename TEntry>
+            void dispatch(SessionID session_id, ProxyMsgType& msg, const TEntry& item) {
+                auto& dispatch = item.value_.dispatch_;
+                // 待处理请求数达上限时直接拒绝, 避免排队时延无限增长
+                size_t pending = dispatch->pending_.fetch_add(1, std::memory_order_relaxed);
+                if (dispatch->max_pending_ != 0 && pending >= dispatch->max_pending_) {
+                    dispatch->pending_.fetch_sub(1, std::memory_order_relaxed);
+                    m_parent->rsp_bind(RpcMethod(item.id_, item.name_), session_id, msg.get_req_id(), msg.get_rpc_model(), msg_status::overload);
+                    return;
+                }
+
+                // 任务队列以内存复制方式移动任务, 捕获对象限于智能指针等可平凡搬移类型
+                auto req = std::make_shared<ProxyMsgType>(msg);
+                auto task = [func = item.value_.func_, dispatch, session_id, req]() {
+                    (*func)(session_id, *req);
+                    dispatch->pending_.fetch_sub(1, std::memory_order_relaxed);
+                };
+                bool added = dispatch->policy_ == rpc_dispatch::session_serial
+                    ? m_serial_pool.add_task(session_id, std::move(task))
+                    : m_shared_pool.add_task(std::move(task));
+                if (!added) {
+                    dispatch->pending_.fetch_sub(1, std::memory_order_relaxed);
+                    m_parent->rsp_bind(RpcMethod(item.id_, item.name_), session_id, msg.get_req_id(), msg.get_rpc_model(), msg_status::fail);
+                }
+            }
+
+            // 自动应答方法的结构哈希, 无返回值时以空类型列表计
+            template<typename TReturn, typename... TRspParams>
+            static constexpr RpcSchema bind_schema() {
+                if constexpr (std::is_void<TReturn>::value)
+                    return RpcSchema{ RpcSchemaID<typename std::decay<TRspParams>::type...>(), RpcSchemaID<>() };
+                else
+                    return RpcSchema{ RpcSchemaID<typename std::decay<TRspParams>::type...>(), RpcSchemaID<TReturn>() };
+            }
+
 /**************   bind_proxy  ******************/
             template<typename TReturn>
             typename std::enable_if<std::is_void<TReturn>::value, void>::type
-                bind_proxy(std::function<TReturn(SessionID, const message_head&)> bindfunc, const std::string& rpc_name, SessionID session_id, const ProxyMsgPtr& msg) {
+                bind_proxy(const std::function<TReturn(SessionID, const message_head&)>& bindfunc, const std::string& rpc_name, uint32_t method_id, SessionID session_id, ProxyMsgType& msg) {
                 msg_status status = msg_status::fail;
-                msg->get_req_params(status);
+                msg.get_req_params(status);
                 if (status != msg_status::ok) {
-                    m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status);
+                    m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status);
                     return;
                 }
-                bind_invoke(bindfunc, session_id, msg->get_message_head());
+                bind_invoke(bindfunc, session_id, msg.get_message_head());
             }
             template<typename TReturn>
             typename std::enable_if<!std::is_void<TReturn>::value, void>::type
-                bind_proxy(std::function<TReturn(SessionID, const message_head&)> bindfunc, const std::string& rpc_name, SessionID session_id, const ProxyMsgPtr& msg) {
+                bind_proxy(const std::function<TReturn(SessionID, const message_head&)>& bindfunc, const std::string& rpc_name, uint32_t method_id, SessionID session_id, ProxyMsgType& msg) {
                 msg_status status = msg_status::fail;
-                msg->get_req_params(status);
+                msg.get_req_params(status);
                 if (status != msg_status::ok) {
-                    m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status, TReturn());
+                    m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status, TReturn());
                     return;
                 }
-                bind_invoke(bindfunc, session_id, msg->get_message_head());
+                bind_invoke(bindfunc, session_id, msg.get_message_head());
             }
             template<typename TReturn, typename TParam0, typename... TRspParams>
             typename std::enable_if<std::is_void<TReturn>::value, void>::type
-                bind_proxy(std::function<TReturn(SessionID, const message_head&, TParam0, TRspParams...)> bindfunc, const std::string& rpc_name, SessionID session_id, const ProxyMsgPtr& msg) {
+                bind_proxy(const std::function<TReturn(SessionID, const message_head&, TParam0, TRspParams...)>& bindfunc, const std::string& rpc_name, uint32_t method_id, SessionID session_id, ProxyMsgType& msg) {
                 msg_status status = msg_status::fail;
                 using args_type = std::tuple<typename std::decay<TParam0>::type, typename std::decay<TRspParams>::type...>;
-                auto rsp = msg->template get_req_params<args_type>(status);
+                auto rsp = msg.template get_req_params<args_type>(status);
                 if (status != msg_status::ok) {
-                    m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status);
+                    m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status);
                     return;
                 }
-                bind_invoke(bindfunc, session_id, msg->get_message_head(), std::move(rsp));
+                bind_invoke(bindfunc, session_id, msg.get_message_head(), std::move(rsp));
             }
             template<typename TReturn, typename TParam0, typename... TRspParams>
             typename std::enable_if<!std::is_void<TReturn>::value, void>::type
-                bind_proxy(std::function<TReturn(SessionID, const message_head&, TParam0, TRspParams...)> bindfunc, const std::string& rpc_name, SessionID session_id, const ProxyMsgPtr& msg) {
+                bind_proxy(const std::function<TReturn(SessionID, const message_head&, TParam0, TRspParams...)>& bindfunc, const std::string& rpc_name, uint32_t method_id, SessionID session_id, ProxyMsgType& msg) {
                 msg_status status = msg_status::fail;
                 using args_type = std::tuple<typename std::decay<TParam0>::type, typename std::decay<TRspParams>::type...>;
-                auto rsp = msg->template get_req_params<args_type>(status);
+                auto rsp = msg.template get_req_params<args_type>(status);
                 if (status != msg_status::ok) {
-                    m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status, TReturn());
+                    m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status, TReturn());
                     return;
                 }
-                bind_invoke(bindfunc, session_id, msg->get_message_head(), std::move(rsp));
+                bind_invoke(bindfunc, session_id, msg.get_message_head(), std::move(rsp));
             }
 
             template<typename TReturn>
@@ -648,53 +1756,53 @@ namespace BTool
 
             template<typename TReturn>
             typename std::enable_if<std::is_void<TReturn>::value, void>::type
-                bind_auto_proxy(std::function<TReturn(SessionID)> bindfunc, const std::string& rpc_name, SessionID session_id, const ProxyMsgPtr& msg) {
+                bind_auto_proxy(const std::function<TReturn(SessionID)>& bindfunc, const std::string& rpc_name, uint32_t method_id, SessionID session_id, ProxyMsgType& msg) {
                 msg_status status = msg_status::fail;
-                msg->get_req_params(status);
+                msg.get_req_params(status);
                 if (status != msg_status::ok) {
-                    m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status);
+                    m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status);
                     return;
                 }
                 bind_auto_invoke(bindfunc, session_id);
-                m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status);
+                m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status);
             }
             template<typename TReturn>
             typename std::enable_if<!std::is_void<TReturn>::value, void>::type
-                bind_auto_proxy(std::function<TReturn(SessionID)> bindfunc, const std::string& rpc_name, SessionID session_id, const ProxyMsgPtr& msg) {
+                bind_auto_proxy(const std::function<TReturn(SessionID)>& bindfunc, const std::string& rpc_name, uint32_t method_id, SessionID session_id, ProxyMsgType& msg) {
                 msg_status status = msg_status::fail;
-                msg->get_req_params(status);
+                msg.get_req_params(status);
                 if (status != msg_status::ok) {
-                    m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status, TReturn());
+                    m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status, TReturn());
                     return;
                 }
                 auto resault = bind_auto_invoke(bindfunc, session_id);
-                m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status, std::move(resault));
+                m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status, std::move(resault));
             }
             template<typename TReturn, typename TParam0, typename... TRspParams>
             typename std::enable_if<std::is_void<TReturn>::value, void>::type
-                bind_auto_proxy(std::function<TReturn(SessionID, TParam0, TRspParams...)> bindfunc, const std::string& rpc_name, SessionID session_id, const ProxyMsgPtr& msg) {
+                bind_auto_proxy(const std::function<TReturn(SessionID, TParam0, TRspParams...)>& bindfunc, const std::string& rpc_name, uint32_t method_id, SessionID session_id, ProxyMsgType& msg) {
                 msg_status status = msg_status::fail;
                 using args_type = std::tuple<typename std::decay<TParam0>::type, typename std::decay<TRspParams>::type...>;
-                auto rsp = msg->template get_req_params<args_type>(status);
+                auto rsp = msg.template get_req_params<args_type>(status);
                 if (status != msg_status::ok) {
-                    m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status);
+                    m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status);
                     return;
                 }
                 bind_auto_invoke(bindfunc, session_id, std::move(rsp));
-                m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status);
+                m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status);
             }
             template<typename TReturn, typename TParam0, typename... TRspParams>
             typename std::enable_if<!std::is_void<TReturn>::value, void>::type
-                bind_auto_proxy(std::function<TReturn(SessionID, TParam0, TRspParams...)> bindfunc, const std::string& rpc_name, SessionID session_id, const ProxyMsgPtr& msg) {
+                bind_auto_proxy(const std::function<TReturn(SessionID, TParam0, TRspParams...)>& bindfunc, const std::string& rpc_name, uint32_t method_id, SessionID session_id, ProxyMsgType& msg) {
                 msg_status status = msg_status::fail;
                 using args_type = std::tuple<typename std::decay<TParam0>::type, typename std::decay<TRspParams>::type...>;
-                auto rsp = msg->template get_req_params<args_type>(status);
+                auto rsp = msg.template get_req_params<args_type>(status);
                 if (status != msg_status::ok) {
-                    m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status, TReturn());
+                    m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status, TReturn());
                     return;
                 }
                 auto resault = bind_auto_invoke(bindfunc, session_id, std::move(rsp));
-                m_parent->rsp_bind(rpc_name, session_id, msg->get_req_id(), msg->get_rpc_model(), status, std::move(resault));
+                m_parent->rsp_bind(RpcMethod(method_id, rpc_name), session_id, msg.get_req_id(), msg.get_rpc_model(), status, std::move(resault));
             }
 
             template<typename TReturn>
@@ -706,22 +1814,103 @@ namespace BTool
                 return std::apply(bindfunc, MemoryStream::tuple_merge(session_id, std::forward<ArgsTuple>(args)));
             }
 
-            // 绑定模式内部解析函数
-            typedef std::function<void(SessionID, const ProxyMsgPtr&)>  bind_function_type;
+/**************   bind_stream_proxy  ******************/
+            // 解析初始额度及请求参数, 开启流后调用处理函数, 处理函数返回后流仍由句柄持有
+            template<typename TReturn, typename... TItems, typename... TRspParams>
+            void bind_stream_proxy(const std::function<TReturn(SessionID, rpc_stream<TItems...>, TRspParams...)>& bindfunc, const std::shared_ptr<const std::string>& rpc_name, uint32_t method_id, SessionID session_id, ProxyMsgType& msg) {
+                msg_status status = msg_status::fail;
+                using args_type = std::tuple<uint32_t, typename std::decay<TRspParams>::type...>;
+                auto rsp = msg.template get_req_params<args_type>(status);
+                if (status != msg_status::ok) {
+                    m_parent->rsp_bind(RpcMethod(method_id, *rpc_name), session_id, msg.get_req_id(), rpc_model::stream, status);
+                    return;
+                }
+                uint32_t req_id = msg.get_req_id();
+                std::apply([&](uint32_t credit, auto&&... params) {
+                    rpc_stream<TItems...> stream(m_parent->template open_stream<TItems...>(rpc_name, method_id, session_id, req_id, credit));
+                    bindfunc(session_id, std::move(stream), std::move(params)...);
+                }, std::move(rsp));
+            }
+
+#ifdef BTOOL_RPC_COROUTINE
+            template<typename TReturn, typename... TRspParams>
+            void bind_co_proxy(const std::function<rpc_task<TReturn>(SessionID, TRspParams...)>& bindfunc, const std::shared_ptr<const std::string>& rpc_name, uint32_t method_id, SessionID session_id, ProxyMsgType& msg) {
+                msg_status status = msg_status::fail;
+                uint32_t req_id = msg.get_req_id();
+                rpc_model model = msg.get_rpc_model();
+                if constexpr (sizeof...(TRspParams) == 0) {
+                    msg.get_req_params(status);
+                    if (status != msg_status::ok) {
+                        co_rsp_fail<TReturn>(RpcMethod(method_id, *rpc_name), session_id, req_id, model, status);
+                        return;
+                    }
+                    co_start(bindfunc(session_id), rpc_name, method_id, session_id, req_id, model);
+                }
+                else {
+                    using args_type = std::tuple<typename std::decay<TRspParams>::type...>;
+                    auto rsp = msg.template get_req_params<args_type>(status);
+                    if (status != msg_status::ok) {
+                        co_rsp_fail<TReturn>(RpcMethod(method_id, *rpc_name), session_id, req_id, model, status);
+                        return;
+                    }
+                    co_start(std::apply(bindfunc, MemoryStream::tuple_merge(session_id, std::move(rsp))), rpc_name, method_id, session_id, req_id, model);
+                }
+            }
+
+            // 启动协程, 于co_return时应答请求端
+            template<typename TReturn>
+            void co_start(rpc_task<TReturn>&& task, const std::shared_ptr<const std::string>& rpc_name, uint32_t method_id, SessionID session_id, uint32_t req_id, rpc_model model) {
+                auto parent = m_parent;
+                if constexpr (std::is_void<TReturn>::value) {
+                    task.start([parent, rpc_name, method_id, session_id, req_id, model](msg_status status) {
+                        parent->rsp_bind(RpcMethod(method_id, *rpc_name), session_id, req_id, model, status);
+                    });
+                }
+                else {
+                    task.start([parent, rpc_name, method_id, session_id, req_id, model](msg_status status, TReturn rslt) {
+                        parent->rsp_bind(RpcMethod(method_id, *rpc_name), session_id, req_id, model, status, std::move(rslt));
+                    });
+                }
+            }
+
+            template<typename TReturn>
+            void co_rsp_fail(const RpcMethod& rpc_name, SessionID session_id, uint32_t req_id, rpc_model model, msg_status status) {
+                if constexpr (std::is_void<TReturn>::value)
+                    m_parent->rsp_bind(rpc_name, session_id, req_id, model, status);
+                else
+                    m_parent->rsp_bind(rpc_name, session_id, req_id, model, status, TReturn());
+            }
+#endif
+
             // bind函数绑定集合
-            std::unordered_map<std::string, bind_function_type>          m_bind_map;
+            RpcMethodTable<bind_item_st>                                 m_bind_map;
             // 所属对象
             RpcBase<TProxyPkgHandle, TProxyMsgHandle, DEFAULT_TIMEOUT>*  m_parent;
+            // 工作线程数
+            size_t                                                       m_dispatch_threads;
+            // 共享工作线程池
+            ParallelTaskPool                                             m_shared_pool;
+            // 按会话串行的工作线程池
+            SerialTaskPool<SessionID>                                    m_serial_pool;
         };
 
         template<template<typename TProxyMsgHandle> typename TProxyPkgHandle, typename TProxyMsgHandle, size_t DEFAULT_TIMEOUT = 1000>
         class RpcBase {
         protected:
-            typedef std::shared_ptr<ProxyMsg<TProxyMsgHandle>>  ProxyMsgPtr;
+            typedef ProxyMsg<TProxyMsgHandle>                   ProxyMsgType;
+            typedef std::shared_ptr<ProxyMsgType>               ProxyMsgPtr;
+            typedef ConcurrentWriteBuffer<>::WriteMemoryStreamPtr   WriteMemoryStreamPtr;
             typedef std::shared_ptr<std::promise<ProxyMsgPtr>>  PromisePtr;
             typedef NetCallBack::SessionID                      SessionID;
+            typedef typename StreamProxy<TProxyMsgHandle>::StreamPtr    StreamPtr;
+
+            // 流式方法经open_stream开启流
+            friend class BindProxy<TProxyPkgHandle, TProxyMsgHandle, DEFAULT_TIMEOUT>;
 
         public:
+            // 流式调用的默认额度, 即应答端至多领先请求端处理的元素数
+            static constexpr uint32_t DEFAULT_STREAM_WINDOW = 64;
+
             RpcBase() : m_bind_proxy(this){}
             virtual ~RpcBase() {}
 
@@ -731,15 +1920,17 @@ namespace BTool
             struct callback_req_op {
                 // 无参数
                 template<bool = std::is_null_pointer<TParam>::value>
-                callback_req_op(RpcBase* parent, const std::string& rpc_name, SessionID session_id)
+                callback_req_op(RpcBase* parent, const RpcMethod& rpc_name, SessionID session_id)
                     : parent_(parent)
-                    , rpc_name_(rpc_name)
+                    , rpc_name_(rpc_name.name_)
+                    , method_id_(rpc_name.id_)
                     , session_id_(session_id) {}
                 // 有参数
                 template<bool = !std::is_null_pointer<TParam>::value>
-                callback_req_op(RpcBase* parent, const std::string& rpc_name, SessionID session_id, TParam&& arg)
+                callback_req_op(RpcBase* parent, const RpcMethod& rpc_name, SessionID session_id, TParam&& arg)
                     : parent_(parent)
-                    , rpc_name_(rpc_name)
+                    , rpc_name_(rpc_name.name_)
+                    , method_id_(rpc_name.id_)
                     , session_id_(session_id)
                     , arg_(std::forward<TParam>(arg)) {}
             public:
@@ -751,12 +1942,12 @@ namespace BTool
                 // std::functional(const &)
                 template<typename TReturn, typename... TRspParams>
                 void functional(const std::function<TReturn(SessionID, msg_status, TRspParams...)>& callback) {
-                    write_msg(parent_->m_callback_proxy.insert(callback));
+                    write_msg(parent_->m_callback_proxy.insert(session_id_, callback), call_schema<TRspParams...>());
                 }
                 // std::functional(&&)
                 template<typename TReturn, typename... TRspParams>
                 void functional(std::function<TReturn(SessionID, msg_status, TRspParams...)>&& callback) {
-                    write_msg(parent_->m_callback_proxy.insert(std::move(callback)));
+                    write_msg(parent_->m_callback_proxy.insert(session_id_, std::move(callback)), call_schema<TRspParams...>());
                 }
                 // &functional
                 template<typename TReturn, typename... TRspParams>
@@ -769,137 +1960,818 @@ namespace BTool
                     operator()([=](SessionID session_id, msg_status status, TRspParams... ps)->TReturn { return (obj->*callback)(session_id, status, ps...); });
                 }
 
-            private:
-                // 无参数
-                template <typename TType = TParam>
-                typename std::enable_if<std::is_null_pointer<TType>::value, void>::type
-                    write_msg(uint32_t req_id) {
-                    parent_->callback_send(TIMEOUT, rpc_name_, session_id_, req_id);
+            private:
+                // 回调参数即返回值, 无回调参数时不比对返回值
+                template<typename... TRspParams>
+                static constexpr RpcSchema call_schema() {
+                    uint32_t result = 0;
+                    if constexpr (sizeof...(TRspParams) > 0)
+                        result = RpcSchemaID<typename std::decay<TRspParams>::type...>();
+                    if constexpr (std::is_null_pointer<TParam>::value)
+                        return RpcSchema{ RpcSchemaID<>(), result };
+                    else
+                        return RpcSchema{ RpcSchemaID<TParam>(), result };
+                }
+
+                // 无参数
+                template <typename TType = TParam>
+                typename std::enable_if<std::is_null_pointer<TType>::value, void>::type
+                    write_msg(uint32_t req_id, const RpcSchema& schema) {
+                    if (req_id == 0)
+                        return;
+                    parent_->callback_send(TIMEOUT, RpcMethod(method_id_, rpc_name_), schema, session_id_, req_id);
+                }
+                // 有参数
+                template <typename TType = TParam>
+                typename std::enable_if<!std::is_null_pointer<TType>::value, void>::type
+                    write_msg(uint32_t req_id, const RpcSchema& schema) {
+                    if (req_id == 0)
+                        return;
+                    parent_->callback_send(TIMEOUT, RpcMethod(method_id_, rpc_name_), schema, session_id_, req_id, std::forward<TParam>(arg_));
+                }
+
+            private:
+                RpcBase*        parent_;
+                // 持有方法名副本及构造时已求得的方法ID, 不依赖调用方的名称存储
+                std::string     rpc_name_;
+                uint32_t        method_id_;
+                SessionID       session_id_;
+                TParam          arg_;
+            };
+
+            /**************   pipeline 请求操作定义  ******************/
+            // 流水线调用, 同一线程连续发出多个请求而无需逐个等待应答, 最后经wait统一收集
+            // 结果按发出顺序存放, 有返回值时为std::tuple<msg_status, TReturn>, 否则为msg_status
+            // 应答回调引用本对象, 析构时等待已发出的请求全部完成(最迟至超时)
+            template<typename TReturn = void>
+            class pipeline_op {
+            public:
+                typedef typename rpc_result<TReturn>::type result_type;
+
+                pipeline_op(RpcBase* parent, SessionID session_id, size_t overtime)
+                    : parent_(parent)
+                    , session_id_(session_id)
+                    , overtime_(overtime) {}
+                pipeline_op(const pipeline_op&) = delete;
+                pipeline_op& operator=(const pipeline_op&) = delete;
+                ~pipeline_op() {
+                    wait();
+                }
+
+                // 发出单个请求, 返回其结果下标
+                template<typename... Args>
+                size_t call(const RpcMethod& rpc_name, Args&&... args) {
+                    size_t index = 0;
+                    uint32_t req_id = add(index);
+                    if (req_id != 0)
+                        parent_->callback_send(overtime_, rpc_name, RpcCallSchema<TReturn, typename std::decay<Args>::type...>(), session_id_, req_id, std::forward<Args>(args)...);
+                    return index;
+                }
+
+                // 批量发出同一方法的多个请求, 全部序列化至同一发送缓存, 以单次写入送出
+                // params: 元素为单个参数或由参数组成的std::tuple
+                // 返回首个结果下标, 其后结果依params顺序排列
+                template<typename TParam>
+                size_t batch(const RpcMethod& rpc_name, const std::vector<TParam>& params) {
+                    size_t first = size();
+                    std::vector<uint32_t> req_ids(params.size());
+                    for (size_t i = 0; i < params.size(); ++i) {
+                        size_t index = 0;
+                        req_ids[i] = add(index);
+                        if (i == 0)
+                            first = index;
+                    }
+                    parent_->batch_send(overtime_, rpc_name, RpcCallSchema<TReturn, TParam>(), session_id_, req_ids, params);
+                    return first;
+                }
+
+                // 等待已发出的请求全部完成
+                const std::vector<result_type>& wait() {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    cv_.wait(lock, [this] { return pending_ == 0; });
+                    return results_;
+                }
+                // 等待全部完成并取出结果, 之后可继续复用
+                std::vector<result_type> release() {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    cv_.wait(lock, [this] { return pending_ == 0; });
+                    return std::move(results_);
+                }
+
+                size_t size() const {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    return results_.size();
+                }
+
+            private:
+                // 登记结果位置及应答回调, 返回0表示已失败
+                uint32_t add(size_t& index) {
+                    {
+                        std::lock_guard<std::mutex> lock(mtx_);
+                        index = results_.size();
+                        results_.emplace_back();
+                        ++pending_;
+                    }
+                    // 仅捕获this与下标, 不超出std::function的小对象缓存
+                    size_t slot = index;
+                    if constexpr (std::is_void<TReturn>::value) {
+                        return parent_->m_callback_proxy.insert(session_id_, std::function<void(SessionID, msg_status)>(
+                            [this, slot](SessionID, msg_status status) { complete(slot, result_type(status)); }));
+                    }
+                    else {
+                        return parent_->m_callback_proxy.insert(session_id_, std::function<void(SessionID, msg_status, TReturn)>(
+                            [this, slot](SessionID, msg_status status, TReturn rslt) { complete(slot, result_type(status, std::move(rslt))); }));
+                    }
+                }
+
+                void complete(size_t index, result_type&& result) {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    results_[index] = std::move(result);
+                    if (--pending_ == 0)
+                        cv_.notify_all();
+                }
+
+            private:
+                RpcBase*                    parent_;
+                SessionID                   session_id_;
+                size_t                      overtime_;
+                mutable std::mutex          mtx_;
+                std::condition_variable     cv_;
+                size_t                      pending_ = 0;
+                std::vector<result_type>    results_;
+            };
+
+#ifdef BTOOL_RPC_COROUTINE
+            /**************   协程调用定义  ******************/
+            // co_await等待应答, 结果同同步调用: 有返回值时为std::tuple<msg_status, TReturn>, 否则为msg_status
+            // 请求于挂起时发出, 超时及断开均如回调模式按时结束, 不占用等待线程
+            // 默认于收到应答的线程(网络线程或超时扫描线程)恢复协程, 可经resume_on指定执行器
+            // 仅引用左值参数, 需在同一表达式内完成co_await
+            template<typename TReturn, typename... Args>
+            class call_awaitable {
+            public:
+                typedef typename rpc_result<TReturn>::type result_type;
+
+                call_awaitable(RpcBase* parent, const RpcMethod& rpc_name, SessionID session_id, size_t overtime, Args&&... args)
+                    : parent_(parent)
+                    , rpc_name_(rpc_name.name_)
+                    , method_id_(rpc_name.id_)
+                    , session_id_(session_id)
+                    , overtime_(overtime)
+                    , args_(std::forward<Args>(args)...) {}
+                // 应答回调引用本对象, 仅可于co_await前移动
+                call_awaitable(call_awaitable&& rhs)
+                    : parent_(rhs.parent_)
+                    , rpc_name_(std::move(rhs.rpc_name_))
+                    , method_id_(rhs.method_id_)
+                    , session_id_(rhs.session_id_)
+                    , overtime_(rhs.overtime_)
+                    , args_(std::move(rhs.args_))
+                    , resume_(std::move(rhs.resume_)) {}
+                call_awaitable(const call_awaitable&) = delete;
+                call_awaitable& operator=(const call_awaitable&) = delete;
+
+                // 指定恢复协程的执行器, 如io_context::executor_type或strand, 应答后经boost::asio::post投递恢复
+                template<typename TExecutor>
+                call_awaitable resume_on(const TExecutor& executor) && {
+                    resume_ = [executor](std::coroutine_handle<> handle) {
+                        boost::asio::post(executor, [handle]() { handle.resume(); });
+                    };
+                    return std::move(*this);
+                }
+
+                bool await_ready() const noexcept {
+                    return false;
+                }
+                bool await_suspend(std::coroutine_handle<> handle) {
+                    handle_ = handle;
+                    uint32_t req_id = insert();
+                    if (req_id != 0) {
+                        std::apply([&](auto&&... args) {
+                            parent_->callback_send(overtime_, RpcMethod(method_id_, rpc_name_), RpcCallSchema<TReturn, typename std::decay<Args>::type...>(), session_id_, req_id, std::forward<decltype(args)>(args)...);
+                        }, std::move(args_));
+                    }
+                    // 应答可能已于本线程内完成(如发送失败或在途已满), 此时不挂起
+                    return !ready_.exchange(true, std::memory_order_acq_rel);
+                }
+                result_type await_resume() {
+                    return std::move(result_);
+                }
+
+            private:
+                // 仅捕获this, 不超出std::function的小对象缓存
+                uint32_t insert() {
+                    if constexpr (std::is_void<TReturn>::value) {
+                        return parent_->m_callback_proxy.insert(session_id_, std::function<void(SessionID, msg_status)>(
+                            [this](SessionID, msg_status status) { complete(result_type(status)); }));
+                    }
+                    else {
+                        return parent_->m_callback_proxy.insert(session_id_, std::function<void(SessionID, msg_status, TReturn)>(
+                            [this](SessionID, msg_status status, TReturn rslt) { complete(result_type(status, std::move(rslt))); }));
+                    }
+                }
+
+                void complete(result_type&& result) {
+                    result_ = std::move(result);
+                    // 先到者仅置位, 后到者负责恢复; 恢复后本对象可能随即析构, 不可再访问成员
+                    if (!ready_.exchange(true, std::memory_order_acq_rel))
+                        return;
+                    auto handle = handle_;
+                    if (!resume_) {
+                        handle.resume();
+                        return;
+                    }
+                    auto resume = std::move(resume_);
+                    resume(handle);
+                }
+
+            private:
+                RpcBase*                                        parent_;
+                std::string                                     rpc_name_;
+                uint32_t                                        method_id_;
+                SessionID                                       session_id_;
+                size_t                                          overtime_;
+                std::tuple<Args...>                             args_;
+                std::function<void(std::coroutine_handle<>)>    resume_;
+                std::coroutine_handle<>                         handle_;
+                std::atomic<bool>                               ready_{ false };
+                result_type                                     result_{};
+            };
+#endif
+
+            /**************   流式调用定义  ******************/
+            // 流式调用辅助操作类, 经operator()(item_cbk, end_cbk)发出请求
+            // item_cbk(SessionID, TItems...): 于网络线程逐个接收元素, 返回后计入已处理并适时归还额度
+            // end_cbk(SessionID, msg_status): 流结束, 状态为应答端finish所指定, 会话断开时为wait_error, 经cancel_stream取消时为fail
+            // 返回流ID, 可经cancel_stream取消; 返回0表示未能发出, 此时end_cbk已执行
+            // 仅引用左值参数, 需在同一表达式内完成调用
+            template<typename... Args>
+            class stream_req_op {
+            public:
+                stream_req_op(RpcBase* parent, const RpcMethod& rpc_name, SessionID session_id, uint32_t window, Args&&... args)
+                    : parent_(parent)
+                    , rpc_name_(rpc_name.name_)
+                    , method_id_(rpc_name.id_)
+                    , session_id_(session_id)
+                    , window_(std::max<uint32_t>(1, window))
+                    , args_(std::forward<Args>(args)...) {}
+
+                // lambda
+                template<typename TItemFunc, typename TEndFunc>
+                uint32_t operator()(TItemFunc&& item_cbk, TEndFunc&& end_cbk) {
+                    return functional(parent_->from_lambad(std::forward<TItemFunc>(item_cbk)), parent_->from_lambad(std::forward<TEndFunc>(end_cbk)));
                 }
-                // 有参数
-                template <typename TType = TParam>
-                typename std::enable_if<!std::is_null_pointer<TType>::value, void>::type
-                    write_msg(uint32_t req_id) {
-                    parent_->callback_send(TIMEOUT, rpc_name_, session_id_, req_id, std::forward<TParam>(arg_));
+                // std::functional
+                template<typename TReturn, typename... TItems>
+                uint32_t functional(std::function<TReturn(SessionID, TItems...)> item_cbk, std::function<void(SessionID, msg_status)> end_cbk) {
+                    auto stream = std::make_shared<typename StreamProxy<TProxyMsgHandle>::stream_st>();
+                    stream->session_id_ = session_id_;
+                    stream->rpc_name_ = rpc_name_;
+                    stream->method_id_ = method_id_;
+                    stream->window_ = window_;
+                    stream->item_fn_ = [item_cbk = std::move(item_cbk)](SessionID session_id, ProxyMsgType& msg) {
+                        msg_status status = msg_status::fail;
+                        if constexpr (sizeof...(TItems) == 0) {
+                            msg.get_rsp_params(status);
+                            if (status == msg_status::ok)
+                                item_cbk(session_id);
+                        }
+                        else {
+                            auto items = msg.template get_rsp_params<std::tuple<typename std::decay<TItems>::type...>>(status);
+                            if (status == msg_status::ok)
+                                std::apply(item_cbk, MemoryStream::tuple_merge(session_id, std::move(items)));
+                        }
+                        return status;
+                    };
+                    stream->end_fn_ = std::move(end_cbk);
+
+                    RpcSchema schema{ RpcSchemaID<typename std::decay<Args>::type...>(), RpcSchemaID<typename std::decay<TItems>::type...>() };
+                    return std::apply([&](auto&&... args) {
+                        return parent_->stream_send(RpcMethod(method_id_, stream->rpc_name_), schema, session_id_, stream, std::forward<decltype(args)>(args)...);
+                    }, std::move(args_));
                 }
 
             private:
-                RpcBase*        parent_;
-                std::string     rpc_name_;
-                SessionID       session_id_;
-                TParam          arg_;
+                RpcBase*                parent_;
+                std::string             rpc_name_;
+                uint32_t                method_id_;
+                SessionID               session_id_;
+                uint32_t                window_;
+                std::tuple<Args...>     args_;
             };
 
         public:
             /**************   bind && bind_auto  ******************/
+            // 返回false表示方法名与已绑定的其他方法ID冲突
             // lambda
             // 函数的执行结果需主动调动rsp_bind
             template<typename TBindFunc>
-            inline void bind(const std::string& rpc_name, TBindFunc&& bindfunc) {
-                bind_functional(rpc_name, from_lambad(std::forward<TBindFunc>(bindfunc)));
+            inline bool bind(const RpcMethod& rpc_name, TBindFunc&& bindfunc) {
+                return bind_functional(rpc_name, from_lambad(std::forward<TBindFunc>(bindfunc)));
             }
             // std::functional
             // 函数的执行结果需主动调动rsp_bind
             template<typename TReturn, typename... TRspParams>
-            inline void bind_functional(const std::string& rpc_name, std::function<TReturn(SessionID, const message_head&, TRspParams...)> bindfunc) {
-                m_bind_proxy.insert(rpc_name, bindfunc);
+            inline bool bind_functional(const RpcMethod& rpc_name, std::function<TReturn(SessionID, const message_head&, TRspParams...)> bindfunc) {
+                return m_bind_proxy.insert(rpc_name, bindfunc);
             }
             // &functional
             // 函数的执行结果需主动调动rsp_bind
             template<typename TReturn, typename... TRspParams>
-            inline void bind(const std::string& rpc_name, TReturn(*bindfunc)(SessionID, const message_head&, TRspParams...)) {
-                bind_functional(rpc_name, std::function<TReturn(SessionID, const message_head&, TRspParams...)>(bindfunc));
+            inline bool bind(const RpcMethod& rpc_name, TReturn(*bindfunc)(SessionID, const message_head&, TRspParams...)) {
+                return bind_functional(rpc_name, std::function<TReturn(SessionID, const message_head&, TRspParams...)>(bindfunc));
             }
             // &object::functional, object
             // 函数的执行结果需主动调动rsp_bind
             template<typename TReturn, typename TObjClass, typename TObject, typename... TRspParams>
-            inline void bind(const std::string& rpc_name, TReturn(TObjClass::* bindfunc)(SessionID, const message_head&, TRspParams...), TObject* obj) {
-                bind(rpc_name, [=](SessionID session_id, const message_head& head, TRspParams... ps)->TReturn { return (obj->*bindfunc)(session_id, head, ps...); });
+            inline bool bind(const RpcMethod& rpc_name, TReturn(TObjClass::* bindfunc)(SessionID, const message_head&, TRspParams...), TObject* obj) {
+                return bind(rpc_name, [=](SessionID session_id, const message_head& head, TRspParams... ps)->TReturn { return (obj->*bindfunc)(session_id, head, ps...); });
             }
 
             // lambda
             // 函数的执行结果直接返回给请求端
             template<typename TBindFunc>
-            inline void bind_auto(const std::string& rpc_name, TBindFunc&& bindfunc) {
-                bind_auto_functional(rpc_name, from_lambad(std::forward<TBindFunc>(bindfunc)));
+            inline bool bind_auto(const RpcMethod& rpc_name, TBindFunc&& bindfunc) {
+                return bind_auto_functional(rpc_name, from_lambad(std::forward<TBindFunc>(bindfunc)));
             }
             // std::functional
             // 函数的执行结果直接返回给请求端
             template<typename TReturn, typename... TRspParams>
-            inline void bind_auto_functional(const std::string& rpc_name, std::function<TReturn(SessionID, TRspParams...)> bindfunc) {
-                m_bind_proxy.insert_auto_rsp(rpc_name, bindfunc);
+            inline bool bind_auto_functional(const RpcMethod& rpc_name, std::function<TReturn(SessionID, TRspParams...)> bindfunc) {
+                return m_bind_proxy.insert_auto_rsp(rpc_name, bindfunc);
             }
             // &functional
             // 函数的执行结果直接返回给请求端
             template<typename TReturn, typename... TRspParams>
-            inline void bind_auto(const std::string& rpc_name, TReturn(*bindfunc)(SessionID, TRspParams...)) {
-                bind_auto_functional(rpc_name, std::function<TReturn(SessionID, TRspParams...)>(bindfunc));
+            inline bool bind_auto(const RpcMethod& rpc_name, TReturn(*bindfunc)(SessionID, TRspParams...)) {
+                return bind_auto_functional(rpc_name, std::function<TReturn(SessionID, TRspParams...)>(bindfunc));
             }
             // &object::functional, object
             // 函数的执行结果直接返回给请求端
             template<typename TReturn, typename TObjClass, typename TObject, typename... TRspParams>
-            inline void bind_auto(const std::string& rpc_name, TReturn(TObjClass::* bindfunc)(SessionID, TRspParams...), TObject* obj) {
-                bind_auto(rpc_name, [=](SessionID session_id, TRspParams... ps)->TReturn { return (obj->*bindfunc)(session_id, ps...); });
+            inline bool bind_auto(const RpcMethod& rpc_name, TReturn(TObjClass::* bindfunc)(SessionID, TRspParams...), TObject* obj) {
+                return bind_auto(rpc_name, [=](SessionID session_id, TRspParams... ps)->TReturn { return (obj->*bindfunc)(session_id, ps...); });
+            }
+
+#ifdef BTOOL_RPC_COROUTINE
+            /**************   bind_co  ******************/
+            // 协程处理函数, 返回rpc_task<TReturn>, co_return结果即应答请求端
+            // 参数须按值传递, 挂起期间不占用网络线程
+            // lambda
+            template<typename TBindFunc>
+            inline bool bind_co(const RpcMethod& rpc_name, TBindFunc&& bindfunc) {
+                return bind_co_functional(rpc_name, from_lambad(std::forward<TBindFunc>(bindfunc)));
+            }
+            // std::functional
+            template<typename TReturn, typename... TRspParams>
+            inline bool bind_co_functional(const RpcMethod& rpc_name, std::function<rpc_task<TReturn>(SessionID, TRspParams...)> bindfunc) {
+                return m_bind_proxy.insert_co(rpc_name, bindfunc);
+            }
+            // &functional
+            template<typename TReturn, typename... TRspParams>
+            inline bool bind_co(const RpcMethod& rpc_name, rpc_task<TReturn>(*bindfunc)(SessionID, TRspParams...)) {
+                return bind_co_functional(rpc_name, std::function<rpc_task<TReturn>(SessionID, TRspParams...)>(bindfunc));
+            }
+            // &object::functional, object
+            template<typename TReturn, typename TObjClass, typename TObject, typename... TRspParams>
+            inline bool bind_co(const RpcMethod& rpc_name, rpc_task<TReturn>(TObjClass::* bindfunc)(SessionID, TRspParams...), TObject* obj) {
+                return bind_co(rpc_name, [=](SessionID session_id, TRspParams... ps)->rpc_task<TReturn> { return (obj->*bindfunc)(session_id, ps...); });
+            }
+#endif
+
+            /**************   bind_stream  ******************/
+            // 流式方法, 处理函数第二个参数为rpc_stream<TItems...>(按值), 经其多次写入元素, 最终finish或释放全部句柄结束
+            // 处理函数的返回值被忽略, 返回后可继续于其他线程写入
+            // lambda
+            template<typename TBindFunc>
+            inline bool bind_stream(const RpcMethod& rpc_name, TBindFunc&& bindfunc) {
+                return bind_stream_functional(rpc_name, from_lambad(std::forward<TBindFunc>(bindfunc)));
+            }
+            // std::functional
+            template<typename TReturn, typename... TItems, typename... TRspParams>
+            inline bool bind_stream_functional(const RpcMethod& rpc_name, std::function<TReturn(SessionID, rpc_stream<TItems...>, TRspParams...)> bindfunc) {
+                return m_bind_proxy.insert_stream(rpc_name, bindfunc);
+            }
+            // &functional
+            template<typename TReturn, typename... TItems, typename... TRspParams>
+            inline bool bind_stream(const RpcMethod& rpc_name, TReturn(*bindfunc)(SessionID, rpc_stream<TItems...>, TRspParams...)) {
+                return bind_stream_functional(rpc_name, std::function<TReturn(SessionID, rpc_stream<TItems...>, TRspParams...)>(bindfunc));
+            }
+
+            // 设置已绑定方法的执行方式, 需于绑定后、开始服务前设置, 重新绑定沿用原设置; 返回false表示方法未绑定
+            // max_pending: 该方法待处理请求数上限, 超出时直接应答msg_status::overload, 0表示不限; 仅工作线程执行时生效
+            bool set_dispatch(const RpcMethod& rpc_name, rpc_dispatch policy, size_t max_pending = 0) {
+                return m_bind_proxy.set_dispatch(rpc_name, policy, max_pending);
+            }
+            // 设置工作线程数, 默认为系统CPU核数
+            void set_dispatch_threads(size_t thread_num) {
+                m_bind_proxy.set_dispatch_threads(thread_num);
             }
 
             template<typename... Args>
-            bool rsp_bind(const std::string& rpc_name, SessionID session_id, uint32_t req_id, rpc_model model, msg_status status, Args&&... args) {
-                auto unit = m_proxy_deal.package_msg(rpc_name, comm_model::rsponse, model, req_id, status, std::forward<Args>(args)...);
-                return write_impl(session_id, unit->get_package(), unit->get_length());
+            bool rsp_bind(const RpcMethod& rpc_name, SessionID session_id, uint32_t req_id, rpc_model model, msg_status status, Args&&... args) {
+                return send_msg(session_id, [&](MemoryStream& buffer) {
+                    m_proxy_deal.package_msg(buffer, rpc_name, comm_model::rsponse, model, req_id, status, std::forward<Args>(args)...);
+                });
+            }
+
+            // 取消流式调用, 通知应答端停止写入, end_cbk以msg_status::fail执行; 流已结束时返回false
+            bool cancel_stream(uint32_t stream_id) {
+                return end_stream(stream_id, msg_status::fail);
             }
 
 
         protected:
             /**************   异步调用发送信息  ******************/
             template<typename... Args>
-            void callback_send(size_t overtime, const std::string& rpc_name, SessionID session_id, uint32_t req_id, Args&&... args) {
-                m_callback_proxy.insert_timer(overtime, session_id, req_id);
+            void callback_send(size_t overtime, const RpcMethod& rpc_name, const RpcSchema& schema, SessionID session_id, uint32_t req_id, Args&&... args) {
+                m_callback_proxy.insert_deadline(overtime, session_id, req_id);
+                msg_status status = check_peer_method(session_id, rpc_name, schema);
+                if (status != msg_status::ok) {
+                    m_callback_proxy.remove(req_id, status);
+                    return;
+                }
                 // todo... 后期考虑将该方法移动至其继承类自身实现, 免去TProxyPkgHandle的引入
-                auto unit = m_proxy_deal.package_msg(rpc_name, comm_model::request, rpc_model::callback, req_id, msg_status::ok, std::forward<Args>(args)...);
-                if (!write_impl(session_id, unit->get_package(), unit->get_length())) {
+                bool rslt = send_msg(session_id, [&](MemoryStream& buffer) {
+                    m_proxy_deal.package_msg(buffer, rpc_name, comm_model::request, rpc_model::callback, req_id, msg_status::ok, std::forward<Args>(args)...);
+                });
+                if (!rslt) {
                     m_callback_proxy.remove(req_id, msg_status::send_error);
                 }
             }
 
+            /**************   批量发送  ******************/
+            // 同一方法的多个请求依次序列化至同一发送缓存, 各请求仍为独立报文, 对端无需区分处理
+            // req_ids与params一一对应, 为0的项已失败, 跳过
+            template<typename TParam>
+            void batch_send(size_t overtime, const RpcMethod& rpc_name, const RpcSchema& schema, SessionID session_id, const std::vector<uint32_t>& req_ids, const std::vector<TParam>& params) {
+                for (auto req_id : req_ids) {
+                    if (req_id != 0)
+                        m_callback_proxy.insert_deadline(overtime, session_id, req_id);
+                }
+                auto fail_all = [&](msg_status status) {
+                    for (auto req_id : req_ids) {
+                        if (req_id != 0)
+                            m_callback_proxy.remove(req_id, status);
+                    }
+                };
+                msg_status status = check_peer_method(session_id, rpc_name, schema);
+                if (status != msg_status::ok) {
+                    fail_all(status);
+                    return;
+                }
+                bool rslt = send_msg(session_id, [&](MemoryStream& buffer) {
+                    for (size_t i = 0; i < req_ids.size(); ++i) {
+                        if (req_ids[i] != 0)
+                            package_param(buffer, rpc_name, req_ids[i], params[i]);
+                    }
+                });
+                if (!rslt) {
+                    fail_all(msg_status::send_error);
+                }
+            }
+
+            // 批量同步调用, 阻塞至全部应答或超时, 返回结果与params一一对应
+            template<size_t TIMEOUT, typename TReturn, typename TParam>
+            std::vector<typename pipeline_op<TReturn>::result_type> batch_call(const RpcMethod& rpc_name, SessionID session_id, const std::vector<TParam>& params) {
+                pipeline_op<TReturn> op(this, session_id, TIMEOUT);
+                op.batch(rpc_name, params);
+                return op.release();
+            }
+
             /**************   同步调用发送信息, 存在阻塞  ******************/
             // 无返回参数 同步调用,存在阻塞
             // 返回参数类型: msg_status,  表示最终状态
             template<size_t TIMEOUT, typename TReturn = void, typename ...Args>
             typename std::enable_if<std::is_void<TReturn>::value, msg_status>::type
-                sync_send(const std::string& rpc_name, SessionID session_id, Args&&... args) {
-                auto [status, item] = sync_send_impl<TIMEOUT>(rpc_name, session_id, std::forward<Args>(args)...);
-                if (status == msg_status::ok) {
-                    item->get_rsp_params(status);
-                }
-                return status;
+                sync_send(const RpcMethod& rpc_name, SessionID session_id, Args&&... args) {
+                return sync_send_impl<TIMEOUT>(rpc_name, RpcCallSchema<void, typename std::decay<Args>::type...>(), session_id, [](ProxyMsgType& item, msg_status& status) {
+                    item.get_rsp_params(status);
+                }, std::forward<Args>(args)...);
             }
             // 有返回参数 同步调用,存在阻塞
             // 返回参数类型: std::tuple<msg_status, TReturn>,  表示<最终状态, 返回结果>
             template<size_t TIMEOUT, typename TReturn, typename ...Args>
             std::tuple<msg_status, typename std::enable_if<!std::is_void<TReturn>::value, TReturn>::type>
-                sync_send(const std::string& rpc_name, SessionID session_id, Args&&... args) {
-                auto [status, item] = sync_send_impl<TIMEOUT>(rpc_name, session_id, std::forward<Args>(args)...);
+                sync_send(const RpcMethod& rpc_name, SessionID session_id, Args&&... args) {
+                TReturn comm_rslt = TReturn();
+                msg_status status = sync_send_impl<TIMEOUT>(rpc_name, RpcCallSchema<TReturn, typename std::decay<Args>::type...>(), session_id, [&comm_rslt](ProxyMsgType& item, msg_status& status) {
+                    comm_rslt = item.template get_rsp_params<TReturn>(status);
+                }, std::forward<Args>(args)...);
+                return std::forward_as_tuple(status, std::move(comm_rslt));
+            }
+
+            /**************   流式调用发送信息  ******************/
+            // 请求内容为初始额度 + 请求参数, 返回流ID, 0表示未能发出
+            template<typename... Args>
+            uint32_t stream_send(const RpcMethod& rpc_name, const RpcSchema& schema, SessionID session_id, const StreamPtr& stream, Args&&... args) {
+                msg_status status = check_peer_method(session_id, rpc_name, schema);
                 if (status != msg_status::ok) {
-                    return std::forward_as_tuple(status, TReturn());
+                    stream->end_fn_(session_id, status);
+                    return 0;
+                }
+                uint32_t req_id = m_stream_proxy.insert(stream);
+                bool rslt = send_msg(session_id, [&](MemoryStream& buffer) {
+                    m_proxy_deal.package_msg(buffer, rpc_name, comm_model::request, rpc_model::stream, req_id, msg_status::ok, stream->window_, std::forward<Args>(args)...);
+                });
+                if (!rslt) {
+                    if (m_stream_proxy.remove(req_id))
+                        stream->end_fn_(session_id, msg_status::send_error);
+                    return 0;
                 }
-                auto comm_rslt = item->template get_rsp_params<TReturn>(status);
-                return std::forward_as_tuple(status, comm_rslt);
+                return req_id;
             }
 
         private:
-            template<size_t TIMEOUT, typename ...Args>
-            std::tuple<msg_status, ProxyMsgPtr> sync_send_impl(const std::string& rpc_name, SessionID session_id, Args&&... args) {
-                auto req_id = m_sync_proxy.get_next_promise();
+            // 应答于等待槽位上解析, parse(ProxyMsgType&, msg_status&)
+            template<size_t TIMEOUT, typename TParse, typename ...Args>
+            msg_status sync_send_impl(const RpcMethod& rpc_name, const RpcSchema& schema, SessionID session_id, TParse&& parse, Args&&... args) {
+                msg_status status = check_peer_method(session_id, rpc_name, schema);
+                if (status != msg_status::ok) {
+                    return status;
+                }
+                auto req_id = m_sync_proxy.acquire();
+                if (req_id == 0) {
+                    return msg_status::wait_error;
+                }
                 // todo... 后期考虑将该方法移动至其继承类自身实现, 免去TProxyPkgHandle的引入
-                auto unit = m_proxy_deal.package_msg(rpc_name, comm_model::request, rpc_model::future, req_id, msg_status::ok, std::forward<Args>(args)...);
-                if (!write_impl(session_id, unit->get_package(), unit->get_length())) {
-                    return std::forward_as_tuple(msg_status::send_error, nullptr);
+                bool rslt = send_msg(session_id, [&](MemoryStream& buffer) {
+                    m_proxy_deal.package_msg(buffer, rpc_name, comm_model::request, rpc_model::future, req_id, msg_status::ok, std::forward<Args>(args)...);
+                });
+                if (!rslt) {
+                    m_sync_proxy.cancel(req_id);
+                    return msg_status::send_error;
                 }
-                return m_sync_proxy.wait_for(req_id, TIMEOUT);
+                return m_sync_proxy.wait_for(req_id, TIMEOUT, std::forward<TParse>(parse));
             }
 
         protected:
+            /**************   方法表协商(仅ID模式)  ******************/
+            // 连接建立后发送本端已绑定方法表
+            void negotiate(SessionID session_id) {
+                if constexpr (ProxyPkgType::use_method_id) {
+                    auto methods = m_bind_proxy.get_methods();
+                    send_msg(session_id, [&](MemoryStream& buffer) {
+                        m_proxy_deal.package_negotiate(buffer, methods);
+                    });
+                }
+            }
+            // 记录对端方法表
+            void on_negotiate(SessionID session_id, const ProxyMsgType& msg) {
+                if constexpr (ProxyPkgType::use_method_id) {
+                    RpcMethodTable<RpcSchema> peer_methods;
+                    for (auto& item : m_proxy_deal.unpackage_negotiate(msg))
+                        peer_methods.insert(item.method_.id_, item.method_.name_, item.schema_);
+                    writeLock lock(m_peer_mtx);
+                    m_peer_methods[session_id] = std::move(peer_methods);
+                }
+            }
+            void on_session_close(SessionID session_id) {
+                m_callback_proxy.close_session(session_id);
+                m_stream_proxy.close_session(session_id);
+                close_streams(session_id);
+                if constexpr (ProxyPkgType::use_method_id) {
+                    writeLock lock(m_peer_mtx);
+                    m_peer_methods.erase(session_id);
+                }
+            }
+
+            /**************   流式调用  ******************/
+            // 处理流式元素、额度及结束应答, 返回false表示非流式消息
+            bool on_stream_msg(SessionID session_id, ProxyMsgType& msg) {
+                switch (msg.get_comm_model()) {
+                case comm_model::stream_item:
+                    on_stream_item(session_id, msg);
+                    return true;
+                case comm_model::stream_credit:
+                    on_stream_credit(session_id, msg);
+                    return true;
+                case comm_model::rsponse:
+                    if (msg.get_rpc_model() != rpc_model::stream)
+                        return false;
+                    on_stream_end(session_id, msg);
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            // 结束指定会话的全部应答端流, 会话为InvalidSessionID时结束全部, 不再发送结束应答
+            // 析构前需调用, 此后流句柄不再访问本对象
+            void close_streams(SessionID session_id = NetCallBack::InvalidSessionID) {
+                std::vector<std::shared_ptr<RpcStreamControl>> streams;
+                {
+                    writeLock lock(m_stream_mtx);
+                    for (auto iter = m_server_streams.begin(); iter != m_server_streams.end();) {
+                        if (session_id != NetCallBack::InvalidSessionID && iter->first != session_id) {
+                            ++iter;
+                            continue;
+                        }
+                        for (auto& item : iter->second) {
+                            if (auto stream = item.second.lock())
+                                streams.push_back(std::move(stream));
+                        }
+                        iter = m_server_streams.erase(iter);
+                    }
+                }
+                // 句柄可能随之全部释放, 需于锁外关闭
+                for (auto& stream : streams)
+                    stream->close();
+            }
+
+            // 序列化并发送, package(MemoryStream&)将消息追加至缓存
+            // 优先直接写入会话的发送缓存节点, 会话不支持时序列化至线程局部缓存后再拷贝写入, 稳态下均不产生内存分配
+            template<typename TPackage>
+            bool send_msg(SessionID session_id, TPackage&& package) {
+                WriteMemoryStreamPtr buffer = acquire_impl(session_id);
+                if (buffer) {
+                    package(*buffer);
+                    return write_impl(session_id, std::move(buffer));
+                }
+
+                static thread_local MemoryStream write_buffer;
+                write_buffer.clear();
+                package(write_buffer);
+                return write_impl(session_id, write_buffer.data(), write_buffer.size());
+            }
+
             virtual bool write_impl(SessionID session_id, const char* const data, size_t bytes_transferred) = 0;
+            // 获取会话发送缓存节点, 返回空表示不支持
+            virtual WriteMemoryStreamPtr acquire_impl(SessionID /*session_id*/) {
+                return nullptr;
+            }
+            // 写入已填充的发送缓存节点
+            virtual bool write_impl(SessionID /*session_id*/, WriteMemoryStreamPtr&& /*buffer*/) {
+                return false;
+            }
+
+        private:
+            // 应答端流, 经本对象发送元素及结束应答
+            template<typename... TItems>
+            class stream_state_impl : public RpcStreamState<TItems...> {
+            public:
+                stream_state_impl(RpcBase* parent, const std::shared_ptr<const std::string>& rpc_name, uint32_t method_id, SessionID session_id, uint32_t req_id, uint32_t credit)
+                    : RpcStreamState<TItems...>(credit)
+                    , parent_(parent)
+                    , rpc_name_(rpc_name)
+                    , method_id_(method_id)
+                    , session_id_(session_id)
+                    , req_id_(req_id) {}
+                // 句柄全部释放时自动结束
+                ~stream_state_impl() {
+                    this->finish(msg_status::ok);
+                }
+
+            protected:
+                bool send_item(const TItems&... items) override {
+                    return parent_->send_msg(session_id_, [&](MemoryStream& buffer) {
+                        parent_->m_proxy_deal.package_msg(buffer, RpcMethod(method_id_, *rpc_name_), comm_model::stream_item, rpc_model::stream, req_id_, msg_status::ok, items...);
+                    });
+                }
+                bool send_end(msg_status status) override {
+                    detach();
+                    return parent_->rsp_bind(RpcMethod(method_id_, *rpc_name_), session_id_, req_id_, rpc_model::stream, status);
+                }
+                void detach() override {
+                    parent_->remove_stream(session_id_, req_id_);
+                }
+
+            private:
+                RpcBase*                                parent_;
+                std::shared_ptr<const std::string>      rpc_name_;
+                uint32_t                                method_id_;
+                SessionID                               session_id_;
+                uint32_t                                req_id_;
+            };
+
+            // 开启应答端流并登记, 以便接收额度及会话断开时关闭
+            template<typename... TItems>
+            std::shared_ptr<RpcStreamState<TItems...>> open_stream(const std::shared_ptr<const std::string>& rpc_name, uint32_t method_id, SessionID session_id, uint32_t req_id, uint32_t credit) {
+                auto stream = std::make_shared<stream_state_impl<TItems...>>(this, rpc_name, method_id, session_id, req_id, credit);
+                writeLock lock(m_stream_mtx);
+                m_server_streams[session_id][req_id] = stream;
+                return stream;
+            }
+
+            void remove_stream(SessionID session_id, uint32_t req_id) {
+                writeLock lock(m_stream_mtx);
+                auto iter = m_server_streams.find(session_id);
+                if (iter == m_server_streams.end())
+                    return;
+                iter->second.erase(req_id);
+                if (iter->second.empty())
+                    m_server_streams.erase(iter);
+            }
+
+            // 应答端: 请求端归还额度或取消
+            void on_stream_credit(SessionID session_id, ProxyMsgType& msg) {
+                msg_status status = msg_status::fail;
+                uint32_t credit = std::get<0>(msg.template get_req_params<std::tuple<uint32_t>>(status));
+                std::shared_ptr<RpcStreamControl> stream;
+                {
+                    readLock lock(m_stream_mtx);
+                    auto iter = m_server_streams.find(session_id);
+                    if (iter != m_server_streams.end()) {
+                        auto item = iter->second.find(msg.get_req_id());
+                        if (item != iter->second.end())
+                            stream = item->second.lock();
+                    }
+                }
+                if (!stream)
+                    return;
+                if (status == msg_status::ok) {
+                    stream->add_credit(credit);
+                    return;
+                }
+                remove_stream(session_id, msg.get_req_id());
+                stream->close();
+            }
+
+            // 请求端: 逐个回调元素, 每处理约半个窗口归还一次额度
+            void on_stream_item(SessionID session_id, ProxyMsgType& msg) {
+                uint32_t req_id = msg.get_req_id();
+                auto stream = m_stream_proxy.find(req_id);
+                if (!stream)
+                    return;
+                msg_status status = stream->item_fn_(session_id, msg);
+                if (status != msg_status::ok) {
+                    end_stream(req_id, status);
+                    return;
+                }
+                // 元素回调内可能已取消
+                if (stream->ended_.load())
+                    return;
+                if (++stream->consumed_ * 2 >= stream->window_) {
+                    send_stream_credit(*stream, req_id, msg_status::ok, stream->consumed_);
+                    stream->consumed_ = 0;
+                }
+            }
+
+            // 请求端: 结束应答
+            void on_stream_end(SessionID session_id, ProxyMsgType& msg) {
+                auto stream = m_stream_proxy.remove(msg.get_req_id());
+                if (!stream)
+                    return;
+                msg_status status = msg_status::fail;
+                msg.get_rsp_params(status);
+                stream->end_fn_(session_id, status);
+            }
+
+            // 请求端: 主动结束, 通知应答端停止写入
+            bool end_stream(uint32_t req_id, msg_status status) {
+                auto stream = m_stream_proxy.remove(req_id);
+                if (!stream)
+                    return false;
+                send_stream_credit(*stream, req_id, status, 0);
+                stream->end_fn_(stream->session_id_, status);
+                return true;
+            }
+
+            bool send_stream_credit(const typename StreamProxy<TProxyMsgHandle>::stream_st& stream, uint32_t req_id, msg_status status, uint32_t credit) {
+                return send_msg(stream.session_id_, [&](MemoryStream& buffer) {
+                    m_proxy_deal.package_msg(buffer, RpcMethod(stream.method_id_, stream.rpc_name_), comm_model::stream_credit, rpc_model::stream, req_id, status, credit);
+                });
+            }
+
+            template<typename T>
+            struct is_tuple : std::false_type {};
+            template<typename... T>
+            struct is_tuple<std::tuple<T...>> : std::true_type {};
+
+            // 序列化单个回调请求, std::tuple参数展开为多个参数
+            template<typename TParam>
+            void package_param(MemoryStream& buffer, const RpcMethod& rpc_name, uint32_t req_id, const TParam& param) {
+                if constexpr (is_tuple<TParam>::value) {
+                    std::apply([&](const auto&... args) {
+                        m_proxy_deal.package_msg(buffer, rpc_name, comm_model::request, rpc_model::callback, req_id, msg_status::ok, args...);
+                    }, param);
+                }
+                else {
+                    m_proxy_deal.package_msg(buffer, rpc_name, comm_model::request, rpc_model::callback, req_id, msg_status::ok, param);
+                }
+            }
+
+            // ID模式下依据对端方法表校验, 对端同ID对应其他方法名时视为未绑定, 参数或返回值结构不一致时返回schema_error
+            // 尚未协商或对端未声明该方法时照常发送, 由对端应答
+            msg_status check_peer_method(SessionID session_id, const RpcMethod& rpc_name, const RpcSchema& schema) {
+                if constexpr (ProxyPkgType::use_method_id) {
+                    readLock lock(m_peer_mtx);
+                    auto iter = m_peer_methods.find(session_id);
+                    if (iter == m_peer_methods.end())
+                        return msg_status::ok;
+                    auto item = iter->second.find(rpc_name.id_);
+                    if (!item)
+                        return msg_status::ok;
+                    if (item->name_ != rpc_name.name_)
+                        return msg_status::no_bind;
+                    auto& peer = item->value_;
+                    if (schema.params_ != 0 && peer.params_ != 0 && schema.params_ != peer.params_)
+                        return msg_status::schema_error;
+                    if (schema.result_ != 0 && peer.result_ != 0 && schema.result_ != peer.result_)
+                        return msg_status::schema_error;
+                }
+                return msg_status::ok;
+            }
 
         private:
             /**************   函数转换  ******************/
@@ -924,16 +2796,29 @@ namespace BTool
             }
 
         protected:
-            ProxyPkg<TProxyPkgHandle, TProxyMsgHandle>                      m_proxy_deal;
+            typedef ProxyPkg<TProxyPkgHandle, TProxyMsgHandle>              ProxyPkgType;
+
+            ProxyPkgType                                                    m_proxy_deal;
             SyncProxy<TProxyMsgHandle>                                      m_sync_proxy;
             CallbackProxy<TProxyMsgHandle>                                  m_callback_proxy;
+            StreamProxy<TProxyMsgHandle>                                    m_stream_proxy;
             BindProxy<TProxyPkgHandle, TProxyMsgHandle, DEFAULT_TIMEOUT>    m_bind_proxy;
+
+        private:
+            // 对端方法表(仅ID模式)
+            rwMutex                                                         m_peer_mtx;
+            std::unordered_map<SessionID, RpcMethodTable<RpcSchema>>        m_peer_methods;
+            // 应答端流, 按会话及req_id登记, 流结束时移除
+            rwMutex                                                         m_stream_mtx;
+            std::unordered_map<SessionID, std::unordered_map<uint32_t, std::weak_ptr<RpcStreamControl>>>   m_server_streams;
         };
 
         template<typename TServer, template<typename TProxyMsgHandle> typename TProxyPkgHandle = DefaultProxyPkgHandle, typename TProxyMsgHandle = DefaultProxyMsgHandle, size_t DEFAULT_TIMEOUT = 1000>
         class RpcService : public RpcBase<TProxyPkgHandle, TProxyMsgHandle, DEFAULT_TIMEOUT> {
             typedef RpcBase<TProxyPkgHandle, TProxyMsgHandle, DEFAULT_TIMEOUT> RpcBaseType;
+            typedef typename RpcBaseType::ProxyMsgType ProxyMsgType;
             typedef typename RpcBaseType::ProxyMsgPtr  ProxyMsgPtr;
+            typedef typename RpcBaseType::WriteMemoryStreamPtr  WriteMemoryStreamPtr;
             typedef typename RpcBaseType::PromisePtr   PromisePtr;
             typedef typename RpcBaseType::SessionID    SessionID;
 
@@ -945,9 +2830,17 @@ namespace BTool
                 using std::placeholders::_1;
                 using std::placeholders::_2;
                 using std::placeholders::_3;
+                m_service->register_open_cbk(std::bind(&RpcService::open_cbk, this, _1));
+                m_service->register_close_cbk(std::bind(&RpcService::close_cbk, this, _1, _2, _3));
                 m_service->register_read_cbk(std::bind(&RpcService::read_cbk, this, _1, _2, _3));
             }
             ~RpcService() {
+                // 先终止服务以等待io线程中的回调结束, 回调内仍会访问m_service
+                m_service->stop();
+                // 工作线程中的请求同样会访问m_service
+                this->m_bind_proxy.stop_dispatch();
+                // 流句柄可能由外部持有, 关闭后不再访问本对象
+                this->close_streams();
                 m_service.reset();
                 m_ioc_pool.stop();
             }
@@ -958,11 +2851,11 @@ namespace BTool
             }
             // 设置开启连接回调
             void register_open_cbk(const NetCallBack::open_cbk& cbk) {
-                m_service->register_open_cbk(cbk);
+                m_cbk.open_cbk_ = cbk;
             }
             // 设置关闭连接回调
             void register_close_cbk(const NetCallBack::close_cbk& cbk) {
-                m_service->register_close_cbk(cbk);
+                m_cbk.close_cbk_ = cbk;
             }
 
             bool listen(const std::string& ip, unsigned short port, bool reuse_address = true) {
@@ -977,40 +2870,74 @@ namespace BTool
                 m_service->close(session_id);
             }
 
+            // 设置新连接的发送合并延时(微秒), 0表示不启用, 需在启动服务前设置
+            // 传输层不支持时返回false
+            bool set_flush_delay(unsigned usec) {
+                if constexpr (has_flush_delay<TServer>::value) {
+                    m_service->set_flush_delay(usec);
+                    return true;
+                }
+                return false;
+            }
+
+            // 设置新连接的忙轮询时长(微秒), 0表示不启用, 需在启动服务前设置
+            // 传输层不支持时返回false
+            bool set_busy_poll(unsigned usec) {
+                if constexpr (has_busy_poll<TServer>::value) {
+                    m_service->set_busy_poll(usec);
+                    return true;
+                }
+                return false;
+            }
+
         public:
          /**************   tcp回调  ******************/
+            void open_cbk(NetCallBack::SessionID session_id) {
+                this->negotiate(session_id);
+                if (m_cbk.open_cbk_)
+                    m_cbk.open_cbk_(session_id);
+            }
+            void close_cbk(NetCallBack::SessionID session_id, const char* const msg, size_t bytes_transferred) {
+                this->on_session_close(session_id);
+                if (m_cbk.close_cbk_)
+                    m_cbk.close_cbk_(session_id, msg, bytes_transferred);
+            }
             void read_cbk(NetCallBack::SessionID session_id, const char* const msg, size_t bytes_transferred) {
-                auto [units, deal_len, err] = this->m_proxy_deal.unpackage_msg(msg, bytes_transferred);
-                if (err.status_ != msg_status::ok) {
-                    //this->m_error_proxy.error(err);
-                    m_service->close(session_id);
-                    return;
-                }
-
-                for (auto& item : units) {
-                    if (item->get_comm_model() == comm_model::request) {
+                // 消息均引用自读缓存, 需在消费前处理完毕
+                bool invalid = false;
+                auto [deal_len, err] = this->m_proxy_deal.unpackage_msg(msg, bytes_transferred, [&](ProxyMsgType& item) {
+                    if (item.get_comm_model() == comm_model::negotiate) {
+                        this->on_negotiate(session_id, item);
+                        return true;
+                    }
+                    if (this->on_stream_msg(session_id, item))
+                        return true;
+                    if (item.get_comm_model() == comm_model::request) {
                         if (!this->m_bind_proxy.invoke(session_id, item)) {
                             //this->m_error_proxy.invoke(item);
                             //m_service->close(session_id);
-                            this->rsp_bind(item->get_rpc_name(), session_id, item->get_req_id(), item->get_rpc_model(), msg_status::no_bind);
-                            //return;
+                            this->rsp_bind(RpcMethod(item.get_method_id(), item.get_rpc_name()), session_id, item.get_req_id(), item.get_rpc_model(), msg_status::no_bind);
                         }
-                        continue;
+                        return true;
                     }
 
-                    switch (item->get_rpc_model()) {
+                    switch (item.get_rpc_model()) {
                     case rpc_model::future:
                         this->m_sync_proxy.invoke(item);
-                        break;
+                        return true;
                     case rpc_model::callback:
                         this->m_callback_proxy.invoke(item);
-                        break;
+                        return true;
                     default:
                         //this->m_error_proxy.invoke(item);
-                        m_service->close(session_id);
-                        return;
-                        break;
+                        invalid = true;
+                        return false;
                     }
+                });
+                if (invalid || err.status_ != msg_status::ok) {
+                    //this->m_error_proxy.error(err);
+                    m_service->close(session_id);
+                    return;
                 }
 
                 m_service->consume_read_buf(session_id, deal_len);
@@ -1019,11 +2946,11 @@ namespace BTool
         public:
          /**************   push  ******************/
             template<size_t TIMEOUT, typename TReturn = void, typename ...Args>
-            decltype(auto) push(const std::string& rpc_name, SessionID session_id, Args&&... args) {
+            decltype(auto) push(const RpcMethod& rpc_name, SessionID session_id, Args&&... args) {
                 return this->template sync_send<TIMEOUT, TReturn>(rpc_name, session_id, std::forward<Args>(args)...);
             }
             template<typename TReturn = void, typename ...Args>
-            decltype(auto) push(const std::string& rpc_name, SessionID session_id, Args&&... args) {
+            decltype(auto) push(const RpcMethod& rpc_name, SessionID session_id, Args&&... args) {
                 return this->template sync_send<DEFAULT_TIMEOUT, TReturn>(rpc_name, session_id, std::forward<Args>(args)...);
             }
 
@@ -1033,17 +2960,17 @@ namespace BTool
             // 返回参数类型: callback_req_op<...>, 通过其发送异步调用
             // 函数必须参数(SessionID, msg_status, ...)
             template<size_t TIMEOUT>
-            decltype(auto) push_back(const std::string& rpc_name, SessionID session_id) {
+            decltype(auto) push_back(const RpcMethod& rpc_name, SessionID session_id) {
                 return typename RpcBaseType::template callback_req_op<TIMEOUT>
                     (this, rpc_name, session_id);
             }
             template<size_t TIMEOUT, typename TParam>
-            decltype(auto) push_back(const std::string& rpc_name, SessionID session_id, TParam&& param) {
+            decltype(auto) push_back(const RpcMethod& rpc_name, SessionID session_id, TParam&& param) {
                 return typename RpcBaseType::template callback_req_op<TIMEOUT, TParam>
                     (this, rpc_name, session_id, std::forward<TParam>(param));
             }
             template<size_t TIMEOUT, typename TParam, typename ...Args>
-            decltype(auto) push_back(const std::string& rpc_name, SessionID session_id, TParam&& param, Args&&... args) {
+            decltype(auto) push_back(const RpcMethod& rpc_name, SessionID session_id, TParam&& param, Args&&... args) {
                 return typename RpcBaseType::template callback_req_op<TIMEOUT, std::tuple<TParam, Args...>>
                     (this, rpc_name, session_id, std::forward_as_tuple(std::forward<TParam>(param), std::forward<Args>(args)...));
             }
@@ -1052,10 +2979,62 @@ namespace BTool
             // 返回参数类型: callback_req_op<...>, 通过其发送异步调用
             // 函数必须参数(SessionID, msg_status, ...)
             template<typename ...Args>
-            decltype(auto) push_back(const std::string& rpc_name, SessionID session_id, Args&&... args) {
+            decltype(auto) push_back(const RpcMethod& rpc_name, SessionID session_id, Args&&... args) {
                 return push_back<DEFAULT_TIMEOUT>(rpc_name, session_id, std::forward<Args>(args)...);
             }
 
+         /**************   pipeline  ******************/
+            // 流水线推送
+            // 返回参数类型: pipeline_op<TReturn>, 通过其call连续发出请求, wait统一收集结果
+            template<size_t TIMEOUT, typename TReturn = void>
+            decltype(auto) pipeline(SessionID session_id) {
+                return typename RpcBaseType::template pipeline_op<TReturn>(this, session_id, TIMEOUT);
+            }
+            template<typename TReturn = void>
+            decltype(auto) pipeline(SessionID session_id) {
+                return typename RpcBaseType::template pipeline_op<TReturn>(this, session_id, DEFAULT_TIMEOUT);
+            }
+
+         /**************   push_batch  ******************/
+            // 批量推送同一方法, 全部请求合并至单次发送, 阻塞至全部应答或超时
+            // params: 元素为单个参数或由参数组成的std::tuple
+            // 返回参数类型: std::vector<pipeline_op<TReturn>::result_type>, 与params一一对应
+            template<size_t TIMEOUT, typename TReturn = void, typename TParam>
+            decltype(auto) push_batch(const RpcMethod& rpc_name, SessionID session_id, const std::vector<TParam>& params) {
+                return this->template batch_call<TIMEOUT, TReturn>(rpc_name, session_id, params);
+            }
+            template<typename TReturn = void, typename TParam>
+            decltype(auto) push_batch(const RpcMethod& rpc_name, SessionID session_id, const std::vector<TParam>& params) {
+                return this->template batch_call<DEFAULT_TIMEOUT, TReturn>(rpc_name, session_id, params);
+            }
+
+         /**************   push_stream  ******************/
+            // 流式推送, 对端经rpc_stream多次写入, 本端逐个回调
+            // WINDOW: 额度, 对端至多领先本端处理WINDOW个元素
+            // 返回参数类型: stream_req_op<...>, 通过其(item_cbk, end_cbk)发出请求, 返回流ID
+            template<uint32_t WINDOW, typename ...Args>
+            decltype(auto) push_stream(const RpcMethod& rpc_name, SessionID session_id, Args&&... args) {
+                return typename RpcBaseType::template stream_req_op<Args...>(this, rpc_name, session_id, WINDOW, std::forward<Args>(args)...);
+            }
+            template<typename ...Args>
+            decltype(auto) push_stream(const RpcMethod& rpc_name, SessionID session_id, Args&&... args) {
+                return typename RpcBaseType::template stream_req_op<Args...>(this, rpc_name, session_id, RpcBaseType::DEFAULT_STREAM_WINDOW, std::forward<Args>(args)...);
+            }
+
+#ifdef BTOOL_RPC_COROUTINE
+         /**************   co_push  ******************/
+            // 协程推送, co_await等待应答
+            // 返回参数类型: call_awaitable<TReturn, ...>, 可经resume_on指定恢复执行器
+            template<size_t TIMEOUT, typename TReturn = void, typename ...Args>
+            decltype(auto) co_push(const RpcMethod& rpc_name, SessionID session_id, Args&&... args) {
+                return typename RpcBaseType::template call_awaitable<TReturn, Args...>(this, rpc_name, session_id, TIMEOUT, std::forward<Args>(args)...);
+            }
+            template<typename TReturn = void, typename ...Args>
+            decltype(auto) co_push(const RpcMethod& rpc_name, SessionID session_id, Args&&... args) {
+                return typename RpcBaseType::template call_awaitable<TReturn, Args...>(this, rpc_name, session_id, DEFAULT_TIMEOUT, std::forward<Args>(args)...);
+            }
+#endif
+
         private:
 
             bool write_impl(SessionID session_id, const char* const data, size_t bytes_transferred) override {
@@ -1063,16 +3042,33 @@ namespace BTool
                     return m_service->write(session_id, data, bytes_transferred);
                 return false;
             }
+            WriteMemoryStreamPtr acquire_impl(SessionID session_id) override {
+                if constexpr (has_acquire_buffer<TServer, SessionID>::value) {
+                    if (m_service)
+                        return m_service->acquire_buffer(session_id);
+                }
+                return nullptr;
+            }
+            bool write_impl(SessionID session_id, WriteMemoryStreamPtr&& buffer) override {
+                if constexpr (has_acquire_buffer<TServer, SessionID>::value) {
+                    if (m_service)
+                        return m_service->write(session_id, std::move(buffer));
+                }
+                return false;
+            }
 
         private:
             AsioContextPool                          m_ioc_pool;
             std::shared_ptr<TServer>                 m_service;
+            NetCallBack                              m_cbk;
         };
 
         template<typename TSession, template<typename TProxyMsgHandle> typename TProxyPkgHandle = DefaultProxyPkgHandle, typename TProxyMsgHandle = DefaultProxyMsgHandle, size_t DEFAULT_TIMEOUT = 1000>
         class RpcClient : public RpcBase<TProxyPkgHandle, TProxyMsgHandle, DEFAULT_TIMEOUT> {
             typedef RpcBase<TProxyPkgHandle, TProxyMsgHandle, DEFAULT_TIMEOUT> RpcBaseType;
+            typedef typename RpcBaseType::ProxyMsgType ProxyMsgType;
             typedef typename RpcBaseType::ProxyMsgPtr  ProxyMsgPtr;
+            typedef typename RpcBaseType::WriteMemoryStreamPtr  WriteMemoryStreamPtr;
             typedef typename RpcBaseType::PromisePtr   PromisePtr;
             typedef typename RpcBaseType::SessionID    SessionID;
 
@@ -1091,8 +3087,21 @@ namespace BTool
                     .register_read_cbk(std::bind(&RpcClient::read_cbk, this, _1, _2, _3));
             }
             ~RpcClient() {
+                // 清空回调, 共享内存会话于此等待其读取线程中执行中的回调结束
                 m_session->register_cbk(NetCallBack());
                 shutdown();
+                // 等待io线程中已开始的回调执行完毕, 回调内仍会访问m_session; 连接对象需先于io_context释放
+                // 于io线程内析构时不存在其他执行中的回调, 不可等待; io_context直至析构末尾才停止, 投递的任务必被执行
+                auto& ioc = m_ioc_pool.get_io_context();
+                if (!ioc.get_executor().running_in_this_thread() && !ioc.stopped()) {
+                    // 承诺由任务共享持有, 避免set_value返回前析构
+                    auto drained = std::make_shared<std::promise<void>>();
+                    auto drained_future = drained->get_future();
+                    boost::asio::post(ioc, [drained]() { drained->set_value(); });
+                    drained_future.wait();
+                }
+                this->m_bind_proxy.stop_dispatch();
+                this->close_streams();
                 m_session.reset();
                 m_ioc_pool.stop();
             }
@@ -1120,13 +3129,35 @@ namespace BTool
                 m_session->shutdown();
             }
 
+            // 设置发送合并延时(微秒), 0表示不启用, 需在连接前设置
+            // 传输层不支持时返回false
+            bool set_flush_delay(unsigned usec) {
+                if constexpr (has_flush_delay<TSession>::value) {
+                    m_session->set_flush_delay(usec);
+                    return true;
+                }
+                return false;
+            }
+
+            // 设置忙轮询时长(微秒), 0表示不启用, 需在连接前设置
+            // 传输层不支持时返回false
+            bool set_busy_poll(unsigned usec) {
+                if constexpr (has_busy_poll<TSession>::value) {
+                    m_session->set_busy_poll(usec);
+                    return true;
+                }
+                return false;
+            }
+
         public:
             /**************   tcp回调  ******************/
             void open_cbk(NetCallBack::SessionID session_id) {
+                this->negotiate(session_id);
                 if (m_cbk.open_cbk_)
                     m_cbk.open_cbk_(session_id);
             }
             void close_cbk(NetCallBack::SessionID session_id, const char* const msg, size_t bytes_transferred) {
+                this->on_session_close(session_id);
                 if (m_cbk.close_cbk_)
                     m_cbk.close_cbk_(session_id, msg, bytes_transferred);
 
@@ -1139,37 +3170,41 @@ namespace BTool
                 }
             }
             void read_cbk(NetCallBack::SessionID session_id, const char* const msg, size_t bytes_transferred) {
-                auto [units, deal_len, err] = this->m_proxy_deal.unpackage_msg(msg, bytes_transferred);
-                if (err.status_ != msg_status::ok) {
-                    //this->m_error_proxy.error(err);
-                    m_session->shutdown(boost::asio::error::invalid_argument);
-                    return;
-                }
-
-                for (auto& item : units) {
-                    if (item->get_comm_model() == comm_model::request) {
+                // 消息均引用自读缓存, 需在消费前处理完毕
+                bool invalid = false;
+                auto [deal_len, err] = this->m_proxy_deal.unpackage_msg(msg, bytes_transferred, [&](ProxyMsgType& item) {
+                    if (item.get_comm_model() == comm_model::negotiate) {
+                        this->on_negotiate(session_id, item);
+                        return true;
+                    }
+                    if (this->on_stream_msg(session_id, item))
+                        return true;
+                    if (item.get_comm_model() == comm_model::request) {
                         if (!this->m_bind_proxy.invoke(session_id, item)) {
                             //this->m_error_proxy.invoke(item);
                             //m_session->shutdown();
-                            this->rsp_bind(item->get_rpc_name(), session_id, item->get_req_id(), item->get_rpc_model(), msg_status::no_bind);
-                            //return;
+                            this->rsp_bind(RpcMethod(item.get_method_id(), item.get_rpc_name()), session_id, item.get_req_id(), item.get_rpc_model(), msg_status::no_bind);
                         }
-                        continue;
+                        return true;
                     }
 
-                    switch (item->get_rpc_model()) {
+                    switch (item.get_rpc_model()) {
                     case rpc_model::future:
                         this->m_sync_proxy.invoke(item);
-                        break;
+                        return true;
                     case rpc_model::callback:
                         this->m_callback_proxy.invoke(item);
-                        break;
+                        return true;
                     default:
                         //this->m_error_proxy.invoke(item);
-                        m_session->shutdown(boost::asio::error::invalid_argument);
-                        return;
-                        break;
+                        invalid = true;
+                        return false;
                     }
+                });
+                if (invalid || err.status_ != msg_status::ok) {
+                    //this->m_error_proxy.error(err);
+                    m_session->shutdown(boost::asio::error::invalid_argument);
+                    return;
                 }
 
                 m_session->consume_read_buf(deal_len);
@@ -1186,11 +3221,11 @@ namespace BTool
 
             /**************   call  ******************/
             template<size_t TIMEOUT, typename TReturn = void, typename ...Args>
-            decltype(auto) call(const std::string& rpc_name, Args&&... args) {
+            decltype(auto) call(const RpcMethod& rpc_name, Args&&... args) {
                 return this->template sync_send<TIMEOUT, TReturn>(rpc_name, get_session_id(), std::forward<Args>(args)...);
             }
             template<typename TReturn = void, typename ...Args>
-            decltype(auto) call(const std::string& rpc_name, Args&&... args) {
+            decltype(auto) call(const RpcMethod& rpc_name, Args&&... args) {
                 return this->template sync_send<DEFAULT_TIMEOUT, TReturn>(rpc_name, get_session_id(), std::forward<Args>(args)...);
             }
 
@@ -1200,17 +3235,17 @@ namespace BTool
             // 返回参数类型: callback_req_op<...>, 通过其发送异步调用
             // 函数必须参数(SessionID, msg_status, ...)
             template<size_t TIMEOUT>
-            decltype(auto) call_back_timer(const std::string& rpc_name) {
+            decltype(auto) call_back_timer(const RpcMethod& rpc_name) {
                 return typename RpcBaseType::template callback_req_op<TIMEOUT>
                     (this, rpc_name, get_session_id());
             }
             template<size_t TIMEOUT, typename TParam>
-            decltype(auto) call_back_timer(const std::string& rpc_name, TParam&& param) {
+            decltype(auto) call_back_timer(const RpcMethod& rpc_name, TParam&& param) {
                 return typename RpcBaseType::template callback_req_op<TIMEOUT, TParam>
                     (this, rpc_name, get_session_id(), std::forward<TParam>(param));
             }
             template<size_t TIMEOUT, typename TParam, typename ...Args>
-            decltype(auto) call_back_timer(const std::string& rpc_name, TParam&& param, Args&&... args) {
+            decltype(auto) call_back_timer(const RpcMethod& rpc_name, TParam&& param, Args&&... args) {
                 return typename RpcBaseType::template callback_req_op<TIMEOUT, std::tuple<TParam, Args...>>
                     (this, rpc_name, get_session_id(), std::forward_as_tuple(std::forward<TParam>(param), std::forward<Args>(args)...));
             }
@@ -1219,26 +3254,92 @@ namespace BTool
             // 返回参数类型: callback_req_op<...>, 通过其发送异步调用
             // 函数必须参数(SessionID, msg_status, ...)
             template<typename ...Args>
-            decltype(auto) call_back(const std::string& rpc_name, Args&&... args) {
+            decltype(auto) call_back(const RpcMethod& rpc_name, Args&&... args) {
                 return call_back_timer<DEFAULT_TIMEOUT>(rpc_name, std::forward<Args>(args)...);
             }
 
+            /**************   pipeline  ******************/
+            // 流水线调用, 单线程保持多个请求在途
+            // 返回参数类型: pipeline_op<TReturn>, 通过其call连续发出请求, wait统一收集结果
+            template<size_t TIMEOUT, typename TReturn = void>
+            decltype(auto) pipeline() {
+                return typename RpcBaseType::template pipeline_op<TReturn>(this, get_session_id(), TIMEOUT);
+            }
+            template<typename TReturn = void>
+            decltype(auto) pipeline() {
+                return typename RpcBaseType::template pipeline_op<TReturn>(this, get_session_id(), DEFAULT_TIMEOUT);
+            }
+
+            /**************   call_batch  ******************/
+            // 批量调用同一方法, 全部请求合并至单次发送, 阻塞至全部应答或超时
+            // params: 元素为单个参数或由参数组成的std::tuple
+            // 返回参数类型: std::vector<pipeline_op<TReturn>::result_type>, 与params一一对应
+            template<size_t TIMEOUT, typename TReturn = void, typename TParam>
+            decltype(auto) call_batch(const RpcMethod& rpc_name, const std::vector<TParam>& params) {
+                return this->template batch_call<TIMEOUT, TReturn>(rpc_name, get_session_id(), params);
+            }
+            template<typename TReturn = void, typename TParam>
+            decltype(auto) call_batch(const RpcMethod& rpc_name, const std::vector<TParam>& params) {
+                return this->template batch_call<DEFAULT_TIMEOUT, TReturn>(rpc_name, get_session_id(), params);
+            }
+
+            /**************   call_stream  ******************/
+            // 流式调用, 应答端经rpc_stream多次写入, 本端逐个回调
+            // WINDOW: 额度, 应答端至多领先本端处理WINDOW个元素
+            // 返回参数类型: stream_req_op<...>, 通过其(item_cbk, end_cbk)发出请求, 返回流ID
+            template<uint32_t WINDOW, typename ...Args>
+            decltype(auto) call_stream(const RpcMethod& rpc_name, Args&&... args) {
+                return typename RpcBaseType::template stream_req_op<Args...>(this, rpc_name, get_session_id(), WINDOW, std::forward<Args>(args)...);
+            }
+            template<typename ...Args>
+            decltype(auto) call_stream(const RpcMethod& rpc_name, Args&&... args) {
+                return typename RpcBaseType::template stream_req_op<Args...>(this, rpc_name, get_session_id(), RpcBaseType::DEFAULT_STREAM_WINDOW, std::forward<Args>(args)...);
+            }
+
+#ifdef BTOOL_RPC_COROUTINE
+            /**************   co_call  ******************/
+            // 协程调用, co_await等待应答
+            // 返回参数类型: call_awaitable<TReturn, ...>, 可经resume_on指定恢复执行器
+            template<size_t TIMEOUT, typename TReturn = void, typename ...Args>
+            decltype(auto) co_call(const RpcMethod& rpc_name, Args&&... args) {
+                return typename RpcBaseType::template call_awaitable<TReturn, Args...>(this, rpc_name, get_session_id(), TIMEOUT, std::forward<Args>(args)...);
+            }
+            template<typename TReturn = void, typename ...Args>
+            decltype(auto) co_call(const RpcMethod& rpc_name, Args&&... args) {
+                return typename RpcBaseType::template call_awaitable<TReturn, Args...>(this, rpc_name, get_session_id(), DEFAULT_TIMEOUT, std::forward<Args>(args)...);
+            }
+#endif
+
         private:
             SessionID get_session_id() const {
                 if (m_session)
                     return m_session->get_session_id();
                 return BoostNet::NetCallBack::InvalidSessionID;
             }
-            bool write_impl(SessionID session_id, const char* const data, size_t bytes_transferred) override {
+            bool write_impl(SessionID /*session_id*/, const char* const data, size_t bytes_transferred) override {
                 if (m_session)
                     return m_session->write(data, bytes_transferred);
                 return false;
             }
+            WriteMemoryStreamPtr acquire_impl(SessionID /*session_id*/) override {
+                if constexpr (has_acquire_buffer<TSession>::value) {
+                    if (m_session)
+                        return m_session->acquire_buffer();
+                }
+                return nullptr;
+            }
+            bool write_impl(SessionID /*session_id*/, WriteMemoryStreamPtr&& buffer) override {
+                if constexpr (has_acquire_buffer<TSession>::value) {
+                    if (m_session)
+                        return m_session->write(std::move(buffer));
+                }
+                return false;
+            }
 
         private:
             AsioContextPool                          m_ioc_pool;
             std::shared_ptr<TSession>                m_session;
-            volatile bool                            m_b_auto_reconnect = true;
+            std::atomic<bool>                        m_b_auto_reconnect{ true };
             NetCallBack                              m_cbk;
         };
     }
@@ -0,0 +1,668 @@
+/******************************************************************************
+File name:  shm_channel.hpp
+Author:	    AChar
+Purpose:    ̼ͬĹڴͨ, ShmSession/ShmServerʹ
+Note:       ÿΪһPOSIXڴ, ߵ߻λ(ͻ->, ->ͻ)
+            λӳ, Խβַ, ȡֱλص
+            ȡʱæѯ, futex; д뷽ڶԷʱŷϵͳ
+            Զ˿ںĹڴǼǴ, ӽ󼴽ͨĹڴ, 쳣˳ͨ
+            ڴڷֹʱ, 쳣˳ͬ´ͬ˿ʱ³ʼ
+*****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <climits>
+#include <cstring>
+#include <signal.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "../mmap_file.hpp"
+#include "net_callback.hpp"
+
+namespace BTool
+{
+    namespace BoostNet
+    {
+        // Թڴе32λԭfutex, δʹFUTEX_PRIVATE_FLAG, Ч
+        // falseʾʱ
+        inline bool ShmFutexWait(std::atomic<uint32_t>* addr, uint32_t expected, unsigned timeout_us) {
+            timespec ts{ (time_t)(timeout_us / 1000000), (long)(timeout_us % 1000000) * 1000 };
+            return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, expected, &ts, nullptr, 0) == 0 || errno != ETIMEDOUT;
+        }
+        inline void ShmFutexWake(std::atomic<uint32_t>* addr) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        }
+
+        // Ƿ
+        inline bool ShmProcessAlive(int pid) {
+            return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+        }
+
+        // ڴID, λ1tcpID
+        inline NetCallBack::SessionID GetNextShmSessionID() {
+            static std::atomic<NetCallBack::SessionID> next_session_id(0);
+            return (++next_session_id) | ((NetCallBack::SessionID)1 << 63);
+        }
+        inline bool IsShmSessionID(NetCallBack::SessionID session_id) {
+            return (session_id >> 63) != 0;
+        }
+
+        // ڴ
+        inline std::string ShmListenName(unsigned short port) {
+            return "/btool_rpc_" + std::to_string(port);
+        }
+
+        // λͷ, дλõ, ȡģƫ
+        struct ShmRingHead {
+            alignas(64) std::atomic<uint64_t>   tail_;          // дλ, д뷽޸
+            alignas(64) std::atomic<uint64_t>   head_;          // ȡλ, ȡ޸
+            alignas(64) std::atomic<uint32_t>   data_seq_;      // ݻ
+            std::atomic<uint32_t>               data_waiting_;  // ȡǷ
+            alignas(64) std::atomic<uint32_t>   space_seq_;     // ռͷŻ
+            std::atomic<uint32_t>               space_waiting_; // д뷽Ƿ
+        };
+        static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory ring requires lock-free 64-bit atomics");
+
+        // ͨͷ, λڹڴҳ
+        struct ShmChannelHead {
+            uint32_t                magic_;
+            uint32_t                head_size_;     // ͷռֽ, ҳС
+            uint64_t                capacity_;      // λ, ҳС
+            std::atomic<int32_t>    client_pid_;
+            std::atomic<int32_t>    server_pid_;
+            std::atomic<uint32_t>   state_;         // ״̬, futex
+            ShmRingHead             rings_[2];      // 0: ͻ->, 1: ->ͻ
+        };
+
+        // ڴͨ, ̰߳ȫ: дⲿ, ȡ޵һ߳
+        class ShmChannel
+        {
+        public:
+            enum : uint32_t {
+                SHM_MAGIC = 0x42435331,
+                WAIT_SLICE_US = 100000,     // , ʱԶ˽Ƿ
+            };
+            // ״̬
+            enum state_t : uint32_t {
+                connecting = 0,
+                accepted = 1,
+                closed = 2,
+            };
+
+        public:
+            ShmChannel()
+                : m_head(nullptr)
+                , m_base(nullptr)
+                , m_map_size(0)
+                , m_is_client(false)
+            {
+                m_data[0] = m_data[1] = nullptr;
+            }
+            ~ShmChannel() {
+                unmap();
+            }
+
+            ShmChannel(const ShmChannel&) = delete;
+            ShmChannel& operator=(const ShmChannel&) = delete;
+
+        public:
+            // ͻ˴ͨ, capacityȡΪҳС
+            bool create(const std::string& name, size_t capacity) {
+                size_t page_size = GetPageSize();
+                capacity = (std::max<size_t>(capacity, 1) + page_size - 1) / page_size * page_size;
+                size_t head_size = (sizeof(ShmChannelHead) + page_size - 1) / page_size * page_size;
+
+                int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+                if (fd == -1)
+                    return false;
+                if (ftruncate(fd, head_size + capacity * 2) != 0 || !map(fd, head_size, capacity)) {
+                    ::close(fd);
+                    ::shm_unlink(name.c_str());
+                    return false;
+                }
+                ::close(fd);
+
+                new (m_head) ShmChannelHead();
+                m_head->head_size_ = (uint32_t)head_size;
+                m_head->capacity_ = capacity;
+                m_head->client_pid_.store(getpid());
+                m_head->magic_ = SHM_MAGIC;
+                m_is_client = true;
+                m_name = name;
+                return true;
+            }
+
+            // ˽ͨ, ɹ
+            bool accept(const std::string& name) {
+                int fd = ::shm_open(name.c_str(), O_RDWR, S_IRUSR | S_IWUSR);
+                if (fd == -1)
+                    return false;
+                ::shm_unlink(name.c_str());
+
+                struct stat sb;
+                ShmChannelHead head;
+                if (fstat(fd, &sb) != 0 || (size_t)sb.st_size < sizeof(ShmChannelHead)
+                    || pread(fd, &head, offsetof(ShmChannelHead, client_pid_), 0) != (ssize_t)offsetof(ShmChannelHead, client_pid_)
+                    || head.magic_ != SHM_MAGIC || (size_t)sb.st_size != head.head_size_ + head.capacity_ * 2
+                    || !map(fd, head.head_size_, head.capacity_))
+                {
+                    ::close(fd);
+                    return false;
+                }
+                ::close(fd);
+
+                m_is_client = false;
+                m_head->server_pid_.store(getpid());
+                uint32_t expected = connecting;
+                if (!m_head->state_.compare_exchange_strong(expected, accepted))
+                    return false;
+                ShmFutexWake(&m_head->state_);
+                return true;
+            }
+
+            // ͻ˵ȴ˽, Ƿѽ; ʱΪر, ˴˺ٽ
+            bool wait_accept(unsigned timeout_ms) {
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+                uint32_t state = m_head->state_.load();
+                while (state == connecting) {
+                    auto now = std::chrono::steady_clock::now();
+                    if (now >= deadline) {
+                        if (m_head->state_.compare_exchange_strong(state, closed))
+                            break;
+                        continue;
+                    }
+                    ShmFutexWait(&m_head->state_, connecting, (unsigned)std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count());
+                    state = m_head->state_.load();
+                }
+                // δʱн
+                ::shm_unlink(m_name.c_str());
+                return state == accepted;
+            }
+
+            // رͨ, ˫еȴ
+            void close() {
+                if (!m_head)
+                    return;
+                m_head->state_.store(closed);
+                ShmFutexWake(&m_head->state_);
+                for (auto& ring : m_head->rings_) {
+                    ring.data_seq_.fetch_add(1);
+                    ShmFutexWake(&ring.data_seq_);
+                    ring.space_seq_.fetch_add(1);
+                    ShmFutexWake(&ring.space_seq_);
+                }
+            }
+
+            bool is_closed() const {
+                return !m_head || m_head->state_.load(std::memory_order_acquire) == closed;
+            }
+
+            // Զ˽Ƿ
+            bool peer_alive() const {
+                return m_head && ShmProcessAlive(m_is_client ? m_head->server_pid_.load() : m_head->client_pid_.load());
+            }
+
+            size_t capacity() const {
+                return m_head ? (size_t)m_head->capacity_ : 0;
+            }
+
+        public:
+            /**************   д  ******************/
+            // дϢ, ʣռ䲻ʱȴԷȡ; ͨرʱfalse
+            bool write(const char* data, size_t size) {
+                ShmRingHead& ring = send_ring();
+                uint64_t capacity = m_head->capacity_;
+                if (size > capacity)
+                    return false;
+
+                uint64_t tail = ring.tail_.load(std::memory_order_relaxed);
+                while (capacity - (tail - ring.head_.load(std::memory_order_acquire)) < size) {
+                    if (is_closed())
+                        return false;
+                    // ٸ, ȡconsumeɶԳ˳, ©
+                    ring.space_waiting_.store(1);
+                    uint32_t seq = ring.space_seq_.load();
+                    if (capacity - (tail - ring.head_.load()) < size && !ShmFutexWait(&ring.space_seq_, seq, WAIT_SLICE_US) && !peer_alive())
+                        close();
+                    ring.space_waiting_.store(0, std::memory_order_relaxed);
+                }
+                if (is_closed())
+                    return false;
+
+                memcpy(send_data() + tail % capacity, data, size);
+                commit(ring, tail + size);
+                return true;
+            }
+
+            // д벻ʣռĲ, ȴ, дֽ; ͨرʱ0
+            size_t write_some(const char* data, size_t size) {
+                if (is_closed())
+                    return 0;
+                ShmRingHead& ring = send_ring();
+                uint64_t capacity = m_head->capacity_;
+                uint64_t tail = ring.tail_.load(std::memory_order_relaxed);
+                size = (size_t)std::min<uint64_t>(size, capacity - (tail - ring.head_.load(std::memory_order_acquire)));
+                if (size == 0)
+                    return 0;
+
+                memcpy(send_data() + tail % capacity, data, size);
+                commit(ring, tail + size);
+                return size;
+            }
+
+            // λʱȴԷȡ, timeout_us΢, ʱ෵true; falseʾͨѹر
+            // writeͬ, ͬһʱ̽һȴ
+            bool wait_space(unsigned timeout_us) {
+                ShmRingHead& ring = send_ring();
+                uint64_t capacity = m_head->capacity_;
+                uint64_t tail = ring.tail_.load(std::memory_order_relaxed);
+                if (!is_closed() && tail - ring.head_.load(std::memory_order_acquire) >= capacity) {
+                    ring.space_waiting_.store(1);
+                    uint32_t seq = ring.space_seq_.load();
+                    if (tail - ring.head_.load() >= capacity && !ShmFutexWait(&ring.space_seq_, seq, timeout_us) && !peer_alive())
+                        close();
+                    ring.space_waiting_.store(0, std::memory_order_relaxed);
+                }
+                return !is_closed();
+            }
+
+        public:
+            /**************   ȡ  ******************/
+            // ȴдλԽseen, spin_usΪǰæѯʱ(΢); falseʾͨѹر
+            bool wait_data(uint64_t seen, unsigned spin_us) {
+                ShmRingHead& ring = recv_ring();
+                if (ring.tail_.load(std::memory_order_acquire) != seen)
+                    return true;
+
+                // ʱæѯֻռöԶCPU, ֱ
+                static const bool multi_core = std::thread::hardware_concurrency() > 1;
+                if (spin_us > 0 && multi_core) {
+                    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(spin_us);
+                    do {
+                        for (int i = 0; i < 64; ++i) {
+                            if (ring.tail_.load(std::memory_order_acquire) != seen)
+                                return true;
+#if defined(__x86_64__) || defined(__i386__)
+                            __builtin_ia32_pause();
+#endif
+                        }
+                    } while (std::chrono::steady_clock::now() < deadline);
+                }
+
+                while (!is_closed()) {
+                    ring.data_waiting_.store(1);
+                    uint32_t seq = ring.data_seq_.load();
+                    if (ring.tail_.load() != seen) {
+                        ring.data_waiting_.store(0, std::memory_order_relaxed);
+                        return true;
+                    }
+                    bool woken = ShmFutexWait(&ring.data_seq_, seq, WAIT_SLICE_US);
+                    ring.data_waiting_.store(0, std::memory_order_relaxed);
+                    if (ring.tail_.load(std::memory_order_acquire) != seen)
+                        return true;
+                    if (!woken && !peer_alive())
+                        close();
+                }
+                // رǰдȡ
+                return ring.tail_.load(std::memory_order_acquire) != seen;
+            }
+
+            // ǰдλ
+            uint64_t tail() const {
+                return recv_ring().tail_.load(std::memory_order_acquire);
+            }
+            // ǰȡλ
+            uint64_t head() const {
+                return recv_ring().head_.load(std::memory_order_relaxed);
+            }
+            // ɶ׵ַ, ɶʼ
+            const char* peek() const {
+                return m_data[m_is_client ? 1 : 0] + head() % m_head->capacity_;
+            }
+            // дλtailĿɶֽ
+            size_t readable(uint64_t tail) const {
+                return (size_t)(tail - head());
+            }
+
+            // Ƴɶͷnֽ
+            void consume(size_t n) {
+                ShmRingHead& ring = recv_ring();
+                uint64_t head = ring.head_.load(std::memory_order_relaxed);
+                n = (size_t)std::min<uint64_t>(n, ring.tail_.load(std::memory_order_acquire) - head);
+                if (n == 0)
+                    return;
+                ring.head_.store(head + n);
+                if (ring.space_waiting_.load()) {
+                    ring.space_seq_.fetch_add(1);
+                    ShmFutexWake(&ring.space_seq_);
+                }
+            }
+
+        private:
+            // дλ, ȡʱ
+            void commit(ShmRingHead& ring, uint64_t tail) {
+                ring.tail_.store(tail);
+                if (ring.data_waiting_.load()) {
+                    ring.data_seq_.fetch_add(1);
+                    ShmFutexWake(&ring.data_seq_);
+                }
+            }
+
+            ShmRingHead& send_ring() const {
+                return m_head->rings_[m_is_client ? 0 : 1];
+            }
+            ShmRingHead& recv_ring() const {
+                return m_head->rings_[m_is_client ? 1 : 0];
+            }
+            char* send_data() const {
+                return m_data[m_is_client ? 0 : 1];
+            }
+
+            static size_t GetPageSize() {
+                long page_size = sysconf(_SC_PAGESIZE);
+                return page_size > 0 ? (size_t)page_size : 4096;
+            }
+
+            // ӳͷ, ֱӳ
+            bool map(int fd, size_t head_size, size_t capacity) {
+                size_t map_size = head_size + capacity * 4;
+                void* base = mmap(nullptr, map_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (base == MAP_FAILED)
+                    return false;
+
+                char* addr = static_cast<char*>(base);
+                bool ok = mmap(addr, head_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+                for (int i = 0; ok && i < 2; ++i) {
+                    char* data = addr + head_size + capacity * 2 * i;
+                    off_t offset = (off_t)(head_size + capacity * i);
+                    ok = mmap(data, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, offset) != MAP_FAILED
+                        && mmap(data + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, offset) != MAP_FAILED;
+                    m_data[i] = data;
+                }
+                if (!ok) {
+                    munmap(base, map_size);
+                    return false;
+                }
+
+                m_base = addr;
+                m_map_size = map_size;
+                m_head = reinterpret_cast<ShmChannelHead*>(addr);
+                return true;
+            }
+
+            void unmap() {
+                if (m_base) {
+                    munmap(m_base, m_map_size);
+                    m_base = nullptr;
+                }
+                m_head = nullptr;
+                m_data[0] = m_data[1] = nullptr;
+            }
+
+        private:
+            // ͷ
+            ShmChannelHead*     m_head;
+            // ׵ַ, 0: ͻ->, 1: ->ͻ
+            char*               m_data[2];
+            // ӳ׵ַС
+            char*               m_base;
+            size_t              m_map_size;
+            // ǷΪͻ
+            bool                m_is_client;
+            // ڴ, ͻʹ
+            std::string         m_name;
+        };
+
+        // ڴͨĴд, ɶ߳ͬʱ
+        // ȡ̵߳Ļصд(Ӧʽȹ黹)ʱȴ: ռ䲻߳дʱݴ, ɶȡ߳ڻص϶д
+        // ˫ȡ߳̾ڻصеȴԶ˶ȡʱȴ; ߳̿ռ䲻ʱɵȴԶ˶ȡ
+        class ShmChannelWriter
+        {
+        public:
+            enum : unsigned {
+                PENDING_WAIT_US = 1000,     // ȡ߳ݴʱεȴʱ, ڼ䵽Ӻʱȡ
+            };
+
+            // ȡ̵߳Ǽ, ڱ߳дΪȡ߳д
+            class ReaderScope {
+            public:
+                explicit ReaderScope(const ShmChannelWriter& writer) { CurrentReader() = &writer; }
+                ~ReaderScope() { CurrentReader() = nullptr; }
+            };
+
+        public:
+            explicit ShmChannelWriter(ShmChannel& channel) : m_channel(channel) {}
+
+            ShmChannelWriter(const ShmChannelWriter&) = delete;
+            ShmChannelWriter& operator=(const ShmChannelWriter&) = delete;
+
+            // дϢ, ͨͨرʱfalse
+            // ȡ߳дʱȴ, δдĲݴ沢true
+            bool write(const char* data, size_t size) {
+                if (size > m_channel.capacity() || m_channel.is_closed())
+                    return false;
+
+                if (CurrentReader() != this) {
+                    std::lock_guard<std::mutex> lock(m_write_mtx);
+                    // дȡ߳ݴ, Ⱥ˳
+                    while (!flush_pending()) {
+                        if (!m_channel.wait_space(ShmChannel::WAIT_SLICE_US))
+                            return false;
+                    }
+                    return m_channel.write(data, size);
+                }
+
+                std::unique_lock<std::mutex> lock(m_write_mtx, std::try_to_lock);
+                if (lock.owns_lock() && flush_pending()) {
+                    size_t written = m_channel.write_some(data, size);
+                    data += written;
+                    size -= written;
+                    if (size == 0)
+                        return true;
+                }
+                std::lock_guard<std::mutex> pending_lock(m_pending_mtx);
+                m_pending.append(data, size);
+                return true;
+            }
+
+            // ȡ̵߳ȴ, ͬShmChannel::wait_data
+            // ݴʱд, ռ䲻ʱֶεȴԷȡ, ڼݼ, ԱȡͷŶԷķͿռ
+            bool wait_data(uint64_t seen, unsigned spin_us) {
+                while (has_pending()) {
+                    if (m_channel.tail() != seen)
+                        return true;
+                    std::unique_lock<std::mutex> lock(m_write_mtx, std::try_to_lock);
+                    // ߳д, дǰдݴ
+                    if (!lock.owns_lock()) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(PENDING_WAIT_US));
+                        continue;
+                    }
+                    if (flush_pending() || !m_channel.wait_space(PENDING_WAIT_US))
+                        break;
+                }
+                return m_channel.wait_data(seen, spin_us);
+            }
+
+        private:
+            // дݴ, m_write_mtx, Ƿȫд
+            bool flush_pending() {
+                std::lock_guard<std::mutex> lock(m_pending_mtx);
+                if (m_pending.empty())
+                    return true;
+                m_pending.erase(0, m_channel.write_some(m_pending.data(), m_pending.size()));
+                return m_pending.empty();
+            }
+
+            bool has_pending() const {
+                std::lock_guard<std::mutex> lock(m_pending_mtx);
+                return !m_pending.empty();
+            }
+
+            static const ShmChannelWriter*& CurrentReader() {
+                static thread_local const ShmChannelWriter* reader = nullptr;
+                return reader;
+            }
+
+        private:
+            ShmChannel&             m_channel;
+            // д, Ƕȡ̵߳ȴͿռʱ, ȡ߳̽Իȡ
+            std::mutex              m_write_mtx;
+            // ȡ߳ݴĴд
+            mutable std::mutex      m_pending_mtx;
+            std::string             m_pending;
+        };
+
+        // ڴ, ǼǴӵͨ
+        struct ShmListenHead {
+            enum : uint32_t {
+                MAX_SLOTS = 64,
+            };
+            // Ǽǲλ
+            enum slot_state : uint32_t {
+                slot_free = 0,
+                slot_writing = 1,
+                slot_ready = 2,
+            };
+            struct slot_st {
+                std::atomic<uint32_t>   state_;
+                char                    name_[60];
+            };
+
+            uint32_t                magic_;
+            std::atomic<int32_t>    server_pid_;
+            std::atomic<uint32_t>   accept_seq_;    // ӻ
+            slot_st                 slots_[MAX_SLOTS];
+        };
+
+        // ڴ
+        class ShmAcceptor
+        {
+        public:
+            ShmAcceptor() : m_head(nullptr) {}
+            ~ShmAcceptor() {
+                close();
+            }
+
+            // Զ˿ںŴڴ, Ѵʱ(ϴ쳣˳)³ʼ
+            // дڸö˿ڼʱfalse, øڴ
+            bool open(unsigned short port) {
+                close();
+                if (IsListening(port))
+                    return false;
+                m_shm = std::make_unique<MMapFile::ShmReaderWriter>(MMapFile::ShmReaderWriter::READER_WRITER, true);
+                if (!m_shm->init(ShmListenName(port), true, sizeof(ShmListenHead))) {
+                    m_shm.reset();
+                    return false;
+                }
+                m_head = new (m_shm->read()) ShmListenHead();
+                m_head->server_pid_.store(getpid());
+                m_head->magic_ = ShmChannel::SHM_MAGIC;
+                return true;
+            }
+
+            // رռѵȴеaccept
+            void close() {
+                if (!m_shm)
+                    return;
+                m_head->server_pid_.store(0);
+                wake();
+                m_head = nullptr;
+                m_shm.reset();
+            }
+
+            void wake() {
+                if (!m_head)
+                    return;
+                m_head->accept_seq_.fetch_add(1);
+                ShmFutexWake(&m_head->accept_seq_);
+            }
+
+            // ȡͨ, ȴtimeout_us΢
+            bool accept(std::string& name, unsigned timeout_us) {
+                if (!m_head)
+                    return false;
+                uint32_t seq = m_head->accept_seq_.load();
+                if (take(name))
+                    return true;
+                ShmFutexWait(&m_head->accept_seq_, seq, timeout_us);
+                return take(name);
+            }
+
+            // ڼǼͨ, ڻ˳ʱfalse
+            static bool Connect(unsigned short port, const std::string& name) {
+                if (name.size() >= sizeof(ShmListenHead::slot_st::name_))
+                    return false;
+                // УСӳ, ͬڴܲǼ
+                int fd = ::shm_open(ShmListenName(port).c_str(), O_RDWR, S_IRUSR | S_IWUSR);
+                if (fd == -1)
+                    return false;
+                struct stat sb;
+                void* ptr = MAP_FAILED;
+                if (fstat(fd, &sb) == 0 && (size_t)sb.st_size == sizeof(ShmListenHead))
+                    ptr = mmap(nullptr, sizeof(ShmListenHead), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if (ptr == MAP_FAILED)
+                    return false;
+
+                bool rslt = false;
+                auto head = static_cast<ShmListenHead*>(ptr);
+                if (head->magic_ == ShmChannel::SHM_MAGIC && ShmProcessAlive(head->server_pid_.load())) {
+                    for (auto& slot : head->slots_) {
+                        uint32_t expected = ShmListenHead::slot_free;
+                        if (!slot.state_.compare_exchange_strong(expected, ShmListenHead::slot_writing))
+                            continue;
+                        memcpy(slot.name_, name.c_str(), name.size() + 1);
+                        slot.state_.store(ShmListenHead::slot_ready);
+                        head->accept_seq_.fetch_add(1);
+                        ShmFutexWake(&head->accept_seq_);
+                        rslt = true;
+                        break;
+                    }
+                }
+                munmap(ptr, sizeof(ShmListenHead));
+                return rslt;
+            }
+
+        private:
+            // ö˿ڵļڴǷɴ̳
+            // ֻӳУ, ɾShmReaderWriter, ͷʱɾ̵ļڴ
+            static bool IsListening(unsigned short port) {
+                int fd = ::shm_open(ShmListenName(port).c_str(), O_RDONLY, S_IRUSR | S_IWUSR);
+                if (fd == -1)
+                    return false;
+                struct stat sb;
+                void* ptr = MAP_FAILED;
+                if (fstat(fd, &sb) == 0 && (size_t)sb.st_size == sizeof(ShmListenHead))
+                    ptr = mmap(nullptr, sizeof(ShmListenHead), PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if (ptr == MAP_FAILED)
+                    return false;
+
+                auto head = static_cast<const ShmListenHead*>(ptr);
+                bool rslt = head->magic_ == ShmChannel::SHM_MAGIC && ShmProcessAlive(head->server_pid_.load());
+                munmap(ptr, sizeof(ShmListenHead));
+                return rslt;
+            }
+
+            bool take(std::string& name) {
+                for (auto& slot : m_head->slots_) {
+                    if (slot.state_.load(std::memory_order_acquire) != ShmListenHead::slot_ready)
+                        continue;
+                    name.assign(slot.name_, strnlen(slot.name_, sizeof(slot.name_)));
+                    slot.state_.store(ShmListenHead::slot_free);
+                    return true;
+                }
+                return false;
+            }
+
+        private:
+            std::unique_ptr<MMapFile::ShmReaderWriter>  m_shm;
+            ShmListenHead*                              m_head;
+        };
+    }
+}
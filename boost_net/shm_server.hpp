@@ -0,0 +1,304 @@
+/*************************************************
+File name:      shm_server.hpp
+Author:			AChar
+Version:
+Date:
+Purpose: ͬʱtcp˿ڼͬڴͨķ, ӿͬTcpServer, ֱΪRpcServiceTServer
+Note:    ڴԶ˿ں, ͬShmSessionӱַʱڴ, ɾtcp
+         ÿڴɶȡ̻߳ص, IDλ1, tcpIDͻ
+         ȡصдʱȴλռ(ݴɶȡ߳д), ͬȴԶӦ, Ӧͬһȡ̶߳ȡ
+*************************************************/
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include "../rwmutex.hpp"
+#include "tcp_server.hpp"
+#include "shm_channel.hpp"
+
+namespace BTool
+{
+    namespace BoostNet
+    {
+        // tcpڴ
+        class ShmServer
+        {
+            typedef NetCallBack::SessionID                  SessionID;
+            typedef TcpSession::WriteMemoryStreamPtr        WriteMemoryStreamPtr;
+
+            // ڴ
+            struct ShmConn {
+                SessionID               id_;
+                ShmChannel              channel_;
+                ShmChannelWriter        writer_{ channel_ };
+                std::thread             reader_;
+                std::atomic<bool>       finished_{ false };
+            };
+            typedef std::shared_ptr<ShmConn>                ShmConnPtr;
+            typedef std::map<SessionID, ShmConnPtr>         ShmConnMap;
+
+            enum {
+                ACCEPT_WAIT_US = 100000,    // εȴʱ, ڼѽ
+            };
+
+        public:
+            // ioc: tcpӵioд
+            // max_wbuffer_size/max_rbuffer_size: tcpӻС, ͬTcpServer
+            ShmServer(AsioContextPool& ioc, size_t max_wbuffer_size = TcpSession::NOLIMIT_WRITE_BUFFER_SIZE, size_t max_rbuffer_size = TcpSession::MAX_READSINGLE_BUFFER_SIZE)
+                : m_tcp(ioc, max_wbuffer_size, max_rbuffer_size)
+                , m_running(false)
+                , m_busy_poll_us(0)
+            {
+            }
+
+            ~ShmServer() {
+                register_cbk(NetCallBack());
+                stop();
+            }
+
+            // üص
+            ShmServer& register_error_cbk(const NetCallBack::server_error_cbk& cbk) {
+                m_tcp.register_error_cbk(cbk);
+                return *this;
+            }
+            // ûص,øʽɻصͬзֿ
+            ShmServer& register_cbk(const NetCallBack& handler) {
+                writeLock lock(m_cbk_mtx);
+                m_handler = handler;
+                m_tcp.register_cbk(handler);
+                return *this;
+            }
+            // ÿӻص
+            ShmServer& register_open_cbk(const NetCallBack::open_cbk& cbk) {
+                writeLock lock(m_cbk_mtx);
+                m_handler.open_cbk_ = cbk;
+                m_tcp.register_open_cbk(cbk);
+                return *this;
+            }
+            // ùرӻص
+            ShmServer& register_close_cbk(const NetCallBack::close_cbk& cbk) {
+                writeLock lock(m_cbk_mtx);
+                m_handler.close_cbk_ = cbk;
+                m_tcp.register_close_cbk(cbk);
+                return *this;
+            }
+            // öȡϢص
+            ShmServer& register_read_cbk(const NetCallBack::read_cbk& cbk) {
+                writeLock lock(m_cbk_mtx);
+                m_handler.read_cbk_ = cbk;
+                m_tcp.register_read_cbk(cbk);
+                return *this;
+            }
+
+            // æѯʱ(΢), ڴӶȡʱæѯʱ, tcpӼTcpServer::set_busy_poll
+            // ǰ
+            ShmServer& set_busy_poll(unsigned usec) {
+                m_busy_poll_us = usec;
+                m_tcp.set_busy_poll(usec);
+                return *this;
+            }
+
+            // tcpӵķͺϲʱ, TcpServer::set_flush_delay
+            ShmServer& set_flush_delay(unsigned usec) {
+                m_tcp.set_flush_delay(usec);
+                return *this;
+            }
+
+            // ʽ, ڴʧʱṩtcp
+            // ip: IP,ĬϱIPV4ַ
+            // port: ˿
+            // reuse_address: Ƿö˿ڸ
+            bool start(unsigned short port, bool reuse_address = true) {
+                return start(nullptr, port, reuse_address);
+            }
+            bool start(const char* ip, unsigned short port, bool reuse_address = true) {
+                if (!m_tcp.start(ip, port, reuse_address))
+                    return false;
+                start_shm(port);
+                return true;
+            }
+
+            // ֹǰ
+            void stop() {
+                stop_shm();
+                m_tcp.stop();
+            }
+
+            // ǰǷṩڴ
+            bool is_shm_listening() const {
+                return m_running.load();
+            }
+
+            // д, ڴڻλʱȴԶ˶ȡ, ȡصдʱȴ, ݴɶȡ߳д
+            bool write(SessionID session_id, const char* send_msg, size_t size) {
+                if (!IsShmSessionID(session_id))
+                    return m_tcp.write(session_id, send_msg, size);
+
+                ShmConnPtr conn = find_conn(session_id);
+                if (!conn)
+                    return false;
+                return conn->writer_.write(send_msg, size);
+            }
+            // ȡtcpӵķͻڵ, ڴӷnullptr, ɵ÷write(session_id, send_msg, size)
+            WriteMemoryStreamPtr acquire_buffer(SessionID session_id) {
+                if (IsShmSessionID(session_id))
+                    return nullptr;
+                return m_tcp.acquire_buffer(session_id);
+            }
+            // дtcpӷͻڵ
+            bool write(SessionID session_id, WriteMemoryStreamPtr&& buffer) {
+                if (IsShmSessionID(session_id))
+                    return false;
+                return m_tcp.write(session_id, std::move(buffer));
+            }
+
+            // ѵָȵĶ
+            void consume_read_buf(SessionID session_id, size_t bytes_transferred) {
+                if (!IsShmSessionID(session_id))
+                    return m_tcp.consume_read_buf(session_id, bytes_transferred);
+
+                ShmConnPtr conn = find_conn(session_id);
+                if (conn)
+                    conn->channel_.consume(bytes_transferred);
+            }
+
+            // ر, ڴӵclose_cbkȡ߳лص
+            void close(SessionID session_id) {
+                if (!IsShmSessionID(session_id))
+                    return m_tcp.close(session_id);
+
+                ShmConnPtr conn = find_conn(session_id);
+                if (conn)
+                    conn->channel_.close();
+            }
+
+        private:
+            ShmConnPtr find_conn(SessionID session_id) const {
+                readLock lock(m_conn_mtx);
+                auto iter = m_conns.find(session_id);
+                return iter == m_conns.end() ? nullptr : iter->second;
+            }
+
+            void start_shm(unsigned short port) {
+                if (m_running.exchange(true))
+                    return;
+                if (!m_acceptor.open(port)) {
+                    m_running.store(false);
+                    return;
+                }
+                m_accept_thread = std::thread(&ShmServer::accept_loop, this);
+            }
+
+            void stop_shm() {
+                if (!m_running.exchange(false))
+                    return;
+                m_acceptor.wake();
+                if (m_accept_thread.joinable())
+                    m_accept_thread.join();
+                m_acceptor.close();
+
+                ShmConnMap conns;
+                {
+                    writeLock lock(m_conn_mtx);
+                    conns.swap(m_conns);
+                }
+                for (auto& item : conns)
+                    item.second->channel_.close();
+                for (auto& item : conns) {
+                    if (item.second->reader_.joinable())
+                        item.second->reader_.join();
+                }
+            }
+
+            // ߳, Ӳѽ
+            void accept_loop() {
+                std::string name;
+                while (m_running.load()) {
+                    if (m_acceptor.accept(name, ACCEPT_WAIT_US) && m_running.load()) {
+                        auto conn = std::make_shared<ShmConn>();
+                        if (conn->channel_.accept(name)) {
+                            conn->id_ = GetNextShmSessionID();
+                            {
+                                writeLock lock(m_conn_mtx);
+                                m_conns[conn->id_] = conn;
+                            }
+                            conn->reader_ = std::thread(&ShmServer::read_loop, this, conn.get());
+                        }
+                    }
+                    sweep();
+                }
+            }
+
+            // նȡ߳ѽ
+            void sweep() {
+                std::vector<ShmConnPtr> finished;
+                {
+                    writeLock lock(m_conn_mtx);
+                    for (auto iter = m_conns.begin(); iter != m_conns.end();) {
+                        if (iter->second->finished_.load()) {
+                            finished.push_back(iter->second);
+                            iter = m_conns.erase(iter);
+                        }
+                        else {
+                            ++iter;
+                        }
+                    }
+                }
+                for (auto& conn : finished) {
+                    if (conn->reader_.joinable())
+                        conn->reader_.join();
+                }
+            }
+
+            // Ӷȡ߳, ɶʼ, ÿλص
+            void read_loop(ShmConn* conn) {
+                ShmChannel& channel = conn->channel_;
+                ShmChannelWriter::ReaderScope reader_scope(conn->writer_);
+                {
+                    readLock lock(m_cbk_mtx);
+                    if (m_handler.open_cbk_)
+                        m_handler.open_cbk_(conn->id_);
+                }
+
+                uint64_t seen = channel.head();
+                while (conn->writer_.wait_data(seen, m_busy_poll_us)) {
+                    uint64_t tail = channel.tail();
+                    {
+                        readLock lock(m_cbk_mtx);
+                        if (m_handler.read_cbk_)
+                            m_handler.read_cbk_(conn->id_, channel.peek(), channel.readable(tail));
+                    }
+                    seen = tail;
+                }
+
+                {
+                    readLock lock(m_cbk_mtx);
+                    if (m_handler.close_cbk_)
+                        m_handler.close_cbk_(conn->id_, nullptr, 0);
+                }
+                conn->finished_.store(true);
+            }
+
+        private:
+            // tcp
+            TcpServer                   m_tcp;
+
+            // ڴ
+            ShmAcceptor                 m_acceptor;
+            std::atomic<bool>           m_running;
+            std::thread                 m_accept_thread;
+
+            // ڴ
+            mutable rwMutex             m_conn_mtx;
+            ShmConnMap                  m_conns;
+
+            // ص, ȡ̻߳صڼж, עصʱɵȴ;ص
+            rwMutex                     m_cbk_mtx;
+            NetCallBack                 m_handler;
+
+            unsigned                    m_busy_poll_us;
+        };
+    }
+}
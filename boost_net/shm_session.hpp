@@ -0,0 +1,305 @@
+/******************************************************************************
+File name:  shm_session.hpp
+Author:	    AChar
+Purpose:    ͬڴ, ӿͬTcpSession, ֱΪRpcClientTSession
+Note:       ӱַ(127.x.x.xlocalhost::1)ʱȾڴͨShmServer, Զ˷ShmServerʧʱΪtcp
+            ڴɶȡ̻߳ص, ȡʱæѯset_busy_pollָʱ, futex
+            TcpSessionͬ, ⲿȡݺconsume_read_bufɾ
+            ȡصдʱȴλռ(ݴɶȡ߳д), ͬȴԶӦ, Ӧͬһȡ̶߳ȡ
+
+Special Note: 캯ioc_type& iocΪⲿ, ҪͷŸö֮ͷioc, ͬTcpSession
+            ȡ̲߳б, ʱرͨȴȡ߳˳, ڶȡ̵߳Ļصͷűһ
+*****************************************************************************/
+
+#pragma once
+
+#include <mutex>
+#include <thread>
+#include "tcp_session.hpp"
+#include "shm_channel.hpp"
+
+namespace BTool
+{
+    namespace BoostNet
+    {
+        // ڴӶ, Ǳڴ治ʱʹtcp
+        class ShmSession : public std::enable_shared_from_this<ShmSession>
+        {
+        public:
+            typedef TcpSession::ioc_type                ioc_type;
+            typedef NetCallBack::SessionID              SessionID;
+
+        private:
+            // ڴ, ɱ󼰶ȡ̹߳ͬ
+            struct ShmConn {
+                ShmChannel              channel_;
+                ShmChannelWriter        writer_{ channel_ };
+            };
+            typedef std::shared_ptr<ShmConn>            ShmConnPtr;
+
+        public:
+            enum {
+                DEFAULT_RING_CAPACITY = 1024 * 1024,    // λĬ
+                CONNECT_TIMEOUT_MS = 2000,              // ȴ˽볬ʱ
+            };
+
+        public:
+            // ioc: ioд, tcpӼ첽
+            // max_wbuffer_size/max_rbuffer_size: tcpӻС, ͬTcpSession
+            ShmSession(ioc_type& ioc, size_t max_wbuffer_size = TcpSession::NOLIMIT_WRITE_BUFFER_SIZE, size_t max_rbuffer_size = TcpSession::MAX_READSINGLE_BUFFER_SIZE)
+                : m_io_context(ioc)
+                , m_tcp(std::make_shared<TcpSession>(ioc, max_wbuffer_size, max_rbuffer_size))
+                , m_shm_session_id(GetNextShmSessionID())
+                , m_use_shm(false)
+                , m_ring_capacity(DEFAULT_RING_CAPACITY)
+                , m_busy_poll_us(0)
+                , m_connect_port(0)
+            {
+            }
+
+            ~ShmSession() {
+                register_cbk(NetCallBack());
+                close_shm();
+                m_tcp->shutdown();
+            }
+
+            // ûص,øʽɻصͬзֿ
+            ShmSession& register_cbk(const NetCallBack& handler) {
+                std::lock_guard<std::recursive_mutex> lock(m_cbk_mtx);
+                m_handler = handler;
+                m_tcp->register_cbk(handler);
+                return *this;
+            }
+            // ÿӻص
+            ShmSession& register_open_cbk(const NetCallBack::open_cbk& cbk) {
+                std::lock_guard<std::recursive_mutex> lock(m_cbk_mtx);
+                m_handler.open_cbk_ = cbk;
+                m_tcp->register_open_cbk(cbk);
+                return *this;
+            }
+            // ùرӻص
+            ShmSession& register_close_cbk(const NetCallBack::close_cbk& cbk) {
+                std::lock_guard<std::recursive_mutex> lock(m_cbk_mtx);
+                m_handler.close_cbk_ = cbk;
+                m_tcp->register_close_cbk(cbk);
+                return *this;
+            }
+            // öȡϢص
+            ShmSession& register_read_cbk(const NetCallBack::read_cbk& cbk) {
+                std::lock_guard<std::recursive_mutex> lock(m_cbk_mtx);
+                m_handler.read_cbk_ = cbk;
+                m_tcp->register_read_cbk(cbk);
+                return *this;
+            }
+
+            // æѯʱ(΢), ڴӶȡʱæѯʱ, tcpӼTcpSession::set_busy_poll
+            // ע: ӿǰ
+            ShmSession& set_busy_poll(unsigned usec) {
+                m_busy_poll_us = usec;
+                m_tcp->set_busy_poll(usec);
+                return *this;
+            }
+
+            // tcpӵķͺϲʱ, TcpSession::set_flush_delay, ڴд뼴ɼ, ϲ
+            ShmSession& set_flush_delay(unsigned usec) {
+                m_tcp->set_flush_delay(usec);
+                return *this;
+            }
+
+            // õλ, ҳȡ, Ϣɳ
+            // ע: ӿǰ
+            ShmSession& set_ring_capacity(size_t capacity) {
+                m_ring_capacity = capacity;
+                return *this;
+            }
+
+            // io_context
+            ioc_type& get_io_context() {
+                return m_io_context;
+            }
+
+            // ǰǷΪڴ
+            bool is_shm() const {
+                return m_use_shm.load(std::memory_order_acquire);
+            }
+
+            // Ƿѿ
+            bool is_open() const {
+                if (!is_shm())
+                    return m_tcp->is_open();
+                std::lock_guard<std::mutex> lock(m_conn_mtx);
+                return m_conn && !m_conn->channel_.is_closed();
+            }
+
+            // ȡID, ڴtcpӵIDͬ
+            SessionID get_session_id() const {
+                return is_shm() ? m_shm_session_id : m_tcp->get_session_id();
+            }
+
+            // ͻ˿, ͬʱȡ; ڴȴ˽, Ͷio_contextз
+            void connect(const char* ip, unsigned short port) {
+                m_connect_ip = ip;
+                m_connect_port = port;
+                boost::asio::post(m_io_context, std::bind(&ShmSession::do_connect, shared_from_this()));
+            }
+
+            // ͻ
+            void reconnect() {
+                boost::asio::post(m_io_context, std::bind(&ShmSession::do_connect, shared_from_this()));
+            }
+
+            // ͬر
+            void shutdown(const boost::system::error_code& ec = boost::asio::error::operation_aborted) {
+                if (is_shm()) {
+                    std::lock_guard<std::mutex> lock(m_conn_mtx);
+                    if (m_conn)
+                        m_conn->channel_.close();
+                    return;
+                }
+                m_tcp->shutdown(ec);
+            }
+
+            // д, ɶ߳ͬʱ; ڴڻλʱȴԶ˶ȡ, ڶȡصдʱȴ, ݴɶȡ߳д
+            bool write(const char* send_msg, size_t size) {
+                if (!is_shm())
+                    return m_tcp->write(send_msg, size);
+
+                ShmConnPtr conn = get_conn();
+                if (!conn)
+                    return false;
+                return conn->writer_.write(send_msg, size);
+            }
+
+            // ѵָȵĶ
+            void consume_read_buf(size_t bytes_transferred) {
+                if (!is_shm())
+                    return m_tcp->consume_read_buf(bytes_transferred);
+
+                ShmConnPtr conn = get_conn();
+                if (conn)
+                    conn->channel_.consume(bytes_transferred);
+            }
+
+        private:
+            // ǷΪַ
+            static bool IsLoopback(const std::string& ip) {
+                return ip.compare(0, 4, "127.") == 0 || ip == "localhost" || ip == "::1";
+            }
+
+            ShmConnPtr get_conn() const {
+                std::lock_guard<std::mutex> lock(m_conn_mtx);
+                return m_conn;
+            }
+
+            void do_connect() {
+                // Կʱ
+                if (is_open())
+                    return;
+                if (IsLoopback(m_connect_ip) && connect_shm())
+                    return;
+                m_use_shm.store(false, std::memory_order_release);
+                m_tcp->connect(m_connect_ip.c_str(), m_connect_port);
+            }
+
+            // ڴ, ʧʱfalse
+            bool connect_shm() {
+                // ȴһӵĶȡ߳˳
+                join_reader();
+
+                static std::atomic<unsigned> next_channel_seq(0);
+                std::string name = ShmListenName(m_connect_port) + "_" + std::to_string(getpid()) + "_" + std::to_string(++next_channel_seq);
+                auto conn = std::make_shared<ShmConn>();
+                if (!conn->channel_.create(name, m_ring_capacity))
+                    return false;
+                if (!ShmAcceptor::Connect(m_connect_port, name) || !conn->channel_.wait_accept(CONNECT_TIMEOUT_MS)) {
+                    conn->channel_.close();
+                    ::shm_unlink(name.c_str());
+                    return false;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(m_conn_mtx);
+                    m_conn = conn;
+                }
+                m_use_shm.store(true, std::memory_order_release);
+                // ȡ߳̽, ӳ, һڶȡ߳ͷʱͷioc
+                // ʱclose_shmرͨȴȡ߳˳
+                m_reader = std::thread([this, conn]() { read_loop(conn); });
+                return true;
+            }
+
+            // ȡ߳, ɶʼ, ÿλص
+            void read_loop(ShmConnPtr conn) {
+                ShmChannel& channel = conn->channel_;
+                ShmChannelWriter::ReaderScope reader_scope(conn->writer_);
+                {
+                    std::lock_guard<std::recursive_mutex> lock(m_cbk_mtx);
+                    if (m_handler.open_cbk_)
+                        m_handler.open_cbk_(m_shm_session_id);
+                }
+
+                uint64_t seen = channel.head();
+                while (conn->writer_.wait_data(seen, m_busy_poll_us)) {
+                    uint64_t tail = channel.tail();
+                    {
+                        std::lock_guard<std::recursive_mutex> lock(m_cbk_mtx);
+                        if (m_handler.read_cbk_)
+                            m_handler.read_cbk_(m_shm_session_id, channel.peek(), channel.readable(tail));
+                    }
+                    seen = tail;
+                }
+
+                // رջصп, 踴ƺ
+                NetCallBack::close_cbk close_cbk;
+                {
+                    std::lock_guard<std::recursive_mutex> lock(m_cbk_mtx);
+                    close_cbk = m_handler.close_cbk_;
+                }
+                if (close_cbk)
+                    close_cbk(m_shm_session_id, nullptr, 0);
+            }
+
+            // ȡ߳(ڻصͷһ)ʱ޷ȴ, ܷ
+            void join_reader() {
+                if (!m_reader.joinable())
+                    return;
+                if (m_reader.get_id() == std::this_thread::get_id())
+                    m_reader.detach();
+                else
+                    m_reader.join();
+            }
+
+            void close_shm() {
+                {
+                    std::lock_guard<std::mutex> lock(m_conn_mtx);
+                    if (m_conn)
+                        m_conn->channel_.close();
+                }
+                join_reader();
+            }
+
+        private:
+            ioc_type&                       m_io_context;
+            // tcp, ʱʹ
+            std::shared_ptr<TcpSession>     m_tcp;
+            // ڴID
+            SessionID                       m_shm_session_id;
+            // ǰǷΪڴ
+            std::atomic<bool>               m_use_shm;
+
+            // ڴӼȡ߳
+            mutable std::mutex              m_conn_mtx;
+            ShmConnPtr                      m_conn;
+            std::thread                     m_reader;
+
+            // ص, ȡ̻߳صڼ, עصʱɵȴ;ص
+            std::recursive_mutex            m_cbk_mtx;
+            NetCallBack                     m_handler;
+
+            size_t                          m_ring_capacity;
+            unsigned                        m_busy_poll_us;
+            std::string                     m_connect_ip;
+            unsigned short                  m_connect_port;
+        };
+    }
+}
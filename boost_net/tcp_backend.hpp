@@ -0,0 +1,44 @@
+/*************************************************
+File name:      tcp_backend.hpp
+Author:			AChar
+Version:
+Date:
+Purpose: TCPѡ, ģлasio(epoll)io_uringʵ
+Note:    ˵ķ/Ӷӿһ, ʹʾ:
+            template<typename Backend = AsioTcpBackend>
+            class EchoServer {
+                typename Backend::context_pool_type m_pool;
+                typename Backend::server_type       m_server{ m_pool };
+            };
+*************************************************/
+
+#pragma once
+
+#include "tcp_server.hpp"
+#if defined(__linux__)
+#include "uring_tcp_server.hpp"
+#endif
+
+namespace BTool
+{
+    namespace BoostNet
+    {
+        // boost::asioĺ
+        struct AsioTcpBackend
+        {
+            typedef AsioContextPool     context_pool_type;
+            typedef TcpServer           server_type;
+            typedef TcpSession          session_type;
+        };
+
+#if defined(__linux__)
+        // io_uringĺ
+        struct UringTcpBackend
+        {
+            typedef UringContextPool    context_pool_type;
+            typedef UringTcpServer      server_type;
+            typedef UringTcpSession     session_type;
+        };
+#endif
+    }
+}
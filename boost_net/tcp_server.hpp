@@ -26,6 +26,7 @@ namespace BTool
             typedef AsioContextPool::ioc_type               ioc_type;
             typedef boost::asio::ip::tcp::acceptor          accept_type;
             typedef std::shared_ptr<TcpSession>             TcpSessionPtr;
+            typedef TcpSession::WriteMemoryStreamPtr        WriteMemoryStreamPtr;
             typedef std::map<SessionID, TcpSessionPtr>      TcpSessionMap;
 
         public:
@@ -36,6 +37,8 @@ namespace BTool
                 , m_acceptor(ioc.get_io_context())
                 , m_max_wbuffer_size(max_wbuffer_size)
                 , m_max_rbuffer_size(max_rbuffer_size)
+                , m_max_gather_count(TcpSession::MAX_GATHER_WRITE_COUNT)
+                , m_max_gather_size(TcpSession::MAX_GATHER_WRITE_SIZE)
             {
             }
 
@@ -43,8 +46,6 @@ namespace BTool
                 m_handler = NetCallBack();
                 m_error_handler = nullptr;
                 stop();
-                boost::system::error_code ec;
-                m_acceptor.close(ec);
             }
 
             // üص
@@ -78,6 +79,33 @@ namespace BTool
                 m_handler.write_cbk_ = cbk;
                 return *this;
             }
+            // ÷֡ȡص, ÿӳdecoderĶ, úٻصread_cbk
+            TcpServer& register_frame_cbk(const FrameDecoder& decoder, const NetCallBack::frame_cbk& cbk) {
+                m_frame_decoder = decoder;
+                m_frame_cbk = cbk;
+                return *this;
+            }
+
+            // ӵξۺϷ, ǰ
+            TcpServer& set_gather_limit(size_t max_count, size_t max_size) {
+                m_max_gather_count = max_count;
+                m_max_gather_size = max_size;
+                return *this;
+            }
+
+            // ӵsocketæѯʱ(΢), 0ʾ, ǰ
+            // ͨAsioContextPool::set_busy_pollʹ, TcpSession::set_busy_poll
+            TcpServer& set_busy_poll(unsigned usec) {
+                m_busy_poll_us = usec;
+                return *this;
+            }
+
+            // ӵķͺϲʱ(΢), 0ʾ, ǰ
+            // TcpSession::set_flush_delay
+            TcpServer& set_flush_delay(unsigned usec) {
+                m_flush_delay_us = usec;
+                return *this;
+            }
 
             // ʽ,
             // ip: IP,ĬϱIPV4ַ
@@ -123,6 +151,9 @@ namespace BTool
 
             // ֹǰ
             void stop() {
+                // io_context, ͷǰر
+                boost::system::error_code ec;
+                m_acceptor.close(ec);
                 clear();
                 m_ioc_pool.stop();
             }
@@ -140,8 +171,25 @@ namespace BTool
                 if (!sess_ptr) {
                     return false;
                 }
+
                 return sess_ptr->write(send_msg, size);
             }
+            // ȡָӵķͻڵ, лwrite(session_id, buffer)ύ
+            WriteMemoryStreamPtr acquire_buffer(SessionID session_id) {
+                auto sess_ptr = find_session(session_id);
+                if (!sess_ptr) {
+                    return nullptr;
+                }
+                return sess_ptr->acquire_buffer();
+            }
+            // дķͻڵ
+            bool write(SessionID session_id, WriteMemoryStreamPtr&& buffer) {
+                auto sess_ptr = find_session(session_id);
+                if (!sess_ptr) {
+                    return false;
+                }
+                return sess_ptr->write(std::move(buffer));
+            }
             // 첽Ϣ
             // setзʧܵsession id
             std::set<SessionID> writeAll(const char* send_msg, size_t size) {
@@ -200,6 +248,16 @@ namespace BTool
                 return false;
             }
 
+            // ȡӷͳ
+            bool get_write_stats(SessionID session_id, TcpSession::WriteStats& stats) const {
+                auto sess_ptr = find_session(session_id);
+                if (sess_ptr) {
+                    stats = sess_ptr->get_write_stats();
+                    return true;
+                }
+                return false;
+            }
+
         private:
             // ˿
             bool start_listen(const char* ip, unsigned short port, bool reuse_address)
@@ -234,6 +292,9 @@ namespace BTool
             void start_accept() {
                 try {
                     TcpSessionPtr session = std::make_shared<TcpSession>(m_ioc_pool.get_io_context(), m_max_wbuffer_size, m_max_rbuffer_size);
+                    session->set_gather_limit(m_max_gather_count, m_max_gather_size);
+                    session->set_busy_poll(m_busy_poll_us);
+                    session->set_flush_delay(m_flush_delay_us);
                     m_acceptor.async_accept(session->get_socket(), std::bind(&TcpServer::handle_accept, this, std::placeholders::_1, session));
                 }
                 catch (std::exception&) {
@@ -252,6 +313,8 @@ namespace BTool
                 }
 
                 session_ptr->register_cbk(m_handler).register_close_cbk(std::bind(&TcpServer::on_close_cbk, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+                if (m_frame_decoder && m_frame_cbk)
+                    session_ptr->register_frame_cbk(m_frame_decoder, m_frame_cbk);
 
                 {
                     std::lock_guard<std::mutex> lock(m_mutex);
@@ -296,9 +359,15 @@ namespace BTool
             AsioContextPool&                    m_ioc_pool;
             accept_type                         m_acceptor;
             NetCallBack                         m_handler;
+            FrameDecoder                        m_frame_decoder;
+            NetCallBack::frame_cbk              m_frame_cbk;
             NetCallBack::server_error_cbk       m_error_handler = nullptr;
             size_t                              m_max_wbuffer_size;
             size_t                              m_max_rbuffer_size;
+            size_t                              m_max_gather_count;
+            size_t                              m_max_gather_size;
+            unsigned                            m_busy_poll_us = 0;
+            unsigned                            m_flush_delay_us = 0;
 
             mutable std::mutex                  m_mutex;
             // Ӷ󣬺ڸΪڴ飬ʡ/ͷڴʱ
@@ -3,7 +3,8 @@ File name:  tcp_session.hpp
 Author:	    AChar
 Purpose:    tcp
 Note:       Ϊⲿܵ޻,ⲿȡݺҪconsume_read_buf,
-            Դɾ
+            Դɾ; Ϊλ, Ϊmax_rbuffer_sizeҳȡ
+            ͨregister_frame_cbk÷֡ص, ֡صԶ, consume_read_buf
 
 Special Note: 캯ioc_type& iocΪⲿ,ҪͷŸö֮ͷioc
             ͵ⲿʹʹҪioc,Ȼö,:
@@ -29,11 +30,16 @@ Special Note: 
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <mutex>
 #include <string>
+#include <vector>
 #include <boost/asio.hpp>
 #include "net_callback.hpp"
 #include "net_buffer.hpp"
+#include "frame_decoder.hpp"
+#include "handler_memory.hpp"
 #include "../atomic_switch.hpp"
 
 namespace BTool
@@ -46,8 +52,9 @@ namespace BTool
         public:
             typedef boost::asio::ip::tcp::socket        socket_type;
             typedef boost::asio::io_context             ioc_type;
-            typedef ReadBuffer                          ReadBufferType;
-            typedef WriteBuffer<1024>                   WriteBufferType;
+            typedef boost::asio::strand<ioc_type::executor_type>    strand_type;
+            typedef MirrorReadBuffer                    ReadBufferType;
+            typedef ConcurrentWriteBuffer<1024>         WriteBufferType;
             typedef WriteBufferType::WriteMemoryStreamPtr   WriteMemoryStreamPtr;
             typedef NetCallBack::SessionID              SessionID;
 
@@ -55,6 +62,36 @@ namespace BTool
                 NOLIMIT_WRITE_BUFFER_SIZE = 0, // 
                 MAX_WRITE_BUFFER_SIZE = 30000,
                 MAX_READSINGLE_BUFFER_SIZE = 2000,
+                MAX_GATHER_WRITE_COUNT = 64,    // ξۺϷϢ
+                MAX_GATHER_WRITE_SIZE = 65536,  // ξۺϷֽ
+                READ_HANDLER_MEMORY_SIZE = 512,     // ڴС
+                WRITE_HANDLER_MEMORY_SIZE = 4096,   // дڴС, ۺдںͻ
+                POST_HANDLER_MEMORY_SIZE = 512,     // ͶڴС
+            };
+
+            // ۺϷͻ, Ϊķӵͼ, 첽дʱָ뼰
+            struct GatherBuffers {
+                typedef boost::asio::const_buffer           value_type;
+                typedef const boost::asio::const_buffer*    const_iterator;
+
+                const_iterator begin() const { return bufs_; }
+                const_iterator end() const { return bufs_ + count_; }
+
+                const boost::asio::const_buffer*    bufs_;
+                size_t                              count_;
+            };
+
+            // ͳ
+            struct WriteStats {
+                unsigned long long send_calls = 0;  // ϵͳô
+                unsigned long long send_batchs = 0; // ۺϷ
+                unsigned long long send_msgs = 0;   // ѷϢ
+                unsigned long long send_bytes = 0;  // ѷֽ
+
+                // ƽÿϢķϵͳô
+                double calls_per_msg() const {
+                    return send_msgs == 0 ? 0 : double(send_calls) / send_msgs;
+                }
             };
 
         public:
@@ -65,12 +102,25 @@ namespace BTool
             TcpSession(ioc_type& ioc, size_t max_wbuffer_size = NOLIMIT_WRITE_BUFFER_SIZE, size_t max_rbuffer_size = MAX_READSINGLE_BUFFER_SIZE)
                 : m_socket(ioc)
                 , m_io_context(ioc)
+                , m_strand(boost::asio::make_strand(ioc))
                 , m_session_id(GetNextSessionID())
                 , m_overtime_timer(ioc)
+                , m_flush_timer(ioc)
+                , m_read_buf(max_rbuffer_size)
                 , m_max_rbuffer_size(max_rbuffer_size)
-                , m_current_send_msg(nullptr)
+                , m_writing(false)
+                , m_write_pending(false)
+                , m_sending_count(0)
+                , m_sending_size(0)
                 , m_max_wbuffer_size(max_wbuffer_size)
+                , m_max_gather_count(MAX_GATHER_WRITE_COUNT)
+                , m_max_gather_size(MAX_GATHER_WRITE_SIZE)
+                , m_busy_poll_us(0)
+                , m_flush_delay_us(0)
                 , m_connect_port(0)
+                , m_read_memory(READ_HANDLER_MEMORY_SIZE)
+                , m_write_memory(WRITE_HANDLER_MEMORY_SIZE)
+                , m_post_memory(POST_HANDLER_MEMORY_SIZE)
             {
             }
 
@@ -105,6 +155,49 @@ namespace BTool
                 m_handler.write_cbk_ = cbk;
                 return *this;
             }
+            // ÷֡ȡص, úȡdecoder֡, ÿ֡صһβԶ, ٻصread_cbk
+            // decoder: ֡, LengthFrameDecoder/DelimiterFrameDecoder, ֡Ȳɳ
+            TcpSession& register_frame_cbk(const FrameDecoder& decoder, const NetCallBack::frame_cbk& cbk) {
+                m_frame_decoder = decoder;
+                m_frame_cbk = cbk;
+                return *this;
+            }
+
+            // õξۺϷ, ÿηɺϲmax_countmax_sizeֽڵĴϢ
+            // max_count: Ϣ, Ϊ1ʱ˻Ϊ, MAX_GATHER_WRITE_COUNT
+            // max_size: ֽ, Ϣʱɵ
+            // ע: ӿǰ
+            TcpSession& set_gather_limit(size_t max_count, size_t max_size) {
+                m_max_gather_count = max_count == 0 ? 1 : std::min<size_t>(max_count, MAX_GATHER_WRITE_COUNT);
+                m_max_gather_size = max_size;
+                return *this;
+            }
+
+            // æѯ, ӿʱΪsocketSO_BUSY_POLL(ȡʱںѯusec΢), socketΪģʽ
+            // ͨAsioContextPool::set_busy_pollʹ, SO_BUSY_POLLҪCAP_NET_ADMINȨ, ʧܲӰ
+            // ע: ӿǰ
+            TcpSession& set_busy_poll(unsigned usec) {
+                m_busy_poll_us = usec;
+                return *this;
+            }
+
+            // ÷ͺϲʱ(Nagle), ͿʱϢӳusec΢ٷ, ڼдϢϲΪwritev
+            // з;ʱ, Ϣɺ, ٶȴ; ݲ, Ӱ췢ʱ
+            // usec: Ϊ0ʱ(Ĭ), ͨȡʮ΢, ӳٻȡСϢ߲µ
+            TcpSession& set_flush_delay(unsigned usec) {
+                m_flush_delay_us = usec;
+                return *this;
+            }
+
+            // ȡͳ
+            WriteStats get_write_stats() const {
+                WriteStats stats;
+                stats.send_calls = m_send_calls.load(std::memory_order_relaxed);
+                stats.send_batchs = m_send_batchs.load(std::memory_order_relaxed);
+                stats.send_msgs = m_send_msgs.load(std::memory_order_relaxed);
+                stats.send_bytes = m_send_bytes.load(std::memory_order_relaxed);
+                return stats;
+            }
 
             // socket
             socket_type& get_socket() {
@@ -146,14 +239,15 @@ namespace BTool
 
                 m_overtime_timer.cancel();
                 m_overtime_timer.expires_from_now(boost::posix_time::milliseconds(2000));
+                // ӷȴ, ӻصȡڵȴע, ӳɹԱʱر
+                m_overtime_timer.async_wait(boost::asio::bind_executor(m_strand, std::bind(&TcpSession::handle_overtimer, shared_from_this(), std::placeholders::_1)));
 #if BOOST_VERSION >= 108000
                 m_socket.async_connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::make_address(ip), port)
-                                    ,std::bind(&TcpSession::handle_connect, shared_from_this(), std::placeholders::_1));
+                                    ,boost::asio::bind_executor(m_strand, std::bind(&TcpSession::handle_connect, shared_from_this(), std::placeholders::_1)));
 #else
                 m_socket.async_connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string(ip), port)
-                                    ,std::bind(&TcpSession::handle_connect, shared_from_this(), std::placeholders::_1));
+                                    ,boost::asio::bind_executor(m_strand, std::bind(&TcpSession::handle_connect, shared_from_this(), std::placeholders::_1)));
 #endif
-                m_overtime_timer.async_wait(std::bind(&TcpSession::handle_overtimer, shared_from_this(), std::placeholders::_1));
             }
 
             // ͻ˿,ͬʱȡ
@@ -178,73 +272,52 @@ namespace BTool
                 close(ec);
             }
 
-            // ΪָɸΪȡͻ, ʵַ͸
-            // WriteMemoryStreamPtr acquire_buffer(const char* const msg, size_t len) {
-            //     std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
-            //     return m_write_buf.acquire(msg, len);
-            // }
-            // bool write(const WriteMemoryStreamPtr& buffer) {
-            //     std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
-            //     if (!m_atomic_switch.has_started()) {
-            //         return false;
-            //     }
-            //     if (m_max_wbuffer_size > NOLIMIT_WRITE_BUFFER_SIZE && m_write_buf.size() + buffer->size() > m_max_wbuffer_size) {
-            //         return false;
-            //     }
-            //     if (!m_write_buf.append(std::move(buffer))) {
-            //         return false;
-            //     }
-            //     // Ƿڷ״̬
-            //     if (m_current_send_msg) {
-            //         return true;
-            //     }
-            //     write();
-            //     return true;
-            // }
-
-            // д
-            bool write(const char* send_msg, size_t size) {
-                std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
-                if (!m_atomic_switch.has_started()) {
+            // ȡյķͻڵ, ÷ֱлwrite(WriteMemoryStreamPtr&&)ύ, ʵַ͸
+            // ɶ߳ͬʱ
+            WriteMemoryStreamPtr acquire_buffer() {
+                return m_write_buf.acquire(nullptr, 0);
+            }
+            // дķͻڵ, ʧʱڵ黹
+            bool write(WriteMemoryStreamPtr&& buffer) {
+                if (!buffer)
                     return false;
-                }
-                if (m_max_wbuffer_size > NOLIMIT_WRITE_BUFFER_SIZE && m_write_buf.size() + size > m_max_wbuffer_size) {
+                if (!m_atomic_switch.has_started()
+                    || (m_max_wbuffer_size > NOLIMIT_WRITE_BUFFER_SIZE && m_write_buf.size() + buffer->size() > m_max_wbuffer_size)) {
+                    m_write_buf.release(buffer);
                     return false;
                 }
-                if (!m_write_buf.append(send_msg, size)) {
+                if (!m_write_buf.append(std::move(buffer))) {
                     return false;
                 }
-                // Ƿڷ״̬
-                if (m_current_send_msg) {
-                    return true;
-                }
 
-                write();
+                post_write();
                 return true;
             }
 
-            // ڵǰϢβ׷
-            // max_package_size: Ϣ
-            bool write_tail(const char* send_msg, size_t size, size_t max_package_size = 65535) {
-                std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
+            // д, , ɶ߳ͬʱ
+            // дк, ͱ־߳̽ͲͶӵstrand, ͬһʱһ
+            bool write(const char* send_msg, size_t size) {
                 if (!m_atomic_switch.has_started()) {
                     return false;
                 }
                 if (m_max_wbuffer_size > NOLIMIT_WRITE_BUFFER_SIZE && m_write_buf.size() + size > m_max_wbuffer_size) {
                     return false;
                 }
-                if (!m_write_buf.append_tail(send_msg, size, max_package_size)) {
+                if (!m_write_buf.append(send_msg, size)) {
                     return false;
                 }
-                // Ƿڷ״̬
-                if (m_current_send_msg) {
-                    return true;
-                }
 
-                write();
+                post_write();
                 return true;
             }
 
+            // ڵǰϢβ׷
+            // ɷ̶߳ռ, ԭغϲ, СϢڷʱۺΪwritev, Чͬ
+            // max_package_size: Ϣ, Լԭнӿ
+            bool write_tail(const char* send_msg, size_t size, size_t /*max_package_size*/ = 65535) {
+                return write(send_msg, size);
+            }
+
             // ѵָȵĶ
             void consume_read_buf(size_t bytes_transferred) {
                 if (m_atomic_switch.has_stoped()) {
@@ -256,17 +329,21 @@ namespace BTool
 
         protected:
             static SessionID GetNextSessionID() {
-                static std::atomic<SessionID> next_session_id(NetCallBack::InvalidSessionID);
-                return ++next_session_id;
+                return NetCallBack::GetNextSessionID();
             }
 
         private:
             // 첽
             bool read() {
                 //try {
-                    m_socket.async_read_some(m_read_buf.prepare(m_max_rbuffer_size - m_read_buf.size()),
-                        std::bind(&TcpSession::handle_read, shared_from_this(),
-                            std::placeholders::_1, std::placeholders::_2));
+                    // ⲿδ, ޷ȡ
+                    if (m_read_buf.free_size() == 0) {
+                        shutdown(boost::asio::error::no_buffer_space);
+                        return false;
+                    }
+                    m_socket.async_read_some(m_read_buf.prepare(m_read_buf.free_size()),
+                        boost::asio::bind_executor(m_strand, MakeAllocHandler(m_read_memory, std::bind(&TcpSession::handle_read, shared_from_this(),
+                            std::placeholders::_1, std::placeholders::_2))));
                     return true;
                 // }
                 // catch (...) {
@@ -275,13 +352,72 @@ namespace BTool
                 // }
             }
 
-            // 첽д
+            // ǼǷռͱ־, ɹͶݷͲ
+            // Ӻ, ͱ־ͷű־ݷǷͶ
+            void post_write() {
+                m_write_pending.exchange(true);
+                if (m_writing.exchange(true))
+                    return;
+                start_write();
+            }
+
+            // ͶݷͲӵstrand, /ȡص, ɷͱ־ߵ
+            // io_contextתɷstrand, ʱstrandio߳ھ͵ص, Ͷȫ̽ʹm_post_memory
+            void start_write() {
+                auto self = shared_from_this();
+                // ͱ־߶ռϲʱ, ߳
+                if (m_flush_delay_us > 0) {
+                    m_flush_timer.expires_after(std::chrono::microseconds(m_flush_delay_us));
+                    m_flush_timer.async_wait(boost::asio::bind_executor(m_strand, MakeAllocHandler(m_post_memory, [self](const boost::system::error_code&) { self->write(); })));
+                    return;
+                }
+                boost::asio::post(m_io_context, MakeAllocHandler(m_post_memory, [self]() mutable {
+                    strand_type& strand = self->m_strand;
+                    HandlerMemory& memory = self->m_post_memory;
+                    boost::asio::dispatch(strand, MakeAllocHandler(memory, [self = std::move(self)]() { self->write(); }));
+                }));
+            }
+
+            // 첽д, ɷͱ־ߵ, ۺϵǰͶеĶϢ, Եwritev
             void write() {
-                m_current_send_msg = m_write_buf.pop_front();
-                boost::asio::async_write(m_socket, boost::asio::buffer(m_current_send_msg->data(), m_current_send_msg->size())
-                    , std::bind(&TcpSession::handle_write, shared_from_this()
+                if (m_atomic_switch.has_stoped()) {
+                    clear_write();
+                    return;
+                }
+
+                // , ǰǼݾɻȡ
+                m_write_pending.exchange(false);
+                m_sending_size = m_write_buf.pop_front(m_sending_msgs, m_max_gather_count, m_max_gather_size);
+                if (m_sending_msgs.empty()) {
+                    // ͷű־ٴȷ, ֹڴڼǼ־δͷŶδͶ
+                    // δǼɺͶ, ѯȴ
+                    m_writing.store(false);
+                    if (m_write_pending.load() && !m_writing.exchange(true))
+                        start_write();
+                    return;
+                }
+
+                m_sending_count = 0;
+                for (auto& msg : m_sending_msgs) {
+                    m_sending_bufs[m_sending_count++] = boost::asio::const_buffer(msg->data(), msg->size());
+                }
+
+                boost::asio::async_write(m_socket, GatherBuffers{ m_sending_bufs.data(), m_sending_count }
+                    , std::bind(&TcpSession::handle_write_some, shared_from_this()
                         , std::placeholders::_1
-                        , std::placeholders::_2));
+                        , std::placeholders::_2)
+                    , boost::asio::bind_executor(m_strand, MakeAllocHandler(m_write_memory, std::bind(&TcpSession::handle_write, shared_from_this()
+                        , std::placeholders::_1
+                        , std::placeholders::_2))));
+            }
+
+            // , ÿεײ㷢ǰ, ʣʱһϵͳ
+            // رʣֽ, ʹʣಿ(m_max_gather_sizeϢ)Եwritev
+            size_t handle_write_some(const boost::system::error_code& ec, size_t bytes_transferred) {
+                if (ec || bytes_transferred >= m_sending_size)
+                    return 0;
+                m_send_calls.fetch_add(1, std::memory_order_relaxed);
+                return m_sending_size - bytes_transferred;
             }
 
             // ӻص
@@ -312,11 +448,31 @@ namespace BTool
                     m_connect_port = m_socket.remote_endpoint(ec).port();
 #endif
 
+                if (m_busy_poll_us > 0)
+                    apply_busy_poll();
+                // ӦòϲȡںNagle, ԶӳȷϵӲȴ
+                if (m_flush_delay_us > 0)
+                    m_socket.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+
+                // ӶΪ, λ֡״̬
+                if (m_frame_decoder)
+                    ResetFrameDecoder(m_frame_decoder);
+
                 if (m_atomic_switch.start() && read() && m_handler.open_cbk_) {
                     m_handler.open_cbk_(m_session_id);
                 }
             }
 
+            // socketæѯ
+            void apply_busy_poll() {
+                boost::system::error_code ec;
+                m_socket.non_blocking(true, ec);
+#if defined(SO_BUSY_POLL)
+                typedef boost::asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL> busy_poll_option;
+                m_socket.set_option(busy_poll_option((int)m_busy_poll_us), ec);
+#endif
+            }
+
             // ص
             void handle_read(const boost::system::error_code& ec, size_t bytes_transferred) {
                 if (ec) {
@@ -326,7 +482,11 @@ namespace BTool
 
                 m_read_buf.commit(bytes_transferred);
 
-                if (m_handler.read_cbk_) {
+                if (m_frame_decoder && m_frame_cbk) {
+                    if (!handle_frames())
+                        return;
+                }
+                else if (m_handler.read_cbk_) {
                     m_handler.read_cbk_(m_session_id, m_read_buf.peek(), m_read_buf.size());
                 }
                 else {
@@ -340,29 +500,61 @@ namespace BTool
                 read();
             }
 
+            // ֡ǰ, ѹرջݷǷʱfalse
+            bool handle_frames() {
+                while (m_read_buf.size() > 0) {
+                    std::string_view frame;
+                    long long frame_len = m_frame_decoder(m_read_buf.peek(), m_read_buf.size(), frame);
+                    if (frame_len < 0) {
+                        shutdown(boost::asio::error::invalid_argument);
+                        return false;
+                    }
+                    if (frame_len == 0)
+                        break;
+
+                    m_frame_cbk(m_session_id, frame);
+                    if (m_atomic_switch.has_stoped())
+                        return false;
+                    m_read_buf.consume(static_cast<size_t>(frame_len));
+                }
+                return true;
+            }
+
             // дص
             void handle_write(const boost::system::error_code& ec, size_t bytes_transferred)
             {
                 if (ec) {
                     shutdown(ec);
+                    clear_write();
                     return;
                 }
                 if (m_atomic_switch.has_stoped()) {
+                    clear_write();
                     return;
                 }
 
-                if (m_handler.write_cbk_ && m_current_send_msg) {
-                    m_handler.write_cbk_(m_session_id, m_current_send_msg->data(), m_current_send_msg->size());
-                }
+                m_send_batchs.fetch_add(1, std::memory_order_relaxed);
+                m_send_msgs.fetch_add(m_sending_msgs.size(), std::memory_order_relaxed);
+                m_send_bytes.fetch_add(bytes_transferred, std::memory_order_relaxed);
 
-                std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
-                m_write_buf.release(m_current_send_msg);
-                if (m_write_buf.empty()) {
-                    return;
+                if (m_handler.write_cbk_) {
+                    for (auto& msg : m_sending_msgs) {
+                        m_handler.write_cbk_(m_session_id, msg->data(), msg->size());
+                    }
                 }
+
+                m_write_buf.release(m_sending_msgs);
                 write();
             }
 
+            // մݲͷŷͱ־, ɷͱ־ߵ
+            void clear_write() {
+                m_write_buf.release(m_sending_msgs);
+                m_write_buf.clear();
+                m_sending_count = 0;
+                m_writing.store(false);
+            }
+
             void handle_overtimer(boost::system::error_code ec) {
                 if (!ec) {
                     m_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
@@ -373,15 +565,13 @@ namespace BTool
             void close(const boost::system::error_code& ec) {
                 {
                     boost::system::error_code ignored_ec;
-                    std::lock_guard<std::recursive_mutex> lock(m_write_mtx);
                     m_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored_ec);
                     if (m_atomic_switch.has_init())
                         m_socket.close(ignored_ec);
 
                     m_atomic_switch.reset();
                     m_read_buf.consume(m_read_buf.size());
-                    m_write_buf.clear();
-                    m_current_send_msg.reset();
+                    // ɷͱ־ڷͻص
                 }
 
                 if (m_handler.close_cbk_) {
@@ -394,26 +584,56 @@ namespace BTool
             // asiosocketװ
             socket_type             m_socket;
             ioc_type&               m_io_context;
+            // //дصͶstrand, ߳iocʱ֤ͬһӵĻص
+            strand_type             m_strand;
             SessionID               m_session_id;
 
             boost::asio::deadline_timer m_overtime_timer;
+            // ͺϲʱ
+            boost::asio::steady_timer   m_flush_timer;
 
             // 
             ReadBufferType          m_read_buf;
             // С
             size_t                  m_max_rbuffer_size;
 
-            // дݱ
-            std::recursive_mutex    m_write_mtx;
             // д
             WriteBufferType         m_write_buf;
+            // Ƿзڷ
+            std::atomic<bool>       m_writing;
+            // ǷӴ͵ݵǼ˷
+            std::atomic<bool>       m_write_pending;
             // ǰڷ͵Ļ
-            WriteMemoryStreamPtr    m_current_send_msg;
+            std::vector<WriteMemoryStreamPtr>       m_sending_msgs;
+            // ǰڷ͵ľۺϻ, , GatherBuffersͼasync_write, ʱ
+            std::array<boost::asio::const_buffer, MAX_GATHER_WRITE_COUNT>   m_sending_bufs;
+            size_t                  m_sending_count;
+            // ǰڷ͵ֽ
+            size_t                  m_sending_size;
             // дС
             size_t                  m_max_wbuffer_size;
+            // ξۺϷϢ
+            size_t                  m_max_gather_count;
+            // ξۺϷֽ
+            size_t                  m_max_gather_size;
+
+            // ͳ
+            std::atomic<unsigned long long> m_send_calls{ 0 };
+            std::atomic<unsigned long long> m_send_batchs{ 0 };
+            std::atomic<unsigned long long> m_send_msgs{ 0 };
+            std::atomic<unsigned long long> m_send_bytes{ 0 };
 
             // ص
             NetCallBack             m_handler;
+            // ֡
+            FrameDecoder            m_frame_decoder;
+            // ֡ȡص
+            NetCallBack::frame_cbk  m_frame_cbk;
+
+            // æѯʱ(΢), 0ʾ
+            unsigned                m_busy_poll_us;
+            // ͺϲʱ(΢)
+            unsigned                m_flush_delay_us;
 
             // ԭͣ־
             AtomicSwitch            m_atomic_switch;
@@ -422,6 +642,11 @@ namespace BTool
             std::string             m_connect_ip;
             // Port
             unsigned short          m_connect_port;
+
+            // /д/Ͷ첽ڴ, ͬһʱһ;, ̬²ڴ治ѷ
+            HandlerMemory           m_read_memory;
+            HandlerMemory           m_write_memory;
+            HandlerMemory           m_post_memory;
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,664 @@
+/*************************************************
+File name:  uring_context.hpp
+Author:     AChar
+Version:
+Date:
+Purpose: io_uring¼ѭ, Ϊasio epollĿѡ
+Note:    ֧Linux, ں6.0(ṩ滷5.19, ν6.0), ʱں˰汾, ʱ׳쳣
+         ֱʹϵͳ, liburing
+         UringContext: io_uringʵ¼ѭ, io_context, ĳһ߳еrun
+         UringContextPool: UringContextĶ, ӿAsioContextPoolһ
+         ¼UringContextѭ߳д, ߳ͨpostͶ
+*************************************************/
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <system_error>
+#include <thread>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+#include "../comm_function_os.hpp"
+#include "net_callback.hpp"
+
+namespace BTool
+{
+    namespace BoostNet
+    {
+        // io_uring
+        struct UringOption {
+            unsigned    entries_ = 4096;            // ύ
+            bool        sqpoll_ = false;            // Ƿںύ߳, úύϵͳ, ռһں߳
+            unsigned    sqpoll_idle_ms_ = 1000;     // ںύ߳̿ʱ
+            int         sqpoll_cpu_ = -1;           // ںύ̰߳, -1ʾ
+            unsigned    buffer_count_ = 1024;       // ṩ, ȡΪ2
+            unsigned    buffer_size_ = 4096;        // ṩС
+        };
+
+        // io_uring¼
+        class UringHandler
+        {
+        public:
+            virtual ~UringHandler() {}
+            // op: ύʱЯĲ, 16λ
+            virtual void on_complete(unsigned op, const io_uring_cqe& cqe) = 0;
+        };
+
+        // io_uring¼ѭ
+        class UringContext : private boost::noncopyable
+        {
+        public:
+            typedef unsigned long long HandlerID;
+            typedef std::function<void()> task_type;
+
+            enum {
+                WAKE_HANDLER_ID = 0,    // ڲ¼
+                OP_BITS = 16,           // user_dataвռλ
+            };
+
+        public:
+            UringContext(const UringOption& option = UringOption())
+                : m_option(option)
+                , m_ring_fd(-1)
+                , m_event_fd(-1)
+                , m_event_value(0)
+                , m_stop(false)
+                , m_wake_pending(false)
+                , m_has_tasks(false)
+                , m_running(false)
+            {
+                if (!KernelSupported())
+                    throw std::system_error(ENOSYS, std::system_category(), "io_uring multishot recv requires linux 6.0+");
+                init_ring();
+                init_buffer_ring();
+
+                m_event_fd = eventfd(0, EFD_CLOEXEC);
+                if (m_event_fd < 0) {
+                    int err = errno;
+                    destroy();
+                    throw std::system_error(err, std::system_category(), "eventfd");
+                }
+            }
+
+            ~UringContext() {
+                destroy();
+            }
+
+        public:
+            // ʽ¼ѭ, ֱstop
+            void run() {
+                m_loop_thread_id = std::this_thread::get_id();
+                m_running.store(true);
+                while (!m_stop.load(std::memory_order_acquire)) {
+                    run_tasks();
+                    // ѶȡδͶʱȴ, ߳Ͷݵstop޷ѭ, ´ѭ
+                    if (!m_wake_armed)
+                        arm_wake();
+                    submit(m_has_tasks.load(std::memory_order_acquire) || !m_wake_armed ? 0 : 1);
+                    process_cqes();
+                }
+                run_tasks();
+                m_running.store(false);
+                m_loop_thread_id = std::thread::id();
+            }
+
+            // ֹ¼ѭ, ߳е
+            void stop() {
+                m_stop.store(true, std::memory_order_release);
+                wake();
+            }
+
+            // ֹٴǰ
+            void restart() {
+                m_stop.store(false, std::memory_order_release);
+            }
+
+            bool stopped() const {
+                return m_stop.load(std::memory_order_acquire);
+            }
+
+            // ¼ѭǷ, Ͷݵrunǰִ
+            bool running() const {
+                return m_running.load();
+            }
+
+            // Ƿѭ߳
+            bool running_in_this_thread() const {
+                return m_running.load() && m_loop_thread_id == std::this_thread::get_id();
+            }
+
+            // Ͷѭִ߳, ߳е
+            void post(task_type&& task) {
+                {
+                    std::lock_guard<std::mutex> lock(m_task_mtx);
+                    m_tasks.push_back(std::move(task));
+                    m_has_tasks.store(true, std::memory_order_release);
+                }
+                // ѭ߳Ͷݵ´εȴǰִ, 軽
+                if (!running_in_this_thread())
+                    wake();
+            }
+
+            // ע/ע¼, ѭ߳е
+            void add_handler(HandlerID id, const std::shared_ptr<UringHandler>& handler) {
+                m_handlers[id] = handler;
+            }
+            void remove_handler(HandlerID id) {
+                m_handlers.erase(id);
+            }
+
+            // ȡcountύ, ռ䲻ʱύ, ѭ߳е
+            // ͬһ봦ͬһύ, һԻȡ
+            io_uring_sqe* get_sqes(unsigned count) {
+                if (count > m_sq_entries)
+                    return nullptr;
+                while (m_sqe_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) + count > m_sq_entries) {
+                    if (!submit(0, m_option.sqpoll_))
+                        return nullptr;
+                }
+                io_uring_sqe* first = &m_sqes[m_sqe_tail & m_sq_mask];
+                for (unsigned i = 0; i < count; ++i) {
+                    io_uring_sqe* sqe = &m_sqes[(m_sqe_tail + i) & m_sq_mask];
+                    memset(sqe, 0, sizeof(io_uring_sqe));
+                }
+                return first;
+            }
+            // ȡһύ, get_sqesϰʹ
+            io_uring_sqe* next_sqe() {
+                io_uring_sqe* sqe = &m_sqes[m_sqe_tail & m_sq_mask];
+                ++m_sqe_tail;
+                return sqe;
+            }
+
+            // ȫΨһĴID, 0ڲ¼
+            // asioӹIDԴ, ӶֱΪID
+            static HandlerID GetNextHandlerID() {
+                return NetCallBack::GetNextSessionID();
+            }
+
+            // ǰںǷ֧, ν(IORING_RECV_MULTISHOT)6.0֧
+            static bool KernelSupported() {
+                utsname name;
+                if (uname(&name) != 0)
+                    return false;
+                int major = 0;
+                if (sscanf(name.release, "%d", &major) != 1)
+                    return false;
+                return major >= 6;
+            }
+
+            // user_data
+            static unsigned long long MakeUserData(HandlerID id, unsigned op) {
+                return (id << OP_BITS) | (op & ((1u << OP_BITS) - 1));
+            }
+
+            // ṩID
+            unsigned short buffer_group() const {
+                return BUFFER_GROUP_ID;
+            }
+            // ȡṩ
+            const char* buffer_data(unsigned short bid) const {
+                return m_buffers + (size_t)bid * m_option.buffer_size_;
+            }
+            // 黹ṩ
+            void recycle_buffer(unsigned short bid) {
+                io_uring_buf* buf = &m_buf_ring[m_buf_ring_tail & m_buf_ring_mask];
+                buf->addr = (unsigned long long)(uintptr_t)buffer_data(bid);
+                buf->len = m_option.buffer_size_;
+                buf->bid = bid;
+                ++m_buf_ring_tail;
+                // β׸Ԫصresvֶص
+                __atomic_store_n(&m_buf_ring[0].resv, m_buf_ring_tail, __ATOMIC_RELEASE);
+            }
+
+        private:
+            enum {
+                BUFFER_GROUP_ID = 0,
+            };
+
+            static int SysSetup(unsigned entries, io_uring_params* params) {
+                return (int)syscall(__NR_io_uring_setup, entries, params);
+            }
+            static int SysEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+                return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+            }
+            static int SysRegister(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+                return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+            }
+
+            void init_ring() {
+                io_uring_params params;
+                memset(&params, 0, sizeof(params));
+                if (m_option.sqpoll_) {
+                    params.flags |= IORING_SETUP_SQPOLL;
+                    params.sq_thread_idle = m_option.sqpoll_idle_ms_;
+                    if (m_option.sqpoll_cpu_ >= 0) {
+                        params.flags |= IORING_SETUP_SQ_AFF;
+                        params.sq_thread_cpu = (unsigned)m_option.sqpoll_cpu_;
+                    }
+                }
+                else {
+                    // ¼ѭ߳̽ںʱ, ٺ˼ж
+                    params.flags |= IORING_SETUP_COOP_TASKRUN;
+                }
+
+                m_ring_fd = SysSetup(m_option.entries_, &params);
+                if (m_ring_fd < 0 && errno == EINVAL && (params.flags & IORING_SETUP_COOP_TASKRUN)) {
+                    params.flags &= ~IORING_SETUP_COOP_TASKRUN;
+                    m_ring_fd = SysSetup(m_option.entries_, &params);
+                }
+                if (m_ring_fd < 0)
+                    throw std::system_error(errno, std::system_category(), "io_uring_setup");
+
+                m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single_mmap)
+                    m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+
+                m_sq_ring = mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQ_RING);
+                if (m_sq_ring == MAP_FAILED) {
+                    m_sq_ring = nullptr;
+                    fail_init("mmap sq ring");
+                }
+                if (single_mmap) {
+                    m_cq_ring = m_sq_ring;
+                }
+                else {
+                    m_cq_ring = mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_CQ_RING);
+                    if (m_cq_ring == MAP_FAILED) {
+                        m_cq_ring = nullptr;
+                        fail_init("mmap cq ring");
+                    }
+                }
+                m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+                void* sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+                if (sqes == MAP_FAILED)
+                    fail_init("mmap sqes");
+                m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+                char* sq = static_cast<char*>(m_sq_ring);
+                m_sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+                m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                m_sq_flags = reinterpret_cast<unsigned*>(sq + params.sq_off.flags);
+                m_sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                m_sq_entries = params.sq_entries;
+                // ύ±±һһӦ
+                unsigned* sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+                for (unsigned i = 0; i < m_sq_entries; ++i)
+                    sq_array[i] = i;
+
+                char* cq = static_cast<char*>(m_cq_ring);
+                m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                m_cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+                m_sqe_tail = *m_sq_tail;
+                m_sqe_submitted = m_sqe_tail;
+            }
+
+            void init_buffer_ring() {
+                unsigned count = 1;
+                while (count < m_option.buffer_count_)
+                    count <<= 1;
+                m_option.buffer_count_ = count;
+                m_buf_ring_mask = count - 1;
+
+                m_buf_ring_size = count * sizeof(io_uring_buf);
+                void* ring = mmap(nullptr, m_buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (ring == MAP_FAILED)
+                    fail_init("mmap buffer ring");
+                // C++io_uring_buf_ringԱƫ, ֱӰio_uring_buf
+                m_buf_ring = static_cast<io_uring_buf*>(ring);
+
+                m_buffers_size = (size_t)count * m_option.buffer_size_;
+                void* buffers = mmap(nullptr, m_buffers_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (buffers == MAP_FAILED)
+                    fail_init("mmap buffers");
+                m_buffers = static_cast<char*>(buffers);
+
+                io_uring_buf_reg reg;
+                memset(&reg, 0, sizeof(reg));
+                reg.ring_addr = (unsigned long long)(uintptr_t)m_buf_ring;
+                reg.ring_entries = count;
+                reg.bgid = BUFFER_GROUP_ID;
+                if (SysRegister(m_ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+                    fail_init("register buffer ring");
+
+                m_buf_ring_tail = 0;
+                for (unsigned i = 0; i < count; ++i)
+                    recycle_buffer((unsigned short)i);
+            }
+
+            void fail_init(const char* what) {
+                int err = errno;
+                destroy();
+                throw std::system_error(err, std::system_category(), what);
+            }
+
+            void destroy() {
+                // ȹرio_uring, ʹں˲ٷʺͷŵӳڴ
+                if (m_ring_fd >= 0) {
+                    close(m_ring_fd);
+                    m_ring_fd = -1;
+                }
+                if (m_event_fd >= 0) {
+                    close(m_event_fd);
+                    m_event_fd = -1;
+                }
+                if (m_buffers) {
+                    munmap(m_buffers, m_buffers_size);
+                    m_buffers = nullptr;
+                }
+                if (m_buf_ring) {
+                    munmap(m_buf_ring, m_buf_ring_size);
+                    m_buf_ring = nullptr;
+                }
+                if (m_sqes) {
+                    munmap(m_sqes, m_sqes_size);
+                    m_sqes = nullptr;
+                }
+                if (m_cq_ring && m_cq_ring != m_sq_ring)
+                    munmap(m_cq_ring, m_cq_ring_size);
+                m_cq_ring = nullptr;
+                if (m_sq_ring) {
+                    munmap(m_sq_ring, m_sq_ring_size);
+                    m_sq_ring = nullptr;
+                }
+                m_handlers.clear();
+            }
+
+            // ύǰύ, ȴwait_nr¼
+            // sq_wait: SQPOLLģʽµȴںύ߳ڳύпռ
+            bool submit(unsigned wait_nr, bool sq_wait = false) {
+                unsigned to_submit = m_sqe_tail - m_sqe_submitted;
+                __atomic_store_n(m_sq_tail, m_sqe_tail, __ATOMIC_RELEASE);
+                m_sqe_submitted = m_sqe_tail;
+
+                unsigned flags = 0;
+                if (m_option.sqpoll_) {
+                    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+                    if (__atomic_load_n(m_sq_flags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP)
+                        flags |= IORING_ENTER_SQ_WAKEUP;
+                    if (sq_wait)
+                        flags |= IORING_ENTER_SQ_WAIT;
+                    // ں߳лȡύ, ȴʱȥϵͳ
+                    if (flags == 0 && wait_nr == 0)
+                        return true;
+                }
+                else if (to_submit == 0 && wait_nr == 0) {
+                    return true;
+                }
+                // δ¼ʱ
+                if (wait_nr > 0 && cq_ready() > 0)
+                    wait_nr = 0;
+                if (wait_nr > 0)
+                    flags |= IORING_ENTER_GETEVENTS;
+
+                for (;;) {
+                    int ret = SysEnter(m_ring_fd, m_option.sqpoll_ ? 0 : to_submit, wait_nr, flags);
+                    if (ret >= 0)
+                        return true;
+                    if (errno == EINTR)
+                        continue;
+                    // ɶ, ɵ÷¼
+                    if (errno == EBUSY || errno == EAGAIN) {
+                        process_cqes();
+                        if (wait_nr == 0 && to_submit == 0)
+                            return true;
+                        continue;
+                    }
+                    return false;
+                }
+            }
+
+            unsigned cq_ready() const {
+                return __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE) - *m_cq_head;
+            }
+
+            void process_cqes() {
+                unsigned head = *m_cq_head;
+                unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+                while (head != tail) {
+                    // ȸƲƽͷ, пٴύ
+                    io_uring_cqe cqe = m_cqes[head & m_cq_mask];
+                    ++head;
+                    __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+                    dispatch(cqe);
+                    if (head == tail)
+                        tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+                }
+            }
+
+            void dispatch(const io_uring_cqe& cqe) {
+                HandlerID id = cqe.user_data >> OP_BITS;
+                unsigned op = (unsigned)(cqe.user_data & ((1u << OP_BITS) - 1));
+                if (id == WAKE_HANDLER_ID) {
+                    m_wake_armed = false;
+                    m_wake_pending.store(false, std::memory_order_release);
+                    // wake()е: ѱ־ȡm_has_tasks֮䲻,
+                    // ͶݷԼѱ־дeventfd, ѭȴδ
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (!m_stop.load(std::memory_order_acquire))
+                        arm_wake();
+                    return;
+                }
+
+                auto iter = m_handlers.find(id);
+                if (iter == m_handlers.end())
+                    return;
+                // пע, 
+                std::shared_ptr<UringHandler> handler = iter->second;
+                handler->on_complete(op, cqe);
+            }
+
+            // Ͷeventfdȡ, ڿ̻߳, ȡύʧʱrun´ѭ
+            void arm_wake() {
+                io_uring_sqe* sqe = get_sqes(1);
+                if (!sqe)
+                    return;
+                next_sqe();
+                m_wake_armed = true;
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = m_event_fd;
+                sqe->addr = (unsigned long long)(uintptr_t)&m_event_value;
+                sqe->len = sizeof(m_event_value);
+                sqe->user_data = MakeUserData(WAKE_HANDLER_ID, 0);
+            }
+
+            void wake() {
+                // dispatchе: ǰдm_has_tasks/m_stopȡѱ־֮䲻
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (m_wake_pending.exchange(true, std::memory_order_acq_rel))
+                    return;
+                unsigned long long value = 1;
+                ssize_t ret = ::write(m_event_fd, &value, sizeof(value));
+                (void)ret;
+            }
+
+            void run_tasks() {
+                if (!m_has_tasks.load(std::memory_order_acquire))
+                    return;
+
+                std::vector<task_type> tasks;
+                {
+                    std::lock_guard<std::mutex> lock(m_task_mtx);
+                    tasks.swap(m_tasks);
+                    m_has_tasks.store(false, std::memory_order_release);
+                }
+                for (auto& task : tasks) {
+                    task();
+                }
+            }
+
+        private:
+            UringOption             m_option;
+            int                     m_ring_fd;
+
+            // ύ
+            void*                   m_sq_ring = nullptr;
+            size_t                  m_sq_ring_size = 0;
+            io_uring_sqe*           m_sqes = nullptr;
+            size_t                  m_sqes_size = 0;
+            unsigned*               m_sq_head = nullptr;
+            unsigned*               m_sq_tail = nullptr;
+            unsigned*               m_sq_flags = nullptr;
+            unsigned                m_sq_mask = 0;
+            unsigned                m_sq_entries = 0;
+            // ύβ
+            unsigned                m_sqe_tail = 0;
+            // ύں˵ύβ
+            unsigned                m_sqe_submitted = 0;
+
+            // ɶ
+            void*                   m_cq_ring = nullptr;
+            size_t                  m_cq_ring_size = 0;
+            unsigned*               m_cq_head = nullptr;
+            unsigned*               m_cq_tail = nullptr;
+            unsigned                m_cq_mask = 0;
+            io_uring_cqe*           m_cqes = nullptr;
+
+            // ṩ滷
+            io_uring_buf*           m_buf_ring = nullptr;
+            size_t                  m_buf_ring_size = 0;
+            unsigned short          m_buf_ring_tail = 0;
+            unsigned                m_buf_ring_mask = 0;
+            char*                   m_buffers = nullptr;
+            size_t                  m_buffers_size = 0;
+
+            // ̻߳
+            int                     m_event_fd;
+            unsigned long long      m_event_value;
+            // ǷͶeventfdȡ, ѭ̷߳
+            bool                    m_wake_armed = false;
+
+            std::atomic<bool>       m_stop;
+            std::atomic<bool>       m_wake_pending;
+            std::atomic<bool>       m_has_tasks;
+            std::atomic<bool>       m_running;
+            std::thread::id         m_loop_thread_id;
+
+            std::mutex              m_task_mtx;
+            std::vector<task_type>  m_tasks;
+
+            // ¼, ѭ̷߳
+            std::unordered_map<HandlerID, std::shared_ptr<UringHandler>> m_handlers;
+        };
+
+        // UringContextĶ, ӿAsioContextPoolһ
+        class UringContextPool : private boost::noncopyable
+        {
+        public:
+            typedef UringContext                    ioc_type;
+            typedef std::shared_ptr<ioc_type>       ioc_ptr_type;
+
+            // pool_size ȱʡʱ,ǻcpu
+            UringContextPool(int pool_size = 0, bool auto_start = true, const std::vector<int>& bind_cores = {}, const UringOption& option = UringOption())
+                : m_pool_size(pool_size)
+                , m_next_ioc_index(0)
+                , m_bstart(false)
+                , m_bind_cores(bind_cores)
+                , m_option(option)
+            {
+                if (m_pool_size <= 0)
+                    m_pool_size = boost::thread::hardware_concurrency();
+
+                if (auto_start)
+                    start();
+            }
+
+            ~UringContextPool() {
+                stop();
+            }
+
+            // ʽ
+            void start() {
+                bool expected = false;
+                if (!m_bstart.compare_exchange_strong(expected, true))  // ˳
+                    return;
+
+                init(m_pool_size);
+            }
+
+            // ʽ,ʹjoin_allȴ
+            void run() {
+                start();
+                m_threads.join_all();
+            }
+
+            // ֹͣ,ܲ
+            void stop() {
+                bool expected = true;
+                if (!m_bstart.compare_exchange_strong(expected, false))  // ֹ˳
+                    return;
+
+                reset_sync();
+            }
+
+            // ѭȡUringContext
+            ioc_type& get_io_context() {
+                auto& result = *m_io_contexts[m_next_ioc_index];
+                if (++m_next_ioc_index == m_pool_size)
+                    m_next_ioc_index = 0;
+                return result;
+            }
+
+        private:
+            void run_io_context(ioc_type& ioc, int core_id) {
+                if (core_id >= 0)
+                    CommonOS::BindCore(core_id);
+                ioc.run();
+            }
+
+            void init(int pool_size) {
+                reset_sync();
+
+                for (int i = 0; i < pool_size; i++) {
+                    auto new_ioc = std::make_shared<ioc_type>(m_option);
+                    m_io_contexts.emplace_back(new_ioc);
+                    int core_id = (int)m_bind_cores.size() > i ? m_bind_cores[i] : -1;
+                    m_threads.create_thread(boost::bind(&UringContextPool::run_io_context, this, boost::ref(*new_ioc), core_id));
+                }
+            }
+
+            void reset_sync() {
+                for (auto& ioc_ptr : m_io_contexts)
+                    ioc_ptr->stop();
+
+                m_threads.join_all();
+                m_io_contexts.clear();
+                m_next_ioc_index = 0;
+            }
+
+        private:
+            // ̳߳ظ
+            int                         m_pool_size;
+            // һUringContext±
+            int                         m_next_ioc_index;
+            // UringContextĶ
+            std::vector<ioc_ptr_type>   m_io_contexts;
+            // ̳߳
+            boost::thread_group         m_threads;
+            // Ƿѿ
+            std::atomic<bool>           m_bstart;
+            // 
+            std::vector<int>            m_bind_cores;
+            // io_uring
+            UringOption                 m_option;
+        };
+    }
+}
@@ -0,0 +1,415 @@
+/*************************************************
+File name:      uring_tcp_server.hpp
+Author:			AChar
+Version:
+Date:
+Purpose: io_uringʵּ˿, ӿTcpServerһ
+Note:    server洢session,ⲿṩIDв
+         öν(multishot accept), һύ, ѯUringContext
+         close/clearΪ첽ر, close_cbkѭ߳лص
+*************************************************/
+
+#pragma once
+
+#include <mutex>
+#include <set>
+#include <map>
+#include <condition_variable>
+#include "uring_tcp_session.hpp"
+#include "net_callback.hpp"
+
+namespace BTool
+{
+    namespace BoostNet
+    {
+        // io_uring TCP
+        class UringTcpServer
+        {
+            typedef NetCallBack::SessionID                  SessionID;
+            typedef UringContextPool::ioc_type              ioc_type;
+            typedef std::shared_ptr<UringTcpSession>        TcpSessionPtr;
+            typedef std::map<SessionID, TcpSessionPtr>      TcpSessionMap;
+
+            // ¼, UringContext
+            class Acceptor : public UringHandler
+            {
+            public:
+                Acceptor(UringTcpServer* server) : m_server(server) {}
+
+                void on_complete(unsigned /*op*/, const io_uring_cqe& cqe) override {
+                    if (m_server)
+                        m_server->handle_accept(cqe);
+                    else if (cqe.res >= 0)
+                        ::close(cqe.res);
+                }
+
+                UringTcpServer* m_server;
+            };
+
+        public:
+            // TCP
+            UringTcpServer(UringContextPool& ioc, size_t max_wbuffer_size = UringTcpSession::NOLIMIT_WRITE_BUFFER_SIZE, size_t max_rbuffer_size = UringTcpSession::MAX_READSINGLE_BUFFER_SIZE)
+                : m_ioc_pool(ioc)
+                , m_listen_ioc(nullptr)
+                , m_listen_fd(-1)
+                , m_acceptor_id(ioc_type::GetNextHandlerID())
+                , m_max_wbuffer_size(max_wbuffer_size)
+                , m_max_rbuffer_size(max_rbuffer_size)
+                , m_max_gather_count(UringTcpSession::MAX_GATHER_WRITE_COUNT)
+                , m_max_gather_size(UringTcpSession::MAX_GATHER_WRITE_SIZE)
+            {
+            }
+
+            ~UringTcpServer() {
+                m_handler = NetCallBack();
+                m_error_handler = nullptr;
+                stop();
+            }
+
+            // üص
+            UringTcpServer& register_error_cbk(const NetCallBack::server_error_cbk& cbk) {
+                m_error_handler = cbk;
+                return *this;
+            }
+
+            // ûص,øʽɻصͬзֿ
+            UringTcpServer& register_cbk(const NetCallBack& handler) {
+                m_handler = handler;
+                return *this;
+            }
+            // ÿӻص
+            UringTcpServer& register_open_cbk(const NetCallBack::open_cbk& cbk) {
+                m_handler.open_cbk_ = cbk;
+                return *this;
+            }
+            // ùرӻص
+            UringTcpServer& register_close_cbk(const NetCallBack::close_cbk& cbk) {
+                m_handler.close_cbk_ = cbk;
+                return *this;
+            }
+            // öȡϢص
+            UringTcpServer& register_read_cbk(const NetCallBack::read_cbk& cbk) {
+                m_handler.read_cbk_ = cbk;
+                return *this;
+            }
+            // ѷϢص
+            UringTcpServer& register_write_cbk(const NetCallBack::write_cbk& cbk) {
+                m_handler.write_cbk_ = cbk;
+                return *this;
+            }
+            // ÷֡ȡص, ÿӳdecoderĶ, úٻصread_cbk
+            UringTcpServer& register_frame_cbk(const FrameDecoder& decoder, const NetCallBack::frame_cbk& cbk) {
+                m_frame_decoder = decoder;
+                m_frame_cbk = cbk;
+                return *this;
+            }
+
+            // ӵξۺϷ, ǰ
+            UringTcpServer& set_gather_limit(size_t max_count, size_t max_size) {
+                m_max_gather_count = max_count;
+                m_max_gather_size = max_size;
+                return *this;
+            }
+
+            // ʽ,
+            // ip: IP,ĬϱIPV4ַ
+            // port: ˿
+            // reuse_address: Ƿö˿ڸ
+            bool start(unsigned short port, bool reuse_address = true) {
+                return start(nullptr, port, reuse_address);
+            }
+            bool start(const char* ip, unsigned short port, bool reuse_address = true) {
+                return start_listen(ip, port, reuse_address);
+            }
+            bool start(const boost::asio::ip::tcp::endpoint& endpoint, bool reuse_address = true) {
+                return start_listen(endpoint, reuse_address);
+            }
+
+            // ʽ,ʹjoin_allȴ
+            void run(unsigned short port, bool reuse_address = false) {
+                run(nullptr, port, reuse_address);
+            }
+            void run(const char* ip, unsigned short port, bool reuse_address = false) {
+                if (!start_listen(ip, port, reuse_address)) {
+                    return;
+                }
+                m_ioc_pool.run();
+            }
+            void run(const boost::asio::ip::tcp::endpoint& endpoint, bool reuse_address = false) {
+                if (!start_listen(endpoint, reuse_address)) {
+                    return;
+                }
+                m_ioc_pool.run();
+            }
+
+            // ֹǰ
+            void stop() {
+                stop_listen();
+                clear();
+                m_ioc_pool.stop();
+                m_listen_ioc = nullptr;
+            }
+
+            // رղյǰ
+            // ע,úֹǰ,ֹյǰ,ֹstop()в
+            void clear() {
+                TcpSessionMap sessions;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    sessions.swap(m_sessions);
+                }
+                for (auto& item : sessions) {
+                    item.second->shutdown(boost::asio::error::operation_aborted);
+                }
+            }
+
+            // 첽д
+            bool write(SessionID session_id, const char* send_msg, size_t size) {
+                auto sess_ptr = find_session(session_id);
+                if (!sess_ptr) {
+                    return false;
+                }
+                return sess_ptr->write(send_msg, size);
+            }
+            // 첽Ϣ
+            // setзʧܵsession id
+            std::set<SessionID> writeAll(const char* send_msg, size_t size) {
+                std::set<SessionID> err_session;
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto& sess_ptr : m_sessions) {
+                    if (!sess_ptr.second->write(send_msg, size))
+                        err_session.emplace(sess_ptr.first);
+                }
+                return err_session;
+            }
+
+            // ڵǰϢβ׷
+            bool write_tail(SessionID session_id, const char* send_msg, size_t size, size_t max_package_size = 65535) {
+                auto sess_ptr = find_session(session_id);
+                if (!sess_ptr) {
+                    return false;
+                }
+                return sess_ptr->write_tail(send_msg, size, max_package_size);
+            }
+
+            // ѵָȵĶ, ڶȡصе
+            void consume_read_buf(SessionID session_id, size_t bytes_transferred) {
+                auto sess_ptr = find_session(session_id);
+                if (sess_ptr) {
+                    sess_ptr->consume_read_buf(bytes_transferred);
+                }
+            }
+
+            // 첽ر, close_cbkѭ߳лص
+            void close(SessionID session_id) {
+                auto sess_ptr = find_session(session_id);
+                if (sess_ptr) {
+                    sess_ptr->shutdown(boost::asio::error::operation_aborted);
+                }
+            }
+
+            // ȡIP
+            bool get_ip(SessionID session_id, std::string& ip) const {
+                auto sess_ptr = find_session(session_id);
+                if (sess_ptr) {
+                    ip = sess_ptr->get_ip();
+                    return true;
+                }
+                return false;
+            }
+
+            // ȡport
+            bool get_port(SessionID session_id, unsigned short& port) const {
+                auto sess_ptr = find_session(session_id);
+                if (sess_ptr) {
+                    port = sess_ptr->get_port();
+                    return true;
+                }
+                return false;
+            }
+
+            // ȡӷͳ
+            bool get_write_stats(SessionID session_id, UringTcpSession::WriteStats& stats) const {
+                auto sess_ptr = find_session(session_id);
+                if (sess_ptr) {
+                    stats = sess_ptr->get_write_stats();
+                    return true;
+                }
+                return false;
+            }
+
+        private:
+            // ˿
+            bool start_listen(const char* ip, unsigned short port, bool reuse_address)
+            {
+                boost::system::error_code ec;
+                boost::asio::ip::tcp::endpoint endpoint = GetEndPointByHost(ip, port, ec);
+                if (ec && ip != nullptr)
+                    return false;
+
+                return start_listen(endpoint, reuse_address);
+            }
+            bool start_listen(const boost::asio::ip::tcp::endpoint& endpoint, bool reuse_address)
+            {
+                if (m_listen_fd >= 0)
+                    return false;
+
+                int fd = ::socket(endpoint.protocol().family(), SOCK_STREAM | SOCK_CLOEXEC, 0);
+                if (fd < 0)
+                    return false;
+
+                int reuse = reuse_address ? 1 : 0;
+                setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+                if (::bind(fd, (const sockaddr*)endpoint.data(), (socklen_t)endpoint.size()) != 0
+                    || ::listen(fd, SOMAXCONN) != 0) {
+                    ::close(fd);
+                    return false;
+                }
+                m_listen_fd = fd;
+
+                // Ҫѭ߳, 
+                m_ioc_pool.start();
+                m_listen_ioc = &m_ioc_pool.get_io_context();
+                m_acceptor = std::make_shared<Acceptor>(this);
+                auto acceptor = m_acceptor;
+                m_listen_ioc->post([this, acceptor]() {
+                    m_listen_ioc->add_handler(m_acceptor_id, acceptor);
+                    start_accept();
+                });
+                return true;
+            }
+
+            // ֹ
+            void stop_listen() {
+                if (m_listen_fd < 0)
+                    return;
+
+                // ߳пڴ, Ƚٹر
+                if (m_acceptor && m_listen_ioc && m_listen_ioc->running_in_this_thread()) {
+                    m_acceptor->m_server = nullptr;
+                    m_listen_ioc->remove_handler(m_acceptor_id);
+                }
+                else if (m_acceptor && m_listen_ioc) {
+                    // ȴ״̬, ڱִʱԿɰȫ
+                    struct StopState {
+                        std::mutex mtx;
+                        std::condition_variable cv;
+                        bool done = false;
+                    };
+                    auto state = std::make_shared<StopState>();
+                    auto acceptor = m_acceptor;
+                    auto ioc = m_listen_ioc;
+                    auto id = m_acceptor_id;
+                    ioc->post([state, acceptor, ioc, id]() {
+                        acceptor->m_server = nullptr;
+                        ioc->remove_handler(id);
+                        std::lock_guard<std::mutex> lock(state->mtx);
+                        state->done = true;
+                        state->cv.notify_one();
+                    });
+                    // ѭбȴ, Ľ¼ܷı
+                    // ѭδʱᴦ¼, ٴʱ¼ִ, ȴ
+                    std::unique_lock<std::mutex> lock(state->mtx);
+                    while (!state->cv.wait_for(lock, std::chrono::milliseconds(100), [&]() { return state->done; })) {
+                        if (!ioc->running())
+                            break;
+                    }
+                }
+                ::shutdown(m_listen_fd, SHUT_RDWR);
+                ::close(m_listen_fd);
+                m_listen_fd = -1;
+                m_acceptor.reset();
+            }
+
+            // Ͷݶν, ڼ߳е
+            void start_accept() {
+                io_uring_sqe* sqe = m_listen_ioc->get_sqes(1);
+                if (!sqe) {
+                    if (m_error_handler)
+                        m_error_handler();
+                    return;
+                }
+                sqe = m_listen_ioc->next_sqe();
+                sqe->opcode = IORING_OP_ACCEPT;
+                sqe->fd = m_listen_fd;
+                sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+                sqe->accept_flags = SOCK_CLOEXEC;
+                sqe->user_data = ioc_type::MakeUserData(m_acceptor_id, 0);
+            }
+
+            // ص, ڼ߳е
+            void handle_accept(const io_uring_cqe& cqe) {
+                if (!(cqe.flags & IORING_CQE_F_MORE)) {
+                    if (cqe.res == -EBADF || cqe.res == -EINVAL) {
+                        if (m_error_handler)
+                            m_error_handler();
+                    }
+                    else {
+                        start_accept();
+                    }
+                }
+                if (cqe.res < 0)
+                    return;
+
+                TcpSessionPtr session_ptr = std::make_shared<UringTcpSession>(m_ioc_pool.get_io_context(), m_max_wbuffer_size, m_max_rbuffer_size);
+                session_ptr->assign(cqe.res);
+                session_ptr->set_gather_limit(m_max_gather_count, m_max_gather_size);
+                session_ptr->register_cbk(m_handler).register_close_cbk(std::bind(&UringTcpServer::on_close_cbk, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+                if (m_frame_decoder && m_frame_cbk)
+                    session_ptr->register_frame_cbk(m_frame_decoder, m_frame_cbk);
+
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_sessions.emplace(session_ptr->get_session_id(), session_ptr);
+                }
+
+                // ѭִ߳п
+                session_ptr->start();
+            }
+
+            // Ӷ
+            TcpSessionPtr find_session(SessionID session_id) const {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto iter = m_sessions.find(session_id);
+                if (iter == m_sessions.end()) {
+                    return TcpSessionPtr();
+                }
+                return iter->second;
+            }
+
+            // ɾӶ
+            void remove_session(SessionID session_id) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_sessions.erase(session_id);
+            }
+
+        private:
+            // رӻص
+            void on_close_cbk(SessionID session_id, const char* const msg, size_t bytes_transferred) {
+                remove_session(session_id);
+                if (m_handler.close_cbk_)
+                    m_handler.close_cbk_(session_id, msg, bytes_transferred);
+            }
+
+        private:
+            UringContextPool&                   m_ioc_pool;
+            // ڵUringContext
+            ioc_type*                           m_listen_ioc;
+            int                                 m_listen_fd;
+            UringContext::HandlerID             m_acceptor_id;
+            std::shared_ptr<Acceptor>           m_acceptor;
+            NetCallBack                         m_handler;
+            FrameDecoder                        m_frame_decoder;
+            NetCallBack::frame_cbk              m_frame_cbk;
+            NetCallBack::server_error_cbk       m_error_handler = nullptr;
+            size_t                              m_max_wbuffer_size;
+            size_t                              m_max_rbuffer_size;
+            size_t                              m_max_gather_count;
+            size_t                              m_max_gather_size;
+
+            mutable std::mutex                  m_mutex;
+            // Ӷ
+            TcpSessionMap                       m_sessions;
+        };
+    }
+}
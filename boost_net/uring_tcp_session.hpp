@@ -0,0 +1,816 @@
+/******************************************************************************
+File name:  uring_tcp_session.hpp
+Author:	    AChar
+Purpose:    io_uringtcp, ӿTcpSessionһ
+Note:       ȡöν(multishot recv)ṩ滷, һύ, ÿͶ
+            Ϊʱֱںṩص, صڼδѵʣݲſ
+            ʱÿϢԵSENDMSGۺϷ, ӵSENDMSGһύ, джʱӶϵ㴦ύʣಿ
+            лصUringContextѭִ߳, shutdownclose_cbk
+
+Special Note: 캯ioc_type& iocΪⲿ,ҪͷŸö֮ͷioc
+            ӿUringContext, ֱӹرδɲ
+*****************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "uring_context.hpp"
+#include "tcp_session.hpp"
+
+namespace BTool
+{
+    namespace BoostNet
+    {
+        // io_uring TCPӶ
+        class UringTcpSession : public UringHandler, public std::enable_shared_from_this<UringTcpSession>
+        {
+        public:
+            typedef UringContext                        ioc_type;
+            typedef MirrorReadBuffer                    ReadBufferType;
+            typedef ConcurrentWriteBuffer<1024>         WriteBufferType;
+            typedef WriteBufferType::WriteMemoryStreamPtr   WriteMemoryStreamPtr;
+            typedef NetCallBack::SessionID              SessionID;
+            typedef TcpSession::WriteStats              WriteStats;
+
+            enum {
+                NOLIMIT_WRITE_BUFFER_SIZE = TcpSession::NOLIMIT_WRITE_BUFFER_SIZE,
+                MAX_WRITE_BUFFER_SIZE = TcpSession::MAX_WRITE_BUFFER_SIZE,
+                MAX_READSINGLE_BUFFER_SIZE = TcpSession::MAX_READSINGLE_BUFFER_SIZE,
+                MAX_GATHER_WRITE_COUNT = TcpSession::MAX_GATHER_WRITE_COUNT,
+                MAX_GATHER_WRITE_SIZE = TcpSession::MAX_GATHER_WRITE_SIZE,
+                CONNECT_TIMEOUT_MS = 2000,
+                MAX_SEND_CHAIN = 8,             // ύSENDMSG
+            };
+
+        public:
+            // ioc: ioд, Ϊⲿ, ҪͷŸö֮ͷioc
+            // max_buffer_size: дС
+            // max_rbuffer_size: С
+            UringTcpSession(ioc_type& ioc, size_t max_wbuffer_size = NOLIMIT_WRITE_BUFFER_SIZE, size_t max_rbuffer_size = MAX_READSINGLE_BUFFER_SIZE)
+                : m_io_context(ioc)
+                , m_session_id(NetCallBack::GetNextSessionID())
+                , m_fd(-1)
+                , m_pending_ops(0)
+                , m_closing(false)
+                , m_reconnect(false)
+                , m_recving(false)
+                , m_read_buf(max_rbuffer_size)
+                , m_max_rbuffer_size(max_rbuffer_size)
+                , m_borrow_data(nullptr)
+                , m_borrow_size(0)
+                , m_borrow_consumed(0)
+                , m_writing(false)
+                , m_write_pending(false)
+                , m_send_completed(0)
+                , m_sending_size(0)
+                , m_max_wbuffer_size(max_wbuffer_size)
+                , m_max_gather_count(MAX_GATHER_WRITE_COUNT)
+                , m_max_gather_size(MAX_GATHER_WRITE_SIZE)
+                , m_connect_port(0)
+            {
+                memset(&m_connect_addr, 0, sizeof(m_connect_addr));
+                memset(&m_connect_ts, 0, sizeof(m_connect_ts));
+            }
+
+            ~UringTcpSession() {
+                m_handler = NetCallBack();
+                // ԱUringContextʱ, ʱδɲ
+                int fd = m_fd.exchange(-1);
+                if (fd >= 0)
+                    ::close(fd);
+            }
+
+            // ûص,øʽɻصͬзֿ
+            UringTcpSession& register_cbk(const NetCallBack& handler) {
+                m_handler = handler;
+                return *this;
+            }
+            // ÿӻص
+            UringTcpSession& register_open_cbk(const NetCallBack::open_cbk& cbk) {
+                m_handler.open_cbk_ = cbk;
+                return *this;
+            }
+            // ùرӻص
+            UringTcpSession& register_close_cbk(const NetCallBack::close_cbk& cbk) {
+                m_handler.close_cbk_ = cbk;
+                return *this;
+            }
+            // öȡϢص
+            UringTcpSession& register_read_cbk(const NetCallBack::read_cbk& cbk) {
+                m_handler.read_cbk_ = cbk;
+                return *this;
+            }
+            // ѷϢص
+            UringTcpSession& register_write_cbk(const NetCallBack::write_cbk& cbk) {
+                m_handler.write_cbk_ = cbk;
+                return *this;
+            }
+            // ÷֡ȡص, ͬTcpSession::register_frame_cbk
+            UringTcpSession& register_frame_cbk(const FrameDecoder& decoder, const NetCallBack::frame_cbk& cbk) {
+                m_frame_decoder = decoder;
+                m_frame_cbk = cbk;
+                return *this;
+            }
+
+            // õξۺϷ, SENDMSGϢ/ֽ
+            // ע: ӿǰ
+            UringTcpSession& set_gather_limit(size_t max_count, size_t max_size) {
+                m_max_gather_count = max_count == 0 ? 1 : max_count;
+                m_max_gather_size = max_size;
+                return *this;
+            }
+
+            // ȡͳ, send_callsΪύSENDMSG
+            WriteStats get_write_stats() const {
+                WriteStats stats;
+                stats.send_calls = m_send_calls.load(std::memory_order_relaxed);
+                stats.send_batchs = m_send_batchs.load(std::memory_order_relaxed);
+                stats.send_msgs = m_send_msgs.load(std::memory_order_relaxed);
+                stats.send_bytes = m_send_bytes.load(std::memory_order_relaxed);
+                return stats;
+            }
+
+            // socket
+            int get_socket() const {
+                return m_fd.load();
+            }
+
+            // UringContext
+            ioc_type& get_io_context() {
+                return m_io_context;
+            }
+
+            // Ƿѿ
+            bool is_open() const {
+                return m_atomic_switch.has_started() && m_fd.load() >= 0;
+            }
+
+            // ȡID
+            SessionID get_session_id() const {
+                return m_session_id;
+            }
+
+            // ȡIP
+            const std::string& get_ip() const {
+                return m_connect_ip;
+            }
+
+            // ȡport
+            unsigned short get_port() const {
+                return m_connect_port;
+            }
+
+            // ˽ӹѽӵ, start֮ǰ
+            void assign(int fd) {
+                m_fd.store(fd);
+            }
+
+            // ͻ˿,ͬʱȡ
+            void connect(const char* ip, unsigned short port) {
+                if (!m_atomic_switch.init())
+                    return;
+
+                m_connect_ip = ip;
+                m_connect_port = port;
+
+                auto self = shared_from_this();
+                m_io_context.post([self]() { self->do_connect(); });
+            }
+
+            // ͻ˿,ͬʱȡ
+            void reconnect() {
+                connect(m_connect_ip.c_str(), m_connect_port);
+            }
+
+            // ˿,ͬʱȡ
+            void start() {
+                if (!m_atomic_switch.init())
+                    return;
+
+                if (m_io_context.running_in_this_thread()) {
+                    handle_start();
+                    return;
+                }
+                auto self = shared_from_this();
+                m_io_context.post([self]() { self->handle_start(); });
+            }
+
+            // 첽ر, close_cbkѭ߳лص
+            void shutdown(const boost::system::error_code& ec = boost::asio::error::operation_aborted)
+            {
+                if (!m_atomic_switch.stop())
+                    return;
+
+                if (m_io_context.running_in_this_thread()) {
+                    close(ec);
+                    return;
+                }
+                auto self = shared_from_this();
+                m_io_context.post([self, ec]() { self->close(ec); });
+            }
+
+            // д, , ɶ߳ͬʱ
+            bool write(const char* send_msg, size_t size) {
+                if (!m_atomic_switch.has_started()) {
+                    return false;
+                }
+                if (m_max_wbuffer_size > NOLIMIT_WRITE_BUFFER_SIZE && m_write_buf.size() + size > m_max_wbuffer_size) {
+                    return false;
+                }
+                if (!m_write_buf.append(send_msg, size)) {
+                    return false;
+                }
+
+                post_write();
+                return true;
+            }
+
+            // ڵǰϢβ׷, ͬwrite
+            bool write_tail(const char* send_msg, size_t size, size_t /*max_package_size*/ = 65535) {
+                return write(send_msg, size);
+            }
+
+            // ѵָȵĶ, ڶȡصлѭ߳е
+            void consume_read_buf(size_t bytes_transferred) {
+                if (m_atomic_switch.has_stoped()) {
+                    return;
+                }
+
+                if (m_borrow_data) {
+                    m_borrow_consumed += std::min(bytes_transferred, m_borrow_size - m_borrow_consumed);
+                    return;
+                }
+                m_read_buf.consume(bytes_transferred);
+            }
+
+        public:
+            // ¼, UringContext
+            void on_complete(unsigned op, const io_uring_cqe& cqe) override {
+                switch (op) {
+                case OP_RECV:
+                    handle_recv(cqe);
+                    break;
+                case OP_SEND:
+                    handle_send(cqe);
+                    break;
+                case OP_CONNECT:
+                    --m_pending_ops;
+                    handle_connect(cqe.res);
+                    break;
+                default:
+                    --m_pending_ops;
+                    break;
+                }
+                release_if_idle();
+            }
+
+        private:
+            // SENDMSG͵һϢ
+            struct SendPart {
+                size_t  first_ = 0;     // Ϣ±
+                size_t  count_ = 0;     // Ϣ
+                size_t  remain_ = 0;    // ʣδֽ
+                msghdr  hdr_;
+
+                // ѷ͵ֽ, iovecϵ㴦
+                void advance(size_t n) {
+                    remain_ -= std::min(n, remain_);
+                    while (n > 0 && hdr_.msg_iovlen > 0) {
+                        iovec& iov = hdr_.msg_iov[0];
+                        if (n < iov.iov_len) {
+                            iov.iov_base = static_cast<char*>(iov.iov_base) + n;
+                            iov.iov_len -= n;
+                            return;
+                        }
+                        n -= iov.iov_len;
+                        ++hdr_.msg_iov;
+                        --hdr_.msg_iovlen;
+                    }
+                }
+            };
+
+            enum {
+                OP_RECV = 1,
+                OP_SEND,
+                OP_CONNECT,
+                OP_TIMEOUT,
+                OP_CANCEL,
+            };
+
+            static boost::system::error_code MakeErrorCode(int err) {
+                return boost::system::error_code(err, boost::system::system_category());
+            }
+
+            // ºѭִ߳
+            void do_connect() {
+                // һδͷ, ͷźٷ
+                if (m_closing) {
+                    m_reconnect = true;
+                    return;
+                }
+
+                in_addr addr;
+                if (inet_pton(AF_INET, m_connect_ip.c_str(), &addr) != 1) {
+                    close(boost::asio::error::invalid_argument);
+                    return;
+                }
+                int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                if (fd < 0) {
+                    close(MakeErrorCode(errno));
+                    return;
+                }
+                m_fd.store(fd);
+                m_io_context.add_handler(m_session_id, shared_from_this());
+
+                m_connect_addr.sin_family = AF_INET;
+                m_connect_addr.sin_port = htons(m_connect_port);
+                m_connect_addr.sin_addr = addr;
+                m_connect_ts.tv_sec = CONNECT_TIMEOUT_MS / 1000;
+                m_connect_ts.tv_nsec = (CONNECT_TIMEOUT_MS % 1000) * 1000000;
+
+                io_uring_sqe* sqe = m_io_context.get_sqes(2);
+                if (!sqe) {
+                    close(boost::asio::error::no_buffer_space);
+                    return;
+                }
+                // 볬ʱύ, ʱECANCELED
+                sqe = m_io_context.next_sqe();
+                sqe->opcode = IORING_OP_CONNECT;
+                sqe->fd = fd;
+                sqe->addr = (unsigned long long)(uintptr_t)&m_connect_addr;
+                sqe->off = sizeof(m_connect_addr);
+                sqe->flags = IOSQE_IO_LINK;
+                sqe->user_data = ioc_type::MakeUserData(m_session_id, OP_CONNECT);
+
+                sqe = m_io_context.next_sqe();
+                sqe->opcode = IORING_OP_LINK_TIMEOUT;
+                sqe->fd = -1;
+                sqe->addr = (unsigned long long)(uintptr_t)&m_connect_ts;
+                sqe->len = 1;
+                sqe->user_data = ioc_type::MakeUserData(m_session_id, OP_TIMEOUT);
+                m_pending_ops += 2;
+            }
+
+            void handle_connect(int res) {
+                if (res < 0) {
+                    close(res == -ECANCELED ? boost::asio::error::timed_out : MakeErrorCode(-res));
+                    return;
+                }
+                handle_start();
+            }
+
+            void handle_start() {
+                int fd = m_fd.load();
+                if (fd < 0) {
+                    close(boost::asio::error::bad_descriptor);
+                    return;
+                }
+                m_io_context.add_handler(m_session_id, shared_from_this());
+
+                if (m_connect_ip.empty() || m_connect_port == 0) {
+                    sockaddr_storage peer;
+                    socklen_t peer_len = sizeof(peer);
+                    if (getpeername(fd, (sockaddr*)&peer, &peer_len) == 0 && peer.ss_family == AF_INET) {
+                        sockaddr_in* peer4 = (sockaddr_in*)&peer;
+                        char ip[INET_ADDRSTRLEN] = { 0 };
+                        inet_ntop(AF_INET, &peer4->sin_addr, ip, sizeof(ip));
+                        if (m_connect_ip.empty())
+                            m_connect_ip = ip;
+                        if (m_connect_port == 0)
+                            m_connect_port = ntohs(peer4->sin_port);
+                    }
+                    else if (peer.ss_family == AF_INET6) {
+                        sockaddr_in6* peer6 = (sockaddr_in6*)&peer;
+                        char ip[INET6_ADDRSTRLEN] = { 0 };
+                        inet_ntop(AF_INET6, &peer6->sin6_addr, ip, sizeof(ip));
+                        if (m_connect_ip.empty())
+                            m_connect_ip = ip;
+                        if (m_connect_port == 0)
+                            m_connect_port = ntohs(peer6->sin6_port);
+                    }
+                }
+
+                // ӶΪ, λ֡״̬
+                if (m_frame_decoder)
+                    ResetFrameDecoder(m_frame_decoder);
+
+                if (m_atomic_switch.start() && read() && m_handler.open_cbk_) {
+                    m_handler.open_cbk_(m_session_id);
+                }
+            }
+
+            // Ͷݶν, ֱ򻺴ľǰٴͶ
+            bool read() {
+                if (m_recving)
+                    return true;
+
+                io_uring_sqe* sqe = m_io_context.get_sqes(1);
+                if (!sqe) {
+                    shutdown(boost::asio::error::no_buffer_space);
+                    return false;
+                }
+                sqe = m_io_context.next_sqe();
+                sqe->opcode = IORING_OP_RECV;
+                sqe->fd = m_fd.load();
+                sqe->ioprio = IORING_RECV_MULTISHOT;
+                sqe->flags = IOSQE_BUFFER_SELECT;
+                sqe->buf_group = m_io_context.buffer_group();
+                sqe->user_data = ioc_type::MakeUserData(m_session_id, OP_RECV);
+                m_recving = true;
+                ++m_pending_ops;
+                return true;
+            }
+
+            void handle_recv(const io_uring_cqe& cqe) {
+                bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+                if (!more) {
+                    m_recving = false;
+                    --m_pending_ops;
+                }
+
+                if (cqe.res > 0) {
+                    unsigned short bid = (unsigned short)(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                    bool ok = m_atomic_switch.has_started() && handle_data(m_io_context.buffer_data(bid), (size_t)cqe.res);
+                    m_io_context.recycle_buffer(bid);
+                    if (ok && !more)
+                        read();
+                    return;
+                }
+
+                if (more || m_atomic_switch.has_stoped())
+                    return;
+
+                // ṩʱľ, Ͷ
+                if (cqe.res == -ENOBUFS) {
+                    read();
+                    return;
+                }
+                shutdown(cqe.res == 0 ? boost::asio::error::eof : MakeErrorCode(-cqe.res));
+            }
+
+            // , ѹرʱfalse
+            bool handle_data(const char* data, size_t len) {
+                if (m_read_buf.size() == 0) {
+                    // ֱṩص, صͨconsume_read_buf
+                    m_borrow_data = data;
+                    m_borrow_size = len;
+                    m_borrow_consumed = 0;
+                    deliver(data, len);
+                    size_t consumed = m_borrow_consumed;
+                    m_borrow_data = nullptr;
+                    m_borrow_size = m_borrow_consumed = 0;
+                    if (m_atomic_switch.has_stoped())
+                        return false;
+                    data += consumed;
+                    len -= consumed;
+                    if (len == 0)
+                        return true;
+                    if (!append_read_buf(data, len)) {
+                        shutdown(boost::asio::error::no_buffer_space);
+                        return false;
+                    }
+                    return true;
+                }
+
+                // δ, ƴӺص
+                while (len > 0) {
+                    size_t n = std::min(len, (size_t)m_read_buf.free_size());
+                    if (n == 0) {
+                        shutdown(boost::asio::error::no_buffer_space);
+                        return false;
+                    }
+                    append_read_buf(data, n);
+                    data += n;
+                    len -= n;
+
+                    const char* buf = m_read_buf.peek();
+                    size_t buf_len = m_read_buf.size();
+                    deliver(buf, buf_len);
+                    if (m_atomic_switch.has_stoped())
+                        return false;
+                }
+                return true;
+            }
+
+            bool append_read_buf(const char* data, size_t len) {
+                if (m_read_buf.free_size() < len)
+                    return false;
+                auto buf = m_read_buf.prepare(len);
+                memcpy(buf.data(), data, len);
+                m_read_buf.commit(len);
+                return true;
+            }
+
+            // صǰɶ, ֡ģʽԶ
+            void deliver(const char* data, size_t len) {
+                if (m_frame_decoder && m_frame_cbk) {
+                    size_t offset = 0;
+                    while (offset < len) {
+                        std::string_view frame;
+                        long long frame_len = m_frame_decoder(data + offset, len - offset, frame);
+                        if (frame_len < 0) {
+                            shutdown(boost::asio::error::invalid_argument);
+                            return;
+                        }
+                        if (frame_len == 0)
+                            break;
+
+                        m_frame_cbk(m_session_id, frame);
+                        if (m_atomic_switch.has_stoped())
+                            return;
+                        offset += static_cast<size_t>(frame_len);
+                    }
+                    consume_read_buf(offset);
+                }
+                else if (m_handler.read_cbk_) {
+                    m_handler.read_cbk_(m_session_id, data, len);
+                }
+                else {
+                    consume_read_buf(len);
+                }
+            }
+
+            // ǼǷռͱ־, ɹͶݷͲ
+            // Ӻ, ͱ־ͷű־ݷǷͶ
+            void post_write() {
+                m_write_pending.exchange(true);
+                if (m_writing.exchange(true))
+                    return;
+                start_write();
+            }
+
+            // ͶݷͲ, ɷͱ־ߵ
+            void start_write() {
+                // ѭ߳ͬӺ¼֮, ԱۺϻصдϢ
+                auto self = shared_from_this();
+                m_io_context.post([self]() { self->write(); });
+            }
+
+            // ۺϵǰͶеϢ, ɷͱ־ߵ
+            // ÿϢԵSENDMSGۺϷ, ݽ϶ʱMAX_SEND_CHAINύ, һύ򷢳
+            void write() {
+                if (m_atomic_switch.has_stoped()) {
+                    clear_write();
+                    return;
+                }
+
+                // , ǰǼݾɻȡ
+                m_write_pending.exchange(false);
+                m_send_parts.clear();
+                m_sending_size = 0;
+                while (m_send_parts.size() < MAX_SEND_CHAIN) {
+                    size_t first = m_sending_msgs.size();
+                    size_t size = m_write_buf.pop_front(m_sending_msgs, m_max_gather_count, m_max_gather_size);
+                    if (m_sending_msgs.size() == first)
+                        break;
+                    SendPart part;
+                    part.first_ = first;
+                    part.count_ = m_sending_msgs.size() - first;
+                    part.remain_ = size;
+                    m_send_parts.push_back(part);
+                    m_sending_size += size;
+                }
+                if (m_send_parts.empty()) {
+                    // ͷű־ٴȷ, ֹڴڼǼ־δͷŶδͶ
+                    // δǼɺͶ, ѯȴ
+                    m_writing.store(false);
+                    if (m_write_pending.load() && !m_writing.exchange(true))
+                        start_write();
+                    return;
+                }
+
+                // εiovec, ύ󲻿
+                m_sending_iovs.resize(m_sending_msgs.size());
+                for (size_t i = 0; i < m_sending_msgs.size(); ++i) {
+                    m_sending_iovs[i].iov_base = const_cast<char*>(m_sending_msgs[i]->data());
+                    m_sending_iovs[i].iov_len = m_sending_msgs[i]->size();
+                }
+                for (auto& part : m_send_parts) {
+                    memset(&part.hdr_, 0, sizeof(part.hdr_));
+                    part.hdr_.msg_iov = &m_sending_iovs[part.first_];
+                    part.hdr_.msg_iovlen = part.count_;
+                }
+                submit_send(0);
+            }
+
+            // ԵfirstύӵSENDMSG, ǰһͺں˲ſʼһ
+            void submit_send(size_t first) {
+                size_t count = m_send_parts.size() - first;
+                io_uring_sqe* sqe = m_io_context.get_sqes((unsigned)count);
+                if (!sqe) {
+                    shutdown(boost::asio::error::no_buffer_space);
+                    clear_write();
+                    return;
+                }
+
+                int fd = m_fd.load();
+                m_send_first = first;
+                m_send_completed = 0;
+                for (size_t i = first; i < m_send_parts.size(); ++i) {
+                    sqe = m_io_context.next_sqe();
+                    sqe->opcode = IORING_OP_SENDMSG;
+                    sqe->fd = fd;
+                    sqe->addr = (unsigned long long)(uintptr_t)&m_send_parts[i].hdr_;
+                    sqe->len = 1;
+                    sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL;
+                    if (i + 1 < m_send_parts.size())
+                        sqe->flags = IOSQE_IO_LINK;
+                    sqe->user_data = ioc_type::MakeUserData(m_session_id, OP_SEND);
+                }
+                m_pending_ops += count;
+                m_send_calls.fetch_add(count, std::memory_order_relaxed);
+            }
+
+            // ӵSENDMSGύ˳
+            void handle_send(const io_uring_cqe& cqe) {
+                --m_pending_ops;
+                SendPart& part = m_send_parts[m_send_first + m_send_completed++];
+                if (cqe.res > 0)
+                    part.advance((size_t)cqe.res);
+                else if (cqe.res == 0 && !m_send_error)
+                    // ύʣݷǿյ, ֽڷ˵Ѳд, ر, ⷴύ
+                    m_send_error = MakeErrorCode(EPIPE);
+                else if (cqe.res < 0 && cqe.res != -ECANCELED && !m_send_error)
+                    m_send_error = MakeErrorCode(-cqe.res);
+
+                if (m_send_first + m_send_completed < m_send_parts.size())
+                    return;
+
+                // 
+                if (m_send_error) {
+                    auto ec = m_send_error;
+                    m_send_error.clear();
+                    shutdown(ec);
+                    clear_write();
+                    return;
+                }
+                if (m_atomic_switch.has_stoped()) {
+                    clear_write();
+                    return;
+                }
+
+                // дǰһдȡ, Զϵ㴦ύ
+                for (size_t i = m_send_first; i < m_send_parts.size(); ++i) {
+                    if (m_send_parts[i].remain_ > 0) {
+                        submit_send(i);
+                        return;
+                    }
+                }
+
+                m_send_batchs.fetch_add(m_send_parts.size(), std::memory_order_relaxed);
+                m_send_msgs.fetch_add(m_sending_msgs.size(), std::memory_order_relaxed);
+                m_send_bytes.fetch_add(m_sending_size, std::memory_order_relaxed);
+
+                if (m_handler.write_cbk_) {
+                    for (auto& msg : m_sending_msgs) {
+                        m_handler.write_cbk_(m_session_id, msg->data(), msg->size());
+                    }
+                }
+
+                m_write_buf.release(m_sending_msgs);
+                m_send_parts.clear();
+                m_send_first = m_send_completed = 0;
+                write();
+            }
+
+            // մݲͷŷͱ־, ɷͱ־ߵ
+            void clear_write() {
+                // SENDMSGδ, ɺ
+                if (m_send_first + m_send_completed < m_send_parts.size())
+                    return;
+                m_write_buf.release(m_sending_msgs);
+                m_write_buf.clear();
+                m_send_parts.clear();
+                m_send_first = m_send_completed = 0;
+                m_writing.store(false);
+            }
+
+            void close(const boost::system::error_code& ec) {
+                int fd = m_fd.load();
+                if (fd >= 0 && !m_closing) {
+                    m_closing = true;
+                    ::shutdown(fd, SHUT_RDWR);
+                    // ȡδɲ
+                    io_uring_sqe* sqe = m_io_context.get_sqes(1);
+                    if (sqe) {
+                        sqe = m_io_context.next_sqe();
+                        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                        sqe->fd = fd;
+                        sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+                        sqe->user_data = ioc_type::MakeUserData(m_session_id, OP_CANCEL);
+                        ++m_pending_ops;
+                    }
+                }
+
+                m_atomic_switch.reset();
+                m_read_buf.consume(m_read_buf.size());
+                // ɷͱ־ڷɺ
+
+                if (m_handler.close_cbk_) {
+                    auto err = ec.message();
+                    m_handler.close_cbk_(m_session_id, err.c_str(), err.length());
+                }
+                release_if_idle();
+            }
+
+            // вѽر, UringContext
+            void release_if_idle() {
+                if (!m_closing || m_pending_ops > 0)
+                    return;
+
+                int fd = m_fd.exchange(-1);
+                if (fd >= 0)
+                    ::close(fd);
+                m_closing = false;
+
+                if (m_reconnect) {
+                    m_reconnect = false;
+                    do_connect();
+                    return;
+                }
+                // ͷ, 
+                m_io_context.remove_handler(m_session_id);
+            }
+
+        private:
+            ioc_type&               m_io_context;
+            SessionID               m_session_id;
+            std::atomic<int>        m_fd;
+
+            // ״̬ѭ̷߳
+            // δɵĲ
+            size_t                  m_pending_ops;
+            // Ƿڹر
+            bool                    m_closing;
+            // رɺǷ
+            bool                    m_reconnect;
+            // ǷͶݶν
+            bool                    m_recving;
+            sockaddr_in             m_connect_addr;
+            __kernel_timespec       m_connect_ts;
+
+            // 
+            ReadBufferType          m_read_buf;
+            // С
+            size_t                  m_max_rbuffer_size;
+            // صڼֱõṩ
+            const char*             m_borrow_data;
+            size_t                  m_borrow_size;
+            size_t                  m_borrow_consumed;
+
+            // д
+            WriteBufferType         m_write_buf;
+            // Ƿзڷ
+            std::atomic<bool>       m_writing;
+            // ǷӴ͵ݵǼ˷
+            std::atomic<bool>       m_write_pending;
+            // ǰڷ͵Ļ
+            std::vector<WriteMemoryStreamPtr>   m_sending_msgs;
+            // ǰڷ͵ľۺϻ
+            std::vector<iovec>      m_sending_iovs;
+            // ǰSENDMSGĸ
+            std::vector<SendPart>   m_send_parts;
+            // ǰSENDMSG±
+            size_t                  m_send_first = 0;
+            // ǰSENDMSG
+            size_t                  m_send_completed;
+            // ǰSENDMSGе׸
+            boost::system::error_code m_send_error;
+            // ǰڷ͵ֽ
+            size_t                  m_sending_size;
+            // дС
+            size_t                  m_max_wbuffer_size;
+            // ξۺϷϢ
+            size_t                  m_max_gather_count;
+            // ξۺϷֽ
+            size_t                  m_max_gather_size;
+
+            // ͳ
+            std::atomic<unsigned long long> m_send_calls{ 0 };
+            std::atomic<unsigned long long> m_send_batchs{ 0 };
+            std::atomic<unsigned long long> m_send_msgs{ 0 };
+            std::atomic<unsigned long long> m_send_bytes{ 0 };
+
+            // ص
+            NetCallBack             m_handler;
+            // ֡
+            FrameDecoder            m_frame_decoder;
+            // ֡ȡص
+            NetCallBack::frame_cbk  m_frame_cbk;
+
+            // ԭͣ־
+            AtomicSwitch            m_atomic_switch;
+
+            // IP
+            std::string             m_connect_ip;
+            // Port
+            unsigned short          m_connect_port;
+        };
+    }
+}
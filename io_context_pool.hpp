@@ -4,9 +4,52 @@ Author:     AChar
 Version:
 Date:
 Description:    ṩio_contextĶ,ṩ첽startͬstopӿ
+                ͨset_busy_pollֻȫ߳Ϊæѯģʽ, ͻӳ
 *************************************************/
 #pragma once
 #include <boost/version.hpp>
+#include <boost/asio/io_context.hpp>
+#include <thread>
+#include <chrono>
+#include <vector>
+
+namespace BTool
+{
+    // æѯ
+    // ѯ߳ioc.poll()ѯepoll_wait, ԶռCPUȡ͵Ļӳ, ϰʹ
+    struct AsioBusyPollOption
+    {
+        // io_context(һio_contextʱΪ߳)Ƿѯ, Ϊձʾȫѯ, Ϊ
+        std::vector<bool>   poll_indexes_;
+        // ѯﵽֵʼ˱, 0ʾ˱
+        unsigned            idle_spins_ = 0;
+        // ˱ʱʱ(΢), 0ʾóCPU
+        unsigned            idle_sleep_us_ = 0;
+
+        // indexio_context/߳Ƿѯ
+        bool is_poll(size_t index) const {
+            return poll_indexes_.empty() || (index < poll_indexes_.size() && poll_indexes_[index]);
+        }
+    };
+
+    // æѯʽio_contextֱֹͣ
+    inline void AsioBusyPollRun(boost::asio::io_context& ioc, const AsioBusyPollOption& option) {
+        unsigned idle = 0;
+        while (!ioc.stopped()) {
+            if (ioc.poll() > 0) {
+                idle = 0;
+                continue;
+            }
+            if (option.idle_spins_ == 0 || ++idle < option.idle_spins_)
+                continue;
+
+            if (option.idle_sleep_us_ > 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(option.idle_sleep_us_));
+            else
+                std::this_thread::yield();
+        }
+    }
+}
 
 #if (BOOST_VERSION >= 107000 && BOOST_VERSION < 108000)
 #include <boost/noncopyable.hpp>
@@ -104,6 +147,20 @@ namespace BTool
             return true;
         }
 
+        // æѯģʽ, ǰ(auto_startΪfalse), úrestartЧ
+        // option.poll_indexes_io_context±ָѯ, ѯ߳̽ͨbind_cores˶ռ
+        AsioContextPool& set_busy_poll(const AsioBusyPollOption& option = AsioBusyPollOption()) {
+            m_busy_poll = option;
+            m_busy_poll_enable = true;
+            return *this;
+        }
+
+        // ȡæѯģʽ, Ч
+        AsioContextPool& clear_busy_poll() {
+            m_busy_poll_enable = false;
+            return *this;
+        }
+
         // ʽ,ʹjoin_allȴ
         void run() {
             start();
@@ -137,9 +194,13 @@ namespace BTool
         }
 
     private:
-        void run_io_context(ioc_type& ioc, int core_id) {
-            CommonOS::BindCore(core_id);
-            ioc.run();
+        void run_io_context(ioc_type& ioc, int core_id, bool busy_poll) {
+            if (core_id >= 0)
+                CommonOS::BindCore(core_id);
+            if (busy_poll)
+                AsioBusyPollRun(ioc, m_busy_poll);
+            else
+                ioc.run();
         }
 
         void init(int pool_size) {
@@ -150,8 +211,10 @@ namespace BTool
                 m_io_contexts.emplace_back(new_ioc);
                 m_io_works.emplace_back(std::make_shared<work_type>(*new_ioc));
                 
-                if ((int)m_bind_cores.size() > i) {
-                    m_threads.create_thread(boost::bind(&AsioContextPool::run_io_context, this, boost::ref(*new_ioc), m_bind_cores[i]));
+                int core_id = (int)m_bind_cores.size() > i ? m_bind_cores[i] : -1;
+                bool busy_poll = m_busy_poll_enable && m_busy_poll.is_poll(i);
+                if (core_id >= 0 || busy_poll) {
+                    m_threads.create_thread(boost::bind(&AsioContextPool::run_io_context, this, boost::ref(*new_ioc), core_id, busy_poll));
                 }
                 else {
                     m_threads.create_thread(boost::bind(&ioc_type::run, boost::ref(*new_ioc)));
@@ -184,6 +247,10 @@ namespace BTool
         std::atomic<bool>           m_bstart;
         // 
         std::vector<int>            m_bind_cores;
+        // Ƿæѯ
+        bool                        m_busy_poll_enable = false;
+        // æѯ
+        AsioBusyPollOption          m_busy_poll;
     };
 
 
@@ -271,6 +338,20 @@ namespace BTool
             return true;
         }
 
+        // æѯģʽ, ǰ(auto_startΪfalse), úrestartЧ
+        // option.poll_indexes_̵߳±ָѯ, ѯ߳̽ͨbind_cores˶ռ
+        AsioSingleContextPool& set_busy_poll(const AsioBusyPollOption& option = AsioBusyPollOption()) {
+            m_busy_poll = option;
+            m_busy_poll_enable = true;
+            return *this;
+        }
+
+        // ȡæѯģʽ, Ч
+        AsioSingleContextPool& clear_busy_poll() {
+            m_busy_poll_enable = false;
+            return *this;
+        }
+
         // ʽ,ʹjoin_allȴ
         void run() {
             start();
@@ -304,9 +385,13 @@ namespace BTool
         }
 
     private:
-        void run_io_context(ioc_type& ioc, int core_id) {
-            CommonOS::BindCore(core_id);
-            ioc.run();
+        void run_io_context(ioc_type& ioc, int core_id, bool busy_poll) {
+            if (core_id >= 0)
+                CommonOS::BindCore(core_id);
+            if (busy_poll)
+                AsioBusyPollRun(ioc, m_busy_poll);
+            else
+                ioc.run();
         }
 
         void init(int pool_size) {
@@ -315,8 +400,10 @@ namespace BTool
             m_io_context = new ioc_type(pool_size);
             m_io_work = new work_type(*m_io_context);
             for (int i = 0; i < pool_size; i++) {
-                if ((int)m_bind_cores.size() > i) {
-                    m_threads.create_thread(boost::bind(&AsioSingleContextPool::run_io_context, this, boost::ref(*m_io_context), m_bind_cores[i]));
+                int core_id = (int)m_bind_cores.size() > i ? m_bind_cores[i] : -1;
+                bool busy_poll = m_busy_poll_enable && m_busy_poll.is_poll(i);
+                if (core_id >= 0 || busy_poll) {
+                    m_threads.create_thread(boost::bind(&AsioSingleContextPool::run_io_context, this, boost::ref(*m_io_context), core_id, busy_poll));
                 }
                 else {
                     m_threads.create_thread(boost::bind(&ioc_type::run, boost::ref(*m_io_context)));
@@ -352,6 +439,10 @@ namespace BTool
         std::atomic<bool>       m_bstart;
         // 
         std::vector<int>        m_bind_cores;
+        // Ƿæѯ
+        bool                    m_busy_poll_enable = false;
+        // æѯ
+        AsioBusyPollOption      m_busy_poll;
     };
 }
 #elif BOOST_VERSION >= 108000 
@@ -443,6 +534,20 @@ namespace BTool {
             return true;
         }
 
+        // æѯģʽ, ǰ(auto_startΪfalse), úrestartЧ
+        // option.poll_indexes_io_context±ָѯ, ѯ߳̽ͨbind_cores˶ռ
+        AsioContextPool& set_busy_poll(const AsioBusyPollOption& option = AsioBusyPollOption()) {
+            m_busy_poll = option;
+            m_busy_poll_enable = true;
+            return *this;
+        }
+
+        // ȡæѯģʽ, Ч
+        AsioContextPool& clear_busy_poll() {
+            m_busy_poll_enable = false;
+            return *this;
+        }
+
         // ʽ,ʹjoin_allȴ
         void run() {
             start();
@@ -476,9 +581,13 @@ namespace BTool {
         }
 
     private:
-        void run_io_context(ioc_type& ioc, int core_id) {
-            CommonOS::BindCore(core_id);
-            ioc.run();
+        void run_io_context(ioc_type& ioc, int core_id, bool busy_poll) {
+            if (core_id >= 0)
+                CommonOS::BindCore(core_id);
+            if (busy_poll)
+                AsioBusyPollRun(ioc, m_busy_poll);
+            else
+                ioc.run();
         }
 
         void init(int pool_size) {
@@ -489,8 +598,10 @@ namespace BTool {
                 m_io_contexts.emplace_back(new_ioc);
                 m_work_guards.emplace_back(std::make_shared<work_guard_type>(new_ioc->get_executor()));
 
-                if ((int)m_bind_cores.size() > i) {
-                    m_threads.create_thread(boost::bind(&AsioContextPool::run_io_context, this, boost::ref(*new_ioc), m_bind_cores[i]));
+                int core_id = (int)m_bind_cores.size() > i ? m_bind_cores[i] : -1;
+                bool busy_poll = m_busy_poll_enable && m_busy_poll.is_poll(i);
+                if (core_id >= 0 || busy_poll) {
+                    m_threads.create_thread(boost::bind(&AsioContextPool::run_io_context, this, boost::ref(*new_ioc), core_id, busy_poll));
                 } else {
                     m_threads.create_thread(boost::bind(&ioc_type::run, boost::ref(*new_ioc)));
                 }
@@ -515,6 +626,8 @@ namespace BTool {
         boost::thread_group m_threads;
         std::atomic<bool> m_bstart;
         std::vector<int> m_bind_cores;
+        bool m_busy_poll_enable = false;
+        AsioBusyPollOption m_busy_poll;
     };
 
     // һ io_context ̳߳
@@ -593,6 +706,20 @@ namespace BTool {
             return true;
         }
 
+        // æѯģʽ, ǰ(auto_startΪfalse), úrestartЧ
+        // option.poll_indexes_̵߳±ָѯ, ѯ߳̽ͨbind_cores˶ռ
+        AsioSingleContextPool& set_busy_poll(const AsioBusyPollOption& option = AsioBusyPollOption()) {
+            m_busy_poll = option;
+            m_busy_poll_enable = true;
+            return *this;
+        }
+
+        // ȡæѯģʽ, Ч
+        AsioSingleContextPool& clear_busy_poll() {
+            m_busy_poll_enable = false;
+            return *this;
+        }
+
         // ʽʹ join_all ȴ
         void run() {
             start();
@@ -619,9 +746,13 @@ namespace BTool {
         }
 
     private:
-        void run_io_context(ioc_type& ioc, int core_id) {
-            CommonOS::BindCore(core_id);
-            ioc.run();
+        void run_io_context(ioc_type& ioc, int core_id, bool busy_poll) {
+            if (core_id >= 0)
+                CommonOS::BindCore(core_id);
+            if (busy_poll)
+                AsioBusyPollRun(ioc, m_busy_poll);
+            else
+                ioc.run();
         }
 
         void init(int pool_size) {
@@ -629,8 +760,10 @@ namespace BTool {
             m_work_guard = std::make_shared<work_guard_type>(m_io_context->get_executor());
 
             for (int i = 0; i < pool_size; i++) {
-                if ((int)m_bind_cores.size() > i) {
-                    m_threads.create_thread(boost::bind(&AsioSingleContextPool::run_io_context, this, boost::ref(*m_io_context), m_bind_cores[i]));
+                int core_id = (int)m_bind_cores.size() > i ? m_bind_cores[i] : -1;
+                bool busy_poll = m_busy_poll_enable && m_busy_poll.is_poll(i);
+                if (core_id >= 0 || busy_poll) {
+                    m_threads.create_thread(boost::bind(&AsioSingleContextPool::run_io_context, this, boost::ref(*m_io_context), core_id, busy_poll));
                 } else {
                     m_threads.create_thread(boost::bind(&ioc_type::run, boost::ref(*m_io_context)));
                 }
@@ -650,6 +783,10 @@ namespace BTool {
         std::atomic<bool> m_bstart;
         // 
         std::vector<int> m_bind_cores;
+        // Ƿæѯ
+        bool m_busy_poll_enable = false;
+        // æѯ
+        AsioBusyPollOption m_busy_poll;
     };
 }
 #else
@@ -5,6 +5,10 @@ Version:
 Date:
 Purpose: ṩmmapļӳд
 Note:    ļдʱ, ޷ȷݰȫд
+         FixBufferVectorBufferԪύдг, ύreleaseд, 쳣˳ʱδύֲ
+         ¼crc32cУ, д뷽δرʱ, ٴ׷Ӵ򿪽У鲢ضһЧ¼; ϵ簲ȫsync
+         VectorBufferopen_checksumʱУ, ָʱύκУ
+         ɰļͷļȡֻ, д뷽׷Ӵ򿪷error_t::unsupported, ȾMigrateǨ
 *************************************************/
 #pragma once
 #include <iomanip>
@@ -21,6 +25,24 @@ Note:    
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <memory>
+#include <type_traits>
+#include <linux/futex.h>
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#if defined(__USE_LZ4__)
+#include <lz4.h>
+#endif
+#if defined(__USE_ZSTD__)
+#include <zstd.h>
+#endif
 #include "boost_net/memory_stream.hpp"
 
 namespace BTool {
@@ -37,6 +59,10 @@ namespace BTool {
             mmap_fail = -6,
             munmap_fail = -7,
             ftruncate_fail = -8,
+            overrun = -9,           // ȡ
+            write_fail = -10,
+            unsupported = -11,      // ʽѹ㷨֧
+            decode_fail = -12,      // Уѹʧ
         };
 
         // Ϣ
@@ -105,6 +131,102 @@ namespace BTool {
             }
             return create_error(error_t::ok);
         }
+
+        // crc32cУ, ɷֶμ, ǰһνΪһεcrc
+        static uint32_t Crc32c(const void* data, size_t len, uint32_t crc = 0) {
+            const unsigned char* p = (const unsigned char*)data;
+            crc = ~crc;
+#if defined(__SSE4_2__)
+            for (; len >= sizeof(uint64_t); len -= sizeof(uint64_t), p += sizeof(uint64_t)) {
+                uint64_t value = 0;
+                memcpy(&value, p, sizeof(uint64_t));
+                crc = (uint32_t)__builtin_ia32_crc32di(crc, value);
+            }
+            for (; len > 0; --len, ++p) {
+                crc = __builtin_ia32_crc32qi(crc, *p);
+            }
+#else
+            static const struct Table {
+                uint32_t items_[256];
+                Table() {
+                    for (uint32_t i = 0; i < 256; ++i) {
+                        uint32_t value = i;
+                        for (int bit = 0; bit < 8; ++bit) {
+                            value = (value >> 1) ^ (0x82F63B78 & (0 - (value & 1)));
+                        }
+                        items_[i] = value;
+                    }
+                }
+            } table;
+            for (; len > 0; --len, ++p) {
+                crc = table.items_[(crc ^ *p) & 0xFF] ^ (crc >> 8);
+            }
+#endif
+            return ~crc;
+        }
+
+        // ļӳ[begin, end)ҳ
+        static error SyncRange(void* addr, size_t begin, size_t end) {
+            if (end <= begin) {
+                return error(error_t::ok);
+            }
+            size_t page_size = sysconf(_SC_PAGE_SIZE);
+            size_t first = begin & ~(page_size - 1);
+            if (msync((char*)addr + first, end - first, MS_SYNC) == -1) {
+                return create_error(error_t::write_fail);
+            }
+            return error(error_t::ok);
+        }
+
+        // ļͷдļ: ļͷsrc_fd[data_offset, data_offset + data_len)дͬĿ¼ʱļ, fsyncrename滻ԭļfsyncĿ¼
+        // һʧܻ쳣˳ʱԭļֲ, ܲʱļ; ھɰļͷǨ
+        static error RewriteFile(int src_fd, const std::string& file, const void* head, size_t head_len, size_t data_offset, size_t data_len) {
+            struct stat sb;
+            if (::fstat(src_fd, &sb) == -1) {
+                return create_error(error_t::stat_fail);
+            }
+            std::string tmp_file = file + ".migrating";
+            int fd = ::open(tmp_file.c_str(), O_CREAT | O_TRUNC | O_WRONLY, sb.st_mode & 0777);
+            if (fd == -1) {
+                return create_error(error_t::open_fail);
+            }
+            error err(error_t::ok);
+            if (pwrite(fd, head, head_len, 0) != (ssize_t)head_len) {
+                err = create_error(error_t::write_fail);
+            }
+            std::vector<char> buffer(std::min<size_t>(data_len, 1024 * 1024));
+            for (size_t offset = 0; !err && offset < data_len; offset += buffer.size()) {
+                size_t count = std::min(data_len - offset, buffer.size());
+                if (pread(src_fd, buffer.data(), count, data_offset + offset) != (ssize_t)count
+                    || pwrite(fd, buffer.data(), count, head_len + offset) != (ssize_t)count) {
+                    err = create_error(error_t::write_fail);
+                }
+            }
+            if (!err && fsync(fd) == -1) {
+                err = create_error(error_t::write_fail);
+            }
+            ::close(fd);
+            if (!err && ::rename(tmp_file.c_str(), file.c_str()) == -1) {
+                err = create_error(error_t::write_fail);
+            }
+            if (err) {
+                ::unlink(tmp_file.c_str());
+                return err;
+            }
+
+            // Ŀ¼̺renameϵ綪ʧ
+            size_t pos = file.find_last_of('/');
+            std::string dir = pos == std::string::npos ? "." : (pos == 0 ? "/" : file.substr(0, pos));
+            int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+            if (dir_fd == -1) {
+                return create_error(error_t::open_fail);
+            }
+            if (fsync(dir_fd) == -1) {
+                err = create_error(error_t::write_fail);
+            }
+            ::close(dir_fd);
+            return err;
+        }
     
     public:
         // ֱӳ, ShmReaderWriterڶд̶С
@@ -191,7 +313,8 @@ namespace BTool {
                 // ȡӳĹڴ
                 m_data = static_cast<_Ty*>(addr);
                 if (is_create) {
-                    if (std::is_constructible<_Ty, int>::value) {
+                    // C++20ۺint, ۺͳһֵʼ
+                    if constexpr (std::is_constructible<_Ty, int>::value && !std::is_aggregate<_Ty>::value) {
                         *m_data = _Ty{0};
                     }
                     else {
@@ -207,8 +330,204 @@ namespace BTool {
             _Ty*                m_data = nullptr;
         };
     
+        // ȡʾ, ɰλ, Reader::set_hints
+        enum read_hint_t : unsigned {
+            hint_none = 0,
+            hint_sequential = 1 << 0,   // ӳMADV_SEQUENTIAL, ɸ߳Ԥһҳ
+            hint_populate = 1 << 1,     // ļpopulate_limitʱMAP_POPULATEӳ, ӳʱȫҳ
+            hint_hugepage = 1 << 2,     // ӳ鲻Сhugepage_minʱMADV_HUGEPAGE
+            hint_dontneed = 1 << 3,     // ͷѶǰMADV_DONTNEED, ֪ͨں˶ҳ
+        };
+
+        // ȡʱӦ÷ʾ, Reader/ReverseReader/VectorBuffer::Readerʹ; ̰߳ȫ
+        class ReadAdvisor {
+        public:
+            enum : size_t {
+                DEFAULT_POPULATE_LIMIT = 64 * 1024 * 1024,
+                DEFAULT_HUGEPAGE_MIN = 2 * 1024 * 1024,
+            };
+
+        public:
+            ReadAdvisor() = default;
+            ~ReadAdvisor() { stop(); }
+
+            void set_hints(unsigned hints, size_t populate_limit = DEFAULT_POPULATE_LIMIT, size_t hugepage_min = DEFAULT_HUGEPAGE_MIN) {
+                m_hints = hints;
+                m_populate_limit = populate_limit;
+                m_hugepage_min = hugepage_min;
+            }
+
+            inline unsigned get_hints() const {
+                return m_hints;
+            }
+
+            // ӳ־, file_sizeΪļܴС
+            int map_flags(size_t file_size) const {
+                if ((m_hints & hint_populate) && file_size <= m_populate_limit)
+                    return MAP_SHARED | MAP_POPULATE;
+                return MAP_SHARED;
+            }
+
+            // ӳɺ
+            void on_map(void* addr, size_t len) const {
+                if (m_hints & hint_sequential)
+                    madvise(addr, len, MADV_SEQUENTIAL);
+                if ((m_hints & hint_hugepage) && len >= m_hugepage_min)
+                    madvise(addr, len, MADV_HUGEPAGE);
+            }
+
+            // ͷӳǰ, offsetΪӳļеʼλ
+            void on_unmap(int fd, void* addr, size_t len, off_t offset) const {
+                if (m_hints & hint_dontneed) {
+                    madvise(addr, len, MADV_DONTNEED);
+                    posix_fadvise(fd, offset, len, POSIX_FADV_DONTNEED);
+                }
+            }
+
+            // ɸ߳̽[offset, offset + len)Ԥҳ, һ
+            void prefetch(int fd, off_t offset, size_t len) {
+                if (!(m_hints & hint_sequential) || len == 0)
+                    return;
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    m_fd = fd;
+                    m_offset = offset;
+                    m_length = len;
+                    m_pending = true;
+                    if (!m_thread.joinable()) {
+                        m_stop = false;
+                        m_thread = std::thread(&ReadAdvisor::prefetch_loop, this);
+                    }
+                }
+                m_cv.notify_one();
+            }
+
+            // ȴ߳˳, رļǰ
+            void stop() {
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    if (!m_thread.joinable())
+                        return;
+                    m_stop = true;
+                    m_pending = false;
+                }
+                m_cv.notify_one();
+                m_thread.join();
+            }
+
+        private:
+            void prefetch_loop() {
+                std::unique_lock<std::mutex> lock(m_mtx);
+                while (true) {
+                    m_cv.wait(lock, [this] { return m_stop || m_pending; });
+                    if (m_stop)
+                        return;
+                    int fd = m_fd;
+                    off_t offset = m_offset;
+                    size_t len = m_length;
+                    m_pending = false;
+                    lock.unlock();
+                    // ڴ治֧readahead, ҳ汾ڴ
+                    readahead(fd, offset, len);
+                    lock.lock();
+                }
+            }
+
+        private:
+            unsigned                m_hints = hint_none;
+            size_t                  m_populate_limit = DEFAULT_POPULATE_LIMIT;
+            size_t                  m_hugepage_min = DEFAULT_HUGEPAGE_MIN;
+
+            // Ԥ̼߳Ԥ
+            std::mutex              m_mtx;
+            std::condition_variable m_cv;
+            std::thread             m_thread;
+            bool                    m_stop = false;
+            bool                    m_pending = false;
+            int                     m_fd = -1;
+            off_t                   m_offset = 0;
+            size_t                  m_length = 0;
+        };
+
+        // partitionspoolִ, task(size_t partition, Result&)شʱ¼׸
+        // ɺڵ̰߳˳صmerge(size_t partition, Result&&), ȫɺ󷵻
+        // poolṩadd_task(func), ParallelTaskPool; add_taskʧʱڵִ߳; pool߳е, ȴ
+        template<typename Result, typename TTaskPool, typename TaskFunc, typename MergeFunc>
+        static error RunPartitions(TTaskPool& pool, size_t partitions, TaskFunc&& task, MergeFunc&& merge) {
+            struct State {
+                std::mutex              mtx_;
+                std::condition_variable cv_;
+                std::vector<Result>     results_;
+                std::vector<char>       finished_;
+                error                   err_{ error_t::ok };
+            } state;
+            state.results_.resize(partitions);
+            state.finished_.assign(partitions, 0);
+
+            for (size_t partition = 0; partition < partitions; ++partition) {
+                auto run = [&state, &task, partition]() {
+                    error err = task(partition, state.results_[partition]);
+                    std::lock_guard<std::mutex> lock(state.mtx_);
+                    if (err && !state.err_)
+                        state.err_ = err;
+                    state.finished_[partition] = 1;
+                    state.cv_.notify_all();
+                };
+                if (!pool.add_task(run))
+                    run();
+            }
+
+            for (size_t partition = 0; partition < partitions; ++partition) {
+                {
+                    std::unique_lock<std::mutex> lock(state.mtx_);
+                    state.cv_.wait(lock, [&] { return state.finished_[partition] != 0; });
+                }
+                merge(partition, std::move(state.results_[partition]));
+            }
+            std::lock_guard<std::mutex> lock(state.mtx_);
+            return state.err_;
+        }
+
+        // зɨļ[data_offset, data_offset + data_len), item_sizeзΪpartitions, RunPartitions
+        // chunk_lenֿӳ, λصfunc(size_t partition, Result&, std::string_view chunk), falseʱ
+        template<typename Result, typename TTaskPool, typename Func, typename MergeFunc>
+        static error ScanFile(TTaskPool& pool, int fd, off_t data_offset, size_t data_len, size_t item_size, size_t chunk_len, size_t partitions, const ReadAdvisor& advisor, Func&& func, MergeFunc&& merge) {
+            size_t item_count = item_size == 0 ? 0 : data_len / item_size;
+            if (partitions == 0) {
+                partitions = std::max(1u, std::thread::hardware_concurrency());
+            }
+            partitions = std::max<size_t>(1, std::min(partitions, item_count));
+            chunk_len = std::max<size_t>(1, chunk_len / std::max<size_t>(1, item_size)) * item_size;
+            off_t page_size = sysconf(_SC_PAGE_SIZE);
+
+            auto task = [&](size_t partition, Result& result) {
+                size_t begin = item_count * partition / partitions * item_size;
+                size_t end = item_count * (partition + 1) / partitions * item_size;
+                for (size_t pos = begin; pos < end; pos += chunk_len) {
+                    size_t len = std::min(chunk_len, end - pos);
+                    off_t offset = data_offset + pos;
+                    off_t pa_offset = offset & ~(page_size - 1);
+                    size_t map_len = len + offset - pa_offset;
+                    void* addr = mmap(NULL, map_len, PROT_READ, advisor.map_flags(data_offset + data_len), fd, pa_offset);
+                    if (addr == MAP_FAILED) {
+                        return create_error(error_t::mmap_fail);
+                    }
+                    advisor.on_map(addr, map_len);
+                    bool next = func(partition, result, std::string_view((char*)addr + offset - pa_offset, len));
+                    advisor.on_unmap(fd, addr, map_len, pa_offset);
+                    munmap(addr, map_len);
+                    if (!next) {
+                        break;
+                    }
+                }
+                return error(error_t::ok);
+            };
+            return RunPartitions<Result>(pool, partitions, task, std::forward<MergeFunc>(merge));
+        }
+
         // ˳һζȡ, ´ζȡͷһεĶȡmmapļ, ̰߳ȫ
         // עcoreʱ޷֤ݰȫд
+        // зɨ(scan)˳ȡα껥Ӱ, ӳ
         class Reader {
         public:
             explicit Reader(bool can_change = false) : m_can_change(can_change), m_item_size(1) {}
@@ -286,6 +605,11 @@ namespace BTool {
                 return m_item_size;
             }
 
+            // ÷ʾ, read_hint_t
+            void set_hints(unsigned hints, size_t populate_limit = ReadAdvisor::DEFAULT_POPULATE_LIMIT, size_t hugepage_min = ReadAdvisor::DEFAULT_HUGEPAGE_MIN) {
+                m_advisor.set_hints(hints, populate_limit, hugepage_min);
+            }
+
             template<typename Type>
             std::tuple<error, Type*, size_t/*count*/> read() {
                 auto [ok, data] = read();
@@ -304,20 +628,45 @@ namespace BTool {
 
                 calc_current();
 
+                int flags = m_advisor.map_flags(m_file_size);
                 if (!m_can_change)
-                    m_cur_read_addr = mmap(NULL, m_cur_read_length + m_cur_offset - m_pa_offset, PROT_READ, MAP_SHARED, m_fd, m_pa_offset);
+                    m_cur_read_addr = mmap(NULL, m_cur_read_length + m_cur_offset - m_pa_offset, PROT_READ, flags, m_fd, m_pa_offset);
                 else
-                    m_cur_read_addr = mmap(NULL, m_cur_read_length + m_cur_offset - m_pa_offset, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, m_pa_offset);
+                    m_cur_read_addr = mmap(NULL, m_cur_read_length + m_cur_offset - m_pa_offset, PROT_READ | PROT_WRITE, flags, m_fd, m_pa_offset);
 
                 if (m_cur_read_addr == MAP_FAILED) {
                     return std::forward_as_tuple(create_error(error_t::mmap_fail), std::string_view{});
                 }
+                m_advisor.on_map(m_cur_read_addr, m_cur_read_length + m_cur_offset - m_pa_offset);
                 m_cur_chunk_index++;
+                // Ԥһ
+                if (m_cur_chunk_index < m_num_chunks) {
+                    off_t next_offset = m_cur_chunk_index * m_chunk_size;
+                    m_advisor.prefetch(m_fd, next_offset, std::min<size_t>(m_chunk_size, m_file_size - next_offset));
+                }
                 return std::forward_as_tuple(error_t::ok, std::string_view((char*)m_cur_read_addr + m_cur_offset - m_pa_offset, m_cur_read_length));
             }
 
+            // зɨ, ļзΪpartitions(0ΪӲ߳), pool(ṩadd_task, ParallelTaskPool)д
+            // 񰴴ʱĿСӳ, λصfunc(size_t partition, std::string_view chunk), falseʱ
+            // pool̵֮߳, ȫɺ󷵻
+            template<typename TTaskPool, typename Func>
+            error scan(TTaskPool& pool, size_t partitions, Func&& func) const {
+                return scan<char>(pool, partitions
+                    , [&](size_t partition, char&, std::string_view chunk) { return func(partition, chunk); }
+                    , [](size_t, char&&) {});
+            }
+
+            // ϲĲзɨ, ÿĬϹResultۼ, λصfunc(size_t partition, Result&, std::string_view chunk)
+            // ɺڵ̰߳˳صmerge(size_t partition, Result&&)
+            template<typename Result, typename TTaskPool, typename Func, typename MergeFunc>
+            error scan(TTaskPool& pool, size_t partitions, Func&& func, MergeFunc&& merge) const {
+                return ScanFile<Result>(pool, m_fd, 0, m_file_size, m_item_size, m_chunk_size, partitions, m_advisor, std::forward<Func>(func), std::forward<MergeFunc>(merge));
+            }
+
             error close() {
                 clean_mmap();
+                m_advisor.stop();
 
                 if (m_fd != -1 && ::close(m_fd) == -1) {
                     return create_error(error_t::close_fail);
@@ -330,6 +679,7 @@ namespace BTool {
             error_t clean_mmap() {
                 error_t err_code = error_t::ok;
                 if (m_cur_read_addr != MAP_FAILED) {
+                    m_advisor.on_unmap(m_fd, m_cur_read_addr, m_cur_read_length + m_cur_offset - m_pa_offset, m_pa_offset);
                     if (munmap(m_cur_read_addr, m_cur_read_length + m_cur_offset - m_pa_offset) == -1) {
                         err_code = error_t::munmap_fail;
                     }
@@ -369,6 +719,8 @@ namespace BTool {
             void*       m_cur_read_addr = MAP_FAILED;
             // ǰȡڴ泤
             size_t      m_cur_read_length = 0;
+            // ʾ
+            ReadAdvisor m_advisor;
         };
 
         // Ӻǰȡ
@@ -443,6 +795,11 @@ namespace BTool {
             inline size_t get_obj_size() const {
                 return m_item_size;
             }
+
+            // ÷ʾ, read_hint_t; ԤΪǰһ
+            void set_hints(unsigned hints, size_t populate_limit = ReadAdvisor::DEFAULT_POPULATE_LIMIT, size_t hugepage_min = ReadAdvisor::DEFAULT_HUGEPAGE_MIN) {
+                m_advisor.set_hints(hints, populate_limit, hugepage_min);
+            }
             
             template<typename Type>
             std::tuple<error, const Type*, size_t/*count*/> read() {
@@ -462,10 +819,15 @@ namespace BTool {
 
                 calc_current();
 
-                m_cur_read_addr = mmap(NULL, m_cur_read_length + m_cur_offset - m_pa_offset, PROT_READ, MAP_SHARED, m_fd, m_pa_offset);
+                m_cur_read_addr = mmap(NULL, m_cur_read_length + m_cur_offset - m_pa_offset, PROT_READ, m_advisor.map_flags(m_file_size), m_fd, m_pa_offset);
                 if (m_cur_read_addr == MAP_FAILED) {
                     return std::forward_as_tuple(create_error(error_t::mmap_fail), std::string_view{});
                 }
+                m_advisor.on_map(m_cur_read_addr, m_cur_read_length + m_cur_offset - m_pa_offset);
+                // Ԥǰһ
+                if (m_cur_chunk_index > 0) {
+                    m_advisor.prefetch(m_fd, (m_cur_chunk_index - 1) * m_chunk_size, m_chunk_size);
+                }
                 return std::forward_as_tuple(error_t::ok, std::string_view((char*)m_cur_read_addr + m_cur_offset - m_pa_offset, m_cur_read_length));
             }
             
@@ -473,6 +835,7 @@ namespace BTool {
             error_t clean_mmap() {
                 error_t err_code = error_t::ok;
                 if (m_cur_read_addr != MAP_FAILED) {
+                    m_advisor.on_unmap(m_fd, m_cur_read_addr, m_cur_read_length + m_cur_offset - m_pa_offset, m_pa_offset);
                     if (munmap(m_cur_read_addr, m_cur_read_length + m_cur_offset - m_pa_offset) == -1) {
                         err_code = error_t::munmap_fail;
                     }
@@ -493,6 +856,7 @@ namespace BTool {
 
             error close() {
                 clean_mmap();
+                m_advisor.stop();
 
                 if (m_fd != -1 && ::close(m_fd) == -1) {
                     return create_error(error_t::close_fail);
@@ -522,9 +886,11 @@ namespace BTool {
             void*       m_cur_read_addr = MAP_FAILED;
             // ǰȡڴ泤
             size_t      m_cur_read_length = 0;
+            // ʾ
+            ReadAdvisor m_advisor;
         };
 
-        // ׷mmap, ÿξ´/ر
+        // ׷mmap, ÿξ´/ر; Ƶ׷ӼAppender
         class Writer {
         public:
             Writer() = default;
@@ -571,7 +937,7 @@ namespace BTool {
                 if (map == MAP_FAILED) {
                     return create_error(error_t::mmap_fail);
                 }
-                memcpy((char*)map, data.data(), data.length());
+                memcpy((char*)map + (m_cur_offset - pa_offset), data.data(), data.length());
                 m_cur_offset += data.length();
 
                 // ȡļӳ䲢رļ
@@ -594,178 +960,1906 @@ namespace BTool {
             // ǰȡƯλ
             off_t   m_cur_offset = 0;
         };
+
+        // פӳ䴰ڵ׷д, ڸƵ׷ӳ; ̰߳ȫ
+        // ļڴСfallocateԤ, дΪڴ濽, дʱӳ
+        // дĴڽɺ̨߳msync/madvise(MADV_DONTNEED)/munmap, رʱļضΪʵд볤
+        // ע: дڼļΪԤ䳤, ȡȷЧ; 쳣˳ʱļβֵ
+        class Appender {
+        public:
+            enum : size_t {
+                DEFAULT_WINDOW_SIZE = 64 * 1024 * 1024,
+            };
+
+        public:
+            // window_size: ӳ䴰ڴС, ҳȡ, ͬʱΪļԤ䲽
+            // sync_retired: дĴǷͬˢ(MS_SYNC), MS_ASYNC
+            Appender(size_t window_size = DEFAULT_WINDOW_SIZE, bool sync_retired = false)
+                : m_page_size(sysconf(_SC_PAGE_SIZE))
+                , m_sync_retired(sync_retired)
+            {
+                m_window_size = std::max<size_t>(window_size, m_page_size);
+                m_window_size = (m_window_size + m_page_size - 1) & ~(m_page_size - 1);
+            }
+            ~Appender() { close(); }
+
+            error open(const std::string& file, bool is_append = true) {
+                close();
+                m_fd = ::open(file.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                return open_impl(is_append);
+            }
+
+            error shm_open(const std::string& title, bool is_append = true) {
+                close();
+                m_fd = ::shm_open(title.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                return open_impl(is_append);
+            }
+
+            // ǰдλ, Чݳ
+            off_t offset() const {
+                return m_cur_offset;
+            }
+
+            error write(std::string_view data) {
+                return write(data.data(), data.length());
+            }
+
+            error write(const void* data, size_t len) {
+                if (m_fd == -1) {
+                    return error(error_t::open_fail, "not open");
+                }
+                const char* src = (const char*)data;
+                while (len > 0) {
+                    // д, лһ
+                    if (m_map == MAP_FAILED || m_cur_offset >= m_map_offset + (off_t)m_window_size) {
+                        auto err = remap();
+                        if (err) {
+                            return err;
+                        }
+                    }
+                    size_t copy_len = std::min<size_t>(len, m_map_offset + m_window_size - m_cur_offset);
+                    memcpy((char*)m_map + (m_cur_offset - m_map_offset), src, copy_len);
+                    m_cur_offset += copy_len;
+                    src += copy_len;
+                    len -= copy_len;
+                }
+                return error(error_t::ok);
+            }
+
+            // ˢµǰд벿
+            // sync: Ƿͬȴ
+            error flush(bool sync = false) {
+                if (m_map == MAP_FAILED || m_cur_offset <= m_map_offset) {
+                    return error(error_t::ok);
+                }
+                if (msync(m_map, m_cur_offset - m_map_offset, sync ? MS_SYNC : MS_ASYNC) == -1) {
+                    return create_error(error_t::unknow);
+                }
+                return error(error_t::ok);
+            }
+
+            // ͷӳ䲢ļضΪʵд볤
+            error close() {
+                if (m_fd == -1) {
+                    return error(error_t::ok);
+                }
+
+                error_t err_code = error_t::ok;
+                if (m_map != MAP_FAILED) {
+                    if (m_sync_retired && m_cur_offset > m_map_offset) {
+                        msync(m_map, m_cur_offset - m_map_offset, MS_SYNC);
+                    }
+                    if (munmap(m_map, m_window_size) == -1) {
+                        err_code = error_t::munmap_fail;
+                    }
+                    m_map = MAP_FAILED;
+                }
+                stop_release();
+
+                if (ftruncate(m_fd, m_cur_offset) == -1 && err_code == error_t::ok) {
+                    err_code = error_t::ftruncate_fail;
+                }
+                if (::close(m_fd) == -1 && err_code == error_t::ok) {
+                    err_code = error_t::close_fail;
+                }
+                m_fd = -1;
+                m_cur_offset = 0;
+                m_map_offset = 0;
+                m_file_size = 0;
+                return err_code == error_t::ok ? error(error_t::ok) : create_error(err_code);
+            }
+
+        private:
+            error open_impl(bool is_append) {
+                if (m_fd == -1) {
+                    return create_error(error_t::open_fail);
+                }
+                struct stat sb;
+                if (fstat(m_fd, &sb) == -1) {
+                    auto err = create_error(error_t::stat_fail);
+                    ::close(m_fd);
+                    m_fd = -1;
+                    return err;
+                }
+                m_file_size = sb.st_size;
+                m_cur_offset = is_append ? sb.st_size : 0;
+                m_map_offset = 0;
+                return error(error_t::ok);
+            }
+
+            // ӳm_cur_offsetҳʼ´, ʱڴСԤļռ
+            error remap() {
+                off_t map_offset = m_cur_offset & ~(off_t)(m_page_size - 1);
+                off_t map_end = map_offset + m_window_size;
+                if (map_end > m_file_size) {
+                    off_t new_size = m_file_size + m_window_size;
+                    if (new_size < map_end) {
+                        new_size = map_end;
+                    }
+                    auto err = allocate(new_size);
+                    if (err) {
+                        return err;
+                    }
+                }
+
+                void* map = mmap(NULL, m_window_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, map_offset);
+                if (map == MAP_FAILED) {
+                    return create_error(error_t::mmap_fail);
+                }
+                if (m_map != MAP_FAILED) {
+                    release(m_map);
+                }
+                m_map = map;
+                m_map_offset = map_offset;
+                return error(error_t::ok);
+            }
+
+            // չļnew_size, ļϵͳ֧fallocateʱ˻Ϊftruncate
+            error allocate(off_t new_size) {
+                if (::fallocate(m_fd, 0, m_file_size, new_size - m_file_size) == 0) {
+                    m_file_size = new_size;
+                    return error(error_t::ok);
+                }
+                if (errno != EOPNOTSUPP && errno != ENOSYS) {
+                    return create_error(error_t::free_space_fail);
+                }
+                if (ftruncate(m_fd, new_size) == -1) {
+                    return create_error(error_t::ftruncate_fail);
+                }
+                m_file_size = new_size;
+                return error(error_t::ok);
+            }
+
+            // дĴڽɺ̨߳ͷ
+            void release(void* map) {
+                {
+                    std::lock_guard<std::mutex> lock(m_release_mtx);
+                    m_release_maps.push_back(map);
+                    if (!m_release_thread.joinable()) {
+                        m_release_stop = false;
+                        m_release_thread = std::thread(&Appender::release_loop, this);
+                    }
+                }
+                m_release_cv.notify_one();
+            }
+
+            void release_loop() {
+                std::vector<void*> maps;
+                std::unique_lock<std::mutex> lock(m_release_mtx);
+                while (true) {
+                    m_release_cv.wait(lock, [this] { return m_release_stop || !m_release_maps.empty(); });
+                    if (m_release_maps.empty()) {
+                        return;
+                    }
+                    maps.swap(m_release_maps);
+                    lock.unlock();
+                    for (void* map : maps) {
+                        msync(map, m_window_size, m_sync_retired ? MS_SYNC : MS_ASYNC);
+                        madvise(map, m_window_size, MADV_DONTNEED);
+                        munmap(map, m_window_size);
+                    }
+                    maps.clear();
+                    lock.lock();
+                }
+            }
+
+            // ȴ̨߳ͷȫں˳
+            void stop_release() {
+                {
+                    std::lock_guard<std::mutex> lock(m_release_mtx);
+                    if (!m_release_thread.joinable()) {
+                        return;
+                    }
+                    m_release_stop = true;
+                }
+                m_release_cv.notify_one();
+                m_release_thread.join();
+            }
+
+        private:
+            // ҳС
+            const size_t            m_page_size;
+            // ӳ䴰ڴС, ͬʱΪԤ䲽
+            size_t                  m_window_size;
+            // дĴǷͬˢ
+            bool                    m_sync_retired;
+            // ļ
+            int                     m_fd = -1;
+            // ǰдλ
+            off_t                   m_cur_offset = 0;
+            // ļѷ䳤
+            off_t                   m_file_size = 0;
+            // ǰļеʼλ, ҳ
+            off_t                   m_map_offset = 0;
+            // ǰڵַ
+            void*                   m_map = MAP_FAILED;
+
+            // ̨ͷ̼߳ͷŴ
+            std::mutex              m_release_mtx;
+            std::condition_variable m_release_cv;
+            std::vector<void*>      m_release_maps;
+            std::thread             m_release_thread;
+            bool                    m_release_stop = false;
+        };
         
-        // ṩڹ̶дĴڴ, ļȲ̶, ʵʱ
-        class VectorBuffer {
+        // ϡ·ļ, ÿinterval¼һμ(ʱ)¼ƫ, ֶλ
+        // VectorBuffer::Writer::write_indexed/FixBuffer::Writer::write_recordά, ȡlocateȷ
+        // 밴д˳ǵݼ, Сǰһ¼ʱadderror_t::write_failҲ(ɵ÷д)
+        class SparseIndex {
         protected:
+            enum : uint32_t {
+                INDEX_MAGIC = 0x58444953,   // ļ
+                INIT_CAPACITY = 4096,       // ʼ, ֮
+            };
+
     #pragma pack(push, 1)
-            // λԪݽṹ
             struct MetaSt {
-                size_t  item_size_;     // ÿдĴС
-                size_t  write_len_;     // дݳ
-                size_t  file_len_;      // ݻ
-                char    data_[0];       // ݻ
+                uint32_t    magic_;
+                uint32_t    interval_;      // ÿ¼һ
+                uint64_t    count_;         // ύ, releaseд
             };
     #pragma pack(pop)
+
         public:
-            // ׷mmap, ÿξԤд, ֶΪļĳ
+    #pragma pack(push, 1)
+            struct Entry {
+                int64_t     key_;           // ¼
+                uint64_t    offset_;        // ¼ƫ(ļԪ)
+            };
+    #pragma pack(pop)
+
+            // ̰߳ȫ
             class Writer {
             public:
                 Writer() = default;
-                ~Writer() {
-                    close();
-                }
-
-                error open(const std::string& file, size_t item_size, bool is_append = true, const off_t& init_buf_length = 4*1024*1024, const off_t& buf_step = 1024*1024) {
-                    bool is_create = false;
-                    auto err = MMapFile::OpenWriteFile<false>(m_fd, is_create, file, 0);
-                    if (err) return err;
-                    m_buf_step = buf_step;
-                    err = check_add_length(init_buf_length);
-                    if (err) return err;
-                    if (is_create || !is_append) {
-                        m_p_meta->write_len_ = 0;
-                        m_p_meta->item_size_ = item_size;
-                    }
-                    return err;
-                }
+                ~Writer() { close(); }
 
-                error shm_open(const std::string& title, size_t item_size, bool is_append = true, const off_t& init_buf_length = 4*1024*1024, const off_t& buf_step = 1024*1024) {
-                    bool is_create = false;
-                    auto err = MMapFile::OpenWriteFile<true>(m_fd, is_create, title, 0);
-                    if (err) return err;
-                    m_buf_step = buf_step;
-                    err = check_add_length(init_buf_length);
-                    if (err) return err;
-                    if (is_create || !is_append) {
-                        m_p_meta->write_len_ = 0;
-                        m_p_meta->item_size_ = item_size;
-                    }
-                    return err;
+                // interval: ÿ¼һ, ׷Ӵʱļ¼ֵ
+                error open(const std::string& file, size_t interval, bool is_append = true) {
+                    return open_impl<false>(file, interval, is_append);
                 }
 
-                void reset_offset(const off_t& off) { 
-                    m_p_meta->write_len_ = off;
+                error shm_open(const std::string& title, size_t interval, bool is_append = true) {
+                    return open_impl<true>(title, interval, is_append);
                 }
 
-                template<typename _Ty>
-                error write(_Ty&& data) {
-                    return write((const char*)(&data), sizeof(_Ty));
+                inline bool is_open() const {
+                    return m_meta != nullptr;
                 }
 
-                error write(const char* data, const size_t& len) {
-                    if (len == 0) {
+                // Ǽһ¼, ÿintervalһ, Сǰһ¼ʱerror_t::write_fail
+                error add(int64_t key, uint64_t offset) {
+                    if (!m_meta) {
+                        return error(error_t::open_fail, "not open");
+                    }
+                    if (key < m_last_key) {
+                        return error(error_t::write_fail, "key out of order");
+                    }
+                    m_last_key = key;
+                    if (m_pending++ % m_meta->interval_ != 0) {
                         return error(error_t::ok);
                     }
-                    auto err = check_add_length(len);
-                    if (err) {
-                        return err;
+                    uint64_t count = m_meta->count_;
+                    Entry* entries = (Entry*)(m_meta + 1);
+                    if (count >= m_capacity) {
+                        auto err = remap(m_capacity * 2);
+                        if (err) {
+                            return err;
+                        }
+                        entries = (Entry*)(m_meta + 1);
                     }
-                    
-                    memcpy((char*)(m_data + m_p_meta->write_len_), data, len);
-                    m_p_meta->write_len_ += len;
+                    entries[count] = Entry{ key, offset };
+                    __atomic_store_n(&m_meta->count_, count + 1, __ATOMIC_RELEASE);
                     return error(error_t::ok);
                 }
 
+                // رղļضΪʵʳ
                 void close() {
-                    // ȡļӳ䲢رļ
-                    if (m_p_meta) {
-                        auto write_len = m_p_meta->write_len_;
-                        auto file_len = m_p_meta->file_len_;
-                        m_p_meta->file_len_ = write_len + sizeof(MetaSt);
-                        munmap((void*)m_p_meta, file_len);
-                        auto ret = ftruncate(m_fd, write_len + sizeof(MetaSt));
+                    if (m_meta) {
+                        size_t file_len = sizeof(MetaSt) + m_meta->count_ * sizeof(Entry);
+                        munmap((void*)m_meta, MapLength(m_capacity));
+                        auto ret = ftruncate(m_fd, file_len);
                         (void)ret;
-                        m_p_meta = nullptr;
-                        m_data = nullptr;
+                        m_meta = nullptr;
                     }
-
                     if (m_fd != -1) {
                         ::close(m_fd);
                         m_fd = -1;
                     }
+                    m_capacity = 0;
+                    m_pending = 0;
+                    m_last_key = INT64_MIN;
                 }
 
             private:
+                static size_t MapLength(size_t capacity) {
+                    return sizeof(MetaSt) + capacity * sizeof(Entry);
+                }
+
+                template<bool is_shm>
+                error open_impl(const std::string& title, size_t interval, bool is_append) {
+                    close();
+                    bool is_create = false;
+                    auto err = MMapFile::OpenWriteFile<is_shm>(m_fd, is_create, title, 0);
+                    if (err) {
+                        return err;
+                    }
+                    struct stat sb;
+                    if (fstat(m_fd, &sb) == -1) {
+                        err = create_error(error_t::stat_fail);
+                        close();
+                        return err;
+                    }
+
+                    size_t capacity = INIT_CAPACITY;
+                    while (MapLength(capacity) < (size_t)sb.st_size)
+                        capacity *= 2;
+                    err = remap(capacity);
+                    if (err) {
+                        close();
+                        return err;
+                    }
+                    if (is_create || !is_append || m_meta->magic_ != INDEX_MAGIC) {
+                        m_meta->interval_ = (uint32_t)std::max<size_t>(interval, 1);
+                        m_meta->count_ = 0;
+                        m_meta->magic_ = INDEX_MAGIC;
+                    }
+                    // ׷ʱ¼, Сһ
+                    m_pending = 0;
+                    m_last_key = m_meta->count_ > 0 ? ((Entry*)(m_meta + 1))[m_meta->count_ - 1].key_ : INT64_MIN;
+                    return error(error_t::ok);
+                }
+
+                error remap(size_t capacity) {
+                    if (m_meta) {
+                        munmap((void*)m_meta, MapLength(m_capacity));
+                        m_meta = nullptr;
+                    }
+                    if (ftruncate(m_fd, MapLength(capacity)) == -1) {
+                        return create_error(error_t::ftruncate_fail);
+                    }
+                    void* addr = mmap(NULL, MapLength(capacity), PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+                    if (addr == MAP_FAILED) {
+                        return create_error(error_t::mmap_fail);
+                    }
+                    m_meta = (MetaSt*)addr;
+                    m_capacity = capacity;
+                    return error(error_t::ok);
+                }
+
+            private:
+                // ļ
+                int         m_fd = -1;
+                // Ԫݼӳ
+                MetaSt*     m_meta = nullptr;
+                // ǰӳɵ
+                size_t      m_capacity = 0;
+                // ԴǼǵļ¼
+                uint64_t    m_pending = 0;
+                // һεǼǵļ¼
+                int64_t     m_last_key = INT64_MIN;
+            };
+
+            // ̰߳ȫ, д뷽дʱlocateǰԶύ
+            class Reader {
+            public:
+                Reader() = default;
+                ~Reader() { close(); }
+
+                error open(const std::string& file) {
+                    close();
+                    m_fd = ::open(file.c_str(), O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                    return open_impl();
+                }
+
+                error shm_open(const std::string& title) {
+                    close();
+                    m_fd = ::shm_open(title.c_str(), O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                    return open_impl();
+                }
+
+                // Ѽص
+                inline size_t size() const {
+                    return m_count;
+                }
+
+                inline const Entry* entries() const {
+                    return m_entries;
+                }
+
+                // д뷽ύ
+                error refresh() {
+                    if (m_fd == -1) {
+                        return error(error_t::open_fail, "not open");
+                    }
+                    struct stat sb;
+                    if (fstat(m_fd, &sb) == -1) {
+                        return create_error(error_t::stat_fail);
+                    }
+                    if ((size_t)sb.st_size < sizeof(MetaSt)) {
+                        return error(error_t::ok);
+                    }
+                    if ((size_t)sb.st_size > m_map_len) {
+                        void* addr = m_addr == MAP_FAILED
+                            ? mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, m_fd, 0)
+                            : mremap(m_addr, m_map_len, sb.st_size, MREMAP_MAYMOVE);
+                        if (addr == MAP_FAILED) {
+                            return create_error(error_t::mmap_fail);
+                        }
+                        m_addr = addr;
+                        m_map_len = sb.st_size;
+                    }
+                    MetaSt* meta = (MetaSt*)m_addr;
+                    if (meta->magic_ != INDEX_MAGIC) {
+                        return error(error_t::ok);
+                    }
+                    uint64_t count = __atomic_load_n(&meta->count_, __ATOMIC_ACQUIRE);
+                    m_count = std::min<size_t>(count, (m_map_len - sizeof(MetaSt)) / sizeof(Entry));
+                    m_entries = (const Entry*)(meta + 1);
+                    return error(error_t::ok);
+                }
+
+                // λСkeyļ¼[lo, hi], ü¼ƫƴlo(lo¼Сkey)Ϊ0, Ҳhi
+                // hiΪ׸Сkeyƫ, ޴ʱΪUINT64_MAX
+                std::tuple<uint64_t, uint64_t> locate(int64_t key) {
+                    refresh();
+                    const Entry* end = m_entries + m_count;
+                    const Entry* iter = std::lower_bound(m_entries, end, key, [](const Entry& entry, int64_t key) { return entry.key_ < key; });
+                    uint64_t lo = iter == m_entries ? 0 : (iter - 1)->offset_;
+                    uint64_t hi = iter == end ? UINT64_MAX : iter->offset_;
+                    return std::make_tuple(lo, hi);
+                }
+
+                void close() {
+                    if (m_addr != MAP_FAILED) {
+                        munmap(m_addr, m_map_len);
+                        m_addr = MAP_FAILED;
+                    }
+                    if (m_fd != -1) {
+                        ::close(m_fd);
+                        m_fd = -1;
+                    }
+                    m_map_len = 0;
+                    m_count = 0;
+                    m_entries = nullptr;
+                }
+
+            private:
+                error open_impl() {
+                    if (m_fd == -1) {
+                        return create_error(error_t::open_fail);
+                    }
+                    return refresh();
+                }
+
+            private:
+                // ļ
+                int             m_fd = -1;
+                // ӳַ
+                void*           m_addr = MAP_FAILED;
+                size_t          m_map_len = 0;
+                // Ѽص
+                size_t          m_count = 0;
+                const Entry*    m_entries = nullptr;
+            };
+        };
+
+        // ṩڹ̶дĴڴ, ļȲ̶, ʵʱ
+        class VectorBuffer {
+        protected:
+            enum : uint32_t {
+                META_MAGIC = 0x42564D4D,    // "MMVB"
+                META_VERSION = 1,
+            };
+    #pragma pack(push, 1)
+            // λԪݽṹ
+            struct MetaSt {
+                uint32_t magic_;        // ļͷʶ, ɰļ޴ֶ
+                uint32_t version_;      // ļͷ汾
+                size_t  item_size_;     // ÿдĴС
+                size_t  write_len_;     // ύݳ, releaseд, ȡԴΪ׼
+                size_t  file_len_;      // ݻ
+                size_t  reserve_len_;   // дݳ, write_len_ʱδύ
+                size_t  synced_len_;    // ݳ, ָʱԴ˴ʼУ
+                bool    clean_;         // д뷽ر, ٴ׷Ӵʱָ
+                bool    checksum_;      // Уļ¼ȫcrc32c
+                char    reserved_[6];
+                char    data_[0];       // ݻ
+            };
+            // ɰļͷ, ȡֻ, дǰ辭MigrateǨǰ汾
+            struct LegacyMetaSt {
+                size_t  item_size_;
+                size_t  write_len_;
+                size_t  file_len_;
+            };
+    #pragma pack(pop)
+
+            // Уļͷ, д뷽δʼ(ȫ0)ʱͬЧ
+            static error CheckMeta(const MetaSt& meta) {
+                if (meta.magic_ == META_MAGIC) {
+                    if (meta.version_ != META_VERSION) {
+                        return error(error_t::unsupported, "unsupported version");
+                    }
+                    return error(error_t::ok);
+                }
+                if (meta.magic_ == 0 && meta.write_len_ == 0) {
+                    return error(error_t::ok);
+                }
+                return error(error_t::unsupported, "legacy or unknown layout");
+            }
+
+            // ɰļͷȡ, ֶļǢʱΪɰļתΪǰṹ
+            static bool LoadLegacyMeta(int fd, MetaSt& meta) {
+                struct stat sb;
+                LegacyMetaSt legacy;
+                if (::fstat(fd, &sb) == -1 || (size_t)sb.st_size < sizeof(LegacyMetaSt)
+                    || pread(fd, &legacy, sizeof(LegacyMetaSt), 0) != (ssize_t)sizeof(LegacyMetaSt)) {
+                    return false;
+                }
+                if (legacy.item_size_ == 0 || legacy.file_len_ != (size_t)sb.st_size || legacy.write_len_ > legacy.file_len_ - sizeof(LegacyMetaSt)) {
+                    return false;
+                }
+                meta = MetaSt{};
+                meta.magic_ = META_MAGIC;
+                meta.version_ = META_VERSION;
+                meta.item_size_ = legacy.item_size_;
+                meta.write_len_ = legacy.write_len_;
+                meta.reserve_len_ = legacy.write_len_;
+                meta.file_len_ = sizeof(MetaSt) + legacy.write_len_;
+                meta.clean_ = true;
+                return true;
+            }
+
+        public:
+            // ɰļͷļǨǰ汾, Ϊǰ汾ʱֱӷ, ޷ʶʱerror_t::unsupported
+            // ʱļдrename滻, ڼ쳣˳ϵʱԭļ; Ǩڼ䲻д뷽򿪸ļ
+            // ڴǨ, д뷽׷Ӵؽ
+            static error Migrate(const std::string& file) {
+                int fd = ::open(file.c_str(), O_RDONLY);
+                if (fd == -1) {
+                    return create_error(error_t::open_fail);
+                }
+                MetaSt meta{};
+                error err(error_t::ok);
+                if (pread(fd, &meta, sizeof(MetaSt), 0) == (ssize_t)sizeof(MetaSt) && meta.magic_ == META_MAGIC) {
+                    err = CheckMeta(meta);
+                }
+                else if (LoadLegacyMeta(fd, meta)) {
+                    err = RewriteFile(fd, file, &meta, sizeof(MetaSt), sizeof(LegacyMetaSt), meta.write_len_);
+                }
+                else {
+                    err = error(error_t::unsupported, "unknown layout");
+                }
+                ::close(fd);
+                return err;
+            }
+
+            // ׷mmap, ÿξԤд, ֶΪļĳ
+            // дƽдг, releaseύ; Уļÿcrc32c
+            // ע: δУļʱ, 쳣˳ٴ׷Ӵ򿪽δύ, ύκУ, ϵʱܱδ̵
+            class Writer {
+            public:
+                Writer() = default;
+                ~Writer() {
+                    close();
+                }
+
+                // ׷Ӵ򿪾ɰļͷļʱerror_t::unsupportedҲĶļ, ȾMigrateǨ
+                error open(const std::string& file, size_t item_size, bool is_append = true, const off_t& init_buf_length = 4*1024*1024, const off_t& buf_step = 1024*1024) {
+                    bool is_create = false;
+                    auto err = MMapFile::OpenWriteFile<false>(m_fd, is_create, file, 0);
+                    if (err) return err;
+                    return open_impl(is_create, item_size, is_append, init_buf_length, buf_step);
+                }
+
+                error shm_open(const std::string& title, size_t item_size, bool is_append = true, const off_t& init_buf_length = 4*1024*1024, const off_t& buf_step = 1024*1024) {
+                    bool is_create = false;
+                    auto err = MMapFile::OpenWriteFile<true>(m_fd, is_create, title, 0);
+                    if (err) return err;
+                    return open_impl(is_create, item_size, is_append, init_buf_length, buf_step);
+                }
+
+                void reset_offset(const off_t& off) { 
+                    m_p_meta->reserve_len_ = off;
+                    m_p_meta->synced_len_ = std::min<size_t>(m_p_meta->synced_len_, off);
+                    __atomic_store_n(&m_p_meta->write_len_, (size_t)off, __ATOMIC_RELEASE);
+                    if (m_checksum) {
+                        m_checksum->reset_offset(off / m_p_meta->item_size_ * sizeof(uint32_t));
+                    }
+                }
+
+                // Уļ, ֮ÿcrc32c, д볤ΪС
+                // д뷽δرʱ, ̴У鲢ضһЧ; δ¼Уʱ¼
+                error open_checksum(const std::string& checksum_file) {
+                    return open_checksum_impl<false>(checksum_file);
+                }
+
+                error shm_open_checksum(const std::string& checksum_title) {
+                    return open_checksum_impl<true>(checksum_title);
+                }
+
+                // ύݼУ, ֮ϵ಻ʧ; ÿд, 趨ڵü
+                error sync() {
+                    if (m_p_meta == nullptr) {
+                        return error(error_t::ok);
+                    }
+                    if (m_checksum) {
+                        auto err = m_checksum->sync();
+                        if (err) {
+                            return err;
+                        }
+                    }
+                    size_t write_len = m_p_meta->write_len_;
+                    auto err = SyncRange(m_p_meta, sizeof(MetaSt) + m_p_meta->synced_len_, sizeof(MetaSt) + write_len);
+                    if (err) {
+                        return err;
+                    }
+                    m_p_meta->synced_len_ = write_len;
+                    return SyncRange(m_p_meta, 0, sizeof(MetaSt));
+                }
+
+                // һ׷Ӵʱָݳ
+                size_t get_discard_len() const {
+                    return m_discard_len;
+                }
+
+                template<typename _Ty>
+                error write(_Ty&& data) {
+                    return write((const char*)(&data), sizeof(_Ty));
+                }
+
+                // ϡ, ֮write_indexedдÿinterval¼һμƫ
+                error open_index(const std::string& index_file, size_t interval, bool is_append = true) {
+                    return m_index.open(index_file, interval, is_append);
+                }
+
+                error shm_open_index(const std::string& index_title, size_t interval, bool is_append = true) {
+                    return m_index.shm_open(index_title, interval, is_append);
+                }
+
+                // дǼ, 밴д˳ǵݼ, ճд뵫error_t::write_fail
+                template<typename _Ty>
+                error write_indexed(int64_t key, _Ty&& data) {
+                    return write_indexed(key, (const char*)(&data), sizeof(_Ty));
+                }
+
+                error write_indexed(int64_t key, const char* data, const size_t& len) {
+                    size_t offset = m_p_meta ? m_p_meta->write_len_ : 0;
+                    auto err = write(data, len);
+                    if (err || !m_index.is_open()) {
+                        return err;
+                    }
+                    return m_index.add(key, offset);
+                }
+
+                error write(const char* data, const size_t& len) {
+                    if (len == 0) {
+                        return error(error_t::ok);
+                    }
+                    auto err = check_add_length(len);
+                    if (err) {
+                        return err;
+                    }
+                    // ȼ¼У, ָʱύУĽСΪ׼
+                    if (m_checksum) {
+                        err = write_checksum(data, len);
+                        if (err) {
+                            return err;
+                        }
+                    }
+                    else {
+                        m_p_meta->checksum_ = false;
+                    }
+
+                    m_p_meta->reserve_len_ = m_p_meta->write_len_ + len;
+                    memcpy((char*)(m_data + m_p_meta->write_len_), data, len);
+                    // releaseд볤, acquireȡ󼴿ɼύ
+                    __atomic_store_n(&m_p_meta->write_len_, m_p_meta->reserve_len_, __ATOMIC_RELEASE);
+                    return error(error_t::ok);
+                }
+
+                void close() {
+                    m_index.close();
+                    if (m_checksum) {
+                        m_checksum->close();
+                        m_checksum.reset();
+                    }
+                    // ȡļӳ䲢رļ
+                    if (m_p_meta) {
+                        auto write_len = m_p_meta->write_len_;
+                        auto file_len = m_p_meta->file_len_;
+                        m_p_meta->file_len_ = write_len + sizeof(MetaSt);
+                        m_p_meta->reserve_len_ = write_len;
+                        m_p_meta->clean_ = true;
+                        munmap((void*)m_p_meta, file_len);
+                        auto ret = ftruncate(m_fd, write_len + sizeof(MetaSt));
+                        (void)ret;
+                        m_p_meta = nullptr;
+                        m_data = nullptr;
+                    }
+
+                    if (m_fd != -1) {
+                        ::close(m_fd);
+                        m_fd = -1;
+                    }
+                }
+
+            private:
+                error open_impl(bool is_create, size_t item_size, bool is_append, const off_t& init_buf_length, const off_t& buf_step) {
+                    bool is_reset = is_create || !is_append;
+                    if (!is_reset) {
+                        auto err = load_meta(is_reset);
+                        if (err) {
+                            close();
+                            return err;
+                        }
+                    }
+                    m_buf_step = buf_step;
+                    auto err = check_add_length(init_buf_length);
+                    if (err) return err;
+                    init_meta(is_reset, item_size);
+                    return err;
+                }
+
+                // Уļͷ, δʼʱ; ɰļͷĶ, ȾMigrateǨ
+                error load_meta(bool& is_reset) {
+                    struct stat sb;
+                    if (::fstat(m_fd, &sb) == -1) {
+                        return create_error(error_t::stat_fail);
+                    }
+                    size_t file_size = sb.st_size;
+                    MetaSt meta{};
+                    if (pread(m_fd, &meta, std::min(file_size, sizeof(MetaSt)), 0) != (ssize_t)std::min(file_size, sizeof(MetaSt))) {
+                        return create_error(error_t::open_fail);
+                    }
+                    auto err = CheckMeta(meta);
+                    if (!err) {
+                        is_reset = meta.magic_ != META_MAGIC;
+                        return err;
+                    }
+                    if (meta.magic_ != META_MAGIC && LoadLegacyMeta(m_fd, meta)) {
+                        return error(error_t::unsupported, "legacy layout is read-only, migrate with VectorBuffer::Migrate");
+                    }
+                    return err;
+                }
+
+                void init_meta(bool is_reset, size_t item_size) {
+                    m_discard_len = 0;
+                    m_need_verify = false;
+                    if (is_reset) {
+                        m_p_meta->magic_ = META_MAGIC;
+                        m_p_meta->version_ = META_VERSION;
+                        m_p_meta->item_size_ = item_size;
+                        m_p_meta->reserve_len_ = 0;
+                        m_p_meta->synced_len_ = 0;
+                        m_p_meta->checksum_ = true;
+                        m_p_meta->write_len_ = 0;
+                    }
+                    else if (!m_p_meta->clean_) {
+                        // д뷽δر, δύ, УڿУļʱ
+                        m_discard_len = std::max(m_p_meta->reserve_len_, m_p_meta->write_len_) - m_p_meta->write_len_;
+                        m_p_meta->reserve_len_ = m_p_meta->write_len_;
+                        m_need_verify = true;
+                    }
+                    m_p_meta->clean_ = false;
+                }
+
+                template<bool is_shm>
+                error open_checksum_impl(const std::string& title) {
+                    if (m_p_meta == nullptr || m_p_meta->item_size_ == 0) {
+                        return error(error_t::open_fail);
+                    }
+                    auto checksum = std::make_unique<Writer>();
+                    error err;
+                    if constexpr (is_shm)
+                        err = checksum->shm_open(title, sizeof(uint32_t), true, sizeof(MetaSt) + m_p_meta->file_len_ / m_p_meta->item_size_ * sizeof(uint32_t), m_buf_step);
+                    else
+                        err = checksum->open(title, sizeof(uint32_t), true, sizeof(MetaSt) + m_p_meta->file_len_ / m_p_meta->item_size_ * sizeof(uint32_t), m_buf_step);
+                    if (err) {
+                        return err;
+                    }
+
+                    size_t item_size = m_p_meta->item_size_;
+                    size_t item_count = m_p_meta->write_len_ / item_size;
+                    const uint32_t* crcs = (const uint32_t*)checksum->m_data;
+                    size_t crc_count = checksum->m_p_meta->write_len_ / sizeof(uint32_t);
+                    size_t valid_count = std::min(item_count, crc_count);
+                    if (m_p_meta->checksum_ && m_need_verify) {
+                        // ̴У
+                        size_t index = std::min(m_p_meta->synced_len_ / item_size, valid_count);
+                        while (index < valid_count && Crc32c(m_data + index * item_size, item_size) == crcs[index]) {
+                            ++index;
+                        }
+                        valid_count = index;
+                    }
+                    else if (!m_p_meta->checksum_) {
+                        // δ¼У, ¼
+                        checksum->reset_offset(0);
+                        for (size_t index = 0; index < item_count; ++index) {
+                            err = checksum->write(Crc32c(m_data + index * item_size, item_size));
+                            if (err) {
+                                return err;
+                            }
+                        }
+                        valid_count = item_count;
+                    }
+                    m_need_verify = false;
+
+                    size_t valid_len = valid_count * item_size;
+                    if (valid_len != m_p_meta->write_len_) {
+                        m_discard_len += m_p_meta->write_len_ - valid_len;
+                        reset_offset(valid_len);
+                    }
+                    if (crc_count != valid_count) {
+                        checksum->reset_offset(valid_count * sizeof(uint32_t));
+                    }
+                    m_p_meta->checksum_ = true;
+                    m_checksum = std::move(checksum);
+                    return error(error_t::ok);
+                }
+
+                error write_checksum(const char* data, size_t len) {
+                    size_t item_size = m_p_meta->item_size_;
+                    if (len % item_size != 0) {
+                        return error(error_t::write_fail);
+                    }
+                    size_t count = len / item_size;
+                    auto err = m_checksum->check_add_length(count * sizeof(uint32_t));
+                    if (err) {
+                        return err;
+                    }
+                    uint32_t* crcs = (uint32_t*)(m_checksum->m_data + m_checksum->m_p_meta->write_len_);
+                    for (size_t index = 0; index < count; ++index) {
+                        crcs[index] = Crc32c(data + index * item_size, item_size);
+                    }
+                    MetaSt* meta = m_checksum->m_p_meta;
+                    meta->reserve_len_ = meta->write_len_ + count * sizeof(uint32_t);
+                    __atomic_store_n(&meta->write_len_, meta->reserve_len_, __ATOMIC_RELEASE);
+                    return error(error_t::ok);
+                }
+
                 error check_add_length(const off_t& len) {
                     // ʣռ
                     size_t write_len = 0;
-                    size_t file_len = 0;
-                    if (m_p_meta) {
-                        if (m_p_meta->write_len_ + len <= m_p_meta->file_len_) {
-                            return error(error_t::ok);
+                    size_t file_len = 0;
+                    if (m_p_meta) {
+                        if (sizeof(MetaSt) + m_p_meta->write_len_ + len <= m_p_meta->file_len_) {
+                            return error(error_t::ok);
+                        }
+                        write_len = m_p_meta->write_len_;
+                        file_len = m_p_meta->file_len_;
+
+                        // ļСֵ, ҪչļС
+                        // ȡļӳ䲢رļ
+                        if (munmap((void*)m_p_meta, m_p_meta->file_len_) == -1) {
+                            return create_error(error_t::munmap_fail);
+                        }
+                        m_p_meta = nullptr;
+                        m_data = nullptr;
+                    }
+                    else {
+                        // ״ӳ, ļɽض
+                        struct stat file_stat;
+                        if (::fstat(m_fd, &file_stat) == -1) {
+                            return create_error(error_t::stat_fail);
+                        }
+                        file_len = file_stat.st_size;
+                    }
+
+                    while (write_len + sizeof(MetaSt) + len > file_len) {
+                        file_len += m_buf_step;
+                    }
+                    file_len = (file_len + sysconf(_SC_PAGE_SIZE) - 1) & ~(sysconf(_SC_PAGE_SIZE) - 1);
+                    if (ftruncate(m_fd, file_len) == -1) {
+                        return create_error(error_t::ftruncate_fail);
+                    }
+                    // ļӳ䲢׷д
+                    void* data = mmap(NULL, file_len, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+                    if (data == MAP_FAILED) {
+                        return create_error(error_t::mmap_fail);
+                    }
+                    m_p_meta = (MetaSt*)data;
+                    m_p_meta->file_len_ = file_len;
+                    m_data = (char*)data + sizeof(MetaSt);
+                    return error(error_t::ok);
+                }
+
+            private:
+                // ļ
+                int         m_fd = -1;
+                // ÿεֵ
+                off_t       m_buf_step = 0;
+                // ļʵܳȴ洢ָ
+                MetaSt*     m_p_meta = nullptr;
+                // mmapʼַ
+                char*       m_data = nullptr;
+                // ϡ, δʱ¼
+                SparseIndex::Writer m_index;
+                // Уļ, δʱ¼
+                std::unique_ptr<Writer> m_checksum;
+                // ʱд뷽δر, УļʱУ
+                bool        m_need_verify = false;
+                // һλָݳ
+                size_t      m_discard_len = 0;
+            };
+            
+            // ̰߳ȫ
+            // ֿȡ(read)ȡʱд; (read_follow)ȡд뷽ύ
+            class Reader {
+                enum : unsigned {
+                    FOLLOW_SPIN_COUNT = 1000,       // ȴʱæѯ
+                    FOLLOW_YIELD_COUNT = 100,       // æѯóʱƬ
+                    FOLLOW_MAX_SLEEP_US = 1000,     // ֮ʱ, 
+                };
+
+            public:
+                explicit Reader(bool can_change = false) : m_can_change(can_change), m_item_size(1) {}
+                ~Reader() { close(); }
+
+                error open(const std::string& file, size_t chunk_size) {
+                    // ļ
+                    auto err = init<false>(file);
+                    if (err) return err;
+                    return open_impl(chunk_size);
+                }
+
+                error shm_open(const std::string& title, size_t chunk_size) {
+                    // ļ
+                    auto err = init<true>(title);
+                    if (err) return err;
+                    return open_impl(chunk_size);
+                }
+
+                inline long long get_obj_num() const {
+                    return m_meta.write_len_ / m_item_size;
+                }
+
+                inline size_t get_obj_size() const {
+                    return m_item_size;
+                }
+
+                inline void* get_data() const {
+                    return m_cur_read_addr;
+                }
+
+                inline size_t get_chunk_index() const {
+                    return m_cur_chunk_index;
+                }
+
+                // ÷ֿȡķʾ, read_hint_t, ڸ
+                void set_hints(unsigned hints, size_t populate_limit = ReadAdvisor::DEFAULT_POPULATE_LIMIT, size_t hugepage_min = ReadAdvisor::DEFAULT_HUGEPAGE_MIN) {
+                    m_advisor.set_hints(hints, populate_limit, hugepage_min);
+                }
+
+                template<typename Type>
+                std::tuple<error, Type*> read_next() {
+                    if (m_cur_read_buf_length < m_cur_chunk_offset + sizeof(Type)) {
+                        auto [err, item, count] = read<Type>();
+                        if (err || count == 0)
+                            return std::forward_as_tuple(err, nullptr);
+                        m_cur_chunk_offset += sizeof(Type);
+                        return std::forward_as_tuple(err, item); 
+                    }
+                    char* data = (char*)m_cur_read_addr + m_cur_chunk_offset;
+                    m_cur_chunk_offset += sizeof(Type);
+                    return std::forward_as_tuple(error_t::ok, (Type*)data);
+                }
+
+                template<typename Type>
+                std::tuple<error, Type*, size_t/*count*/> read() {
+                    auto [ok, data] = read();
+                    return std::forward_as_tuple(ok, (Type*)data.data(), data.length() / sizeof(Type));
+                }
+
+                std::tuple<error, std::string_view> read() {
+                    // ϴζȡ
+                    error_t err_code = clean_mmap();
+                    if (err_code != error_t::ok) {
+                        return std::forward_as_tuple(create_error(err_code), std::string_view{});
+                    }
+                    if ((size_t)m_cur_file_offset + m_cur_read_buf_length >= (size_t)m_meta.write_len_) {
+                        return std::forward_as_tuple(error_t::ok, std::string_view{});
+                    }
+
+                    calc_current();
+                    int flags = m_advisor.map_flags(m_file_size);
+                    if (!m_can_change)
+                        m_cur_read_addr = mmap(NULL, m_cur_read_chunk_length, PROT_READ, flags, m_fd, m_pa_offset);
+                    else
+                        m_cur_read_addr = mmap(NULL, m_cur_read_chunk_length, PROT_READ | PROT_WRITE, flags, m_fd, m_pa_offset);
+
+                    if (m_cur_read_addr == MAP_FAILED) {
+                        return std::forward_as_tuple(create_error(error_t::mmap_fail), std::string_view{});
+                    }
+                    m_advisor.on_map(m_cur_read_addr, m_cur_read_chunk_length);
+                    m_cur_chunk_index++;
+                    // Ԥһ
+                    if (m_cur_chunk_index < m_num_chunks) {
+                        size_t next_offset = m_cur_chunk_index * m_chunk_size;
+                        m_advisor.prefetch(m_fd, m_head_len + next_offset, std::min<size_t>(m_chunk_size, m_meta.write_len_ - next_offset));
+                    }
+                    return std::forward_as_tuple(error_t::ok, std::string_view((char*)m_cur_read_addr + m_cur_file_offset - m_pa_offset, m_cur_read_buf_length));
+                }
+
+                // øʼ±, Ĭ׸ʼ
+                void seek_follow(size_t index) {
+                    m_follow_offset = index * m_item_size;
+                }
+
+                // һ±
+                inline size_t get_follow_index() const {
+                    return m_follow_offset / m_item_size;
+                }
+
+                template<typename Type>
+                std::tuple<error, Type*, size_t/*count*/> read_follow(size_t max_count, unsigned timeout_us = 0) {
+                    auto [err, data] = read_follow(max_count, timeout_us);
+                    return std::forward_as_tuple(err, (Type*)data.data(), data.length() / sizeof(Type));
+                }
+
+                // : ϴθλд뷽ύ, max_count
+                // ʱæѯ, óʱƬ, ֮, ȴtimeout_us΢, ʱؿ
+                // д뷽չļԶӳ, ´εread_followcloseǰЧ
+                // д뷽д볤(׷Ӵ򿪻reset_offset)λ֮ǰʱ, ׸¸
+                std::tuple<error, std::string_view> read_follow(size_t max_count, unsigned timeout_us = 0) {
+                    size_t write_len = 0;
+                    auto err = load_follow_len(write_len);
+                    if (err) {
+                        return std::forward_as_tuple(err, std::string_view{});
+                    }
+                    // ʱд뷽δɳʼ
+                    if (m_item_size <= 0) {
+                        m_item_size = (int)((MetaSt*)m_follow_addr)->item_size_;
+                        if (m_item_size <= 0) {
+                            return std::forward_as_tuple(error(error_t::ok), std::string_view{});
+                        }
+                    }
+                    if (write_len < m_follow_offset) {
+                        m_follow_offset = 0;
+                    }
+
+                    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
+                    unsigned sleep_us = 0;
+                    for (unsigned times = 0; write_len < m_follow_offset + m_item_size; ++times) {
+                        if (times >= FOLLOW_SPIN_COUNT) {
+                            auto now = std::chrono::steady_clock::now();
+                            if (now >= deadline) {
+                                return std::forward_as_tuple(error(error_t::ok), std::string_view{});
+                            }
+                            if (times < FOLLOW_SPIN_COUNT + FOLLOW_YIELD_COUNT) {
+                                std::this_thread::yield();
+                            }
+                            else {
+                                sleep_us = std::min<unsigned>(sleep_us == 0 ? 1 : sleep_us * 2, FOLLOW_MAX_SLEEP_US);
+                                std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(std::chrono::microseconds(sleep_us), deadline - now));
+                            }
+                        }
+                        else if (timeout_us == 0) {
+                            return std::forward_as_tuple(error(error_t::ok), std::string_view{});
+                        }
+                        write_len = load_write_len();
+                        if (write_len < m_follow_offset) {
+                            m_follow_offset = 0;
+                        }
+                    }
+
+                    size_t count = std::min<size_t>((write_len - m_follow_offset) / m_item_size, max_count);
+                    size_t length = count * m_item_size;
+                    err = remap_follow(m_head_len + m_follow_offset + length);
+                    if (err) {
+                        return std::forward_as_tuple(err, std::string_view{});
+                    }
+                    std::string_view data((char*)m_follow_addr + m_head_len + m_follow_offset, length);
+                    m_follow_offset += length;
+                    return std::forward_as_tuple(error(error_t::ok), data);
+                }
+
+                // ϡλ[begin, end)ڵ, key_of(const Type&)ȡ, ǵݼ
+                // ڶֲ, ҳ; ӳ, ´εread_range/read_followcloseǰЧ
+                template<typename Type, typename KeyFunc>
+                std::tuple<error, Type*, size_t/*count*/> read_range(SparseIndex::Reader& index, int64_t begin, int64_t end, KeyFunc&& key_of) {
+                    size_t write_len = 0;
+                    auto err = load_follow_len(write_len);
+                    if (!err) {
+                        err = remap_follow(m_head_len + write_len);
+                    }
+                    if (err || end <= begin) {
+                        return std::forward_as_tuple(err, nullptr, 0);
+                    }
+                    Type* items = (Type*)((char*)m_follow_addr + m_head_len);
+                    size_t count = write_len / sizeof(Type);
+
+                    // ׸Сkey±
+                    auto lower_index = [&](int64_t key) {
+                        auto [lo, hi] = index.locate(key);
+                        size_t first = std::min<size_t>(lo / sizeof(Type), count);
+                        size_t last = hi == UINT64_MAX ? count : std::min<size_t>(hi / sizeof(Type) + 1, count);
+                        return (size_t)(std::partition_point(items + first, items + last, [&](const Type& item) { return key_of(item) < key; }) - items);
+                    };
+                    size_t first = lower_index(begin);
+                    size_t last = std::max(first, lower_index(end));
+                    return std::forward_as_tuple(error(error_t::ok), items + first, last - first);
+                }
+
+                // зɨ, ʱύзΪpartitions(0ΪӲ߳), pool(ṩadd_task, ParallelTaskPool)д
+                // 񰴴ʱĿСӳ, λصfunc(size_t partition, std::string_view chunk), falseʱ
+                // pool̵֮߳, ȫɺ󷵻
+                template<typename TTaskPool, typename Func>
+                error scan(TTaskPool& pool, size_t partitions, Func&& func) const {
+                    return scan<char>(pool, partitions
+                        , [&](size_t partition, char&, std::string_view chunk) { return func(partition, chunk); }
+                        , [](size_t, char&&) {});
+                }
+
+                // ϲĲзɨ, ÿĬϹResultۼ, λصfunc(size_t partition, Result&, std::string_view chunk)
+                // ɺڵ̰߳˳صmerge(size_t partition, Result&&)
+                template<typename Result, typename TTaskPool, typename Func, typename MergeFunc>
+                error scan(TTaskPool& pool, size_t partitions, Func&& func, MergeFunc&& merge) const {
+                    return ScanFile<Result>(pool, m_fd, m_head_len, m_meta.write_len_, m_item_size, m_chunk_size, partitions, m_advisor, std::forward<Func>(func), std::forward<MergeFunc>(merge));
+                }
+
+                error close() {
+                    clean_mmap();
+                    m_advisor.stop();
+                    if (m_follow_addr != MAP_FAILED) {
+                        munmap(m_follow_addr, m_follow_map_len);
+                        m_follow_addr = MAP_FAILED;
+                        m_follow_map_len = 0;
+                    }
+
+                    if (m_fd != -1 && ::close(m_fd) == -1) {
+                        return create_error(error_t::close_fail);
+                    }
+                    m_fd = -1;
+                    return error(error_t::ok);
+                }
+
+            private:
+                // ȡд뷽ύ, ״θʱӳ
+                error load_follow_len(size_t& write_len) {
+                    if (m_follow_addr == MAP_FAILED) {
+                        auto err = remap_follow(m_head_len + m_meta.write_len_);
+                        if (err) {
+                            return err;
+                        }
+                    }
+                    write_len = load_write_len();
+                    return error(error_t::ok);
+                }
+
+                // ȡд뷽ύ, ɰļͷиֶλòͬ
+                size_t load_write_len() const {
+                    if (m_legacy) {
+                        return __atomic_load_n(&((LegacyMetaSt*)m_follow_addr)->write_len_, __ATOMIC_ACQUIRE);
+                    }
+                    return __atomic_load_n(&((MetaSt*)m_follow_addr)->write_len_, __ATOMIC_ACQUIRE);
+                }
+
+                // ӳļʼ, Ȳlengthʱ, ӳɳļ, ύ
+                error remap_follow(size_t length) {
+                    if (m_follow_addr != MAP_FAILED && length <= m_follow_map_len) {
+                        return error(error_t::ok);
+                    }
+                    size_t map_len = std::max<size_t>(length, m_follow_map_len * 2);
+                    map_len = (map_len + m_page_size - 1) & ~(m_page_size - 1);
+                    void* addr = MAP_FAILED;
+                    if (m_follow_addr == MAP_FAILED)
+                        addr = mmap(NULL, map_len, m_can_change ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, m_fd, 0);
+                    else
+                        addr = mremap(m_follow_addr, m_follow_map_len, map_len, MREMAP_MAYMOVE);
+                    if (addr == MAP_FAILED) {
+                        return create_error(error_t::mmap_fail);
+                    }
+                    m_follow_addr = addr;
+                    m_follow_map_len = map_len;
+                    return error(error_t::ok);
+                }
+
+                // ɰļͷļͬɶ, ʼƫm_head_lenΪ׼
+                template<bool is_shm>
+                error init(const std::string& title) {
+                    MetaSt meta{};
+                    {
+                        Mapper<MetaSt> meta_mapping;
+                        error err;
+                        if constexpr (is_shm)
+                            err = meta_mapping.shm_open(title);
+                        else 
+                            err = meta_mapping.open(title);
+                        if (err) {
+                            return err;
+                        }
+                        meta = *meta_mapping.get();
+                    }
+
+                    if constexpr (is_shm) {
+                        if (!m_can_change) 
+                            m_fd = ::shm_open(title.c_str(), O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                        else
+                            m_fd = ::shm_open(title.c_str(), O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                    }
+                    else {
+                        if (!m_can_change) 
+                            m_fd = ::open(title.c_str(), O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                        else
+                            m_fd = ::open(title.c_str(), O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                    }
+
+                    m_legacy = false;
+                    m_head_len = sizeof(MetaSt);
+                    auto err = CheckMeta(meta);
+                    if (err) {
+                        if (meta.magic_ == META_MAGIC || m_fd == -1 || !LoadLegacyMeta(m_fd, meta)) {
+                            close();
+                            return err;
+                        }
+                        m_legacy = true;
+                        m_head_len = sizeof(LegacyMetaSt);
+                    }
+                    m_file_size = m_head_len + meta.write_len_;
+                    m_item_size = meta.item_size_;
+                    m_meta = meta;
+                    return error(error_t::ok);
+                }
+                error open_impl(size_t chunk_size) {
+                    size_t data_size = m_meta.write_len_;
+                    // ȡļܴС
+                    // С
+                    m_chunk_size = chunk_size * m_item_size;
+                    if (m_chunk_size > data_size) {
+                        m_chunk_size = data_size;
+                    }
+                    // 
+                    if (m_chunk_size > 0) {
+                        // ȡ
+                        m_num_chunks = (data_size + m_chunk_size - 1) / m_chunk_size;
+                    }
+                    return error(error_t::ok);
+                }
+
+                error_t clean_mmap() {
+                    error_t err_code = error_t::ok;
+                    if (m_cur_read_addr != MAP_FAILED) {
+                        m_advisor.on_unmap(m_fd, m_cur_read_addr, m_cur_read_chunk_length, m_pa_offset);
+                        if (munmap(m_cur_read_addr, m_cur_read_chunk_length) == -1) {
+                            err_code = error_t::munmap_fail;
+                        }
+                        m_cur_read_addr = MAP_FAILED;
+                    }
+                    return err_code;
+                }
+
+                void calc_current() {
+                    m_cur_chunk_offset = 0;
+                    m_cur_file_offset = m_head_len + m_cur_chunk_index * m_chunk_size;
+                    
+                    // һҪ
+                    m_cur_read_buf_length = (m_cur_chunk_index < m_num_chunks - 1) ? m_chunk_size : m_meta.write_len_ - m_cur_chunk_index * m_chunk_size;
+
+                    // ȡһ߽
+                    m_pa_offset = m_cur_file_offset & ~(m_page_size - 1);
+                    m_cur_read_chunk_length = m_cur_read_buf_length + m_cur_file_offset - m_pa_offset;
+                }
+
+            private:
+                // ҳС
+                off_t       m_page_size = sysconf(_SC_PAGE_SIZE);
+                // Ƿɸıļ
+                bool        m_can_change;
+                // С
+                int         m_item_size;
+                // ļ
+                int         m_fd = -1;
+                // ļܴС
+                off_t       m_file_size = 0;
+                // ǰȡƯλ(ļͷ)
+                off_t       m_cur_chunk_offset = 0;
+                // ļͷ
+                off_t       m_cur_file_offset = 0;
+                // ʼƯλ
+                off_t       m_pa_offset = 0;
+                // ȡĿС
+                size_t      m_chunk_size = 0;
+                // ȡĿ
+                size_t      m_num_chunks = 0;
+                // ǰȡĿ±
+                size_t      m_cur_chunk_index = 0;
+                // ǰȡڴַ
+                void*       m_cur_read_addr = MAP_FAILED;
+                // ǰȡڴ泤(ļͷ)
+                size_t      m_cur_read_buf_length = 0;
+                // ǰȡĿС, ҳ
+                size_t      m_cur_read_chunk_length = 0;
+                // ʱԪ, ɰļͷתΪǰṹ
+                MetaSt      m_meta;
+                // ļͷȼʼƫ, ɰļͷΪsizeof(LegacyMetaSt)
+                size_t      m_head_len = sizeof(MetaSt);
+                // ǷΪɰļͷ, ɶȡ
+                bool        m_legacy = false;
+                // ӳַ, ļʼ
+                void*       m_follow_addr = MAP_FAILED;
+                // ӳ䳤
+                size_t      m_follow_map_len = 0;
+                // һλ(ļͷ)
+                size_t      m_follow_offset = 0;
+                // ֿȡķʾ
+                ReadAdvisor m_advisor;
+            };            
+        };
+
+        // ѹ, ¼ѹ׷д, ʺϳڹ鵵ȶṹ
+        // ѹǰɶָ(, ʱ)һ¼(仯Сĸ, ۸), ֽƽ, ѹ
+        // ѹ㷨ʱ__USE_LZ4____USE_ZSTD__ӶӦ, ѹĿ鰴ԭ洢
+        // ļṹ: MetaSt + (BlockHead + ѹ)... + (BlockEntry...), رʱд
+        // д뷽δرʱ޿, ȡ׷Ӵ򿪵д뷽ͷؽ, ضһУͨĿ
+        class BlockBuffer {
+        public:
+            // ѹ㷨
+            enum class codec_t : uint8_t {
+                none = 0,
+                lz4 = 1,
+                zstd = 2,
+            };
+
+            // б任
+            enum class transform_t : uint8_t {
+                delta = 1,      // һ¼
+                xor_prev = 2,   // һ¼
+            };
+
+            enum : uint32_t {
+                BLOCK_MAGIC = 0x4B4C4242,
+                MAX_COLUMNS = 16,
+                DEFAULT_BLOCK_RECORDS = 4096,
+            };
+
+            // Ĭѹ㷨, ȡѱֵ֧㷨, lz4
+#if defined(__USE_LZ4__)
+            static constexpr codec_t DEFAULT_CODEC = codec_t::lz4;
+#elif defined(__USE_ZSTD__)
+            static constexpr codec_t DEFAULT_CODEC = codec_t::zstd;
+#else
+            static constexpr codec_t DEFAULT_CODEC = codec_t::none;
+#endif
+
+            // Ƿѱָ֧ѹ㷨
+            static bool Supported(codec_t codec) {
+                switch (codec) {
+                case codec_t::none:
+                    return true;
+#if defined(__USE_LZ4__)
+                case codec_t::lz4:
+                    return true;
+#endif
+#if defined(__USE_ZSTD__)
+                case codec_t::zstd:
+                    return true;
+#endif
+                default:
+                    return false;
+                }
+            }
+
+        protected:
+    #pragma pack(push, 1)
+            // б任
+            struct Column {
+                uint16_t    offset_;            // ڼ¼еƫ
+                uint8_t     size_;              // г, 48
+                uint8_t     kind_;              // transform_t
+            };
+            struct MetaSt {
+                uint32_t    magic_;
+                uint32_t    record_size_;       // ¼
+                uint32_t    block_records_;     // ÿ¼
+                uint8_t     codec_;             // ѹ㷨, codec_t
+                uint8_t     shuffle_;           // Ƿֽƽ
+                uint8_t     column_count_;      // б任
+                uint8_t     reserved_;
+                uint64_t    write_len_;         // ύݳ(sizeof(MetaSt))
+                uint64_t    record_count_;      // ύ¼
+                uint64_t    index_offset_;      // ļеƫ, 0ʾ޿
+                uint64_t    block_count_;       // 
+                Column      columns_[MAX_COLUMNS];
+            };
+            // ͷ, Ϊѹ
+            struct BlockHead {
+                uint32_t    record_count_;      // ڼ¼
+                uint32_t    comp_len_;          // ѹݳ
+                uint32_t    crc_;               // ѹݵcrc32c
+                uint8_t     codec_;             // ʵʹõѹ㷨, ѹʱΪnone
+                uint8_t     reserved_[3];
+            };
+            // 
+            struct BlockEntry {
+                uint64_t    offset_;            // ͷļеƫ
+                uint64_t    first_record_;      // ¼±
+            };
+    #pragma pack(pop)
+
+            // ѹ, ʧܻδ֧ʱ0
+            static size_t Compress(codec_t codec, int level, const char* src, size_t len, std::string& dst) {
+                switch (codec) {
+#if defined(__USE_LZ4__)
+                case codec_t::lz4: {
+                    dst.resize(LZ4_compressBound((int)len));
+                    int ret = LZ4_compress_default(src, dst.data(), (int)len, (int)dst.size());
+                    return ret > 0 ? ret : 0;
+                }
+#endif
+#if defined(__USE_ZSTD__)
+                case codec_t::zstd: {
+                    dst.resize(ZSTD_compressBound(len));
+                    size_t ret = ZSTD_compress(dst.data(), dst.size(), src, len, level == 0 ? 1 : level);
+                    return ZSTD_isError(ret) ? 0 : ret;
+                }
+#endif
+                default:
+                    (void)level; (void)src; (void)len; (void)dst;
+                    return 0;
+                }
+            }
+
+            // ѹ, ѹ󳤶Ϊraw_len
+            static bool Decompress(codec_t codec, const char* src, size_t len, char* dst, size_t raw_len) {
+                switch (codec) {
+                case codec_t::none:
+                    if (len != raw_len)
+                        return false;
+                    memcpy(dst, src, len);
+                    return true;
+#if defined(__USE_LZ4__)
+                case codec_t::lz4:
+                    return LZ4_decompress_safe(src, dst, (int)len, (int)raw_len) == (int)raw_len;
+#endif
+#if defined(__USE_ZSTD__)
+                case codec_t::zstd: {
+                    size_t ret = ZSTD_decompress(dst, raw_len, src, len);
+                    return !ZSTD_isError(ret) && ret == raw_len;
+                }
+#endif
+                default:
+                    return false;
+                }
+            }
+
+            // б任, ʱԺǰһ¼ԭֵ, ʱǰһ¼ѻԭֵ
+            template<typename Type>
+            static void TransformColumn(char* data, size_t count, size_t record_size, size_t offset, transform_t kind, bool encode) {
+                auto load = [&](size_t index) { Type value; memcpy(&value, data + index * record_size + offset, sizeof(Type)); return value; };
+                auto store = [&](size_t index, Type value) { memcpy(data + index * record_size + offset, &value, sizeof(Type)); };
+                if (encode) {
+                    for (size_t index = count - 1; index > 0; --index) {
+                        store(index, kind == transform_t::delta ? Type(load(index) - load(index - 1)) : Type(load(index) ^ load(index - 1)));
+                    }
+                }
+                else {
+                    for (size_t index = 1; index < count; ++index) {
+                        store(index, kind == transform_t::delta ? Type(load(index) + load(index - 1)) : Type(load(index) ^ load(index - 1)));
+                    }
+                }
+            }
+
+            static void TransformColumns(const MetaSt& meta, char* data, size_t count, bool encode) {
+                if (count < 2) {
+                    return;
+                }
+                for (size_t i = 0; i < meta.column_count_; ++i) {
+                    const Column& column = meta.columns_[i];
+                    if (column.size_ == sizeof(uint32_t))
+                        TransformColumn<uint32_t>(data, count, meta.record_size_, column.offset_, (transform_t)column.kind_, encode);
+                    else
+                        TransformColumn<uint64_t>(data, count, meta.record_size_, column.offset_, (transform_t)column.kind_, encode);
+                }
+            }
+
+            // , شѹ, λworkshuffle
+            static const char* Encode(const MetaSt& meta, const char* raw, size_t count, std::string& work, std::string& shuffle) {
+                size_t record_size = meta.record_size_;
+                size_t len = count * record_size;
+                if (meta.column_count_ > 0) {
+                    work.assign(raw, len);
+                    TransformColumns(meta, work.data(), count, true);
+                    raw = work.data();
+                }
+                if (!meta.shuffle_) {
+                    return raw;
+                }
+                // ֽƽ, ͬһֶεĸֽ
+                shuffle.resize(len);
+                for (size_t byte = 0; byte < record_size; ++byte) {
+                    char* plane = shuffle.data() + byte * count;
+                    for (size_t index = 0; index < count; ++index) {
+                        plane[index] = raw[index * record_size + byte];
+                    }
+                }
+                return shuffle.data();
+            }
+
+            // У鲢out, block_lenΪɷʳ, countΪӦ¼, workΪʱ
+            static bool Decode(const MetaSt& meta, const char* block, size_t block_len, size_t count, char* out, std::string& work) {
+                BlockHead head;
+                if (block_len < sizeof(BlockHead)) {
+                    return false;
+                }
+                memcpy(&head, block, sizeof(BlockHead));
+                const char* comp = block + sizeof(BlockHead);
+                if (head.record_count_ != count || head.comp_len_ > block_len - sizeof(BlockHead) || Crc32c(comp, head.comp_len_) != head.crc_) {
+                    return false;
+                }
+                size_t record_size = meta.record_size_;
+                size_t len = count * record_size;
+                char* dst = out;
+                if (meta.shuffle_) {
+                    work.resize(len);
+                    dst = work.data();
+                }
+                if (!Decompress((codec_t)head.codec_, comp, head.comp_len_, dst, len)) {
+                    return false;
+                }
+                if (meta.shuffle_) {
+                    for (size_t byte = 0; byte < record_size; ++byte) {
+                        const char* plane = dst + byte * count;
+                        for (size_t index = 0; index < count; ++index) {
+                            out[index * record_size + byte] = plane[index];
+                        }
+                    }
+                }
+                TransformColumns(meta, out, count, false);
+                return true;
+            }
+
+            // ȡ, ޿Чʱͷؽ, metaΪЧ
+            static void LoadIndex(const char* base, size_t file_size, MetaSt& meta, std::vector<BlockEntry>& entries) {
+                entries.clear();
+                size_t data_end = std::min<size_t>(sizeof(MetaSt) + meta.write_len_, file_size);
+                if (meta.index_offset_ != 0 && meta.index_offset_ == data_end
+                    && meta.block_count_ <= (file_size - data_end) / sizeof(BlockEntry)) {
+                    entries.resize(meta.block_count_);
+                    memcpy(entries.data(), base + meta.index_offset_, meta.block_count_ * sizeof(BlockEntry));
+                    return;
+                }
+
+                size_t offset = sizeof(MetaSt);
+                uint64_t record_count = 0;
+                BlockHead head;
+                while (offset + sizeof(BlockHead) <= data_end) {
+                    memcpy(&head, base + offset, sizeof(BlockHead));
+                    if (head.record_count_ == 0 || head.record_count_ > meta.block_records_ || head.comp_len_ > data_end - offset - sizeof(BlockHead)
+                        || Crc32c(base + offset + sizeof(BlockHead), head.comp_len_) != head.crc_) {
+                        break;
+                    }
+                    entries.push_back(BlockEntry{ offset, record_count });
+                    record_count += head.record_count_;
+                    offset += sizeof(BlockHead) + head.comp_len_;
+                }
+                meta.write_len_ = offset - sizeof(MetaSt);
+                meta.record_count_ = record_count;
+                meta.block_count_ = entries.size();
+                meta.index_offset_ = 0;
+            }
+
+            static bool WriteAll(int fd, const char* data, size_t len, off_t offset) {
+                while (len > 0) {
+                    ssize_t ret = pwrite(fd, data, len, offset);
+                    if (ret <= 0) {
+                        if (ret < 0 && errno == EINTR)
+                            continue;
+                        return false;
+                    }
+                    data += ret;
+                    len -= ret;
+                    offset += ret;
+                }
+                return true;
+            }
+
+        public:
+            // ̰߳ȫ, һʱѹд, ÿдļͷ, ȡ´򿪼ɼ
+            class Writer {
+            public:
+                Writer() = default;
+                ~Writer() { close(); }
+
+                // record_size: ¼
+                // codec: ѹ㷨, Ĭȡѱֵ֧㷨, ָδֵ֧㷨ʱerror_t::unsupported
+                // is_append: ׷ʱ¼ļһ, ļѹ㷨б任
+                // block_records: ÿ¼, ԽѹԽ, ȡʱѹԽ
+                // level: ѹ, 0ΪĬ, zstdʹ
+                error open(const std::string& file, size_t record_size, codec_t codec = DEFAULT_CODEC, bool is_append = true, size_t block_records = DEFAULT_BLOCK_RECORDS, int level = 0) {
+                    close();
+                    if (!Supported(codec) || record_size == 0 || block_records == 0 || record_size * block_records > UINT32_MAX) {
+                        return error(error_t::unsupported);
+                    }
+                    bool is_create = false;
+                    auto err = MMapFile::OpenWriteFile<false>(m_fd, is_create, file, 0);
+                    if (err) return err;
+                    m_level = level;
+                    m_entries.clear();
+                    m_block.clear();
+
+                    if (!is_create && is_append) {
+                        err = load_exist(record_size);
+                        if (err || m_meta.magic_ == BLOCK_MAGIC) {
+                            if (err) release();
+                            return err;
+                        }
+                    }
+                    m_meta = MetaSt{ BLOCK_MAGIC, (uint32_t)record_size, (uint32_t)block_records, (uint8_t)codec, 1, 0, 0, 0, 0, 0, 0, {} };
+                    if (ftruncate(m_fd, sizeof(MetaSt)) == -1) {
+                        err = create_error(error_t::ftruncate_fail);
+                        release();
+                        return err;
+                    }
+                    return commit();
+                }
+
+                // б任, ׸дǰ
+                // offset: ڼ¼еƫ, size: г, 48
+                error add_column(transform_t kind, size_t offset, size_t size) {
+                    if (m_fd == -1 || m_meta.block_count_ > 0 || m_meta.column_count_ >= MAX_COLUMNS
+                        || (size != sizeof(uint32_t) && size != sizeof(uint64_t)) || offset + size > m_meta.record_size_) {
+                        return error(error_t::unsupported);
+                    }
+                    m_meta.columns_[m_meta.column_count_++] = Column{ (uint16_t)offset, (uint8_t)size, (uint8_t)kind };
+                    return commit();
+                }
+
+                // Ƿֽƽ, ĬϿ, ׸дǰ
+                error set_shuffle(bool shuffle) {
+                    if (m_fd == -1 || m_meta.block_count_ > 0) {
+                        return error(error_t::unsupported);
+                    }
+                    m_meta.shuffle_ = shuffle;
+                    return commit();
+                }
+
+                template<typename _Ty>
+                error write(const _Ty& data) {
+                    return write((const char*)(&data), sizeof(_Ty));
+                }
+
+                // д¼
+                error write(const char* data, size_t len) {
+                    size_t block_len = (size_t)m_meta.record_size_ * m_meta.block_records_;
+                    if (m_fd == -1 || len % m_meta.record_size_ != 0) {
+                        return error(error_t::write_fail);
+                    }
+                    while (len > 0) {
+                        size_t copy_len = std::min(len, block_len - m_block.size());
+                        m_block.append(data, copy_len);
+                        data += copy_len;
+                        len -= copy_len;
+                        if (m_block.size() == block_len) {
+                            auto err = flush_block();
+                            if (err) {
+                                return err;
+                            }
                         }
-                        write_len = m_p_meta->write_len_;
-                        file_len = m_p_meta->file_len_;
+                    }
+                    return error(error_t::ok);
+                }
 
-                        // ļСֵ, ҪչļС
-                        // ȡļӳ䲢رļ
-                        if (munmap((void*)m_p_meta, m_p_meta->file_len_) == -1) {
-                            return create_error(error_t::munmap_fail);
+                // δĿѹд, ƵýС, ѹ
+                error flush() {
+                    if (m_fd == -1 || m_block.empty()) {
+                        return error(error_t::ok);
+                    }
+                    return flush_block();
+                }
+
+                // дδĿ鲢
+                error sync() {
+                    auto err = flush();
+                    if (err || m_fd == -1) {
+                        return err;
+                    }
+                    if (fdatasync(m_fd) == -1) {
+                        return create_error(error_t::write_fail);
+                    }
+                    return error(error_t::ok);
+                }
+
+                // д¼, δеļ¼
+                inline uint64_t get_record_count() const {
+                    return m_meta.record_count_ + (m_meta.record_size_ == 0 ? 0 : m_block.size() / m_meta.record_size_);
+                }
+
+                // дδĿ鼰ر
+                void close() {
+                    if (m_fd == -1) {
+                        return;
+                    }
+                    if (!flush()) {
+                        uint64_t index_offset = sizeof(MetaSt) + m_meta.write_len_;
+                        size_t index_len = m_entries.size() * sizeof(BlockEntry);
+                        if (WriteAll(m_fd, (const char*)m_entries.data(), index_len, index_offset)
+                            && ftruncate(m_fd, index_offset + index_len) != -1) {
+                            m_meta.index_offset_ = index_offset;
+                            commit();
                         }
-                        m_p_meta = nullptr;
-                        m_data = nullptr;
                     }
+                    release();
+                }
 
-                    while (write_len + sizeof(MetaSt) + len > file_len) {
-                        file_len += m_buf_step;
+            private:
+                // дֱӹر
+                void release() {
+                    ::close(m_fd);
+                    m_fd = -1;
+                    m_meta = MetaSt{};
+                    m_entries.clear();
+                    m_block.clear();
+                }
+
+                // ļ, ļΪʱm_meta.magic_ΪBLOCK_MAGIC
+                error load_exist(size_t record_size) {
+                    m_meta = MetaSt{};
+                    struct stat file_stat;
+                    if (::fstat(m_fd, &file_stat) == -1) {
+                        return create_error(error_t::stat_fail);
                     }
-                    file_len = file_len & ~(sysconf(_SC_PAGE_SIZE) - 1);
-                    if (ftruncate(m_fd, file_len) == -1) {
-                        return create_error(error_t::ftruncate_fail);
+                    size_t file_size = file_stat.st_size;
+                    if (file_size < sizeof(MetaSt)) {
+                        return error(error_t::ok);
                     }
-                    // ļӳ䲢׷д
-                    void* data = mmap(NULL, file_len, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
-                    if (data == MAP_FAILED) {
+                    void* addr = mmap(NULL, file_size, PROT_READ, MAP_SHARED, m_fd, 0);
+                    if (addr == MAP_FAILED) {
                         return create_error(error_t::mmap_fail);
                     }
-                    m_p_meta = (MetaSt*)data;
-                    m_p_meta->file_len_ = file_len;
-                    m_data = (char*)data + sizeof(MetaSt);
+                    memcpy(&m_meta, addr, sizeof(MetaSt));
+                    if (m_meta.magic_ != BLOCK_MAGIC || m_meta.record_size_ != record_size || !Supported((codec_t)m_meta.codec_)) {
+                        munmap(addr, file_size);
+                        return error(error_t::unsupported);
+                    }
+                    LoadIndex((const char*)addr, file_size, m_meta, m_entries);
+                    munmap(addr, file_size);
+
+                    // ƳδУͨ, رʱд
+                    m_meta.index_offset_ = 0;
+                    if (ftruncate(m_fd, sizeof(MetaSt) + m_meta.write_len_) == -1) {
+                        return create_error(error_t::ftruncate_fail);
+                    }
+                    return commit();
+                }
+
+                error flush_block() {
+                    size_t count = m_block.size() / m_meta.record_size_;
+                    const char* raw = Encode(m_meta, m_block.data(), count, m_work, m_shuffle);
+                    size_t raw_len = m_block.size();
+                    size_t comp_len = Compress((codec_t)m_meta.codec_, m_level, raw, raw_len, m_comp);
+                    BlockHead head{ (uint32_t)count, 0, 0, m_meta.codec_, {} };
+                    const char* comp = m_comp.data();
+                    if (comp_len == 0 || comp_len >= raw_len) {
+                        head.codec_ = (uint8_t)codec_t::none;
+                        comp = raw;
+                        comp_len = raw_len;
+                    }
+                    head.comp_len_ = (uint32_t)comp_len;
+                    head.crc_ = Crc32c(comp, comp_len);
+
+                    // дٸļͷ, 쳣˳ʱļͷĿ
+                    uint64_t offset = sizeof(MetaSt) + m_meta.write_len_;
+                    if (!WriteAll(m_fd, (const char*)&head, sizeof(BlockHead), offset) || !WriteAll(m_fd, comp, comp_len, offset + sizeof(BlockHead))) {
+                        return create_error(error_t::write_fail);
+                    }
+                    m_entries.push_back(BlockEntry{ offset, m_meta.record_count_ });
+                    m_meta.write_len_ += sizeof(BlockHead) + comp_len;
+                    m_meta.record_count_ += count;
+                    m_meta.block_count_ = m_entries.size();
+                    m_block.clear();
+                    return commit();
+                }
+
+                // дļͷ
+                error commit() {
+                    if (!WriteAll(m_fd, (const char*)&m_meta, sizeof(MetaSt), 0)) {
+                        return create_error(error_t::write_fail);
+                    }
                     return error(error_t::ok);
                 }
 
             private:
-                // ļ
-                int         m_fd = -1;
-                // ÿεֵ
-                off_t       m_buf_step = 0;
-                // ļʵܳȴ洢ָ
-                MetaSt*     m_p_meta = nullptr;
-                // mmapʼַ
-                char*       m_data = nullptr;
+                int                     m_fd = -1;
+                int                     m_level = 0;
+                MetaSt                  m_meta{};
+                // 
+                std::vector<BlockEntry> m_entries;
+                // δĿ
+                std::string             m_block;
+                // 뼰ѹ
+                std::string             m_work;
+                std::string             m_shuffle;
+                std::string             m_comp;
             };
-            
-            // ̰߳ȫ
+
+            // ̰߳ȫ, ȡʱύĿ
+            // ֿȡӿͬVectorBuffer::Reader, ÿζȡɿɶ̲߳нѹڲ
             class Reader {
+                // ζȡĽѹ, ߳ȡѹ
+                struct DecodeTask {
+                    size_t              first_ = 0;
+                    size_t              last_ = 0;
+                    char*               out_ = nullptr;
+                    std::atomic<size_t> next_{ 0 };
+                    std::atomic<size_t> done_{ 0 };
+                    std::atomic<bool>   failed_{ false };
+                };
+                typedef std::shared_ptr<DecodeTask> DecodeTaskPtr;
+
             public:
-                explicit Reader(bool can_change = false) : m_can_change(can_change), m_item_size(1) {}
+                // threads: ѹ߳(߳), 0ΪӲ߳
+                explicit Reader(unsigned threads = 0)
+                    : m_threads(threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads)
+                {
+                }
                 ~Reader() { close(); }
 
+                // chunk_size: ÿζȡļ¼, ȡ
                 error open(const std::string& file, size_t chunk_size) {
-                    // ļ
-                    auto err = init<false>(file);
-                    if (err) return err;
-                    return open_impl(chunk_size);
-                }
+                    close();
+                    m_fd = ::open(file.c_str(), O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                    if (m_fd == -1) {
+                        return create_error(error_t::open_fail);
+                    }
+                    struct stat file_stat;
+                    if (::fstat(m_fd, &file_stat) == -1) {
+                        return create_error(error_t::stat_fail);
+                    }
+                    m_file_size = file_stat.st_size;
+                    if (m_file_size < sizeof(MetaSt)) {
+                        return error(error_t::open_fail);
+                    }
+                    void* addr = mmap(NULL, m_file_size, PROT_READ, MAP_SHARED, m_fd, 0);
+                    if (addr == MAP_FAILED) {
+                        return create_error(error_t::mmap_fail);
+                    }
+                    m_base = (const char*)addr;
+                    memcpy(&m_meta, m_base, sizeof(MetaSt));
+                    if (m_meta.magic_ != BLOCK_MAGIC || m_meta.record_size_ == 0 || !Supported((codec_t)m_meta.codec_)) {
+                        return error(error_t::unsupported);
+                    }
+                    LoadIndex(m_base, m_file_size, m_meta, m_entries);
 
-                error shm_open(const std::string& title, size_t chunk_size) {
-                    // ļ
-                    auto err = init<true>(title);
-                    if (err) return err;
-                    return open_impl(chunk_size);
+                    m_chunk_blocks = std::max<size_t>(1, (chunk_size + m_meta.block_records_ - 1) / m_meta.block_records_);
+                    m_num_chunks = (m_entries.size() + m_chunk_blocks - 1) / m_chunk_blocks;
+                    return error(error_t::ok);
                 }
 
                 inline long long get_obj_num() const {
-                    return m_meta.write_len_ / m_item_size;
+                    return m_meta.record_count_;
                 }
 
                 inline size_t get_obj_size() const {
-                    return m_item_size;
+                    return m_meta.record_size_;
+                }
+
+                inline size_t get_block_count() const {
+                    return m_entries.size();
                 }
 
                 inline void* get_data() const {
-                    return m_cur_read_addr;
+                    return (void*)m_buffer.data();
                 }
 
                 inline size_t get_chunk_index() const {
@@ -779,9 +2873,9 @@ namespace BTool {
                         if (err || count == 0)
                             return std::forward_as_tuple(err, nullptr);
                         m_cur_chunk_offset += sizeof(Type);
-                        return std::forward_as_tuple(err, item); 
+                        return std::forward_as_tuple(err, item);
                     }
-                    char* data = (char*)m_cur_read_addr + m_cur_chunk_offset;
+                    char* data = m_buffer.data() + m_cur_chunk_offset;
                     m_cur_chunk_offset += sizeof(Type);
                     return std::forward_as_tuple(error_t::ok, (Type*)data);
                 }
@@ -792,158 +2886,312 @@ namespace BTool {
                     return std::forward_as_tuple(ok, (Type*)data.data(), data.length() / sizeof(Type));
                 }
 
+                // ѹһ, ´ζȡcloseǰЧ
                 std::tuple<error, std::string_view> read() {
-                    // ϴζȡ
-                    error_t err_code = clean_mmap();
-                    if (err_code != error_t::ok) {
-                        return std::forward_as_tuple(create_error(err_code), std::string_view{});
-                    }
-                    if ((size_t)m_cur_file_offset + m_cur_read_buf_length >= (size_t)m_meta.write_len_) {
+                    m_cur_chunk_offset = 0;
+                    m_cur_read_buf_length = 0;
+                    if (m_cur_chunk_index >= m_num_chunks) {
                         return std::forward_as_tuple(error_t::ok, std::string_view{});
                     }
-
-                    calc_current();
-                    if (!m_can_change)
-                        m_cur_read_addr = mmap(NULL, m_cur_read_chunk_length, PROT_READ, MAP_SHARED, m_fd, m_pa_offset);
-                    else
-                        m_cur_read_addr = mmap(NULL, m_cur_read_chunk_length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, m_pa_offset);
-
-                    if (m_cur_read_addr == MAP_FAILED) {
-                        return std::forward_as_tuple(create_error(error_t::mmap_fail), std::string_view{});
+                    size_t first = m_cur_chunk_index * m_chunk_blocks;
+                    size_t last = std::min(first + m_chunk_blocks, m_entries.size());
+                    size_t end_record = last < m_entries.size() ? m_entries[last].first_record_ : m_meta.record_count_;
+                    m_buffer.resize((end_record - m_entries[first].first_record_) * m_meta.record_size_);
+                    if (!decode(first, last)) {
+                        return std::forward_as_tuple(error(error_t::decode_fail), std::string_view{});
                     }
                     m_cur_chunk_index++;
-                    return std::forward_as_tuple(error_t::ok, std::string_view((char*)m_cur_read_addr + m_cur_file_offset - m_pa_offset, m_cur_read_buf_length));
+                    m_cur_read_buf_length = m_buffer.size();
+                    return std::forward_as_tuple(error_t::ok, std::string_view(m_buffer.data(), m_buffer.size()));
                 }
 
-                error close() {
-                    clean_mmap();
-
-                    if (m_fd != -1 && ::close(m_fd) == -1) {
-                        return create_error(error_t::close_fail);
-                    }
-                    m_fd = -1;
-                    return error(error_t::ok);
+                // зɨ, ȫзΪpartitions(0ΪӲ߳), pool(ṩadd_task, ParallelTaskPool)д
+                // ѹڻ, λصfunc(size_t partition, std::string_view block), falseʱ
+                // pool̵֮߳, ȫɺ󷵻, ѹʧʱerror_t::decode_fail
+                template<typename TTaskPool, typename Func>
+                error scan(TTaskPool& pool, size_t partitions, Func&& func) const {
+                    return scan<char>(pool, partitions
+                        , [&](size_t partition, char&, std::string_view block) { return func(partition, block); }
+                        , [](size_t, char&&) {});
                 }
 
-            private:
-                template<bool is_shm>
-                error init(const std::string& title) {
-                    Mapper<MetaSt> meta_mapping;
-                    error err;
-                    if constexpr (is_shm)
-                        err = meta_mapping.shm_open(title);
-                    else 
-                        err = meta_mapping.open(title);
-                    if (err) {
-                        return err;
+                // ϲĲзɨ, ÿĬϹResultۼ, λصfunc(size_t partition, Result&, std::string_view block)
+                // ɺڵ̰߳˳صmerge(size_t partition, Result&&)
+                template<typename Result, typename TTaskPool, typename Func, typename MergeFunc>
+                error scan(TTaskPool& pool, size_t partitions, Func&& func, MergeFunc&& merge) const {
+                    size_t block_count = m_entries.size();
+                    if (partitions == 0) {
+                        partitions = std::max(1u, std::thread::hardware_concurrency());
                     }
-                    auto p_meta = meta_mapping.get();
-                    m_file_size = sizeof(MetaSt) + p_meta->write_len_;
-                    m_item_size = p_meta->item_size_;
-                    m_meta = *p_meta;
+                    partitions = std::max<size_t>(1, std::min(partitions, block_count));
+
+                    auto task = [&](size_t partition, Result& result) {
+                        std::string buffer;
+                        std::string work;
+                        size_t last = block_count * (partition + 1) / partitions;
+                        for (size_t block = block_count * partition / partitions; block < last; ++block) {
+                            const BlockEntry& entry = m_entries[block];
+                            uint64_t end_record = block + 1 < block_count ? m_entries[block + 1].first_record_ : m_meta.record_count_;
+                            if (entry.offset_ >= m_file_size || entry.first_record_ > end_record) {
+                                return error(error_t::decode_fail);
+                            }
+                            size_t count = end_record - entry.first_record_;
+                            buffer.resize(count * m_meta.record_size_);
+                            if (!Decode(m_meta, m_base + entry.offset_, m_file_size - entry.offset_, count, buffer.data(), work)) {
+                                return error(error_t::decode_fail);
+                            }
+                            if (!func(partition, result, std::string_view(buffer.data(), buffer.size()))) {
+                                break;
+                            }
+                        }
+                        return error(error_t::ok);
+                    };
+                    return RunPartitions<Result>(pool, partitions, task, std::forward<MergeFunc>(merge));
+                }
 
-                    if constexpr (is_shm) {
-                        if (!m_can_change) 
-                            m_fd = ::shm_open(title.c_str(), O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-                        else
-                            m_fd = ::shm_open(title.c_str(), O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                void close() {
+                    stop_workers();
+                    if (m_base != nullptr) {
+                        munmap((void*)m_base, m_file_size);
+                        m_base = nullptr;
                     }
-                    else {
-                        if (!m_can_change) 
-                            m_fd = ::open(title.c_str(), O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-                        else
-                            m_fd = ::open(title.c_str(), O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                    if (m_fd != -1) {
+                        ::close(m_fd);
+                        m_fd = -1;
                     }
-                    return error(error_t::ok);
+                    m_file_size = 0;
+                    m_meta = MetaSt{};
+                    m_entries.clear();
+                    m_chunk_blocks = 0;
+                    m_num_chunks = 0;
+                    m_cur_chunk_index = 0;
+                    m_cur_chunk_offset = 0;
+                    m_cur_read_buf_length = 0;
                 }
-                error open_impl(size_t chunk_size) {
-                    size_t data_size = m_meta.write_len_;
-                    // ȡļܴС
-                    // С
-                    m_chunk_size = chunk_size * m_item_size;
-                    if (m_chunk_size > data_size) {
-                        m_chunk_size = data_size;
+
+            private:
+                // ѹ[first, last)m_buffer, һʱѸ̹߳ͬȡ
+                bool decode(size_t first, size_t last) {
+                    auto task = std::make_shared<DecodeTask>();
+                    task->first_ = first;
+                    task->last_ = last;
+                    task->out_ = m_buffer.data();
+                    task->next_ = first;
+                    size_t count = last - first;
+                    if (count > 1 && m_threads > 1) {
+                        {
+                            std::lock_guard<std::mutex> lock(m_mtx);
+                            while (m_workers.size() + 1 < std::min<size_t>(m_threads, count)) {
+                                m_workers.emplace_back(&Reader::worker_loop, this);
+                            }
+                            m_task = task;
+                        }
+                        m_cv.notify_all();
                     }
-                    // 
-                    if (m_chunk_size > 0) {
-                        // ȡ
-                        m_num_chunks = (data_size + m_chunk_size - 1) / m_chunk_size;
+                    decode_blocks(*task, m_work);
+                    if (task->done_.load(std::memory_order_acquire) != count) {
+                        std::unique_lock<std::mutex> lock(m_mtx);
+                        m_done_cv.wait(lock, [&] { return task->done_.load(std::memory_order_acquire) == count; });
                     }
-                    return error(error_t::ok);
+                    return !task->failed_.load();
                 }
 
-                error_t clean_mmap() {
-                    error_t err_code = error_t::ok;
-                    if (m_cur_read_addr != MAP_FAILED) {
-                        if (munmap(m_cur_read_addr, m_cur_read_chunk_length) == -1) {
-                            err_code = error_t::munmap_fail;
+                // ȡѹ, ֱȫȡ
+                void decode_blocks(DecodeTask& task, std::string& work) {
+                    size_t count = task.last_ - task.first_;
+                    uint64_t base_record = m_entries[task.first_].first_record_;
+                    for (size_t block = task.next_.fetch_add(1); block < task.last_; block = task.next_.fetch_add(1)) {
+                        const BlockEntry& entry = m_entries[block];
+                        uint64_t end_record = block + 1 < m_entries.size() ? m_entries[block + 1].first_record_ : m_meta.record_count_;
+                        bool ok = entry.offset_ < m_file_size && entry.first_record_ <= end_record
+                            && Decode(m_meta, m_base + entry.offset_, m_file_size - entry.offset_, end_record - entry.first_record_,
+                                task.out_ + (entry.first_record_ - base_record) * m_meta.record_size_, work);
+                        if (!ok) {
+                            task.failed_.store(true);
+                        }
+                        if (task.done_.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                            std::lock_guard<std::mutex> lock(m_mtx);
+                            m_done_cv.notify_all();
                         }
-                        m_cur_read_addr = MAP_FAILED;
                     }
-                    return err_code;
                 }
 
-                void calc_current() {
-                    m_cur_chunk_offset = 0;
-                    m_cur_file_offset = sizeof(MetaSt) + m_cur_chunk_index * m_chunk_size;
-                    
-                    // һҪ
-                    m_cur_read_buf_length = (m_cur_chunk_index < m_num_chunks - 1) ? m_chunk_size : m_meta.write_len_ - m_cur_chunk_index * m_chunk_size;
+                void worker_loop() {
+                    std::string work;
+                    std::unique_lock<std::mutex> lock(m_mtx);
+                    DecodeTaskPtr seen;
+                    while (true) {
+                        m_cv.wait(lock, [&] { return m_stop || m_task != seen; });
+                        if (m_stop)
+                            return;
+                        seen = m_task;
+                        lock.unlock();
+                        decode_blocks(*seen, work);
+                        lock.lock();
+                    }
+                }
 
-                    // ȡһ߽
-                    m_pa_offset = m_cur_file_offset & ~(m_page_size - 1);
-                    m_cur_read_chunk_length = m_cur_read_buf_length + m_cur_file_offset - m_pa_offset;
+                void stop_workers() {
+                    {
+                        std::lock_guard<std::mutex> lock(m_mtx);
+                        m_stop = true;
+                    }
+                    m_cv.notify_all();
+                    for (auto& worker : m_workers) {
+                        worker.join();
+                    }
+                    m_workers.clear();
+                    m_task.reset();
+                    m_stop = false;
                 }
 
             private:
-                // ҳС
-                off_t       m_page_size = sysconf(_SC_PAGE_SIZE);
-                // Ƿɸıļ
-                bool        m_can_change;
-                // С
-                int         m_item_size;
-                // ļ
-                int         m_fd = -1;
-                // ļܴС
-                off_t       m_file_size = 0;
-                // ǰȡƯλ(sizeof(MetaSt))
-                off_t       m_cur_chunk_offset = 0;
-                // sizeof(MetaSt)
-                off_t       m_cur_file_offset = 0;
-                // ʼƯλ
-                off_t       m_pa_offset = 0;
-                // ȡĿС
-                size_t      m_chunk_size = 0;
-                // ȡĿ
-                size_t      m_num_chunks = 0;
+                // ѹ߳, ߳
+                unsigned                    m_threads;
+                int                         m_fd = -1;
+                size_t                      m_file_size = 0;
+                // ļֻӳ
+                const char*                 m_base = nullptr;
+                MetaSt                      m_meta{};
+                std::vector<BlockEntry>     m_entries;
+                // ÿζȡĿȡܴ
+                size_t                      m_chunk_blocks = 0;
+                size_t                      m_num_chunks = 0;
                 // ǰȡĿ±
-                size_t      m_cur_chunk_index = 0;
-                // ǰȡڴַ
-                void*       m_cur_read_addr = MAP_FAILED;
-                // ǰȡڴ泤(sizeof(MetaSt))
-                size_t      m_cur_read_buf_length = 0;
-                // ǰȡĿС, ҳ
-                size_t      m_cur_read_chunk_length = 0;
-                // ָڴӳԪ
-                MetaSt      m_meta;
-            };            
+                size_t                      m_cur_chunk_index = 0;
+                // ǰȡƯλ
+                size_t                      m_cur_chunk_offset = 0;
+                // ǰȡݳ
+                size_t                      m_cur_read_buf_length = 0;
+                // ѹ
+                std::string                 m_buffer;
+                // ̵߳Ľѹʱ
+                std::string                 m_work;
+
+                // ѹ߳
+                std::mutex                  m_mtx;
+                std::condition_variable     m_cv;
+                std::condition_variable     m_done_cv;
+                std::vector<std::thread>    m_workers;
+                DecodeTaskPtr               m_task;
+                bool                        m_stop = false;
+            };
         };
 
         // ṩڶ̬дĴڴ, ʱ
         class FixBuffer {
         protected:
+            enum : uint32_t {
+                META_MAGIC = 0x42464D4D,    // "MMFB"
+                META_VERSION = 1,
+            };
     #pragma pack(push, 1)
             // ̬Ԫݽṹ
+            // ֶǰ8ֽڶ, ݻͬ
             struct MetaSt {
-                bool    has_finished_;  // д
-                size_t  write_len_;     // дݳ
+                uint32_t magic_;        // ļͷʶ, ɰļ޴ֶ
+                uint32_t version_;      // ļͷ汾
+                size_t  write_len_;     // ύݳ, releaseд, ȡԴΪ׼
+                size_t  reserve_len_;   // дݳ, write_len_ʱδύ
+                size_t  synced_len_;    // ݳ, ָʱԴ˴ʼУ
                 size_t  file_size_;     // ݻ
+                bool    has_finished_;  // д
+                bool    clean_;         // д뷽ر, ٴ׷Ӵʱָ
+                bool    record_only_;   // ݾwrite_recordд, ָʱУ
+                char    reserved_[5];
                 char    data_[0];       // ݻ
             };
+            // ɰļͷ, ȡֻ, дǰ辭MigrateǨǰ汾
+            struct LegacyMetaSt {
+                uint8_t has_finished_;
+                size_t  write_len_;
+                size_t  file_size_;
+            };
+            // У¼ͷ, Ϊ
+            struct RecordHead {
+                uint32_t    len_;       // ݳ
+                uint32_t    crc_;       // ȼݵcrc32c
+            };
     #pragma pack(pop)
 
-        public:
+            // Уoffsetļ¼, Уͨʱݳ, 򷵻-1
+            static int64_t CheckRecord(const char* data, size_t length, size_t offset) {
+                RecordHead head;
+                if (offset + sizeof(RecordHead) > length) {
+                    return -1;
+                }
+                memcpy(&head, data + offset, sizeof(RecordHead));
+                if (head.len_ > length - offset - sizeof(RecordHead)) {
+                    return -1;
+                }
+                uint32_t crc = Crc32c(&head.len_, sizeof(uint32_t));
+                if (Crc32c(data + offset + sizeof(RecordHead), head.len_, crc) != head.crc_) {
+                    return -1;
+                }
+                return head.len_;
+            }
+
+            // Уļͷ, д뷽δʼ(ȫ0)ʱͬЧ
+            static error CheckMeta(const MetaSt& meta) {
+                if (meta.magic_ == META_MAGIC) {
+                    if (meta.version_ != META_VERSION) {
+                        return error(error_t::unsupported, "unsupported version");
+                    }
+                    return error(error_t::ok);
+                }
+                if (meta.magic_ == 0 && meta.write_len_ == 0) {
+                    return error(error_t::ok);
+                }
+                return error(error_t::unsupported, "legacy or unknown layout");
+            }
+
+            // ɰļͷȡ, ֶļǢʱΪɰļתΪǰṹ
+            static bool LoadLegacyMeta(int fd, MetaSt& meta) {
+                struct stat sb;
+                LegacyMetaSt legacy;
+                if (::fstat(fd, &sb) == -1 || (size_t)sb.st_size < sizeof(LegacyMetaSt)
+                    || pread(fd, &legacy, sizeof(LegacyMetaSt), 0) != (ssize_t)sizeof(LegacyMetaSt)) {
+                    return false;
+                }
+                if (legacy.has_finished_ > 1 || legacy.file_size_ != (size_t)sb.st_size || legacy.write_len_ > legacy.file_size_ - sizeof(LegacyMetaSt)) {
+                    return false;
+                }
+                meta = MetaSt{};
+                meta.magic_ = META_MAGIC;
+                meta.version_ = META_VERSION;
+                meta.write_len_ = legacy.write_len_;
+                meta.reserve_len_ = legacy.write_len_;
+                meta.file_size_ = sizeof(MetaSt) + legacy.write_len_;
+                meta.has_finished_ = legacy.has_finished_ != 0;
+                meta.clean_ = true;
+                return true;
+            }
+
+        public:
+            // ɰļͷļǨǰ汾, Ϊǰ汾ʱֱӷ, ޷ʶʱerror_t::unsupported
+            // ʱļдrename滻, ڼ쳣˳ϵʱԭļ; Ǩڼ䲻д뷽򿪸ļ
+            static error Migrate(const std::string& file) {
+                int fd = ::open(file.c_str(), O_RDONLY);
+                if (fd == -1) {
+                    return create_error(error_t::open_fail);
+                }
+                MetaSt meta{};
+                error err(error_t::ok);
+                if (pread(fd, &meta, sizeof(MetaSt), 0) == (ssize_t)sizeof(MetaSt) && meta.magic_ == META_MAGIC) {
+                    err = CheckMeta(meta);
+                }
+                else if (LoadLegacyMeta(fd, meta)) {
+                    err = RewriteFile(fd, file, &meta, sizeof(MetaSt), sizeof(LegacyMetaSt), meta.write_len_);
+                }
+                else {
+                    err = error(error_t::unsupported, "unknown layout");
+                }
+                ::close(fd);
+                return err;
+            }
+
             // ̰߳ȫ
+            // дƽдг, releaseύ; get_dataȡ´д, commitرʱύ
             class Writer {
             public:
                 Writer() = default;
@@ -985,32 +3233,84 @@ namespace BTool {
                 }
                 
                 error write(const char* msg, const size_t& len, size_t& start_offset) {
-                    // ʣռǷ㹻
-                    if (!check_res_space(len)) {
-                        return create_error(error_t::free_space_fail);
+                    char* data = nullptr;
+                    auto err = get_data(len, data, start_offset);
+                    if (err) {
+                        return err;
                     }
-                    start_offset = m_meta->write_len_;
-                    // д뻺
-                    memcpy(m_meta->data_ + start_offset, msg, len);
-                    // дݳ
-                    m_meta->write_len_ += len;
+                    // д뻺ύ
+                    memcpy(data, msg, len);
+                    commit();
                     return error(error_t::ok);
                 }
 
                 void reset_offset(off_t off) { 
-                    m_meta->write_len_ = off;
+                    m_meta->reserve_len_ = off;
+                    m_meta->synced_len_ = std::min<size_t>(m_meta->synced_len_, off);
+                    __atomic_store_n(&m_meta->write_len_, (size_t)off, __ATOMIC_RELEASE);
+                }
+
+                // ύд, ֮ȡɼ
+                void commit() {
+                    if (m_meta != nullptr && m_meta->write_len_ != m_meta->reserve_len_) {
+                        __atomic_store_n(&m_meta->write_len_, m_meta->reserve_len_, __ATOMIC_RELEASE);
+                    }
+                }
+
+                // ύύ, ֮ϵ಻ʧ; ÿд, 趨ڵü
+                error sync() {
+                    if (m_meta == nullptr) {
+                        return error(error_t::ok);
+                    }
+                    commit();
+                    size_t write_len = m_meta->write_len_;
+                    auto err = SyncRange(m_meta, sizeof(MetaSt) + m_meta->synced_len_, sizeof(MetaSt) + write_len);
+                    if (err) {
+                        return err;
+                    }
+                    m_meta->synced_len_ = write_len;
+                    return SyncRange(m_meta, 0, sizeof(MetaSt));
+                }
+
+                // һ׷Ӵʱָݳ
+                size_t get_discard_len() const {
+                    return m_discard_len;
+                }
+
+                // ϡ, ֮write_recordдļ¼ÿinterval¼һμƫ
+                error open_index(const std::string& index_file, size_t interval, bool is_append = true) {
+                    return m_index.open(index_file, interval, is_append);
+                }
+
+                error shm_open_index(const std::string& index_title, size_t interval, bool is_append = true) {
+                    return m_index.shm_open(index_title, interval, is_append);
+                }
+
+                // дУ¼(RecordHead + )ύ, ʱǼǼ, 밴д˳ǵݼ, ¼ճд뵫error_t::write_fail
+                error write_record(int64_t key, const char* msg, uint32_t len) {
+                    char* data = nullptr;
+                    size_t start_offset = 0;
+                    auto err = reserve(sizeof(RecordHead) + len, data, start_offset);
+                    if (err) {
+                        return err;
+                    }
+                    RecordHead head{ len, Crc32c(msg, len, Crc32c(&len, sizeof(uint32_t))) };
+                    memcpy(data, &head, sizeof(RecordHead));
+                    memcpy(data + sizeof(RecordHead), msg, len);
+                    commit();
+                    if (!m_index.is_open()) {
+                        return error(error_t::ok);
+                    }
+                    return m_index.add(key, start_offset);
                 }
 
-                // ȡַ
+                // ȡַ, ´д, commitرʱύ
                 error get_data(const size_t& len, char*& data, size_t& start_offset) {
-                    start_offset = m_meta->write_len_;
-                    // ʣռǷ㹻
-                    if (m_meta->has_finished_ || !check_res_space(len)) {
-                        return create_error(error_t::free_space_fail);
+                    auto err = reserve(len, data, start_offset);
+                    if (!err) {
+                        m_meta->record_only_ = false;
                     }
-                    m_meta->write_len_ += len;
-                    data = m_meta->data_ + start_offset;
-                    return error(error_t::ok);
+                    return err;
                 }
                 
                 error add_file_len(const size_t& len) {
@@ -1023,13 +3323,17 @@ namespace BTool {
                 }
                 
                 void add_write_len(const size_t& len) {
-                    m_meta->write_len_ += len;
+                    m_meta->reserve_len_ += len;
+                    m_meta->record_only_ = false;
+                    commit();
                 }
 
                 void finished_write() {
                     // ΪʵݴС
                     if (m_meta != nullptr) {
+                        commit();
                         m_meta->has_finished_ = true;
+                        m_meta->clean_ = true;
                         auto real_buffer_size = m_meta->file_size_;
                         auto file_size = m_meta->file_size_ = m_meta->write_len_ + sizeof(MetaSt);
                         munmap(m_meta, real_buffer_size);
@@ -1042,7 +3346,10 @@ namespace BTool {
 
                 // رչڴ
                 void close() {
+                    m_index.close();
                     if (m_meta != nullptr) {
+                        commit();
+                        m_meta->clean_ = true;
                         auto real_file_size = m_meta->file_size_;
                         munmap(m_meta, real_file_size);
                         m_meta = nullptr;
@@ -1054,7 +3361,17 @@ namespace BTool {
                 }
 
             protected:
+                // ׷Ӵ򿪾ɰļͷļʱerror_t::unsupportedҲĶļ, ȾMigrateǨ
                 error open_impl(bool is_create, size_t buffer_size, bool is_append) {
+                    bool is_reset = is_create || !is_append;
+                    if (!is_reset) {
+                        auto err = load_meta(is_reset);
+                        if (err) {
+                            close();
+                            return err;
+                        }
+                    }
+
                     // ùڴС
                     size_t page_size = sysconf(_SC_PAGE_SIZE);
                     size_t shm_size = std::max(sizeof(MetaSt) + buffer_size, page_size);
@@ -1082,19 +3399,82 @@ namespace BTool {
 
                     // ȡӳĹڴ
                     m_meta = static_cast<MetaSt*>(addr);
-                    if (is_create || !is_append) {
-                        *m_meta = MetaSt{false, 0, real_file_size};
+                    m_discard_len = 0;
+                    if (is_reset) {
+                        *m_meta = MetaSt{};
+                        m_meta->magic_ = META_MAGIC;
+                        m_meta->version_ = META_VERSION;
+                        m_meta->file_size_ = real_file_size;
+                        m_meta->record_only_ = true;
                     }
                     else {
                         m_meta->file_size_ = real_file_size;
+                        if (!m_meta->clean_) {
+                            recover();
+                        }
                     }
                     m_meta->has_finished_ = false;
+                    m_meta->clean_ = false;
+                    return error(error_t::ok);
+                }
+
+                // Уļͷ, δʼʱ, ɰļͷܾд
+                error load_meta(bool& is_reset) {
+                    struct stat sb;
+                    if (::fstat(m_shm_fd, &sb) == -1) {
+                        return create_error(error_t::stat_fail);
+                    }
+                    size_t file_size = sb.st_size;
+                    MetaSt meta{};
+                    if (pread(m_shm_fd, &meta, std::min(file_size, sizeof(MetaSt)), 0) != (ssize_t)std::min(file_size, sizeof(MetaSt))) {
+                        return create_error(error_t::open_fail);
+                    }
+                    auto err = CheckMeta(meta);
+                    if (!err) {
+                        is_reset = meta.magic_ != META_MAGIC;
+                        return err;
+                    }
+                    if (meta.magic_ != META_MAGIC && LoadLegacyMeta(m_shm_fd, meta)) {
+                        return error(error_t::unsupported, "legacy layout is read-only, migrate with FixBuffer::Migrate");
+                    }
+                    return err;
+                }
+
+                // д뷽δر, δύ; ΪУ¼ʱ̴У, ضһЧ¼
+                void recover() {
+                    size_t capacity = m_meta->file_size_ - sizeof(MetaSt);
+                    size_t write_len = std::min(m_meta->write_len_, capacity);
+                    size_t valid_len = write_len;
+                    if (m_meta->record_only_) {
+                        valid_len = std::min(m_meta->synced_len_, write_len);
+                        int64_t len = 0;
+                        while ((len = CheckRecord(m_meta->data_, write_len, valid_len)) >= 0) {
+                            valid_len += sizeof(RecordHead) + len;
+                        }
+                    }
+                    m_discard_len = std::max(m_meta->reserve_len_, m_meta->write_len_) - valid_len;
+                    m_meta->synced_len_ = std::min(m_meta->synced_len_, valid_len);
+                    m_meta->reserve_len_ = valid_len;
+                    __atomic_store_n(&m_meta->write_len_, valid_len, __ATOMIC_RELEASE);
+                }
+
+                // ύǰݲԤlenȵд
+                error reserve(const size_t& len, char*& data, size_t& start_offset) {
+                    // ʣռǷ㹻
+                    if (m_meta->has_finished_ || !check_res_space(len)) {
+                        start_offset = m_meta->reserve_len_;
+                        return create_error(error_t::free_space_fail);
+                    }
+                    commit();
+                    start_offset = m_meta->reserve_len_;
+                    m_meta->reserve_len_ += len;
+                    data = m_meta->data_ + start_offset;
                     return error(error_t::ok);
                 }
 
                 // ʣռǷ
                 inline bool check_res_space(const size_t& len) {
-                    return len <= m_meta->file_size_ - sizeof(MetaSt) - m_meta->write_len_;
+                    return len <= m_meta->file_size_ - sizeof(MetaSt) - m_meta->reserve_len_;
                 }
 
             protected:
@@ -1103,7 +3483,11 @@ namespace BTool {
 
                 bool            m_is_shm = false;
                 std::string     m_file_path;
+                // һλָݳ
+                size_t          m_discard_len = 0;
 
+                // ϡ, δʱ¼
+                SparseIndex::Writer m_index;
             };
 
             // ̰߳ȫ
@@ -1113,32 +3497,32 @@ namespace BTool {
                 ~Reader() { close(); }
 
                 error open(const std::string& file) {
+                    MetaSt meta{};
                     {
                         Mapper<MetaSt> meta_mapping;
                         auto err = meta_mapping.open(file);
                         if (err) {
                             return err;
                         }
-                        auto p_meta = meta_mapping.get();
-                        m_file_size = sizeof(MetaSt) + p_meta->write_len_;
+                        meta = *meta_mapping.get();
                     }
                     // ļ
                     if (!m_can_change)
                         m_fd = ::open(file.c_str(), O_RDONLY, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
                     else
                         m_fd = ::open(file.c_str(), O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-                    return open_impl();
+                    return open_impl(meta);
                 }
 
                 error shm_open(const std::string& title) {
+                    MetaSt meta{};
                     {
                         Mapper<MetaSt> meta_mapping;
                         auto err = meta_mapping.shm_open(title);
                         if (err) {
                             return err;
                         }
-                        auto p_meta = meta_mapping.get();
-                        m_file_size = sizeof(MetaSt) + p_meta->write_len_;
+                        meta = *meta_mapping.get();
                     }
                     // ļ
                     if (!m_can_change)
@@ -1146,68 +3530,566 @@ namespace BTool {
                     else
                         m_fd = ::shm_open(title.c_str(), O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
 
-                    return open_impl();
+                    return open_impl(meta);
+                }
+
+                void* get_data() const {
+                    return m_data;
+                }
+
+                // ɰļͷд뷽, شʱĳ
+                size_t get_length() const {
+                    if (m_legacy) {
+                        return m_legacy_meta.write_len_;
+                    }
+                    return __atomic_load_n(&m_meta->write_len_, __ATOMIC_ACQUIRE);
+                }
+
+                bool finished() const {
+                    if (m_legacy) {
+                        return m_legacy_meta.has_finished_;
+                    }
+                    return m_meta->has_finished_;
+                }
+
+                // ȡoffsetУ¼offsetһ, Խʱؿoffset
+                // verify: ǷУcrc32c, Уʧͬ; д뷽׷Ӵʱѻָ, һУ
+                std::string_view next_record(size_t& offset, bool verify = false) const {
+                    size_t length = m_file_size - m_head_len;
+                    RecordHead head;
+                    if (verify) {
+                        int64_t len = CheckRecord(m_data, length, offset);
+                        if (len < 0) {
+                            return std::string_view{};
+                        }
+                        head.len_ = (uint32_t)len;
+                    }
+                    else {
+                        if (offset + sizeof(RecordHead) > length) {
+                            return std::string_view{};
+                        }
+                        memcpy(&head, m_data + offset, sizeof(RecordHead));
+                        if (offset + sizeof(RecordHead) + head.len_ > length) {
+                            return std::string_view{};
+                        }
+                    }
+                    std::string_view record(m_data + offset + sizeof(RecordHead), head.len_);
+                    offset += sizeof(RecordHead) + head.len_;
+                    return record;
+                }
+
+                // ϡλ, λص[begin, end)ڵУ¼
+                // key_of(std::string_view)ȡ¼, ¼ǵݼ; func(std::string_view)falseʱֹͣ
+                template<typename KeyFunc, typename Func>
+                void for_range(SparseIndex::Reader& index, int64_t begin, int64_t end, KeyFunc&& key_of, Func&& func) const {
+                    size_t offset = std::get<0>(index.locate(begin));
+                    while (true) {
+                        size_t prev_offset = offset;
+                        std::string_view record = next_record(offset);
+                        if (offset == prev_offset) {
+                            return;
+                        }
+                        int64_t key = key_of(record);
+                        if (key >= end) {
+                            return;
+                        }
+                        if (key >= begin && !func(record)) {
+                            return;
+                        }
+                    }
+                }
+
+                void close() {
+                    if (m_read_addr != nullptr) {
+                        munmap(static_cast<void*>(m_read_addr), m_file_size); // رӳ
+                        m_read_addr = nullptr;
+                        m_meta = nullptr;
+                        m_data = nullptr;
+                    }
+                    if (m_fd != -1) {
+                        ::close(m_fd); // رչڴļ
+                        m_fd = -1;
+                    }
+                }
+
+            private:
+                // ɰļͷļͬɶ, ʼƫm_head_lenΪ׼
+                error open_impl(MetaSt& meta) {
+                    m_legacy = false;
+                    m_head_len = sizeof(MetaSt);
+                    auto err = CheckMeta(meta);
+                    if (err) {
+                        if (meta.magic_ == META_MAGIC || m_fd == -1 || !LoadLegacyMeta(m_fd, meta)) {
+                            close();
+                            return err;
+                        }
+                        m_legacy = true;
+                        m_head_len = sizeof(LegacyMetaSt);
+                        m_legacy_meta = meta;
+                    }
+                    m_file_size = m_head_len + meta.write_len_;
+
+                    struct stat sb;
+                    if (m_fd == -1 || fstat(m_fd, &sb) == -1 || (size_t)sb.st_size < m_file_size) {
+                        return create_error(error_t::open_fail);
+                    }
+
+                    if (!m_can_change)
+                        m_read_addr = mmap(NULL, m_file_size, PROT_READ, MAP_SHARED, m_fd, 0);
+                    else
+                        m_read_addr = mmap(NULL, m_file_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+
+                    if (m_read_addr == MAP_FAILED) {
+                        return create_error(error_t::mmap_fail);
+                    }
+
+                    m_meta = static_cast<MetaSt*>(m_read_addr);
+                    m_data = (char*)m_read_addr + m_head_len;
+                    return error(error_t::ok);
+                }
+
+            private:
+                // Ƿɸıļ
+                bool        m_can_change;
+                // ļ
+                int         m_fd = -1;
+                // ǰȡڴַ
+                size_t      m_file_size = 0;
+                // ǰȡڴַ
+                void*       m_read_addr = MAP_FAILED;
+                // ָڴӳԪ, ɰļͷʱɷ
+                MetaSt*     m_meta = nullptr;
+                char*       m_data = nullptr;
+                // ļͷȼʼƫ, ɰļͷΪsizeof(LegacyMetaSt)
+                size_t      m_head_len = sizeof(MetaSt);
+                // ǷΪɰļͷ, ɶȡ
+                bool        m_legacy = false;
+                // ɰļͷתԪ
+                MetaSt      m_legacy_meta{};
+            };
+        };
+
+        // ڴϢ, ̶Ȳλ, (̻߳)λ, ȡάα
+        // ߲ȴȡ, ȡ󳬹ʱݱ, readerror_t::overrunǲ
+        // λseqlock, ȡУ, ȡΪ
+        // ȡʱæѯfutex, ߽жȡʱŷϵͳ
+        // λ󳬹STALE_SLOT_TIMEOUT_MSδΪ쳣˳: ȡòλ붪ʧerror_t::overrun,
+        // òλ߲ٵȴֱӽӹ; עⱻж˳ʵд, ݿӹܷ
+        class RingBuffer {
+        protected:
+            enum : uint32_t {
+                RING_MAGIC = 0x474e4952,    // ʼɱ
+                RING_VERSION = 1,
+                OPEN_TIMEOUT_MS = 1000,     // Ѵڻʱȴɳʼʱ
+                STALE_SLOT_TIMEOUT_MS = 1000,   // λʱδΪ쳣˳
+            };
+
+            // Ԫ, ȡ߼ִͬ
+            struct MetaSt {
+                std::atomic<uint32_t>   magic_;         // ʼɺΪRING_MAGIC
+                uint32_t                version_;
+                uint64_t                item_size_;     // ÿ󳤶
+                uint64_t                capacity_;      // λ, 2
+                uint64_t                slot_size_;     // ÿλ, λͷ
+                alignas(64) std::atomic<uint64_t> claim_seq_;   // һ
+                alignas(64) std::atomic<uint32_t> notify_seq_;  // жȡʱÿη, futex
+                std::atomic<uint32_t>   waiters_;       // еĶȡ
+            };
+            // λ, seqдΪ2*seq+1, Ϊ2*seq+2
+            struct SlotSt {
+                std::atomic<uint64_t>   seq_;
+                std::atomic<uint64_t>   length_;
+                char                    data_[0];
+            };
+
+            static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free, "shared memory atomics must be lock free");
+
+            static constexpr size_t DataOffset() {
+                return (sizeof(MetaSt) + 63) & ~(size_t)63;
+            }
+
+            static SlotSt* GetSlot(MetaSt* meta, uint64_t seq) {
+                return (SlotSt*)((char*)meta + DataOffset() + (seq & (meta->capacity_ - 1)) * meta->slot_size_);
+            }
+
+            static bool FutexWait(std::atomic<uint32_t>* addr, uint32_t expected, unsigned timeout_us) {
+                timespec ts{ (time_t)(timeout_us / 1000000), (long)(timeout_us % 1000000) * 1000 };
+                return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, expected, &ts, nullptr, 0) == 0 || errno != ETIMEDOUT;
+            }
+            static void FutexWake(std::atomic<uint32_t>* addr) {
+                syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+            }
+
+            // ӳ价, ½ʱitem_size/capacityʼ, ѴʱȴʼɲУitem_size(Ϊ0ʱУ)
+            static error Attach(int fd, bool is_create, size_t item_size, size_t capacity, MetaSt*& meta, size_t& map_len) {
+                if (is_create) {
+                    size_t cap = 2;
+                    while (cap < capacity)
+                        cap <<= 1;
+                    size_t slot_size = (sizeof(SlotSt) + item_size + 7) & ~(size_t)7;
+                    map_len = DataOffset() + cap * slot_size;
+                    if (ftruncate(fd, map_len) == -1) {
+                        return create_error(error_t::ftruncate_fail);
+                    }
+                    void* addr = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                    if (addr == MAP_FAILED) {
+                        return create_error(error_t::mmap_fail);
+                    }
+                    meta = (MetaSt*)addr;
+                    meta->version_ = RING_VERSION;
+                    meta->item_size_ = item_size;
+                    meta->capacity_ = cap;
+                    meta->slot_size_ = slot_size;
+                    meta->magic_.store(RING_MAGIC, std::memory_order_release);
+                    return error(error_t::ok);
+                }
+
+                // ȴɳʼ
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(OPEN_TIMEOUT_MS);
+                void* addr = MAP_FAILED;
+                while (true) {
+                    struct stat sb;
+                    if (fstat(fd, &sb) == -1) {
+                        return create_error(error_t::stat_fail);
+                    }
+                    if ((size_t)sb.st_size >= DataOffset()) {
+                        if (addr == MAP_FAILED) {
+                            addr = mmap(NULL, DataOffset(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                            if (addr == MAP_FAILED) {
+                                return create_error(error_t::mmap_fail);
+                            }
+                        }
+                        if (((MetaSt*)addr)->magic_.load(std::memory_order_acquire) == RING_MAGIC)
+                            break;
+                    }
+                    if (std::chrono::steady_clock::now() >= deadline) {
+                        if (addr != MAP_FAILED)
+                            munmap(addr, DataOffset());
+                        return error(error_t::open_fail, "ring not initialized");
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+
+                MetaSt* head = (MetaSt*)addr;
+                bool matched = head->version_ == RING_VERSION && (item_size == 0 || head->item_size_ == item_size);
+                map_len = DataOffset() + head->capacity_ * head->slot_size_;
+                munmap(addr, DataOffset());
+                if (!matched) {
+                    return error(error_t::open_fail, "ring format mismatch");
+                }
+                addr = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (addr == MAP_FAILED) {
+                    return create_error(error_t::mmap_fail);
+                }
+                meta = (MetaSt*)addr;
+                return error(error_t::ok);
+            }
+
+        public:
+            // , ͬһɶ߳ͬʱд
+            class Writer {
+            public:
+                Writer() = default;
+                ~Writer() { close(); }
+
+                // item_size: ÿ󳤶
+                // capacity: λ, ȡΪ2; Ѵʱ, item_sizeһʧ
+                error open(const std::string& file, size_t item_size, size_t capacity) {
+                    return open_impl<false>(file, item_size, capacity);
+                }
+
+                error shm_open(const std::string& title, size_t item_size, size_t capacity) {
+                    return open_impl<true>(title, item_size, capacity);
+                }
+
+                inline size_t get_obj_size() const {
+                    return m_meta ? m_meta->item_size_ : 0;
+                }
+
+                inline size_t get_capacity() const {
+                    return m_meta ? m_meta->capacity_ : 0;
+                }
+
+                template<typename _Ty>
+                error write(const _Ty& data) {
+                    return write((const char*)(&data), sizeof(_Ty));
+                }
+
+                // λ, lenɳitem_size
+                // ͣٳʱλѱƵ߽ӹʱerror_t::overrun
+                error write(const char* data, size_t len) {
+                    if (!m_meta) {
+                        return error(error_t::open_fail, "not open");
+                    }
+                    if (len > m_meta->item_size_) {
+                        return error(error_t::free_space_fail, "item too large");
+                    }
+
+                    uint64_t seq = m_meta->claim_seq_.fetch_add(1, std::memory_order_relaxed);
+                    SlotSt* slot = GetSlot(m_meta, seq);
+                    uint64_t busy = 2 * seq + 1;
+                    uint64_t prev = seq >= m_meta->capacity_ ? 2 * (seq - m_meta->capacity_) + 2 : 0;
+                    // ȴһָòλ, ƺͬһλͬʱд; ʱΪһ˳, ֱӽӹ
+                    std::chrono::steady_clock::time_point deadline{};
+                    uint64_t cur = slot->seq_.load(std::memory_order_acquire);
+                    while (true) {
+                        if (cur >= busy) {
+                            return error(error_t::overrun, "slot reclaimed");
+                        }
+                        if (cur < prev) {
+                            auto now = std::chrono::steady_clock::now();
+                            if (deadline == std::chrono::steady_clock::time_point{}) {
+                                deadline = now + std::chrono::milliseconds(STALE_SLOT_TIMEOUT_MS);
+                            }
+                            if (now < deadline) {
+                                std::this_thread::yield();
+                                cur = slot->seq_.load(std::memory_order_acquire);
+                                continue;
+                            }
+                        }
+                        if (slot->seq_.compare_exchange_weak(cur, busy, std::memory_order_acquire, std::memory_order_acquire))
+                            break;
+                    }
+
+                    std::atomic_thread_fence(std::memory_order_release);
+                    slot->length_.store(len, std::memory_order_relaxed);
+                    memcpy(slot->data_, data, len);
+                    if (!slot->seq_.compare_exchange_strong(busy, busy + 1, std::memory_order_release, std::memory_order_relaxed)) {
+                        return error(error_t::overrun, "slot reclaimed");
+                    }
+
+                    // ȡǼ߹˫, ޶ȡʱϵͳ
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (m_meta->waiters_.load(std::memory_order_relaxed) > 0) {
+                        m_meta->notify_seq_.fetch_add(1, std::memory_order_release);
+                        FutexWake(&m_meta->notify_seq_);
+                    }
+                    return error(error_t::ok);
+                }
+
+                void close() {
+                    if (m_meta) {
+                        munmap((void*)m_meta, m_map_len);
+                        m_meta = nullptr;
+                    }
+                    if (m_fd != -1) {
+                        ::close(m_fd);
+                        m_fd = -1;
+                    }
+                }
+
+            private:
+                template<bool is_shm>
+                error open_impl(const std::string& title, size_t item_size, size_t capacity) {
+                    close();
+                    bool is_create = false;
+                    auto err = MMapFile::OpenWriteFile<is_shm>(m_fd, is_create, title, 0);
+                    if (!err) {
+                        err = Attach(m_fd, is_create, item_size, capacity, m_meta, m_map_len);
+                    }
+                    if (err) {
+                        close();
+                    }
+                    return err;
+                }
+
+            private:
+                // ļ
+                int         m_fd = -1;
+                // ӳ䳤
+                size_t      m_map_len = 0;
+                // ӳʼַ
+                MetaSt*     m_meta = nullptr;
+            };
+
+            // ȡ, άα, ̰߳ȫ
+            class Reader {
+            public:
+                Reader() = default;
+                ~Reader() { close(); }
+
+                // from_oldest: ǷԻɶݿʼ, ȡ򿪺󷢲
+                error open(const std::string& file, bool from_oldest = false) {
+                    return open_impl<false>(file, from_oldest);
+                }
+
+                error shm_open(const std::string& title, bool from_oldest = false) {
+                    return open_impl<true>(title, from_oldest);
+                }
+
+                inline size_t get_obj_size() const {
+                    return m_meta ? m_meta->item_size_ : 0;
+                }
+
+                // һȡ
+                inline uint64_t get_cursor() const {
+                    return m_cursor;
+                }
+
+                // 򸲸ǻ߳ʱδʧ
+                inline uint64_t get_lost() const {
+                    return m_lost;
                 }
 
-                void* get_data() const {
-                    return m_data;
+                // 뵫δȡ
+                inline uint64_t get_lag() const {
+                    return m_meta ? m_meta->claim_seq_.load(std::memory_order_acquire) - m_cursor : 0;
                 }
 
-                size_t get_length() const {
-                    return m_meta->write_len_;
+                // ȡһType, Ƿ
+                template<typename Type>
+                std::tuple<error, bool> read(Type& data) {
+                    auto [err, len] = read((char*)&data, sizeof(Type));
+                    return std::forward_as_tuple(err, len > 0);
                 }
 
-                bool finished() const {
-                    return m_meta->has_finished_;
+                // ȡһbuf, , ʱ0
+                // ǻλ߳ʱδʱerror_t::overrun, αòֲ붪ʧ, ɼȡ
+                std::tuple<error, size_t> read(char* buf, size_t buf_len) {
+                    if (!m_meta) {
+                        return std::forward_as_tuple(error(error_t::open_fail, "not open"), 0);
+                    }
+                    SlotSt* slot = GetSlot(m_meta, m_cursor);
+                    uint64_t want = 2 * m_cursor + 2;
+                    uint64_t seq = slot->seq_.load(std::memory_order_acquire);
+                    // δ
+                    if (seq < want) {
+                        if (stalled()) {
+                            ++m_lost;
+                            ++m_cursor;
+                            return std::forward_as_tuple(error(error_t::overrun, "producer stalled"), 0);
+                        }
+                        return std::forward_as_tuple(error(error_t::ok), 0);
+                    }
+                    if (seq == want) {
+                        size_t len = std::min<size_t>(slot->length_.load(std::memory_order_relaxed), m_meta->item_size_);
+                        if (len > buf_len) {
+                            return std::forward_as_tuple(error(error_t::free_space_fail, "buffer too small"), 0);
+                        }
+                        memcpy(buf, slot->data_, len);
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        if (slot->seq_.load(std::memory_order_relaxed) == want) {
+                            ++m_cursor;
+                            return std::forward_as_tuple(error(error_t::ok), len);
+                        }
+                    }
+                    skip_overrun();
+                    return std::forward_as_tuple(error(error_t::overrun, "reader overrun"), 0);
                 }
 
-                void close() {
-                    if (m_read_addr != nullptr) {
-                        munmap(static_cast<void*>(m_read_addr), m_file_size); // رӳ
-                        m_read_addr = nullptr;
+                // ȴһɶ(Ǽ߳ʱδ), æѯspin_us΢, futex, ʱfalse
+                bool wait(unsigned timeout_us, unsigned spin_us = 0) {
+                    if (!m_meta) {
+                        return false;
+                    }
+                    auto start = std::chrono::steady_clock::now();
+                    auto spin_end = start + std::chrono::microseconds(spin_us);
+                    auto deadline = start + std::chrono::microseconds(timeout_us);
+                    while (!readable()) {
+                        auto now = std::chrono::steady_clock::now();
+                        if (now >= deadline) {
+                            return false;
+                        }
+                        if (now < spin_end) {
+                            continue;
+                        }
+                        m_meta->waiters_.fetch_add(1, std::memory_order_seq_cst);
+                        uint32_t notify_seq = m_meta->notify_seq_.load(std::memory_order_seq_cst);
+                        if (!readable()) {
+                            // ߲STALE_SLOT_TIMEOUT_MS, Ա쳣˳ʱʱλ
+                            auto sleep_us = std::min<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(deadline - now).count(), (int64_t)STALE_SLOT_TIMEOUT_MS * 1000);
+                            FutexWait(&m_meta->notify_seq_, notify_seq, (unsigned)sleep_us);
+                        }
+                        m_meta->waiters_.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                    return true;
+                }
+
+                error close() {
+                    if (m_meta) {
+                        munmap((void*)m_meta, m_map_len);
                         m_meta = nullptr;
-                        m_data = nullptr;
                     }
-                    if (m_fd != -1) {
-                        ::close(m_fd); // رչڴļ
+                    if (m_fd != -1 && ::close(m_fd) == -1) {
                         m_fd = -1;
+                        return create_error(error_t::close_fail);
                     }
+                    m_fd = -1;
+                    return error(error_t::ok);
                 }
 
             private:
-                error open_impl() {
-                    struct stat sb;
-                    if (m_fd == -1 || fstat(m_fd, &sb) == -1 || (size_t)sb.st_size < m_file_size) {
+                template<bool is_shm>
+                error open_impl(const std::string& title, bool from_oldest) {
+                    close();
+                    // ǼдԪ, Զдʽ
+                    if constexpr (is_shm)
+                        m_fd = ::shm_open(title.c_str(), O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                    else
+                        m_fd = ::open(title.c_str(), O_RDWR, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                    if (m_fd == -1) {
                         return create_error(error_t::open_fail);
                     }
+                    auto err = Attach(m_fd, false, 0, 0, m_meta, m_map_len);
+                    if (err) {
+                        close();
+                        return err;
+                    }
+                    uint64_t claim_seq = m_meta->claim_seq_.load(std::memory_order_acquire);
+                    m_cursor = claim_seq;
+                    if (from_oldest) {
+                        m_cursor = claim_seq > m_meta->capacity_ ? claim_seq - m_meta->capacity_ : 0;
+                    }
+                    m_lost = 0;
+                    m_stall_cursor = UINT64_MAX;
+                    return error(error_t::ok);
+                }
 
-                    if (!m_can_change)
-                        m_read_addr = mmap(NULL, m_file_size, PROT_READ, MAP_SHARED, m_fd, 0);
-                    else
-                        m_read_addr = mmap(NULL, m_file_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+                // ǰαѷѱǻ߳ʱδ
+                bool readable() {
+                    return GetSlot(m_meta, m_cursor)->seq_.load(std::memory_order_acquire) >= 2 * m_cursor + 2 || stalled();
+                }
 
-                    if (m_read_addr == MAP_FAILED) {
-                        return create_error(error_t::mmap_fail);
+                // ǰαѱ, ״ηδ𳬹STALE_SLOT_TIMEOUT_MS
+                bool stalled() {
+                    if (m_meta->claim_seq_.load(std::memory_order_acquire) <= m_cursor) {
+                        return false;
+                    }
+                    auto now = std::chrono::steady_clock::now();
+                    if (m_stall_cursor != m_cursor) {
+                        m_stall_cursor = m_cursor;
+                        m_stall_since = now;
+                        return false;
                     }
+                    return now - m_stall_since >= std::chrono::milliseconds(STALE_SLOT_TIMEOUT_MS);
+                }
 
-                    m_meta = static_cast<MetaSt*>(m_read_addr);
-                    if (sizeof(MetaSt) <= m_file_size)
-                        m_data = (char*)m_read_addr + sizeof(MetaSt);
-                    return error(error_t::ok);
+                // ǺŰ, ٴα
+                void skip_overrun() {
+                    uint64_t claim_seq = m_meta->claim_seq_.load(std::memory_order_acquire);
+                    uint64_t half = m_meta->capacity_ / 2;
+                    uint64_t next = claim_seq > half ? claim_seq - half : 0;
+                    if (next <= m_cursor) {
+                        next = m_cursor + 1;
+                    }
+                    m_lost += next - m_cursor;
+                    m_cursor = next;
                 }
 
             private:
-                // Ƿɸıļ
-                bool        m_can_change;
                 // ļ
                 int         m_fd = -1;
-                // ǰȡڴַ
-                size_t      m_file_size = 0;
-                // ǰȡڴַ
-                void*       m_read_addr = MAP_FAILED;
-                // ָڴӳԪ
+                // ӳ䳤
+                size_t      m_map_len = 0;
+                // ӳʼַ
                 MetaSt*     m_meta = nullptr;
-                char*       m_data = nullptr;
+                // һȡ
+                uint64_t    m_cursor = 0;
+                // 򸲸ǻ߳ʱδʧ
+                uint64_t    m_lost = 0;
+                // δα꼰ʱ, ж߳ʱ
+                uint64_t    m_stall_cursor = UINT64_MAX;
+                std::chrono::steady_clock::time_point m_stall_since{};
             };
         };
 
@@ -1344,6 +4226,677 @@ namespace BTool {
             size_t                  m_buffer_size;
         };
 
+        // 첽־д, ΪBatchWriter, дִ̲߳ļIO
+        // ռ䲢, дͣˢ¼, ɺ̨̰߳д
+        // ̨߳io_uringύѷյĿ, ʱ˻Ϊpwrite; ѡO_DIRECT, ʱתд
+        // ύ: ۼдֽfdatasync; ߽ȫдʱȴ
+        // ɶ߳ͬʱwrite, ͬһ߳дݱ˳, ̼ͬ߳ռȺΪ
+        // ע: O_DIRECTдʱ, flush/ύ/رս볤ȵβд, 漴ضΪʵʳ, ֮дǸò
+        //       ʱ֮ļȼʵʳ; дض֮쳣˳ʱ, ļβDIRECT_ALIGNֽڵ
+        class AsyncWriter {
+        public:
+            // ύ
+            enum class sync_t {
+                none,       // fdatasync, رʱ
+                interval,   // ϴfdatasyncvalueдʱ
+                bytes,      // ϴfdatasyncۼдvalueֽʱ
+            };
+
+            enum : size_t {
+                DEFAULT_BLOCK_SIZE = 4 * 1024 * 1024,
+                DEFAULT_BLOCK_COUNT = 2,
+                DEFAULT_FLUSH_INTERVAL_MS = 10,     // δдͣʱ
+                DIRECT_ALIGN = 4096,                // O_DIRECTַȶ
+                MAX_BLOCK_SIZE = 1u << 30,
+            };
+
+        private:
+            // д, seq_ΪǰصĿ, Ųһʱʾδд
+            struct Block {
+                char*                   data_ = nullptr;
+                std::atomic<uint32_t>   seq_{ 0 };
+                std::atomic<uint64_t>   committed_{ 0 };            // ɿֽ
+                std::atomic<uint64_t>   sealed_{ UINT64_MAX };      // պЧ, δʱΪUINT64_MAX
+            };
+
+            // ļдʹõСio_uringװ, ̨߳ʹ, ֱʹϵͳ
+            class FileUring {
+            public:
+                FileUring() = default;
+                ~FileUring() { close(); }
+
+                bool open(unsigned entries) {
+                    io_uring_params params;
+                    memset(&params, 0, sizeof(params));
+                    m_ring_fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+                    if (m_ring_fd < 0) {
+                        return false;
+                    }
+                    m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                    m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                    if (params.features & IORING_FEAT_SINGLE_MMAP)
+                        m_sq_ring_size = m_cq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+                    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+                    m_sq_ring = mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQ_RING);
+                    m_cq_ring = (params.features & IORING_FEAT_SINGLE_MMAP) ? m_sq_ring
+                        : mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_CQ_RING);
+                    void* sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+                    if (m_sq_ring == MAP_FAILED || m_cq_ring == MAP_FAILED || sqes == MAP_FAILED) {
+                        if (sqes != MAP_FAILED)
+                            munmap(sqes, m_sqes_size);
+                        close();
+                        return false;
+                    }
+                    m_sqes = (io_uring_sqe*)sqes;
+
+                    char* sq = (char*)m_sq_ring;
+                    m_sq_tail = (unsigned*)(sq + params.sq_off.tail);
+                    m_sq_mask = *(unsigned*)(sq + params.sq_off.ring_mask);
+                    m_sq_entries = params.sq_entries;
+                    // ύ±±һһӦ
+                    unsigned* sq_array = (unsigned*)(sq + params.sq_off.array);
+                    for (unsigned i = 0; i < m_sq_entries; ++i)
+                        sq_array[i] = i;
+
+                    char* cq = (char*)m_cq_ring;
+                    m_cq_head = (unsigned*)(cq + params.cq_off.head);
+                    m_cq_tail = (unsigned*)(cq + params.cq_off.tail);
+                    m_cq_mask = *(unsigned*)(cq + params.cq_off.ring_mask);
+                    m_cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+                    m_sqe_tail = *m_sq_tail;
+                    return true;
+                }
+
+                void close() {
+                    if (m_sqes) {
+                        munmap(m_sqes, m_sqes_size);
+                        m_sqes = nullptr;
+                    }
+                    if (m_cq_ring && m_cq_ring != MAP_FAILED && m_cq_ring != m_sq_ring)
+                        munmap(m_cq_ring, m_cq_ring_size);
+                    if (m_sq_ring && m_sq_ring != MAP_FAILED)
+                        munmap(m_sq_ring, m_sq_ring_size);
+                    m_sq_ring = m_cq_ring = nullptr;
+                    if (m_ring_fd >= 0) {
+                        ::close(m_ring_fd);
+                        m_ring_fd = -1;
+                    }
+                    m_pending = 0;
+                }
+
+                inline bool is_open() const {
+                    return m_ring_fd >= 0;
+                }
+
+                // ͬʱ׼д
+                inline unsigned capacity() const {
+                    return m_sq_entries;
+                }
+
+                void prep_write(int fd, const void* buf, unsigned len, off_t offset, uint64_t user_data) {
+                    io_uring_sqe* sqe = &m_sqes[m_sqe_tail & m_sq_mask];
+                    memset(sqe, 0, sizeof(io_uring_sqe));
+                    sqe->opcode = IORING_OP_WRITE;
+                    sqe->fd = fd;
+                    sqe->addr = (uint64_t)buf;
+                    sqe->len = len;
+                    sqe->off = offset;
+                    sqe->user_data = user_data;
+                    ++m_sqe_tail;
+                    ++m_pending;
+                }
+
+                // ύ׼д벢ȴȫ, λصfunc(user_data, res), ϵͳʧʱfalse
+                template<typename Func>
+                bool submit_wait(Func&& func) {
+                    unsigned to_submit = m_pending;
+                    unsigned remain = m_pending;
+                    m_pending = 0;
+                    __atomic_store_n(m_sq_tail, m_sqe_tail, __ATOMIC_RELEASE);
+                    while (remain > 0) {
+                        int ret = (int)syscall(__NR_io_uring_enter, m_ring_fd, to_submit, remain, IORING_ENTER_GETEVENTS, nullptr, 0);
+                        if (ret < 0) {
+                            if (errno == EINTR)
+                                continue;
+                            return false;
+                        }
+                        to_submit -= std::min<unsigned>(to_submit, (unsigned)ret);
+                        unsigned head = *m_cq_head;
+                        unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+                        for (; head != tail && remain > 0; ++head, --remain) {
+                            io_uring_cqe& cqe = m_cqes[head & m_cq_mask];
+                            func(cqe.user_data, cqe.res);
+                        }
+                        __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+                    }
+                    return true;
+                }
+
+            private:
+                int             m_ring_fd = -1;
+                void*           m_sq_ring = nullptr;
+                void*           m_cq_ring = nullptr;
+                size_t          m_sq_ring_size = 0;
+                size_t          m_cq_ring_size = 0;
+                size_t          m_sqes_size = 0;
+                io_uring_sqe*   m_sqes = nullptr;
+                unsigned*       m_sq_tail = nullptr;
+                unsigned        m_sq_mask = 0;
+                unsigned        m_sq_entries = 0;
+                unsigned*       m_cq_head = nullptr;
+                unsigned*       m_cq_tail = nullptr;
+                unsigned        m_cq_mask = 0;
+                io_uring_cqe*   m_cqes = nullptr;
+                unsigned        m_sqe_tail = 0;
+                unsigned        m_pending = 0;
+            };
+
+            // дһ
+            struct WriteItem {
+                const char* data_;
+                size_t      len_;
+                off_t       offset_;
+            };
+
+        public:
+            // block_size: С, DIRECT_ALIGNȡ, д벻ɳֵ
+            // block_count: , Ϊ2
+            AsyncWriter(size_t block_size = DEFAULT_BLOCK_SIZE, size_t block_count = DEFAULT_BLOCK_COUNT)
+                : m_block_size((std::min<size_t>(std::max<size_t>(block_size, DIRECT_ALIGN), MAX_BLOCK_SIZE) + DIRECT_ALIGN - 1) & ~(size_t)(DIRECT_ALIGN - 1))
+                , m_block_count(std::max<size_t>(block_count, 2))
+            {
+            }
+
+            ~AsyncWriter() { close(); }
+
+            // ÷ύ, valueΪֽ, openǰ
+            void set_sync_policy(sync_t policy, uint64_t value) {
+                m_sync_policy = policy;
+                m_sync_value = value;
+            }
+
+            // δдͣʱ, openǰ
+            void set_flush_interval(unsigned ms) {
+                m_flush_interval_ms = std::max<unsigned>(ms, 1);
+            }
+
+            // over_write: Ƿ񸲸ԭļ
+            // direct: ǷO_DIRECTд
+            // use_uring: Ƿʹio_uring, ʱ˻Ϊpwrite
+            error open(const std::string& file, bool over_write = true, bool direct = false, bool use_uring = true) {
+                close();
+                int flags = O_RDWR | O_CREAT | (over_write ? O_TRUNC : 0) | (direct ? O_DIRECT : 0);
+                m_fd = ::open(file.c_str(), flags, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+                if (m_fd == -1) {
+                    return create_error(error_t::open_fail);
+                }
+                struct stat sb;
+                if (fstat(m_fd, &sb) == -1) {
+                    auto err = create_error(error_t::stat_fail);
+                    close();
+                    return err;
+                }
+                m_direct = direct;
+                m_file_offset = sb.st_size;
+
+                m_blocks.reset(new Block[m_block_count]);
+                for (size_t i = 0; i < m_block_count; ++i) {
+                    if (posix_memalign((void**)&m_blocks[i].data_, DIRECT_ALIGN, m_block_size) != 0) {
+                        close();
+                        return error(error_t::unknow, "alloc block fail");
+                    }
+                    m_blocks[i].seq_.store((uint32_t)i, std::memory_order_relaxed);
+                }
+                if (direct) {
+                    // תϴδβһ
+                    if (posix_memalign((void**)&m_bounce, DIRECT_ALIGN, m_block_size + DIRECT_ALIGN) != 0) {
+                        close();
+                        return error(error_t::unknow, "alloc block fail");
+                    }
+                    // ׷ʱĩβδ벿, ֮һͬд
+                    m_file_offset = sb.st_size & ~(off_t)(DIRECT_ALIGN - 1);
+                    m_tail_len = sb.st_size - m_file_offset;
+                    if (m_tail_len > 0 && pread(m_fd, m_bounce, DIRECT_ALIGN, m_file_offset) < (ssize_t)m_tail_len) {
+                        auto err = create_error(error_t::open_fail);
+                        close();
+                        return err;
+                    }
+                }
+                if (use_uring) {
+                    m_uring.open((unsigned)std::max<size_t>(m_block_count, 8));
+                }
+
+                m_state.store(0, std::memory_order_relaxed);
+                m_io_errno.store(0, std::memory_order_relaxed);
+                m_uring_failed = false;
+                m_write_seq = 0;
+                m_flush_req = 0;
+                m_flush_done = 0;
+                m_flush_target = 0;
+                m_flush_sync = false;
+                m_stop = false;
+                m_thread = std::thread(&AsyncWriter::write_loop, this);
+                return error(error_t::ok);
+            }
+
+            // Ƿio_uringд
+            inline bool is_uring() const {
+                return m_uring.is_open();
+            }
+
+            error write(std::string_view data) {
+                return write(data.data(), data.length());
+            }
+
+            template<typename _Ty>
+            error write(const _Ty& data) {
+                return write((const char*)(&data), sizeof(_Ty));
+            }
+
+            // ǰ, ǰʣռ䲻ʱղлһ, ȫдʱȴ
+            error write(const char* data, size_t len) {
+                if (m_fd == -1) {
+                    return error(error_t::open_fail, "not open");
+                }
+                if (len > m_block_size) {
+                    return error(error_t::free_space_fail, "item too large");
+                }
+                if (len == 0) {
+                    return error(error_t::ok);
+                }
+
+                uint64_t state = m_state.load(std::memory_order_acquire);
+                while (true) {
+                    int io_errno = m_io_errno.load(std::memory_order_relaxed);
+                    if (io_errno != 0) {
+                        errno = io_errno;
+                        return create_error(error_t::write_fail);
+                    }
+                    uint32_t seq = (uint32_t)(state >> 32);
+                    uint64_t offset = state & 0xffffffff;
+                    Block& block = m_blocks[seq % m_block_count];
+                    // δд
+                    if (block.seq_.load(std::memory_order_acquire) != seq) {
+                        std::this_thread::yield();
+                        state = m_state.load(std::memory_order_acquire);
+                        continue;
+                    }
+                    if (offset + len <= m_block_size) {
+                        if (!m_state.compare_exchange_weak(state, state + len, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                            continue;
+                        }
+                        memcpy(block.data_ + offset, data, len);
+                        block.committed_.fetch_add(len, std::memory_order_release);
+                        return error(error_t::ok);
+                    }
+                    seal(state);
+                    state = m_state.load(std::memory_order_acquire);
+                }
+            }
+
+            // յǰ鲢ȴǰдȫд
+            // sync: Ƿͬʱfdatasync
+            error flush(bool sync = false) {
+                if (m_fd == -1) {
+                    return error(error_t::open_fail, "not open");
+                }
+                seal_current();
+                {
+                    std::unique_lock<std::mutex> lock(m_mtx);
+                    uint64_t req = ++m_flush_req;
+                    // ſɻ, ֵȽ
+                    uint32_t target = (uint32_t)(m_state.load(std::memory_order_acquire) >> 32);
+                    if ((int32_t)(target - m_flush_target) > 0)
+                        m_flush_target = target;
+                    m_flush_sync = m_flush_sync || sync;
+                    m_cv.notify_all();
+                    m_done_cv.wait(lock, [&] { return m_flush_done >= req || m_io_errno.load() != 0; });
+                }
+                int io_errno = m_io_errno.load();
+                if (io_errno != 0) {
+                    errno = io_errno;
+                    return create_error(error_t::write_fail);
+                }
+                return error(error_t::ok);
+            }
+
+            // дȫݺر, ʱвд
+            error close() {
+                if (m_thread.joinable()) {
+                    seal_current();
+                    {
+                        std::lock_guard<std::mutex> lock(m_mtx);
+                        m_stop = true;
+                    }
+                    m_cv.notify_all();
+                    m_thread.join();
+                }
+
+                error_t err_code = m_io_errno.load() != 0 ? error_t::write_fail : error_t::ok;
+                if (m_fd != -1) {
+                    if (err_code == error_t::ok) {
+                        // βд, ٽضΪʵʳ
+                        write_tail();
+                        if (m_io_errno.load() != 0)
+                            err_code = error_t::write_fail;
+                    }
+                    if (fdatasync(m_fd) == -1 && err_code == error_t::ok)
+                        err_code = error_t::write_fail;
+                    if (::close(m_fd) == -1 && err_code == error_t::ok)
+                        err_code = error_t::close_fail;
+                    m_fd = -1;
+                }
+                m_uring.close();
+                if (m_blocks) {
+                    for (size_t i = 0; i < m_block_count; ++i)
+                        free(m_blocks[i].data_);
+                    m_blocks.reset();
+                }
+                free(m_bounce);
+                m_bounce = nullptr;
+                m_tail_len = 0;
+                return err_code == error_t::ok ? error(error_t::ok) : create_error(err_code);
+            }
+
+        private:
+            // stateָ, ɹʱ̨֪ͨ߳
+            bool seal(uint64_t state) {
+                uint32_t seq = (uint32_t)(state >> 32);
+                if (!m_state.compare_exchange_strong(state, (uint64_t)(uint32_t)(seq + 1) << 32, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    return false;
+                }
+                m_blocks[seq % m_block_count].sealed_.store(state & 0xffffffff, std::memory_order_release);
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                }
+                m_cv.notify_all();
+                return true;
+            }
+
+            // յǰǿտ
+            void seal_current() {
+                uint64_t state = m_state.load(std::memory_order_acquire);
+                while ((state & 0xffffffff) > 0 && !seal(state)) {
+                    state = m_state.load(std::memory_order_acquire);
+                }
+            }
+
+            // ̨д߳
+            void write_loop() {
+                auto last_sync = std::chrono::steady_clock::now();
+                uint64_t unsync_bytes = 0;
+                while (true) {
+                    // ռѷҿɵĿ
+                    size_t ready = 0;
+                    bool copying = false;
+                    for (; ready < m_block_count; ++ready) {
+                        Block& block = m_blocks[(m_write_seq + ready) % m_block_count];
+                        uint64_t sealed = block.sealed_.load(std::memory_order_acquire);
+                        if (sealed == UINT64_MAX)
+                            break;
+                        if (block.committed_.load(std::memory_order_acquire) != sealed) {
+                            copying = true;
+                            break;
+                        }
+                    }
+
+                    if (ready > 0) {
+                        unsync_bytes += write_blocks(ready);
+                        // 黹дĿ
+                        for (size_t i = 0; i < ready; ++i) {
+                            Block& block = m_blocks[(m_write_seq + i) % m_block_count];
+                            block.committed_.store(0, std::memory_order_relaxed);
+                            block.sealed_.store(UINT64_MAX, std::memory_order_relaxed);
+                            block.seq_.store((uint32_t)(m_write_seq + i + m_block_count), std::memory_order_release);
+                        }
+                        m_write_seq += (uint32_t)ready;
+                    }
+
+                    // ύ
+                    auto now = std::chrono::steady_clock::now();
+                    if (unsync_bytes > 0 && ((m_sync_policy == sync_t::bytes && unsync_bytes >= m_sync_value)
+                        || (m_sync_policy == sync_t::interval && now - last_sync >= std::chrono::milliseconds(m_sync_value)))) {
+                        write_tail();
+                        sync_file();
+                        unsync_bytes = 0;
+                        last_sync = now;
+                    }
+
+                    std::unique_lock<std::mutex> lock(m_mtx);
+                    // Ӧflush, Ŀ֮ǰĿд
+                    if (m_flush_done < m_flush_req && (int32_t)(m_write_seq - m_flush_target) >= 0) {
+                        uint64_t req = m_flush_req;
+                        bool sync = m_flush_sync;
+                        m_flush_sync = false;
+                        lock.unlock();
+                        write_tail();
+                        if (sync) {
+                            sync_file();
+                            unsync_bytes = 0;
+                            last_sync = std::chrono::steady_clock::now();
+                        }
+                        lock.lock();
+                        m_flush_done = req;
+                        m_done_cv.notify_all();
+                        continue;
+                    }
+                    if (ready > 0)
+                        continue;
+                    if (copying) {
+                        lock.unlock();
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    if (m_stop && (uint32_t)(m_state.load(std::memory_order_acquire) >> 32) == m_write_seq)
+                        break;
+
+                    Block& next = m_blocks[m_write_seq % m_block_count];
+                    bool woken = m_cv.wait_for(lock, std::chrono::milliseconds(m_flush_interval_ms), [&] {
+                        return m_stop || m_flush_done < m_flush_req || next.sealed_.load(std::memory_order_acquire) != UINT64_MAX;
+                    });
+                    lock.unlock();
+                    // ʱͣδд
+                    if (!woken) {
+                        seal_current();
+                    }
+                }
+                m_done_cv.notify_all();
+            }
+
+            // дm_write_seqready, дֽ
+            uint64_t write_blocks(size_t ready) {
+                uint64_t total = 0;
+                if (!m_direct) {
+                    std::vector<WriteItem> items;
+                    items.reserve(ready);
+                    for (size_t i = 0; i < ready; ++i) {
+                        Block& block = m_blocks[(m_write_seq + i) % m_block_count];
+                        size_t len = block.sealed_.load(std::memory_order_relaxed);
+                        items.push_back(WriteItem{ block.data_, len, m_file_offset });
+                        m_file_offset += len;
+                        total += len;
+                    }
+                    write_items(items);
+                    return total;
+                }
+
+                // O_DIRECT: ϴδβƴӺд벿, ʣಿ´
+                for (size_t i = 0; i < ready; ++i) {
+                    Block& block = m_blocks[(m_write_seq + i) % m_block_count];
+                    size_t len = block.sealed_.load(std::memory_order_relaxed);
+                    memcpy(m_bounce + m_tail_len, block.data_, len);
+                    size_t data_len = m_tail_len + len;
+                    size_t aligned_len = data_len & ~(size_t)(DIRECT_ALIGN - 1);
+                    if (aligned_len > 0) {
+                        std::vector<WriteItem> items{ WriteItem{ m_bounce, aligned_len, m_file_offset } };
+                        write_items(items);
+                        m_file_offset += aligned_len;
+                        memmove(m_bounce, m_bounce + aligned_len, data_len - aligned_len);
+                    }
+                    m_tail_len = data_len - aligned_len;
+                    total += len;
+                }
+                return total;
+            }
+
+            // O_DIRECTʱδβд, ضΪʵʳ, ֮ݻḲ䲿
+            void write_tail() {
+                if (!m_direct || m_tail_len == 0)
+                    return;
+                memset(m_bounce + m_tail_len, 0, DIRECT_ALIGN - m_tail_len);
+                std::vector<WriteItem> items{ WriteItem{ m_bounce, DIRECT_ALIGN, m_file_offset } };
+                write_items(items);
+                if (m_io_errno.load(std::memory_order_relaxed) == 0 && ftruncate(m_fd, m_file_offset + m_tail_len) == -1)
+                    set_io_error(errno);
+            }
+
+            // io_uringд, дio_uringʧܵĲpwrite
+            void write_items(std::vector<WriteItem>& items) {
+                if (m_uring.is_open()) {
+                    for (size_t begin = 0; begin < items.size(); begin += m_uring.capacity()) {
+                        size_t end = std::min<size_t>(items.size(), begin + m_uring.capacity());
+                        for (size_t i = begin; i < end; ++i)
+                            m_uring.prep_write(m_fd, items[i].data_, (unsigned)items[i].len_, items[i].offset_, i);
+                        bool ok = m_uring.submit_wait([&](uint64_t index, int res) {
+                            if (res > 0) {
+                                items[index].data_ += res;
+                                items[index].len_ -= res;
+                                items[index].offset_ += res;
+                            }
+                            // ں˲֧IORING_OP_WRITE
+                            else if (res == -EINVAL || res == -EOPNOTSUPP) {
+                                m_uring_failed = true;
+                            }
+                        });
+                        if (!ok || m_uring_failed) {
+                            m_uring.close();
+                            break;
+                        }
+                    }
+                }
+                for (auto& item : items) {
+                    while (item.len_ > 0) {
+                        ssize_t ret = pwrite(m_fd, item.data_, item.len_, item.offset_);
+                        if (ret <= 0) {
+                            if (ret < 0 && errno == EINTR)
+                                continue;
+                            set_io_error(ret < 0 ? errno : EIO);
+                            return;
+                        }
+                        item.data_ += ret;
+                        item.len_ -= ret;
+                        item.offset_ += ret;
+                    }
+                }
+            }
+
+            void sync_file() {
+                if (fdatasync(m_fd) == -1)
+                    set_io_error(errno);
+            }
+
+            void set_io_error(int err) {
+                int expected = 0;
+                m_io_errno.compare_exchange_strong(expected, err);
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_done_cv.notify_all();
+            }
+
+        private:
+            // С
+            const size_t                m_block_size;
+            const size_t                m_block_count;
+            // ύ
+            sync_t                      m_sync_policy = sync_t::none;
+            uint64_t                    m_sync_value = 0;
+            unsigned                    m_flush_interval_ms = DEFAULT_FLUSH_INTERVAL_MS;
+
+            // ļ´дλ
+            int                         m_fd = -1;
+            off_t                       m_file_offset = 0;
+            bool                        m_direct = false;
+            // O_DIRECTת漰δβ
+            char*                       m_bounce = nullptr;
+            size_t                      m_tail_len = 0;
+            FileUring                   m_uring;
+            bool                        m_uring_failed = false;
+
+            // д, 32λΪǰ, 32λΪǰ볤
+            std::unique_ptr<Block[]>    m_blocks;
+            std::atomic<uint64_t>       m_state{ 0 };
+            // ̨߳һдĿ
+            uint32_t                    m_write_seq = 0;
+            // ̨д
+            std::atomic<int>            m_io_errno{ 0 };
+
+            // ̨̼߳flush
+            std::thread                 m_thread;
+            std::mutex                  m_mtx;
+            std::condition_variable     m_cv;
+            std::condition_variable     m_done_cv;
+            bool                        m_stop = false;
+            uint64_t                    m_flush_req = 0;
+            uint64_t                    m_flush_done = 0;
+            uint32_t                    m_flush_target = 0;
+            bool                        m_flush_sync = false;
+        };
+
+        // seqlockĶ, ڹڴMapperӳ, жڲλα
+        // д뷽дǰһ, ȡΪǰһʱ, д, ޾ʱϵͳ
+        // ȡʱpauseæSPIN_COUNT, ֮ÿǰóʱƬ
+        // λͬһʱ̽һд뷽; д뷽д;쳣˳ʱű, ȡmax_retryκ󷵻false, ֱһд
+        template<typename _Ty>
+        struct alignas(64) SeqlockSlot {
+            static_assert(std::is_trivially_copyable<_Ty>::value, "SeqlockSlot requires trivially copyable type");
+
+            enum : unsigned {
+                SPIN_COUNT = 64,                // æԴ
+                DEFAULT_MAX_RETRY = 100000,     // ĬೢԴ
+            };
+
+            uint64_t    seq_;       // , ʾд, __atomic
+            _Ty         data_;
+
+            void store(const _Ty& value) {
+                // һд뷽;˳ʱΪ, ȡд, ֤ɺŻصż
+                uint64_t begin = __atomic_load_n(&seq_, __ATOMIC_RELAXED) | 1;
+                __atomic_store_n(&seq_, begin, __ATOMIC_RELAXED);
+                __atomic_thread_fence(__ATOMIC_RELEASE);
+                memcpy(&data_, &value, sizeof(_Ty));
+                __atomic_store_n(&seq_, begin + 1, __ATOMIC_RELEASE);
+            }
+
+            // ȡһµĿ, max_retryԲһʱfalse
+            bool load(_Ty& value, unsigned max_retry = DEFAULT_MAX_RETRY) const {
+                for (unsigned times = 0; times < max_retry; ++times) {
+                    if (times >= SPIN_COUNT) {
+                        std::this_thread::yield();
+                    }
+                    else if (times > 0) {
+#if defined(__x86_64__) || defined(__i386__)
+                        __builtin_ia32_pause();
+#endif
+                    }
+                    uint64_t seq = __atomic_load_n(&seq_, __ATOMIC_ACQUIRE);
+                    if (seq & 1) {
+                        continue;
+                    }
+                    memcpy(&value, &data_, sizeof(_Ty));
+                    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                    if (__atomic_load_n(&seq_, __ATOMIC_RELAXED) == seq) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // ɵд, ȡɾݴжϿǷ
+            uint64_t version() const {
+                return __atomic_load_n(&seq_, __ATOMIC_ACQUIRE) / 2;
+            }
+        };
+
         class ShmReaderWriter {
         public:
             enum RWType { READER = O_RDONLY, WRITER = O_RDWR, READER_WRITER = WRITER };
@@ -1484,6 +5037,50 @@ namespace BTool {
                 return true;
             }
 
+            // : ڴ水SeqlockSlot<_Ty>鲼, ÿ±Ӧһ, 絥Լ
+            // initʱshm_sizeȡsizeof(SeqlockSlot<_Ty>) * , ʱ0ʼ; ±ͬһʱ̽һд뷽
+            // ȡREADER򿪼, ȡдڴ
+            template<typename _Ty>
+            size_t snapshot_count() const {
+                if (m_shm_ptr == MAP_FAILED)
+                    return 0;
+                return m_shm_size / sizeof(SeqlockSlot<_Ty>);
+            }
+
+            template<typename _Ty>
+            bool write_snapshot(size_t index, const _Ty& value) {
+                if (m_type == READER || index >= snapshot_count<_Ty>()) return false;
+                ((SeqlockSlot<_Ty>*)m_shm_ptr)[index].store(value);
+                return true;
+            }
+
+            // ȡһµĿ, max_retryԲһʱfalse
+            template<typename _Ty>
+            bool read_snapshot(size_t index, _Ty& value, unsigned max_retry = SeqlockSlot<_Ty>::DEFAULT_MAX_RETRY) const {
+                if (index >= snapshot_count<_Ty>()) return false;
+                return ((const SeqlockSlot<_Ty>*)m_shm_ptr)[index].load(value, max_retry);
+            }
+
+            // ȡfirstcount, շֱһ, سɹȡĸ, ʧֹܼͣ
+            template<typename _Ty>
+            size_t read_snapshots(size_t first, _Ty* values, size_t count, unsigned max_retry = SeqlockSlot<_Ty>::DEFAULT_MAX_RETRY) const {
+                size_t total = snapshot_count<_Ty>();
+                count = first < total ? std::min(count, total - first) : 0;
+                const SeqlockSlot<_Ty>* slots = (const SeqlockSlot<_Ty>*)m_shm_ptr + first;
+                for (size_t i = 0; i < count; ++i) {
+                    if (!slots[i].load(values[i], max_retry))
+                        return i;
+                }
+                return count;
+            }
+
+            // ɵд, ±Խʱ0
+            template<typename _Ty>
+            uint64_t snapshot_version(size_t index) const {
+                if (index >= snapshot_count<_Ty>()) return 0;
+                return ((const SeqlockSlot<_Ty>*)m_shm_ptr)[index].version();
+            }
+
             void unlink() {
                 if (!m_shm_name.empty())
                     shm_unlink(m_shm_name.c_str());
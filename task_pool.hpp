@@ -96,7 +96,7 @@ namespace BTool {
                 thread_num = core_num;
             }
             size_t cur_thread_ver = ++m_cur_thread_ver;
-            thread_num = thread_num < TP_MAX_THREAD ? thread_num : TP_MAX_THREAD;
+            thread_num = thread_num < TP_MAX_THREAD ? thread_num : (size_t)TP_MAX_THREAD;
 
             for (size_t i = 0; i < thread_num; i++) {
                 if (is_bind_core) {
@@ -749,12 +749,12 @@ namespace BTool {
 
                 template <typename AsTPropType>
                 PropCountNode(AsTPropType&& prop, PropCountNode* pre_same_prop_node, PropCountNode* pre_list_prop_node, bool can_immediately_pop)
-                    : can_pop_(can_immediately_pop)
-                    , count_(1)
-                    , pre_same_prop_node_(pre_same_prop_node)
+                    : pre_same_prop_node_(pre_same_prop_node)
                     , next_same_prop_node_(nullptr)
                     , pre_list_prop_node_(pre_list_prop_node)
                     , next_list_prop_node_(nullptr)
+                    , count_(1)
+                    , can_pop_(can_immediately_pop)
                     , prop_(std::forward<AsTPropType>(prop)) {
                     if (pre_same_prop_node) pre_same_prop_node->next_same_prop_node_ = this;
                     if (pre_list_prop_node) pre_list_prop_node->next_list_prop_node_ = this;
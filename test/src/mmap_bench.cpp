@@ -0,0 +1,111 @@
+// MMapFile::Reader顺序回放压测, 对比各访问提示下读取大文件的吞吐及缺页次数
+// 用法: mmap_bench [文件大小MB] [块大小MB] [文件路径]
+// 每种策略读取前丢弃文件页缓存(posix_fadvise), 每种策略输出一行JSON, 字段: policy/file_mb/chunk_mb/seconds/mb_per_sec/major_faults/minor_faults/checksum
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <sys/resource.h>
+#include "mmap_file.hpp"
+
+using namespace BTool;
+
+typedef std::chrono::steady_clock bench_clock;
+
+static size_t g_file_mb = 4096;
+static size_t g_chunk_mb = 16;
+static std::string g_file = "mmap_bench.dat";
+
+// 生成测试文件, 已存在且大小一致时复用
+static bool PrepareFile() {
+    struct stat sb;
+    if (stat(g_file.c_str(), &sb) == 0 && (size_t)sb.st_size == g_file_mb * 1024 * 1024)
+        return true;
+
+    ::unlink(g_file.c_str());
+    MMapFile::Appender appender;
+    if (appender.open(g_file, false))
+        return false;
+    std::string block(1024 * 1024, 0);
+    for (size_t i = 0; i < block.size() / sizeof(uint64_t); ++i)
+        ((uint64_t*)block.data())[i] = i;
+    for (size_t i = 0; i < g_file_mb; ++i) {
+        if (appender.write(block))
+            return false;
+    }
+    return !appender.close();
+}
+
+// 丢弃文件页缓存, 使每种策略均自磁盘读取
+static void DropCache() {
+    int fd = ::open(g_file.c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+static void Bench(const char* policy, unsigned hints) {
+    DropCache();
+
+    MMapFile::Reader reader(sizeof(uint64_t));
+    // 使MAP_POPULATE对测试文件生效
+    reader.set_hints(hints, g_file_mb * 1024 * 1024);
+    if (reader.open(g_file, g_chunk_mb * 1024 * 1024 / sizeof(uint64_t))) {
+        std::cout << "{\"error\":\"open failed\",\"policy\":\"" << policy << "\"}" << std::endl;
+        return;
+    }
+
+    struct rusage begin_usage, end_usage;
+    getrusage(RUSAGE_SELF, &begin_usage);
+    auto start = bench_clock::now();
+
+    uint64_t checksum = 0;
+    size_t total = 0;
+    while (true) {
+        auto [err, data, count] = reader.read<uint64_t>();
+        if (err || count == 0)
+            break;
+        for (size_t i = 0; i < count; ++i)
+            checksum += data[i];
+        total += count * sizeof(uint64_t);
+    }
+
+    double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+    getrusage(RUSAGE_SELF, &end_usage);
+    reader.close();
+
+    std::cout << "{\"policy\":\"" << policy << "\""
+        << ",\"file_mb\":" << total / 1024 / 1024
+        << ",\"chunk_mb\":" << g_chunk_mb
+        << ",\"seconds\":" << seconds
+        << ",\"mb_per_sec\":" << (unsigned long long)(seconds > 0 ? total / 1024 / 1024 / seconds : 0)
+        << ",\"major_faults\":" << end_usage.ru_majflt - begin_usage.ru_majflt
+        << ",\"minor_faults\":" << end_usage.ru_minflt - begin_usage.ru_minflt
+        << ",\"checksum\":" << checksum
+        << "}" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1)
+        g_file_mb = std::max(1ul, strtoul(argv[1], nullptr, 10));
+    if (argc > 2)
+        g_chunk_mb = std::max(1ul, strtoul(argv[2], nullptr, 10));
+    if (argc > 3)
+        g_file = argv[3];
+
+    if (!PrepareFile()) {
+        std::cout << "{\"error\":\"prepare file failed\",\"file\":\"" << g_file << "\"}" << std::endl;
+        return 1;
+    }
+
+    Bench("none", MMapFile::hint_none);
+    Bench("sequential", MMapFile::hint_sequential);
+    Bench("populate", MMapFile::hint_populate);
+    Bench("hugepage", MMapFile::hint_hugepage);
+    Bench("dontneed", MMapFile::hint_dontneed);
+    Bench("sequential+dontneed", MMapFile::hint_sequential | MMapFile::hint_dontneed);
+    Bench("all", MMapFile::hint_sequential | MMapFile::hint_populate | MMapFile::hint_hugepage | MMapFile::hint_dontneed);
+    return 0;
+}
@@ -0,0 +1,1387 @@
+// MMapFile功能自检, 各用例依次执行, 失败时输出用例名及原因并返回非0
+// 用法: mmap_test [临时目录]
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "mmap_file.hpp"
+
+using namespace BTool;
+
+static std::string g_dir = ".";
+
+#define TEST_CHECK(cond) do { if (!(cond)) { std::cout << __FUNCTION__ << " failed at line " << __LINE__ << ": " #cond << std::endl; return false; } } while (0)
+
+static std::string TempFile(const char* name) {
+    std::string file = g_dir + "/" + name;
+    ::unlink(file.c_str());
+    return file;
+}
+
+static size_t FileSize(const std::string& file) {
+    struct stat sb;
+    return stat(file.c_str(), &sb) == 0 ? (size_t)sb.st_size : 0;
+}
+
+// AsyncWriter关闭后重新打开, 块序号自0重新计数, flush须正常返回
+static bool TestAsyncWriterReopen() {
+    std::string file = TempFile("mmap_test_async.dat");
+    MMapFile::AsyncWriter writer(4096);
+    const int counts[] = { 5000, 10 };
+    for (int round = 0; round < 2; ++round) {
+        TEST_CHECK(!writer.open(file, round == 0));
+        for (int i = 0; i < counts[round]; ++i)
+            TEST_CHECK(!writer.write(std::string_view("0123456789")));
+        TEST_CHECK(!writer.flush());
+        TEST_CHECK(!writer.close());
+    }
+    TEST_CHECK(FileSize(file) == (5000 + 10) * 10);
+    ::unlink(file.c_str());
+    return true;
+}
+
+// 按旧版文件头(无标识及版本)生成文件, data后补0至file_size
+static bool WriteLegacyFile(const std::string& file, const void* head, size_t head_len, const std::string& data, size_t file_size) {
+    std::string content((const char*)head, head_len);
+    content += data;
+    content.resize(file_size, 0);
+    FILE* fp = fopen(file.c_str(), "wb");
+    if (fp == nullptr)
+        return false;
+    bool ok = fwrite(content.data(), 1, content.size(), fp) == content.size();
+    fclose(fp);
+    return ok;
+}
+
+// 读取VectorBuffer中全部uint64_t子项, 须依次为0, 1, 2...
+static bool ReadSequence(MMapFile::VectorBuffer::Reader& reader, uint64_t& expect) {
+    expect = 0;
+    while (true) {
+        auto [err, items, count] = reader.read<uint64_t>();
+        TEST_CHECK(!err);
+        if (count == 0)
+            break;
+        for (size_t i = 0; i < count; ++i, ++expect)
+            TEST_CHECK(items[i] == expect);
+    }
+    return true;
+}
+
+// 旧版VectorBuffer文件: 读取方只读访问, 写入方拒绝且不改动文件, 经Migrate迁移后可追加
+static bool TestVectorBufferLegacy() {
+    std::string file = TempFile("mmap_test_vector.dat");
+    std::string data;
+    for (uint64_t i = 0; i < 100; ++i)
+        data.append((const char*)&i, sizeof(i));
+    size_t head[3] = { sizeof(uint64_t), data.size(), 3 * sizeof(size_t) + data.size() };
+    TEST_CHECK(WriteLegacyFile(file, head, sizeof(head), data, head[2]));
+    uint64_t expect = 0;
+    {
+        MMapFile::VectorBuffer::Reader reader;
+        TEST_CHECK(!reader.open(file, 256));
+        TEST_CHECK(reader.get_obj_num() == 100);
+        TEST_CHECK(ReadSequence(reader, expect));
+        TEST_CHECK(expect == 100);
+    }
+    {
+        MMapFile::VectorBuffer::Writer writer;
+        auto err = writer.open(file, sizeof(uint64_t), true, 4096);
+        TEST_CHECK(err && err.code() == MMapFile::error_t::unsupported);
+        TEST_CHECK(FileSize(file) == head[2]);
+    }
+
+    TEST_CHECK(!MMapFile::VectorBuffer::Migrate(file));
+    TEST_CHECK(FileSize(file + ".migrating") == 0);
+    TEST_CHECK(!MMapFile::VectorBuffer::Migrate(file));
+    {
+        MMapFile::VectorBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, sizeof(uint64_t), true, 4096));
+        for (uint64_t i = 100; i < 150; ++i)
+            TEST_CHECK(!writer.write(i));
+        writer.close();
+    }
+    MMapFile::VectorBuffer::Reader reader;
+    TEST_CHECK(!reader.open(file, 1024 * 1024));
+    TEST_CHECK(reader.get_obj_num() == 150);
+    TEST_CHECK(ReadSequence(reader, expect));
+    TEST_CHECK(expect == 150);
+    reader.close();
+
+    // 无法识别的文件头, 追加打开及迁移均失败且不改动文件
+    std::string garbage(64, 'x');
+    TEST_CHECK(WriteLegacyFile(file, garbage.data(), garbage.size(), "", garbage.size()));
+    MMapFile::VectorBuffer::Writer writer;
+    auto err = writer.open(file, sizeof(uint64_t), true, 4096);
+    TEST_CHECK(err && err.code() == MMapFile::error_t::unsupported);
+    err = MMapFile::VectorBuffer::Migrate(file);
+    TEST_CHECK(err && err.code() == MMapFile::error_t::unsupported);
+    TEST_CHECK(FileSize(file) == garbage.size());
+    ::unlink(file.c_str());
+    return true;
+}
+
+// 旧版FixBuffer文件: 读取方只读访问, 写入方拒绝且不改动文件, 经Migrate迁移后可追加
+static bool TestFixBufferLegacy() {
+#pragma pack(push, 1)
+    struct { uint8_t has_finished_; size_t write_len_; size_t file_size_; } head = { 1, 10, 4096 };
+#pragma pack(pop)
+    std::string file = TempFile("mmap_test_fix.dat");
+    TEST_CHECK(WriteLegacyFile(file, &head, sizeof(head), "0123456789", head.file_size_));
+    {
+        MMapFile::FixBuffer::Reader reader;
+        TEST_CHECK(!reader.open(file));
+        TEST_CHECK(reader.get_length() == 10);
+        TEST_CHECK(reader.finished());
+        TEST_CHECK(std::string((const char*)reader.get_data(), 10) == "0123456789");
+    }
+    {
+        MMapFile::FixBuffer::Writer writer;
+        auto err = writer.open(file, 0, true);
+        TEST_CHECK(err && err.code() == MMapFile::error_t::unsupported);
+        TEST_CHECK(FileSize(file) == head.file_size_);
+    }
+
+    TEST_CHECK(!MMapFile::FixBuffer::Migrate(file));
+    TEST_CHECK(FileSize(file + ".migrating") == 0);
+    TEST_CHECK(!MMapFile::FixBuffer::Migrate(file));
+    {
+        MMapFile::FixBuffer::Reader reader;
+        TEST_CHECK(!reader.open(file));
+        TEST_CHECK(reader.get_length() == 10);
+        TEST_CHECK(reader.finished());
+    }
+    {
+        MMapFile::FixBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, 0, true));
+        TEST_CHECK(!writer.write("abc", 3));
+        writer.close();
+    }
+    MMapFile::FixBuffer::Reader reader;
+    TEST_CHECK(!reader.open(file));
+    TEST_CHECK(reader.get_length() == 13);
+    TEST_CHECK(std::string((const char*)reader.get_data(), 13) == "0123456789abc");
+    reader.close();
+    ::unlink(file.c_str());
+    return true;
+}
+
+// BlockBuffer默认压缩算法须已编译支持, 未定义__USE_LZ4__/__USE_ZSTD__时亦可直接打开
+static bool TestBlockBufferDefaultCodec() {
+    std::string file = TempFile("mmap_test_block.dat");
+    {
+        MMapFile::BlockBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, sizeof(uint64_t)));
+        for (uint64_t i = 0; i < 10000; ++i)
+            TEST_CHECK(!writer.write(i));
+        writer.close();
+    }
+    MMapFile::BlockBuffer::Reader reader;
+    TEST_CHECK(!reader.open(file, 1024 * 1024));
+    TEST_CHECK(reader.get_obj_num() == 10000);
+    reader.close();
+    ::unlink(file.c_str());
+    return true;
+}
+
+// 写入方写入中途退出(序号保持奇数)时, 读取方有限次尝试后返回false, 下一次写入后恢复
+static bool TestSeqlockAbandonedWrite() {
+    struct Quote {
+        int64_t price_;
+        int64_t volume_;
+    };
+    std::string title = "/mmap_test_seqlock";
+    ::shm_unlink(title.c_str());
+    MMapFile::Mapper<MMapFile::SeqlockSlot<Quote>> mapper;
+    TEST_CHECK(!mapper.shm_open(title));
+    MMapFile::SeqlockSlot<Quote>* slot = mapper.get();
+    Quote quote{ 100, 10 };
+    slot->store(quote);
+    Quote out{};
+    TEST_CHECK(slot->load(out) && out.price_ == 100 && slot->version() == 1);
+
+    __atomic_store_n(&slot->seq_, slot->seq_ + 1, __ATOMIC_RELEASE);
+    TEST_CHECK(!slot->load(out, 10));
+    TEST_CHECK(!slot->load(out));
+
+    // 之后的写入恢复一致, 序号回到偶数
+    Quote next{ 101, 11 };
+    slot->store(next);
+    TEST_CHECK(slot->load(out) && out.price_ == 101 && out.volume_ == 11);
+    TEST_CHECK(slot->seq_ % 2 == 0 && slot->version() == 2);
+    mapper.close();
+    ::shm_unlink(title.c_str());
+    return true;
+}
+
+static std::string ReadFile(const std::string& file) {
+    std::ifstream in(file, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+// Appender: 跨窗口写入内容连续, 关闭后文件截断至实际长度, 追加打开时大于窗口的记录完整写入
+static bool TestAppender() {
+    std::string file = TempFile("mmap_test_appender.dat");
+    const size_t count = 20000;
+    const size_t rec_len = 37;
+    {
+        MMapFile::Appender appender(4096);
+        TEST_CHECK(!appender.open(file, false));
+        char rec[rec_len];
+        for (size_t i = 0; i < count; ++i) {
+            snprintf(rec, sizeof(rec), "%036zu", i);
+            TEST_CHECK(!appender.write(rec, rec_len));
+        }
+        TEST_CHECK(!appender.close());
+    }
+    TEST_CHECK(FileSize(file) == count * rec_len);
+    std::string content = ReadFile(file);
+    for (size_t i = 0; i < count; i += 997) {
+        char expect[rec_len];
+        snprintf(expect, sizeof(expect), "%036zu", i);
+        TEST_CHECK(memcmp(content.data() + i * rec_len, expect, rec_len) == 0);
+    }
+    {
+        MMapFile::Appender appender(4096);
+        TEST_CHECK(!appender.open(file, true));
+        TEST_CHECK(!appender.write(std::string(10000, 'z')));
+        TEST_CHECK(!appender.write(std::string_view("end")));
+    }
+    content = ReadFile(file);
+    TEST_CHECK(content.size() == count * rec_len + 10003);
+    TEST_CHECK(content.compare(count * rec_len, 10000, std::string(10000, 'z')) == 0);
+    TEST_CHECK(content.compare(content.size() - 3, 3, "end") == 0);
+    ::unlink(file.c_str());
+
+    // 共享内存
+    std::string title = "mmap_test_appender";
+    ::shm_unlink(title.c_str());
+    {
+        MMapFile::Appender appender(1 << 16);
+        TEST_CHECK(!appender.shm_open(title, false));
+        for (int i = 0; i < 1000; ++i)
+            TEST_CHECK(!appender.write(std::string_view("abcd")));
+        TEST_CHECK(!appender.close());
+    }
+    int fd = ::shm_open(title.c_str(), O_RDONLY, 0);
+    TEST_CHECK(fd >= 0);
+    struct stat sb;
+    TEST_CHECK(fstat(fd, &sb) == 0 && sb.st_size == 4000);
+    ::close(fd);
+    ::shm_unlink(title.c_str());
+
+    // Writer经Appender写入
+    {
+        MMapFile::Writer writer;
+        TEST_CHECK(!writer.open(file, false));
+        char rec[rec_len];
+        for (size_t i = 0; i < count; ++i) {
+            snprintf(rec, sizeof(rec), "%036zu", i);
+            TEST_CHECK(!writer.write(std::string_view(rec, rec_len)));
+        }
+    }
+    content = ReadFile(file);
+    TEST_CHECK(content.size() == count * rec_len);
+    TEST_CHECK(content.compare(rec_len * 5, rec_len - 1, "000000000000000000000000000000000005") == 0);
+    ::unlink(file.c_str());
+    return true;
+}
+
+// RingBuffer: 多线程及跨进程写入, 读取方按各写入方顺序读取, 落后时计入丢失数而非读到错乱数据
+static bool TestRingBuffer() {
+    struct Tick {
+        uint64_t producer_;
+        uint64_t seq_;
+    };
+    const char* title = "mmap_test_ring";
+    ::shm_unlink(title);
+    const uint64_t producers = 4;
+    const uint64_t count = 20000;
+    MMapFile::RingBuffer::Writer writer;
+    TEST_CHECK(!writer.shm_open(title, sizeof(Tick), 1 << 12));
+
+    // 快速及慢速读取方, 慢速读取方必然被覆盖
+    struct reader_rslt_st {
+        uint64_t got_ = 0;
+        uint64_t lost_ = 0;
+        bool ordered_ = true;
+    } rslts[2];
+    std::atomic<int> ready{ 0 };
+    auto read_all = [&](bool slow, reader_rslt_st& rslt) {
+        MMapFile::RingBuffer::Reader reader;
+        if (reader.shm_open(title)) {
+            rslt.ordered_ = false;
+            return;
+        }
+        ++ready;
+        uint64_t next[producers] = { 0 };
+        while (rslt.got_ + reader.get_lost() < producers * count) {
+            if (!reader.wait(2000000))
+                break;
+            Tick tick;
+            auto [err, has_data] = reader.read(tick);
+            if (err) {
+                if (err.code() != MMapFile::error_t::overrun)
+                    rslt.ordered_ = false;
+                continue;
+            }
+            if (!has_data)
+                continue;
+            if (tick.producer_ >= producers || tick.seq_ < next[tick.producer_])
+                rslt.ordered_ = false;
+            else
+                next[tick.producer_] = tick.seq_ + 1;
+            if (slow && ++rslt.got_ % 1000 == 0)
+                usleep(1000);
+            else if (!slow)
+                ++rslt.got_;
+        }
+        rslt.lost_ = reader.get_lost();
+    };
+    std::thread fast_reader([&] { read_all(false, rslts[0]); });
+    std::thread slow_reader([&] { read_all(true, rslts[1]); });
+    while (ready < 2)
+        std::this_thread::yield();
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        MMapFile::RingBuffer::Writer child;
+        if (child.shm_open(title, sizeof(Tick), 0))
+            _exit(2);
+        for (uint64_t i = 0; i < count; ++i)
+            child.write(Tick{ producers - 1, i });
+        _exit(0);
+    }
+    std::vector<std::thread> threads;
+    for (uint64_t producer = 0; producer < producers - 1; ++producer) {
+        threads.emplace_back([&, producer] {
+            for (uint64_t i = 0; i < count; ++i)
+                writer.write(Tick{ producer, i });
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    int status = 0;
+    waitpid(pid, &status, 0);
+    fast_reader.join();
+    slow_reader.join();
+    TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    for (auto& rslt : rslts) {
+        TEST_CHECK(rslt.ordered_);
+        TEST_CHECK(rslt.got_ + rslt.lost_ == producers * count);
+    }
+    TEST_CHECK(rslts[1].lost_ > 0);
+
+    // 子项长度不一致时打开失败, 超长写入失败
+    MMapFile::RingBuffer::Writer mismatch;
+    TEST_CHECK(mismatch.shm_open(title, sizeof(Tick) + 1, 16));
+    char big[sizeof(Tick) * 2] = { 0 };
+    TEST_CHECK(writer.write(big, sizeof(big)));
+    // 自最早可读位置开始读取
+    {
+        MMapFile::RingBuffer::Reader reader;
+        TEST_CHECK(!reader.shm_open(title, true));
+        TEST_CHECK(reader.get_lag() == writer.get_capacity());
+    }
+    writer.close();
+    ::shm_unlink(title);
+    return true;
+}
+
+// 模拟生产者申请槽位后异常退出: 申请序号并置为写入中, 不再发布
+struct RingAbandon : public MMapFile::RingBuffer {
+    static bool Claim(const std::string& title) {
+        int fd = ::shm_open(title.c_str(), O_RDWR, S_IRUSR | S_IWUSR);
+        if (fd == -1)
+            return false;
+        MetaSt* meta = nullptr;
+        size_t map_len = 0;
+        bool ok = !Attach(fd, false, 0, 0, meta, map_len);
+        if (ok) {
+            uint64_t seq = meta->claim_seq_.fetch_add(1, std::memory_order_relaxed);
+            GetSlot(meta, seq)->seq_.store(2 * seq + 1, std::memory_order_release);
+            munmap((void*)meta, map_len);
+        }
+        ::close(fd);
+        return ok;
+    }
+};
+
+// RingBuffer: 生产者申请槽位后异常退出, 读取方超时后跳过该槽位并计入丢失数, 回绕至该槽位的生产者超时后接管
+static bool TestRingBufferAbandoned() {
+    const char* title = "mmap_test_ring_abandon";
+    ::shm_unlink(title);
+    MMapFile::RingBuffer::Writer writer;
+    TEST_CHECK(!writer.shm_open(title, sizeof(uint64_t), 4));
+    MMapFile::RingBuffer::Reader reader;
+    TEST_CHECK(!reader.shm_open(title));
+
+    TEST_CHECK(!writer.write(uint64_t(1)));
+    TEST_CHECK(RingAbandon::Claim(title));
+    TEST_CHECK(!writer.write(uint64_t(2)));
+
+    uint64_t value = 0;
+    TEST_CHECK(reader.wait(0));
+    auto [err, has_data] = reader.read(value);
+    TEST_CHECK(!err && has_data && value == 1);
+    // 槽位未发布, 未超时前不可读
+    std::tie(err, has_data) = reader.read(value);
+    TEST_CHECK(!err && !has_data);
+    TEST_CHECK(!reader.wait(1000));
+    TEST_CHECK(reader.wait(5000000));
+    std::tie(err, has_data) = reader.read(value);
+    TEST_CHECK(err.code() == MMapFile::error_t::overrun && !has_data);
+    TEST_CHECK(reader.get_lost() == 1);
+    std::tie(err, has_data) = reader.read(value);
+    TEST_CHECK(!err && has_data && value == 2);
+
+    // 回绕至被遗弃的槽位, 生产者超时后接管并可被读取
+    TEST_CHECK(!writer.write(uint64_t(3)));
+    TEST_CHECK(!writer.write(uint64_t(4)));
+    auto start = std::chrono::steady_clock::now();
+    TEST_CHECK(!writer.write(uint64_t(5)));
+    TEST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(500));
+    for (uint64_t expect = 3; expect <= 5; ++expect) {
+        std::tie(err, has_data) = reader.read(value);
+        TEST_CHECK(!err && has_data && value == expect);
+    }
+    TEST_CHECK(reader.get_lost() == 1);
+    writer.close();
+    ::shm_unlink(title);
+    return true;
+}
+
+// VectorBuffer跟随读取: 写入方持续写入时按序读到全部子项, 无新数据时超时返回空, 写入方重建文件后自头读取
+static bool TestVectorBufferFollow() {
+    struct Rec {
+        uint64_t seq_;
+        char pad_[24];
+    };
+    for (int shm = 0; shm < 2; ++shm) {
+        std::string file = shm ? "mmap_test_follow" : TempFile("mmap_test_follow.dat");
+        if (shm)
+            ::shm_unlink(file.c_str());
+        const uint64_t count = 50000;
+        MMapFile::VectorBuffer::Writer writer;
+        TEST_CHECK(!(shm ? writer.shm_open(file, sizeof(Rec), false, 4096, 4096) : writer.open(file, sizeof(Rec), false, 4096, 4096)));
+        for (uint64_t i = 0; i < 10; ++i)
+            TEST_CHECK(!writer.write(Rec{ i, {} }));
+        MMapFile::VectorBuffer::Reader reader;
+        TEST_CHECK(!(shm ? reader.shm_open(file, 16) : reader.open(file, 16)));
+
+        std::thread producer([&] {
+            for (uint64_t i = 10; i < count; ++i) {
+                writer.write(Rec{ i, {} });
+                if (i % 5000 == 0)
+                    usleep(200);
+            }
+        });
+        uint64_t next = 0;
+        bool ordered = true;
+        while (next < count) {
+            auto [err, items, num] = reader.read_follow<Rec>(4096, 2000000);
+            if (err || num == 0)
+                break;
+            for (size_t i = 0; i < num; ++i, ++next)
+                ordered = ordered && items[i].seq_ == next;
+        }
+        producer.join();
+        TEST_CHECK(next == count && ordered);
+        TEST_CHECK(reader.get_follow_index() == count);
+        auto [idle_err, idle_data] = reader.read_follow(10);
+        TEST_CHECK(!idle_err && idle_data.empty());
+
+        writer.close();
+        MMapFile::VectorBuffer::Writer rebuilt;
+        TEST_CHECK(!(shm ? rebuilt.shm_open(file, sizeof(Rec), false) : rebuilt.open(file, sizeof(Rec), false)));
+        TEST_CHECK(!rebuilt.write(Rec{ 777, {} }));
+        auto [err, items, num] = reader.read_follow<Rec>(10, 1000000);
+        TEST_CHECK(!err && num == 1 && items[0].seq_ == 777);
+        rebuilt.close();
+        reader.close();
+        if (shm)
+            ::shm_unlink(file.c_str());
+        else
+            ::unlink(file.c_str());
+    }
+    return true;
+}
+
+// 稀疏索引: 键小于前一记录键时返回错误且不入索引, 追加打开后仍以已有最后索引键校验
+static bool TestSparseIndexOutOfOrder() {
+    std::string index = TempFile("mmap_test_index_order.idx");
+    {
+        MMapFile::SparseIndex::Writer writer;
+        TEST_CHECK(!writer.open(index, 2, false));
+        TEST_CHECK(!writer.add(10, 0));
+        TEST_CHECK(!writer.add(20, 8));
+        auto err = writer.add(15, 16);
+        TEST_CHECK(err.code() == MMapFile::error_t::write_fail);
+        TEST_CHECK(!writer.add(20, 24));
+        TEST_CHECK(!writer.add(30, 32));
+    }
+    {
+        MMapFile::SparseIndex::Writer writer;
+        TEST_CHECK(!writer.open(index, 2, true));
+        TEST_CHECK(writer.add(19, 40).code() == MMapFile::error_t::write_fail);
+        TEST_CHECK(!writer.add(25, 40));
+    }
+    MMapFile::SparseIndex::Reader reader;
+    TEST_CHECK(!reader.open(index));
+    TEST_CHECK(reader.size() == 3);
+    reader.close();
+    ::unlink(index.c_str());
+    return true;
+}
+
+// 稀疏索引: 按键区间定位结果与顺序遍历一致, 写入方未关闭时亦可查询; FixBuffer变长记录同样适用
+static bool TestSparseIndexRange() {
+    struct Tick {
+        int64_t ts_;
+        uint64_t seq_;
+    };
+    std::string file = TempFile("mmap_test_index.dat");
+    std::string index = TempFile("mmap_test_index.idx");
+    const uint64_t count = 100000;
+    auto key_of = [](const Tick& tick) { return tick.ts_; };
+    {
+        MMapFile::VectorBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, sizeof(Tick), false));
+        TEST_CHECK(!writer.open_index(index, 64, false));
+        for (uint64_t i = 0; i < count; ++i) {
+            Tick tick{ (int64_t)(i / 3) * 10, i };
+            TEST_CHECK(!writer.write_indexed(tick.ts_, tick));
+        }
+        MMapFile::SparseIndex::Reader index_reader;
+        TEST_CHECK(!index_reader.open(index));
+        MMapFile::VectorBuffer::Reader reader;
+        TEST_CHECK(!reader.open(file, 16));
+        auto [err, items, num] = reader.read_range<Tick>(index_reader, 1000, 1020, key_of);
+        TEST_CHECK(!err && num == 6 && items[0].seq_ == 300);
+        writer.close();
+    }
+    MMapFile::SparseIndex::Reader index_reader;
+    TEST_CHECK(!index_reader.open(index));
+    TEST_CHECK(index_reader.size() > 0);
+    MMapFile::VectorBuffer::Reader reader;
+    TEST_CHECK(!reader.open(file, 16));
+    for (int64_t begin : { -5, 0, 5, 10, 12345, 333320, 333330, 999999 }) {
+        int64_t end = begin + 105;
+        uint64_t first = count, expect = 0;
+        for (uint64_t i = 0; i < count; ++i) {
+            int64_t ts = (int64_t)(i / 3) * 10;
+            if (ts >= begin && ts < end) {
+                if (first == count)
+                    first = i;
+                ++expect;
+            }
+        }
+        auto [err, items, num] = reader.read_range<Tick>(index_reader, begin, end, key_of);
+        TEST_CHECK(!err && num == expect);
+        TEST_CHECK(num == 0 || items[0].seq_ == first);
+    }
+    reader.close();
+    index_reader.close();
+    ::unlink(file.c_str());
+    ::unlink(index.c_str());
+
+    // FixBuffer长度前缀记录
+    {
+        MMapFile::FixBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, 16 << 20, false));
+        TEST_CHECK(!writer.open_index(index, 16, false));
+        for (int64_t i = 0; i < 20000; ++i) {
+            std::string rec = std::string((const char*)&i, sizeof(i)) + std::string(i % 7, 'a');
+            TEST_CHECK(!writer.write_record(i, rec.data(), rec.size()));
+        }
+        writer.finished_write();
+    }
+    MMapFile::FixBuffer::Reader fix_reader;
+    TEST_CHECK(!fix_reader.open(file));
+    TEST_CHECK(!index_reader.open(index));
+    auto record_key = [](std::string_view rec) {
+        int64_t key;
+        memcpy(&key, rec.data(), sizeof(key));
+        return key;
+    };
+    std::vector<int64_t> keys;
+    bool sized = true;
+    fix_reader.for_range(index_reader, 5000, 5010, record_key, [&](std::string_view rec) {
+        int64_t key = record_key(rec);
+        keys.push_back(key);
+        sized = sized && rec.size() == sizeof(key) + (size_t)key % 7;
+        return true;
+    });
+    TEST_CHECK(sized && keys.size() == 10 && keys.front() == 5000 && keys.back() == 5009);
+    fix_reader.close();
+    index_reader.close();
+    ::unlink(file.c_str());
+    ::unlink(index.c_str());
+    return true;
+}
+
+// 读取提示: 任意提示组合下顺序及逆序读取结果不变
+static bool TestReadHints() {
+    std::string file = TempFile("mmap_test_hints.dat");
+    const uint64_t count = 300000;
+    {
+        MMapFile::Appender appender(1 << 20);
+        TEST_CHECK(!appender.open(file, false));
+        for (uint64_t i = 0; i < count; ++i)
+            TEST_CHECK(!appender.write(&i, sizeof(i)));
+    }
+    const unsigned all_hints = MMapFile::hint_sequential | MMapFile::hint_populate | MMapFile::hint_hugepage | MMapFile::hint_dontneed;
+    for (unsigned hints = 0; hints <= all_hints; ++hints) {
+        MMapFile::Reader reader(sizeof(uint64_t));
+        reader.set_hints(hints, 1 << 20);
+        TEST_CHECK(!reader.open(file, 10000));
+        uint64_t next = 0;
+        while (true) {
+            auto [err, items, num] = reader.read<uint64_t>();
+            TEST_CHECK(!err);
+            if (num == 0)
+                break;
+            for (size_t i = 0; i < num; ++i, ++next)
+                TEST_CHECK(items[i] == next);
+        }
+        TEST_CHECK(next == count);
+
+        MMapFile::ReverseReader reverse(sizeof(uint64_t));
+        reverse.set_hints(hints);
+        TEST_CHECK(!reverse.open(file, 7000));
+        uint64_t total = 0;
+        while (true) {
+            auto [err, items, num] = reverse.read<uint64_t>();
+            TEST_CHECK(!err);
+            if (num == 0)
+                break;
+            TEST_CHECK(items[num - 1] == count - 1 - total);
+            total += num;
+        }
+        TEST_CHECK(total == count);
+    }
+    ::unlink(file.c_str());
+
+    {
+        MMapFile::VectorBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, sizeof(uint64_t), false));
+        for (uint64_t i = 0; i < count; ++i)
+            TEST_CHECK(!writer.write(i));
+    }
+    MMapFile::VectorBuffer::Reader reader;
+    reader.set_hints(MMapFile::hint_sequential | MMapFile::hint_dontneed | MMapFile::hint_hugepage);
+    TEST_CHECK(!reader.open(file, 50000));
+    uint64_t next = 0;
+    while (true) {
+        auto [err, items, num] = reader.read<uint64_t>();
+        TEST_CHECK(!err);
+        if (num == 0)
+            break;
+        for (size_t i = 0; i < num; ++i, ++next)
+            TEST_CHECK(items[i] == next);
+    }
+    TEST_CHECK(next == count);
+    reader.close();
+    ::unlink(file.c_str());
+    return true;
+}
+
+// AsyncWriter: 各写出方式及分组提交策略下多线程写入完整且同一线程内有序, O_DIRECT追加未对齐文件, 定时刷新
+static bool TestAsyncWriterModes() {
+    typedef MMapFile::AsyncWriter::sync_t sync_t;
+    struct mode_st {
+        bool direct_;
+        bool uring_;
+        sync_t sync_;
+        uint64_t sync_value_;
+        size_t block_size_;
+        size_t block_count_;
+    } modes[] = {
+        { false, true, sync_t::none, 0, 1 << 20, 2 },
+        { false, false, sync_t::bytes, 1 << 20, 1 << 20, 4 },
+        { true, true, sync_t::interval, 5, 1 << 20, 2 },
+        { true, false, sync_t::none, 0, 64 << 10, 3 },
+    };
+    std::string file = TempFile("mmap_test_async_modes.dat");
+    const int threads = 4;
+    const uint32_t count = 20000;
+    const size_t rec_len = 37;
+    for (auto& mode : modes) {
+        ::unlink(file.c_str());
+        MMapFile::AsyncWriter writer(mode.block_size_, mode.block_count_);
+        writer.set_sync_policy(mode.sync_, mode.sync_value_);
+        TEST_CHECK(!writer.open(file, true, mode.direct_, mode.uring_));
+        std::atomic<int> write_errors{ 0 };
+        std::vector<std::thread> producers;
+        for (int t = 0; t < threads; ++t) {
+            producers.emplace_back([&, t] {
+                // [线程号 u8][序号 u32][填充'x']
+                char rec[rec_len];
+                memset(rec, 'x', rec_len);
+                rec[0] = (char)t;
+                for (uint32_t i = 0; i < count; ++i) {
+                    memcpy(rec + 1, &i, sizeof(i));
+                    if (writer.write(rec, rec_len))
+                        ++write_errors;
+                    if (t == 0 && i == count / 2)
+                        writer.flush(true);
+                }
+            });
+        }
+        for (auto& producer : producers)
+            producer.join();
+        TEST_CHECK(write_errors == 0);
+        TEST_CHECK(!writer.close());
+
+        std::string content = ReadFile(file);
+        TEST_CHECK(content.size() == threads * count * rec_len);
+        uint32_t next[threads] = { 0 };
+        for (size_t offset = 0; offset < content.size(); offset += rec_len) {
+            int t = content[offset];
+            uint32_t seq = 0;
+            memcpy(&seq, &content[offset + 1], sizeof(seq));
+            TEST_CHECK(t >= 0 && t < threads && seq == next[t]);
+            TEST_CHECK(content[offset + rec_len - 1] == 'x');
+            ++next[t];
+        }
+    }
+
+    // O_DIRECT追加至长度未对齐的文件
+    ::unlink(file.c_str());
+    {
+        MMapFile::AsyncWriter writer;
+        TEST_CHECK(!writer.open(file, true, false));
+        TEST_CHECK(!writer.write(std::string_view("hello")));
+        TEST_CHECK(!writer.close());
+    }
+    {
+        MMapFile::AsyncWriter writer;
+        TEST_CHECK(!writer.open(file, false, true));
+        TEST_CHECK(!writer.write(std::string_view(" world")));
+        TEST_CHECK(!writer.flush());
+        // 刷新后零填充已截断, 文件长度即实际长度
+        TEST_CHECK(FileSize(file) == 11 && ReadFile(file) == "hello world");
+        TEST_CHECK(!writer.write(std::string_view("!")));
+        TEST_CHECK(!writer.close());
+    }
+    TEST_CHECK(ReadFile(file) == "hello world!");
+
+    // 未写满块于刷新间隔后写出, 无需关闭
+    ::unlink(file.c_str());
+    {
+        MMapFile::AsyncWriter writer;
+        writer.set_flush_interval(5);
+        TEST_CHECK(!writer.open(file));
+        TEST_CHECK(!writer.write(std::string_view("abc")));
+        for (int i = 0; i < 100 && FileSize(file) != 3; ++i)
+            usleep(10000);
+        TEST_CHECK(FileSize(file) == 3);
+    }
+    ::unlink(file.c_str());
+    return true;
+}
+
+// crc32c(Castagnoli)标准测试向量, 分段计算与整体一致
+static bool TestCrc32c() {
+    TEST_CHECK(MMapFile::Crc32c("123456789", 9) == 0xE3069283);
+    TEST_CHECK(MMapFile::Crc32c("56789", 5, MMapFile::Crc32c("1234", 4)) == 0xE3069283);
+    TEST_CHECK(MMapFile::Crc32c("", 0) == 0);
+    return true;
+}
+
+// FixBuffer写入方异常退出: 均为校验记录时截断至最后一条有效记录, 否则仅丢弃未提交部分
+static bool TestFixBufferRecovery() {
+    std::string file = TempFile("mmap_test_fix_recover.dat");
+    {
+        MMapFile::FixBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, 1 << 20, false));
+        for (int i = 0; i < 100; ++i) {
+            std::string rec = "rec" + std::to_string(i);
+            TEST_CHECK(!writer.write_record(i, rec.data(), rec.size()));
+        }
+        writer.close();
+        TEST_CHECK(!writer.open(file, 1 << 20, true));
+        TEST_CHECK(writer.get_discard_len() == 0);
+    }
+
+    // 子进程追加后损坏最后一条记录, 其后再写入一条记录后退出
+    pid_t pid = fork();
+    if (pid == 0) {
+        MMapFile::FixBuffer::Writer writer;
+        if (writer.open(file, 1 << 20, true))
+            _exit(2);
+        for (int i = 100; i < 200; ++i) {
+            std::string rec = "rec" + std::to_string(i);
+            writer.write_record(i, rec.data(), rec.size());
+        }
+        MMapFile::FixBuffer::Reader reader;
+        if (reader.open(file))
+            _exit(3);
+        int fd = ::open(file.c_str(), O_RDWR);
+        // 当前文件头48字节, 改写最后一条记录的末字节
+        char c = 0x5A;
+        if (pwrite(fd, &c, 1, 48 + reader.get_length() - 1) != 1)
+            _exit(4);
+        ::close(fd);
+        writer.write_record(200, "partial", 7);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    {
+        MMapFile::FixBuffer::Reader reader;
+        TEST_CHECK(!reader.open(file));
+        size_t offset = 0;
+        int count = 0;
+        while (!reader.next_record(offset, true).empty())
+            ++count;
+        // 读取方校验时止于损坏记录
+        TEST_CHECK(count == 199);
+    }
+    {
+        MMapFile::FixBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, 1 << 20, true));
+        // 截断至损坏记录"rec199"处, 其后的"partial"一并丢弃
+        TEST_CHECK(writer.get_discard_len() == 2 * 8 + 6 + 7);
+        TEST_CHECK(!writer.write_record(1000, "after", 5));
+        TEST_CHECK(!writer.sync());
+        writer.finished_write();
+    }
+    {
+        MMapFile::FixBuffer::Reader reader;
+        TEST_CHECK(!reader.open(file));
+        TEST_CHECK(reader.finished());
+        size_t offset = 0;
+        int count = 0;
+        std::string_view last;
+        for (std::string_view rec; !(rec = reader.next_record(offset, true)).empty(); ++count)
+            last = rec;
+        TEST_CHECK(count == 200);
+        TEST_CHECK(last == "after");
+    }
+
+    // 非记录写入, 仅丢弃未提交部分
+    file = TempFile("mmap_test_fix_recover.dat");
+    pid = fork();
+    if (pid == 0) {
+        MMapFile::FixBuffer::Writer writer;
+        if (writer.open(file, 1 << 16, false))
+            _exit(2);
+        writer.write("abcdef", 6);
+        char* data = nullptr;
+        size_t offset = 0;
+        writer.get_data(10, data, offset);
+        _exit(0);
+    }
+    waitpid(pid, &status, 0);
+    TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    {
+        MMapFile::FixBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, 1 << 16, true));
+        TEST_CHECK(writer.get_discard_len() == 10);
+        writer.finished_write();
+    }
+    MMapFile::FixBuffer::Reader reader;
+    TEST_CHECK(!reader.open(file));
+    TEST_CHECK(reader.get_length() == 6);
+    reader.close();
+    ::unlink(file.c_str());
+    return true;
+}
+
+struct ChecksumTick {
+    int64_t key;
+    double  px;
+    char    pad[16];
+};
+
+// VectorBuffer校验文件: 异常退出后自已落盘处逐项校验截断; 已有数据未开启校验时重建校验文件
+static bool TestVectorBufferChecksum() {
+    std::string file = TempFile("mmap_test_vector_crc.dat");
+    std::string crc_file = TempFile("mmap_test_vector_crc.crc");
+    pid_t pid = fork();
+    if (pid == 0) {
+        MMapFile::VectorBuffer::Writer writer;
+        if (writer.open(file, sizeof(ChecksumTick), false, 4096, 4096) || writer.open_checksum(crc_file))
+            _exit(2);
+        for (int i = 0; i < 1000; ++i) {
+            if (writer.write(ChecksumTick{ i, i * 0.5, {} }))
+                _exit(3);
+        }
+        if (writer.sync())
+            _exit(4);
+        for (int i = 1000; i < 1200; ++i)
+            writer.write(ChecksumTick{ i, i * 0.5, {} });
+        // 模拟未落盘数据损坏: 第1100个子项, 当前文件头56字节
+        int fd = ::open(file.c_str(), O_RDWR);
+        ChecksumTick bad{ -1, 0, {} };
+        if (pwrite(fd, &bad, sizeof(bad), 56 + 1100 * sizeof(ChecksumTick)) != (ssize_t)sizeof(bad))
+            _exit(5);
+        ::close(fd);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    {
+        MMapFile::VectorBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, sizeof(ChecksumTick), true, 4096, 4096));
+        TEST_CHECK(!writer.open_checksum(crc_file));
+        TEST_CHECK(writer.get_discard_len() == 100 * sizeof(ChecksumTick));
+        TEST_CHECK(!writer.write(ChecksumTick{ 1100, 1, {} }));
+        TEST_CHECK(writer.write("x", 1));
+    }
+    {
+        MMapFile::VectorBuffer::Reader reader;
+        TEST_CHECK(!reader.open(file, 1024 * 1024));
+        TEST_CHECK(reader.get_obj_num() == 1101);
+        auto [err, items, count] = reader.read<ChecksumTick>();
+        TEST_CHECK(!err && count == 1101);
+        TEST_CHECK(items[1099].key == 1099 && items[1100].key == 1100 && items[1100].px == 1);
+    }
+
+    // 已有数据后开启校验, 校验文件补齐已有子项
+    file = TempFile("mmap_test_vector_crc.dat");
+    crc_file = TempFile("mmap_test_vector_crc.crc");
+    {
+        MMapFile::VectorBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, sizeof(ChecksumTick), false));
+        for (int i = 0; i < 50; ++i)
+            TEST_CHECK(!writer.write(ChecksumTick{ i, 0, {} }));
+        TEST_CHECK(!writer.open_checksum(crc_file));
+        for (int i = 50; i < 60; ++i)
+            TEST_CHECK(!writer.write(ChecksumTick{ i, 0, {} }));
+    }
+    MMapFile::VectorBuffer::Reader reader;
+    TEST_CHECK(!reader.open(crc_file, 4096));
+    TEST_CHECK(reader.get_obj_num() == 60);
+    auto [err, crcs, count] = reader.read<uint32_t>();
+    ChecksumTick tick{ 55, 0, {} };
+    TEST_CHECK(!err && count == 60 && crcs[55] == MMapFile::Crc32c(&tick, sizeof(tick)));
+    reader.close();
+    ::unlink(file.c_str());
+    ::unlink(crc_file.c_str());
+    return true;
+}
+
+#pragma pack(push, 1)
+struct BlockTick {
+    int64_t ts_;
+    double price_;
+    int32_t volume_;
+    char symbol_[12];
+};
+#pragma pack(pop)
+
+static BlockTick MakeBlockTick(size_t i) {
+    BlockTick tick;
+    tick.ts_ = 1700000000000000000ll + i * 1000 + i % 7;
+    tick.price_ = 100.0 + (i % 50) * 0.01;
+    tick.volume_ = (int32_t)(i % 100);
+    memcpy(tick.symbol_, "600000.SH\0\0\0", sizeof(tick.symbol_));
+    return tick;
+}
+
+// 按块读取及逐条读取均与写入内容一致
+static bool VerifyBlockFile(const std::string& file, size_t count, unsigned threads, size_t chunk_size) {
+    MMapFile::BlockBuffer::Reader reader(threads);
+    TEST_CHECK(!reader.open(file, chunk_size));
+    TEST_CHECK((size_t)reader.get_obj_num() == count);
+    size_t index = 0;
+    while (true) {
+        auto [err, items, num] = reader.read<BlockTick>();
+        TEST_CHECK(!err);
+        if (num == 0)
+            break;
+        for (size_t i = 0; i < num; ++i, ++index) {
+            BlockTick expect = MakeBlockTick(index);
+            TEST_CHECK(memcmp(&items[i], &expect, sizeof(expect)) == 0);
+        }
+    }
+    TEST_CHECK(index == count);
+
+    MMapFile::BlockBuffer::Reader next_reader(threads);
+    TEST_CHECK(!next_reader.open(file, chunk_size));
+    for (index = 0;; ++index) {
+        auto [err, tick] = next_reader.read_next<BlockTick>();
+        TEST_CHECK(!err);
+        if (!tick)
+            break;
+        TEST_CHECK(tick->ts_ == MakeBlockTick(index).ts_);
+    }
+    TEST_CHECK(index == count);
+    return true;
+}
+
+// BlockBuffer: 各压缩算法及列变换读写一致, 追加打开, 异常退出后仅保留已封闭块, 损坏块截断或报告decode_fail
+static bool TestBlockBuffer() {
+    typedef MMapFile::BlockBuffer BlockBuffer;
+    std::string file = TempFile("mmap_test_block_codec.dat");
+    const size_t count = 20000;
+    const size_t block_records = 1000;
+    for (auto codec : { BlockBuffer::codec_t::none, BlockBuffer::codec_t::lz4, BlockBuffer::codec_t::zstd }) {
+        if (!BlockBuffer::Supported(codec))
+            continue;
+        for (int transform = 0; transform < 2; ++transform) {
+            ::unlink(file.c_str());
+            {
+                BlockBuffer::Writer writer;
+                TEST_CHECK(!writer.open(file, sizeof(BlockTick), codec, false, block_records));
+                if (transform) {
+                    TEST_CHECK(!writer.add_column(BlockBuffer::transform_t::delta, 0, 8));
+                    TEST_CHECK(!writer.add_column(BlockBuffer::transform_t::xor_prev, 8, 8));
+                }
+                else {
+                    TEST_CHECK(!writer.set_shuffle(false));
+                }
+                for (size_t i = 0; i < count / 2; ++i)
+                    TEST_CHECK(!writer.write(MakeBlockTick(i)));
+                // 提前封闭不满块
+                TEST_CHECK(!writer.flush());
+                std::vector<BlockTick> batch;
+                for (size_t i = count / 2; i < count; ++i)
+                    batch.push_back(MakeBlockTick(i));
+                TEST_CHECK(!writer.write((const char*)batch.data(), batch.size() * sizeof(BlockTick)));
+                // 非整条记录及写入后再增加列变换均失败
+                TEST_CHECK(writer.write("x", 1));
+                TEST_CHECK(writer.add_column(BlockBuffer::transform_t::delta, 0, 8));
+                TEST_CHECK(writer.get_record_count() == count);
+            }
+            for (unsigned threads : { 1u, 4u }) {
+                for (size_t chunk_size : { 700ul, 50000ul }) {
+                    if (!VerifyBlockFile(file, count, threads, chunk_size))
+                        return false;
+                }
+            }
+        }
+    }
+
+    // 追加, 记录长度不一致时拒绝
+    {
+        BlockBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, sizeof(BlockTick), BlockBuffer::codec_t::none, true, block_records));
+        TEST_CHECK(writer.get_record_count() == count);
+        for (size_t i = count; i < count + 500; ++i)
+            TEST_CHECK(!writer.write(MakeBlockTick(i)));
+    }
+    {
+        BlockBuffer::Writer writer;
+        auto err = writer.open(file, 8, BlockBuffer::codec_t::none, true, block_records);
+        TEST_CHECK(err && err.code() == MMapFile::error_t::unsupported);
+    }
+    TEST_CHECK(VerifyBlockFile(file, count + 500, 3, 10000));
+
+    // 异常退出: 无块索引, 写入中的块不计入
+    pid_t pid = fork();
+    if (pid == 0) {
+        BlockBuffer::Writer writer;
+        if (writer.open(file, sizeof(BlockTick), BlockBuffer::codec_t::none, true, block_records))
+            _exit(2);
+        for (size_t i = count + 500; i < count + 3800; ++i)
+            writer.write(MakeBlockTick(i));
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    // 追加前最后一块不满(500条), 其后写入的3300条封闭3块
+    size_t committed = count + 500 + 3 * block_records;
+    TEST_CHECK(VerifyBlockFile(file, committed, 2, 7000));
+
+    // 损坏最后一块: 读取方不计入, 写入方追加打开时截断
+    {
+        int fd = ::open(file.c_str(), O_RDWR);
+        TEST_CHECK(fd >= 0);
+        char c = 0x11;
+        TEST_CHECK(pwrite(fd, &c, 1, FileSize(file) - 10) == 1);
+        ::close(fd);
+        BlockBuffer::Reader reader(1);
+        TEST_CHECK(!reader.open(file, 1000000));
+        TEST_CHECK((size_t)reader.get_obj_num() == committed - block_records);
+        reader.close();
+        BlockBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, sizeof(BlockTick), BlockBuffer::codec_t::none, true, block_records));
+        TEST_CHECK(writer.get_record_count() == committed - block_records);
+    }
+    TEST_CHECK(VerifyBlockFile(file, committed - block_records, 2, 7000));
+
+    // 存在块索引时由读取时校验发现损坏
+    {
+        int fd = ::open(file.c_str(), O_RDWR);
+        TEST_CHECK(fd >= 0);
+        char c = 0x11;
+        TEST_CHECK(pwrite(fd, &c, 1, 200) == 1);
+        ::close(fd);
+        BlockBuffer::Reader reader(4);
+        TEST_CHECK(!reader.open(file, 100000));
+        auto [err, data] = reader.read();
+        TEST_CHECK(err && err.code() == MMapFile::error_t::decode_fail);
+    }
+    ::unlink(file.c_str());
+    return true;
+}
+
+// 供scan使用的最简线程池, 未启动时add_task返回false
+class ScanTaskPool {
+public:
+    ~ScanTaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto& thread : m_threads)
+            thread.join();
+    }
+
+    void start(size_t thread_num) {
+        for (size_t i = 0; i < thread_num; ++i)
+            m_threads.emplace_back([this] { run(); });
+    }
+
+    template<typename TFunction>
+    bool add_task(TFunction&& func) {
+        if (m_threads.empty())
+            return false;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_tasks.emplace_back(std::forward<TFunction>(func));
+        }
+        m_cv.notify_one();
+        return true;
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        while (true) {
+            m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+            if (m_tasks.empty())
+                return;
+            auto task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+private:
+    std::mutex                          m_mtx;
+    std::condition_variable             m_cv;
+    std::deque<std::function<void()>>   m_tasks;
+    std::vector<std::thread>            m_threads;
+    bool                                m_stop = false;
+};
+
+// 并行分区扫描: 按区间顺序合并结果覆盖全部子项且不影响读取游标; 线程池拒绝任务时于调用线程执行
+static bool TestParallelScan() {
+    struct Rec {
+        uint64_t seq_;
+        uint64_t value_;
+    };
+    struct part_st {
+        uint64_t first_ = UINT64_MAX;
+        uint64_t last_ = 0;
+        uint64_t count_ = 0;
+        uint64_t sum_ = 0;
+        bool contiguous_ = true;
+    };
+    auto accumulate = [](size_t, part_st& part, std::string_view chunk) {
+        const Rec* recs = (const Rec*)chunk.data();
+        for (size_t i = 0; i < chunk.size() / sizeof(Rec); ++i) {
+            if (part.count_ == 0)
+                part.first_ = recs[i].seq_;
+            else if (recs[i].seq_ != part.last_ + 1)
+                part.contiguous_ = false;
+            part.last_ = recs[i].seq_;
+            part.sum_ += recs[i].value_;
+            ++part.count_;
+        }
+        return true;
+    };
+    const uint64_t count = 100003;
+    const uint64_t total = 3ull * count * (count - 1) / 2;
+    std::string file = TempFile("mmap_test_scan.dat");
+    {
+        MMapFile::Appender appender;
+        TEST_CHECK(!appender.open(file, false));
+        for (uint64_t i = 0; i < count; ++i) {
+            Rec rec{ i, i * 3 };
+            TEST_CHECK(!appender.write(&rec, sizeof(rec)));
+        }
+    }
+    for (bool started : { true, false }) {
+        ScanTaskPool pool;
+        if (started)
+            pool.start(4);
+        MMapFile::Reader reader(sizeof(Rec));
+        TEST_CHECK(!reader.open(file, 1000));
+        size_t merged = 0;
+        uint64_t next = 0, sum = 0;
+        bool ordered = true;
+        TEST_CHECK(!reader.scan<part_st>(pool, 7, accumulate, [&](size_t partition, part_st&& part) {
+            ordered = ordered && partition == merged++ && part.contiguous_ && part.first_ == next;
+            next = part.last_ + 1;
+            sum += part.sum_;
+        }));
+        TEST_CHECK(ordered && merged == 7 && next == count && sum == total);
+        auto [err, items, num] = reader.read<Rec>();
+        TEST_CHECK(!err && num == 1000 && items[999].seq_ == 999);
+        // 无合并, 各区间首块后结束
+        std::atomic<size_t> chunks{ 0 };
+        TEST_CHECK(!reader.scan(pool, 3, [&](size_t, std::string_view) { ++chunks; return false; }));
+        TEST_CHECK(chunks == 3);
+    }
+    ::unlink(file.c_str());
+
+    ScanTaskPool pool;
+    pool.start(4);
+    {
+        MMapFile::VectorBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, sizeof(Rec), false));
+        for (uint64_t i = 0; i < count; ++i)
+            TEST_CHECK(!writer.write(Rec{ i, i * 3 }));
+    }
+    {
+        MMapFile::VectorBuffer::Reader reader;
+        TEST_CHECK(!reader.open(file, 4096));
+        uint64_t sum = 0;
+        TEST_CHECK(!reader.scan<part_st>(pool, 0, accumulate, [&](size_t, part_st&& part) { sum += part.sum_; }));
+        TEST_CHECK(sum == total);
+    }
+    ::unlink(file.c_str());
+
+    {
+        MMapFile::BlockBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, sizeof(Rec), MMapFile::BlockBuffer::codec_t::none, false, 1000));
+        TEST_CHECK(!writer.add_column(MMapFile::BlockBuffer::transform_t::delta, 0, 8));
+        for (uint64_t i = 0; i < count; ++i)
+            TEST_CHECK(!writer.write(Rec{ i, i * 3 }));
+    }
+    {
+        MMapFile::BlockBuffer::Reader reader(1);
+        TEST_CHECK(!reader.open(file, 1000));
+        size_t merged = 0;
+        uint64_t next = 0, sum = 0;
+        bool ordered = true;
+        TEST_CHECK(!reader.scan<part_st>(pool, 16, accumulate, [&](size_t, part_st&& part) {
+            ordered = ordered && part.contiguous_ && part.first_ == next;
+            next = part.last_ + 1;
+            sum += part.sum_;
+            ++merged;
+        }));
+        TEST_CHECK(ordered && merged == 16 && next == count && sum == total);
+    }
+    ::unlink(file.c_str());
+
+    // 空文件仍合并一次
+    {
+        MMapFile::VectorBuffer::Writer writer;
+        TEST_CHECK(!writer.open(file, sizeof(Rec), false));
+    }
+    {
+        MMapFile::VectorBuffer::Reader reader;
+        TEST_CHECK(!reader.open(file, 10));
+        size_t calls = 0, merges = 0;
+        TEST_CHECK(!reader.scan<int>(pool, 4, [&](size_t, int&, std::string_view) { ++calls; return true; }, [&](size_t, int&&) { ++merges; }));
+        TEST_CHECK(calls == 0 && merges == 1);
+    }
+    ::unlink(file.c_str());
+    return true;
+}
+
+// ShmReaderWriter快照: 跨进程写入时读取方不会读到撕裂的快照且版本单调, 越界及只读方写入失败
+static bool TestShmSnapshots() {
+    struct Quote {
+        uint64_t a_, b_, c_, d_, e_;
+    };
+    static_assert(sizeof(MMapFile::SeqlockSlot<Quote>) == 64, "SeqlockSlot<Quote> should fit one cache line");
+    const size_t slots = 8;
+    const uint64_t rounds = 20000;
+    const char* title = "/mmap_test_snapshot";
+    ::shm_unlink(title);
+    MMapFile::ShmReaderWriter writer(MMapFile::ShmReaderWriter::READER_WRITER, true);
+    TEST_CHECK(writer.init(title, true, sizeof(MMapFile::SeqlockSlot<Quote>) * slots, 0));
+    TEST_CHECK(writer.snapshot_count<Quote>() == slots);
+    Quote quote{};
+    TEST_CHECK(writer.read_snapshot(0, quote) && quote.a_ == 0);
+    TEST_CHECK(!writer.write_snapshot(slots, quote));
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (uint64_t i = 1; i <= rounds; ++i) {
+            for (size_t k = 0; k < slots; ++k)
+                writer.write_snapshot(k, Quote{ i, i, i, i, i + k });
+        }
+        _exit(0);
+    }
+    MMapFile::ShmReaderWriter reader(MMapFile::ShmReaderWriter::READER, false);
+    TEST_CHECK(reader.init(title));
+    TEST_CHECK(!reader.write_snapshot(0, quote));
+    uint64_t last[slots] = { 0 };
+    bool consistent = true, done = false;
+    while (consistent && !done) {
+        Quote quotes[slots];
+        TEST_CHECK(reader.read_snapshots(0, quotes, slots) == slots);
+        done = true;
+        for (size_t k = 0; k < slots; ++k) {
+            const Quote& q = quotes[k];
+            consistent = consistent && q.a_ == q.b_ && q.b_ == q.c_ && q.c_ == q.d_ && q.e_ == (q.a_ ? q.a_ + k : 0) && q.a_ >= last[k];
+            last[k] = q.a_;
+            done = done && q.a_ == rounds;
+        }
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    TEST_CHECK(consistent);
+    TEST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    TEST_CHECK(reader.snapshot_version<Quote>(3) == rounds);
+    Quote tail[5];
+    TEST_CHECK(reader.read_snapshots(slots - 2, tail, 5) == 2);
+    TEST_CHECK(reader.read_snapshots(slots, tail, 5) == 0);
+    writer.unlink();
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1)
+        g_dir = argv[1];
+
+    bool (*cases[])() = {
+        TestAsyncWriterReopen,
+        TestVectorBufferLegacy,
+        TestFixBufferLegacy,
+        TestBlockBufferDefaultCodec,
+        TestSeqlockAbandonedWrite,
+        TestAppender,
+        TestRingBuffer,
+        TestRingBufferAbandoned,
+        TestVectorBufferFollow,
+        TestSparseIndexRange,
+        TestSparseIndexOutOfOrder,
+        TestReadHints,
+        TestAsyncWriterModes,
+        TestCrc32c,
+        TestFixBufferRecovery,
+        TestVectorBufferChecksum,
+        TestBlockBuffer,
+        TestParallelScan,
+        TestShmSnapshots,
+    };
+    int failed = 0;
+    for (auto test_case : cases) {
+        if (!test_case())
+            ++failed;
+    }
+    std::cout << (failed == 0 ? "all passed" : "failed") << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,745 @@
+// 网络层功能自检, 各用例依次执行, 失败时输出用例名及原因并返回非0
+// 覆盖聚合发送, 无锁发送队列及多线程写入保序, 分帧解析及环形读缓存, asio与io_uring后端, 忙轮询, 共享内存通道及tcp回落
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <algorithm>
+#include "boost_net/tcp_backend.hpp"
+#include "boost_net/shm_server.hpp"
+#include "boost_net/shm_session.hpp"
+
+using namespace BTool;
+using namespace BTool::BoostNet;
+
+#define TEST_CHECK(cond) do { if (!(cond)) { std::cout << __FUNCTION__ << " failed at line " << __LINE__ << ": " #cond << std::endl; return false; } } while (0)
+
+typedef std::chrono::steady_clock steady_clock;
+
+static unsigned short NextPort() {
+    static unsigned short port = 46300;
+    return port++;
+}
+
+// 等待条件成立, 超时返回false
+template<typename TPred>
+static bool WaitFor(TPred&& pred, long long timeout_ms = 5000) {
+    auto deadline = steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!pred()) {
+        if (steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// 定长测试记录, 经字节流传输后按整条解析
+struct record_st {
+    uint32_t    producer_;
+    uint32_t    seq_;
+    char        pad_[8];
+};
+
+// 接收端: 按整条记录解析字节流, 校验各生产者的序号连续递增
+class RecordSink {
+public:
+    RecordSink(size_t producers) : m_next(producers, 0), m_count(0), m_bad(0) {}
+
+    // 返回已解析的字节数, 不足一条的剩余部分留待下次
+    size_t feed(const char* data, size_t len) {
+        size_t used = 0;
+        std::lock_guard<std::mutex> lock(m_mtx);
+        for (; len - used >= sizeof(record_st); used += sizeof(record_st)) {
+            record_st rec;
+            memcpy(&rec, data + used, sizeof(rec));
+            if (rec.producer_ >= m_next.size() || rec.seq_ != m_next[rec.producer_])
+                ++m_bad;
+            else
+                ++m_next[rec.producer_];
+            ++m_count;
+        }
+        return used;
+    }
+
+    size_t count() const { return m_count.load(); }
+    size_t bad() const { return m_bad.load(); }
+
+private:
+    std::mutex              m_mtx;
+    std::vector<uint32_t>   m_next;
+    std::atomic<size_t>     m_count;
+    std::atomic<size_t>     m_bad;
+};
+
+// 启动回环服务, 读取的数据交由sink解析
+static bool StartSink(TcpServer& server, RecordSink& sink, unsigned short port) {
+    server.register_read_cbk([&server, &sink](const NetCallBack::SessionID& session_id, const char* msg, size_t len) {
+        server.consume_read_buf(session_id, sink.feed(msg, len));
+    });
+    return server.start("127.0.0.1", port);
+}
+
+// 连接并等待开启
+static bool OpenSession(const std::shared_ptr<TcpSession>& session, unsigned short port) {
+    std::atomic<bool> opened{ false };
+    session->register_open_cbk([&opened](const NetCallBack::SessionID&) { opened = true; });
+    session->connect("127.0.0.1", port);
+    bool rslt = WaitFor([&] { return opened.load(); });
+    session->register_open_cbk(nullptr);
+    return rslt;
+}
+
+// 聚合发送: 发送中入队的消息于完成后合并发出, 每批不超过设定条数, 字节流顺序不变
+static bool TestGatherWrite() {
+    const uint32_t count = 10000;
+    for (size_t max_count : { (size_t)1, (size_t)4, (size_t)TcpSession::MAX_GATHER_WRITE_COUNT }) {
+        unsigned short port = NextPort();
+        AsioContextPool pool(1);
+        TcpServer server(pool);
+        RecordSink sink(1);
+        TEST_CHECK(StartSink(server, sink, port));
+        auto session = std::make_shared<TcpSession>(pool.get_io_context());
+        session->set_gather_limit(max_count, TcpSession::MAX_GATHER_WRITE_SIZE);
+        TEST_CHECK(OpenSession(session, port));
+
+        for (uint32_t i = 0; i < count; ++i) {
+            record_st rec{ 0, i, {} };
+            TEST_CHECK(session->write((const char*)&rec, sizeof(rec)));
+        }
+        TEST_CHECK(WaitFor([&] { return sink.count() == count; }));
+        TEST_CHECK(sink.bad() == 0);
+        TEST_CHECK(WaitFor([&] { return session->get_write_stats().send_msgs == count; }));
+
+        auto stats = session->get_write_stats();
+        TEST_CHECK(stats.send_bytes == count * sizeof(record_st));
+        TEST_CHECK(stats.send_batchs >= (count + max_count - 1) / max_count);
+        if (max_count == 1)
+            TEST_CHECK(stats.send_batchs == count);
+        else
+            TEST_CHECK(stats.send_batchs < count && stats.calls_per_msg() < 1);
+
+        session->shutdown();
+        session.reset();
+        server.stop();
+    }
+    return true;
+}
+
+// 无锁发送缓存: 多生产者并发入队, 单消费者批量取出, 同一生产者的消息保持入队顺序, 节点归还后复用
+static bool TestConcurrentWriteBuffer() {
+    typedef ConcurrentWriteBuffer<64> BufferType;
+    const uint32_t producers = 4;
+    const uint32_t count = 20000;
+    BufferType buf(16);
+    RecordSink sink(producers);
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&buf, p]() {
+            for (uint32_t i = 0; i < count; ++i) {
+                record_st rec{ p, i, {} };
+                buf.append((const char*)&rec, sizeof(rec));
+            }
+        });
+    }
+
+    std::vector<BufferType::WriteMemoryStreamPtr> items;
+    size_t max_batch = 0;
+    auto start = steady_clock::now();
+    while (sink.count() < producers * count && steady_clock::now() - start < std::chrono::seconds(10)) {
+        size_t bytes = buf.pop_front(items, 32, 1 << 20);
+        size_t total = 0;
+        for (auto& item : items) {
+            total += item->size();
+            sink.feed(item->data(), item->size());
+        }
+        TEST_CHECK(bytes == total);
+        max_batch = std::max(max_batch, items.size());
+        buf.release(items);
+        TEST_CHECK(items.empty());
+    }
+    for (auto& thread : threads)
+        thread.join();
+    TEST_CHECK(sink.count() == producers * count && sink.bad() == 0);
+    TEST_CHECK(max_batch <= 32);
+    TEST_CHECK(buf.empty() && buf.size() == 0);
+
+    // 超出单次字节上限的消息暂存, 留待下次作为首条取出
+    std::string big(100, 'b');
+    TEST_CHECK(buf.append("a", 1) && buf.append(big.data(), big.size()) && buf.append("c", 1));
+    TEST_CHECK(buf.pop_front(items, 8, 10) == 1 && items.size() == 1);
+    buf.release(items);
+    TEST_CHECK(!buf.empty());
+    TEST_CHECK(buf.pop_front(items, 8, 10) == 100 && items.size() == 1);
+    buf.release(items);
+    TEST_CHECK(buf.pop_front(items, 8, 10) == 1 && std::string(items[0]->data(), 1) == "c");
+    buf.release(items);
+    TEST_CHECK(buf.empty());
+
+    // append_tail并入前一条消息, 达到包长上限时另起一条
+    TEST_CHECK(buf.append("ab", 2) && buf.append_tail("cd", 2) && buf.append_tail("ef", 2, 6));
+    auto merged = buf.pop_front_merged();
+    TEST_CHECK(merged && std::string(merged->data(), merged->size()) == "abcd");
+    buf.release(merged);
+    merged = buf.pop_front_merged();
+    TEST_CHECK(merged && std::string(merged->data(), merged->size()) == "ef");
+    buf.release(merged);
+    TEST_CHECK(buf.empty());
+    return true;
+}
+
+// 多线程同时写入同一连接, 各线程的消息按各自写入顺序到达, 无丢失
+static bool TestConcurrentWrite() {
+    const uint32_t producers = 4;
+    const uint32_t count = 20000;
+    unsigned short port = NextPort();
+    AsioContextPool pool(2);
+    TcpServer server(pool);
+    RecordSink sink(producers);
+    TEST_CHECK(StartSink(server, sink, port));
+    auto session = std::make_shared<TcpSession>(pool.get_io_context());
+    TEST_CHECK(OpenSession(session, port));
+
+    std::atomic<size_t> failed{ 0 };
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (uint32_t i = 0; i < count; ++i) {
+                record_st rec{ p, i, {} };
+                if (!session->write((const char*)&rec, sizeof(rec)))
+                    ++failed;
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    TEST_CHECK(failed == 0);
+    TEST_CHECK(WaitFor([&] { return sink.count() == producers * count; }));
+    TEST_CHECK(sink.bad() == 0);
+    TEST_CHECK(WaitFor([&] { return session->get_write_stats().send_msgs == producers * count; }));
+
+    session->shutdown();
+    session.reset();
+    server.stop();
+    return true;
+}
+
+// 长度前缀分帧: 数据不足时等待, 完整时返回整帧长度, 长度非法时返回负值
+static bool TestLengthFrameDecoder() {
+    std::string_view body;
+    std::string frame("\x05\x00\x00\x00hello\x02\x00\x00\x00hi", 15);
+    LengthFrameDecoder<uint32_t> decoder;
+    TEST_CHECK(decoder(frame.data(), 3, body) == 0);
+    TEST_CHECK(decoder(frame.data(), 8, body) == 0);
+    TEST_CHECK(decoder(frame.data(), frame.size(), body) == 9 && body == "hello");
+    TEST_CHECK(decoder(frame.data() + 9, 6, body) == 6 && body == "hi");
+
+    // 网络字节序及长度含帧头
+    std::string big("\x00\x07" "abcde", 7);
+    TEST_CHECK(LengthFrameDecoder<uint16_t>(0, true, true)(big.data(), big.size(), body) == 7 && body == "abcde");
+    TEST_CHECK(LengthFrameDecoder<uint16_t>(0, true, true)(big.data(), 6, body) == 0);
+    std::string short_head("\x00\x01", 2);
+    TEST_CHECK(LengthFrameDecoder<uint16_t>(0, true, true)(short_head.data(), short_head.size(), body) < 0);
+
+    // 超出帧体上限时无需等待完整帧即判定非法
+    TEST_CHECK(LengthFrameDecoder<uint32_t>(4)(frame.data(), 4, body) < 0);
+    TEST_CHECK(LengthFrameDecoder<uint32_t>(5)(frame.data(), frame.size(), body) == 9);
+    return true;
+}
+
+// 可复位的自定义解析器, 记录复位次数
+struct counting_decoder {
+    int* resets_;
+    long long operator()(const char* data, size_t len, std::string_view& body) {
+        if (len == 0)
+            return 0;
+        body = std::string_view(data, 1);
+        return 1;
+    }
+    void reset() { ++*resets_; }
+};
+
+// 分隔符分帧: 增量查找不重复扫描, 复位后自头查找, 超长视为非法
+static bool TestDelimiterFrameDecoder() {
+    std::string_view body;
+    DelimiterFrameDecoder decoder("\r\n");
+    std::string data = "abc\r";
+    TEST_CHECK(decoder(data.data(), data.size(), body) == 0);
+    data += "\ndef";
+    TEST_CHECK(decoder(data.data(), data.size(), body) == 5 && body == "abc");
+    data.erase(0, 5);
+    TEST_CHECK(decoder(data.data(), data.size(), body) == 0);
+    data += "\r\n";
+    TEST_CHECK(decoder(data.data(), data.size(), body) == 5 && body == "def");
+
+    // 未完成帧被丢弃(如连接重开)后, 新数据即使更长也须自头查找
+    FrameDecoder frame_decoder = MakeFrameDecoder(DelimiterFrameDecoder("\n"));
+    std::string partial(16, 'x');
+    TEST_CHECK(frame_decoder(partial.data(), partial.size(), body) == 0);
+    ResetFrameDecoder(frame_decoder);
+    std::string fresh = "ok\n" + std::string(20, 'y');
+    TEST_CHECK(frame_decoder(fresh.data(), fresh.size(), body) == 3 && body == "ok");
+    // 数据未增长时同样视为缓存已重置
+    TEST_CHECK(frame_decoder(partial.data(), partial.size(), body) == 0);
+    TEST_CHECK(frame_decoder(fresh.data(), 3, body) == 3 && body == "ok");
+
+    // 帧体上限
+    DelimiterFrameDecoder limited("\n", 4);
+    TEST_CHECK(limited("abcd\n", 5, body) == 5 && body == "abcd");
+    TEST_CHECK(limited("abcdef", 6, body) < 0);
+    TEST_CHECK(DelimiterFrameDecoder("")("a\n", 2, body) < 0);
+
+    // 自定义解析器经MakeFrameDecoder包装后可复位, 副本状态相互独立
+    int resets = 0;
+    FrameDecoder custom = MakeFrameDecoder(counting_decoder{ &resets });
+    FrameDecoder copy = custom;
+    ResetFrameDecoder(custom);
+    ResetFrameDecoder(copy);
+    TEST_CHECK(resets == 2);
+    TEST_CHECK(custom("z", 1, body) == 1 && body == "z");
+    return true;
+}
+
+// 环形读缓存: 跨越环尾的数据依旧连续可读, 容量按页取整且不扩容
+static bool TestMirrorReadBuffer() {
+    MirrorReadBuffer buf(100);
+    size_t capacity = buf.capacity();
+    TEST_CHECK(capacity >= 100 && capacity % 4096 == 0);
+    TEST_CHECK(buf.free_size() == capacity && buf.size() == 0);
+
+    // 写入后消费大部分, 使后续写入跨越环尾
+    size_t first = capacity - 10;
+    auto out = buf.prepare(first);
+    TEST_CHECK(out.size() == first);
+    memset(out.data(), 'a', first);
+    buf.commit(first);
+    buf.consume(first - 5);
+    TEST_CHECK(buf.size() == 5);
+
+    std::string pattern;
+    for (size_t i = 0; pattern.size() < 100; ++i)
+        pattern += std::to_string(i);
+    pattern.resize(100);
+    size_t written = 0;
+    while (written < pattern.size()) {
+        out = buf.prepare(pattern.size() - written);
+        TEST_CHECK(out.size() > 0);
+        memcpy(out.data(), pattern.data() + written, out.size());
+        buf.commit(out.size());
+        written += out.size();
+    }
+    TEST_CHECK(buf.size() == 105);
+    TEST_CHECK(std::string(buf.peek(), 5) == "aaaaa");
+    TEST_CHECK(std::string(buf.peek() + 5, 100) == pattern);
+    buf.consume(5);
+    TEST_CHECK(std::string(buf.peek(), buf.size()) == pattern);
+
+    // 写满后不再提供可写空间
+    out = buf.prepare(capacity);
+    TEST_CHECK(out.size() == buf.free_size());
+    buf.commit(capacity * 2);
+    TEST_CHECK(buf.free_size() == 0 && buf.prepare(1).size() == 0);
+    buf.consume(capacity);
+    TEST_CHECK(buf.size() == 0 && buf.free_size() == capacity);
+    return true;
+}
+
+// 分帧读取: 读缓存远小于总数据量, 帧在环尾处被截断后依旧整帧回调
+static bool TestFrameSession() {
+    const uint32_t count = 3000;
+    unsigned short port = NextPort();
+    AsioContextPool pool(1);
+    TcpServer server(pool);
+    std::atomic<uint32_t> received{ 0 }, bad{ 0 };
+    server.register_frame_cbk(LengthFrameDecoder<uint32_t>(4096), [&](const NetCallBack::SessionID&, std::string_view frame) {
+        uint32_t seq = received.load();
+        if (frame.size() != 1 + seq % 1000 || frame.find_first_not_of(char('a' + seq % 26)) != std::string_view::npos)
+            ++bad;
+        ++received;
+    });
+    TEST_CHECK(server.start("127.0.0.1", port));
+    auto session = std::make_shared<TcpSession>(pool.get_io_context());
+    TEST_CHECK(OpenSession(session, port));
+
+    std::string frame;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t len = 1 + i % 1000;
+        frame.assign((const char*)&len, sizeof(len));
+        frame.append(len, char('a' + i % 26));
+        TEST_CHECK(session->write(frame.data(), frame.size()));
+    }
+    TEST_CHECK(WaitFor([&] { return received.load() == count; }));
+    TEST_CHECK(bad == 0);
+
+    session->shutdown();
+    session.reset();
+    server.stop();
+    return true;
+}
+
+// 以Backend收发分帧消息: 服务端原样回显, 客户端校验回显内容及顺序
+template<typename Backend, typename ClientPool = typename Backend::context_pool_type>
+static bool EchoRoundTrip(typename Backend::context_pool_type& server_pool, ClientPool& client_pool, unsigned short port, NetCallBack::SessionID* session_id = nullptr) {
+    typedef typename Backend::session_type session_type;
+    const uint32_t count = 2000;
+    typename Backend::server_type server(server_pool);
+    server.register_frame_cbk(LengthFrameDecoder<uint32_t>(), [&server](const NetCallBack::SessionID& id, std::string_view frame) {
+        uint32_t len = (uint32_t)frame.size();
+        std::string reply((const char*)&len, sizeof(len));
+        reply.append(frame.data(), frame.size());
+        server.write(id, reply.data(), reply.size());
+    });
+    TEST_CHECK(server.start("127.0.0.1", port));
+
+    std::atomic<uint32_t> received{ 0 }, bad{ 0 };
+    std::atomic<bool> opened{ false };
+    auto session = std::make_shared<session_type>(client_pool.get_io_context());
+    session->register_open_cbk([&opened](const NetCallBack::SessionID&) { opened = true; });
+    session->register_frame_cbk(LengthFrameDecoder<uint32_t>(), [&](const NetCallBack::SessionID&, std::string_view frame) {
+        uint32_t seq = received.load();
+        if (frame.size() != sizeof(seq) + seq % 64 || memcmp(frame.data(), &seq, sizeof(seq)) != 0)
+            ++bad;
+        ++received;
+    });
+    session->connect("127.0.0.1", port);
+    TEST_CHECK(WaitFor([&] { return opened.load(); }));
+    if (session_id)
+        *session_id = session->get_session_id();
+
+    std::string frame;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t len = sizeof(i) + i % 64;
+        frame.assign((const char*)&len, sizeof(len));
+        frame.append((const char*)&i, sizeof(i));
+        frame.append(i % 64, 'x');
+        TEST_CHECK(session->write(frame.data(), frame.size()));
+    }
+    TEST_CHECK(WaitFor([&] { return received.load() == count; }));
+    TEST_CHECK(bad == 0);
+
+    // 连接对象需先于其io服务释放
+    session->shutdown();
+    session.reset();
+    server.stop();
+    return true;
+}
+
+// io_uring后端与asio后端行为一致, 连接ID互不冲突; 内核不支持io_uring时跳过
+static bool TestUringBackend() {
+    AsioContextPool asio_server_pool(1), asio_client_pool(1);
+    NetCallBack::SessionID asio_id = 0;
+    TEST_CHECK(EchoRoundTrip<AsioTcpBackend>(asio_server_pool, asio_client_pool, NextPort(), &asio_id));
+
+    for (bool sqpoll : { false, true }) {
+        UringOption option;
+        option.sqpoll_ = sqpoll;
+        std::unique_ptr<UringContextPool> server_pool, client_pool;
+        try {
+            server_pool = std::make_unique<UringContextPool>(1, true, std::vector<int>(), option);
+            client_pool = std::make_unique<UringContextPool>(1, true, std::vector<int>(), option);
+        }
+        catch (std::exception& e) {
+            std::cout << __FUNCTION__ << " skipped" << (sqpoll ? " sqpoll: " : ": ") << e.what() << std::endl;
+            continue;
+        }
+        NetCallBack::SessionID uring_id = 0;
+        TEST_CHECK(EchoRoundTrip<UringTcpBackend>(*server_pool, *client_pool, NextPort(), &uring_id));
+        TEST_CHECK(uring_id != 0 && uring_id != asio_id);
+        client_pool->stop();
+        server_pool->stop();
+    }
+    return true;
+}
+
+// io_uring循环空闲阻塞时, 其他线程逐个投递的任务均可及时唤醒循环执行; 内核不支持io_uring时跳过
+static bool TestUringCrossThreadPost() {
+    std::unique_ptr<UringContextPool> pool;
+    try {
+        pool = std::make_unique<UringContextPool>(1);
+    }
+    catch (std::exception& e) {
+        std::cout << __FUNCTION__ << " skipped: " << e.what() << std::endl;
+        return true;
+    }
+    UringContext& ioc = pool->get_io_context();
+    std::atomic<int> done(0);
+    for (int i = 1; i <= 20000; ++i) {
+        ioc.post([&done]() { ++done; });
+        // 每次投递后等待执行完毕, 使循环反复进入空闲等待
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (done.load() != i && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+        TEST_CHECK(done.load() == i);
+    }
+    pool->stop();
+    return true;
+}
+
+// 忙轮询: 轮询与阻塞线程混用时收发正常, 轮询线程可及时停止, 取消后以阻塞方式重启
+// 服务停止时一并停止其io服务, 故每个服务使用独立的AsioContextPool
+static bool TestBusyPoll() {
+    AsioBusyPollOption option;
+    option.poll_indexes_ = { true, false };
+    option.idle_spins_ = 1000;
+    option.idle_sleep_us_ = 20;
+    AsioSingleContextPool client_pool(2, false);
+    client_pool.set_busy_poll(option).start();
+    {
+        AsioContextPool server_pool(2, false);
+        server_pool.set_busy_poll(option).start();
+        TEST_CHECK(EchoRoundTrip<AsioTcpBackend>(server_pool, client_pool, NextPort()));
+    }
+
+    // 全部线程持续自旋, 同时设置socket忙轮询, 权限不足时设置失败但不影响收发
+    {
+        const uint32_t count = 1000;
+        unsigned short port = NextPort();
+        AsioContextPool server_pool(1, false);
+        server_pool.set_busy_poll().start();
+        TcpServer server(server_pool);
+        server.set_busy_poll(50);
+        RecordSink sink(1);
+        TEST_CHECK(StartSink(server, sink, port));
+        auto session = std::make_shared<TcpSession>(client_pool.get_io_context());
+        session->set_busy_poll(50);
+        TEST_CHECK(OpenSession(session, port));
+        for (uint32_t i = 0; i < count; ++i) {
+            record_st rec{ 0, i, {} };
+            TEST_CHECK(session->write((const char*)&rec, sizeof(rec)));
+        }
+        TEST_CHECK(WaitFor([&] { return sink.count() == count; }));
+        TEST_CHECK(sink.bad() == 0);
+        session->shutdown();
+        session.reset();
+        auto start = steady_clock::now();
+        server.stop();
+        TEST_CHECK(steady_clock::now() - start < std::chrono::seconds(1));
+    }
+
+    auto start = steady_clock::now();
+    client_pool.stop();
+    TEST_CHECK(steady_clock::now() - start < std::chrono::seconds(1));
+
+    client_pool.clear_busy_poll().start();
+    AsioContextPool server_pool(1);
+    TEST_CHECK(EchoRoundTrip<AsioTcpBackend>(server_pool, client_pool, NextPort()));
+    return true;
+}
+
+// 共享内存通道: 同进程内建立两端, 写入跨越环形缓存边界时可读序列仍连续, 超出容量的消息写入失败, 关闭后双方均可感知
+static bool TestShmChannel() {
+    std::string name = "/btool_net_test_" + std::to_string(getpid());
+    ShmChannel client, server;
+    TEST_CHECK(client.create(name, 1));
+    TEST_CHECK(server.accept(name));
+    TEST_CHECK(client.wait_accept(1000));
+    const size_t capacity = client.capacity();
+    TEST_CHECK(capacity > 0 && server.capacity() == capacity);
+
+    std::vector<char> oversize(capacity + 1, 'x');
+    TEST_CHECK(!client.write(oversize.data(), oversize.size()));
+
+    // 消息长度不整除容量, 必然有消息跨越边界
+    const uint32_t count = 20000;
+    const size_t msg_size = 100;
+    std::atomic<bool> write_ok{ true };
+    std::thread writer([&] {
+        char msg[msg_size];
+        for (uint32_t i = 0; i < count; ++i) {
+            memset(msg, (char)i, sizeof(msg));
+            memcpy(msg, &i, sizeof(i));
+            if (!client.write(msg, sizeof(msg))) {
+                write_ok = false;
+                return;
+            }
+        }
+    });
+    uint32_t received = 0, bad = 0;
+    uint64_t seen = server.head();
+    while (received < count && server.wait_data(seen, 0)) {
+        seen = server.tail();
+        size_t readable = server.readable(seen);
+        while (readable >= msg_size) {
+            const char* data = server.peek();
+            uint32_t seq;
+            memcpy(&seq, data, sizeof(seq));
+            if (seq != received || data[msg_size - 1] != (char)received)
+                ++bad;
+            ++received;
+            server.consume(msg_size);
+            readable -= msg_size;
+        }
+    }
+    writer.join();
+    TEST_CHECK(write_ok && received == count && bad == 0);
+
+    // 反向写入
+    TEST_CHECK(server.write("pong", 4));
+    TEST_CHECK(client.wait_data(client.head(), 0));
+    TEST_CHECK(client.readable(client.tail()) == 4 && memcmp(client.peek(), "pong", 4) == 0);
+    client.consume(4);
+
+    client.close();
+    TEST_CHECK(server.is_closed());
+    TEST_CHECK(!server.wait_data(server.tail(), 0));
+    TEST_CHECK(!server.write("ping", 4));
+    return true;
+}
+
+// ShmSession连接ShmServer时经共享内存, 连接普通TcpServer时回落为tcp, 两种情况下收发一致
+template<typename TServer>
+static bool ShmEchoRoundTrip(bool expect_shm) {
+    const uint32_t count = 2000;
+    unsigned short port = NextPort();
+    AsioContextPool server_pool(1), client_pool(1);
+    LengthFrameDecoder<uint32_t> decoder;
+    TServer server(server_pool);
+    server.register_read_cbk([&](NetCallBack::SessionID id, const char* const msg, size_t bytes_transferred) {
+        size_t used = 0;
+        std::string_view body;
+        long long frame_len;
+        while ((frame_len = decoder(msg + used, bytes_transferred - used, body)) > 0) {
+            server.write(id, msg + used, (size_t)frame_len);
+            used += (size_t)frame_len;
+        }
+        server.consume_read_buf(id, used);
+    });
+    TEST_CHECK(server.start("127.0.0.1", port));
+
+    std::atomic<uint32_t> received{ 0 }, bad{ 0 };
+    std::atomic<bool> opened{ false };
+    std::atomic<NetCallBack::SessionID> open_id{ 0 };
+    auto session = std::make_shared<ShmSession>(client_pool.get_io_context());
+    session->register_open_cbk([&](NetCallBack::SessionID id) { open_id = id; opened = true; });
+    session->register_read_cbk([&](NetCallBack::SessionID, const char* const msg, size_t bytes_transferred) {
+        size_t used = 0;
+        std::string_view body;
+        long long frame_len;
+        while ((frame_len = decoder(msg + used, bytes_transferred - used, body)) > 0) {
+            uint32_t seq = received.load();
+            if (body.size() != sizeof(seq) + seq % 64 || memcmp(body.data(), &seq, sizeof(seq)) != 0)
+                ++bad;
+            ++received;
+            used += (size_t)frame_len;
+        }
+        session->consume_read_buf(used);
+    });
+    session->connect("127.0.0.1", port);
+    TEST_CHECK(WaitFor([&] { return opened.load(); }));
+    TEST_CHECK(session->is_shm() == expect_shm);
+    TEST_CHECK(IsShmSessionID(open_id) == expect_shm && session->get_session_id() == open_id);
+
+    std::string frame;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t len = sizeof(i) + i % 64;
+        frame.assign((const char*)&len, sizeof(len));
+        frame.append((const char*)&i, sizeof(i));
+        frame.append(i % 64, 'x');
+        TEST_CHECK(session->write(frame.data(), frame.size()));
+    }
+    TEST_CHECK(WaitFor([&] { return received.load() == count; }));
+    TEST_CHECK(bad == 0);
+
+    session->shutdown();
+    session.reset();
+    server.stop();
+    return true;
+}
+
+static bool TestShmSession() {
+    TEST_CHECK(ShmEchoRoundTrip<ShmServer>(true));
+    TEST_CHECK(ShmEchoRoundTrip<TcpServer>(false));
+    return true;
+}
+
+// 双方均于读取回调中内联写入且环形缓存写满时不互相等待: 服务端逐条回显, 客户端对每条回显再内联应答
+static bool TestShmInlineWrite() {
+    const uint32_t count = 20000;
+    const size_t body_size = 200;
+    unsigned short port = NextPort();
+    AsioContextPool server_pool(1), client_pool(1);
+    LengthFrameDecoder<uint32_t> decoder;
+    std::atomic<uint32_t> acks{ 0 }, echoes{ 0 }, write_fail{ 0 };
+    ShmServer server(server_pool);
+    server.register_read_cbk([&](NetCallBack::SessionID id, const char* const msg, size_t bytes_transferred) {
+        size_t used = 0;
+        std::string_view body;
+        long long frame_len;
+        while ((frame_len = decoder(msg + used, bytes_transferred - used, body)) > 0) {
+            if (body[0] == 'd') {
+                std::string reply(msg + used, (size_t)frame_len);
+                reply[sizeof(uint32_t)] = 'e';
+                if (!server.write(id, reply.data(), reply.size()))
+                    ++write_fail;
+            }
+            else {
+                ++acks;
+            }
+            used += (size_t)frame_len;
+        }
+        server.consume_read_buf(id, used);
+    });
+    TEST_CHECK(server.start("127.0.0.1", port));
+
+    std::atomic<bool> opened{ false };
+    auto session = std::make_shared<ShmSession>(client_pool.get_io_context());
+    session->set_ring_capacity(4096);
+    session->register_open_cbk([&](NetCallBack::SessionID) { opened = true; });
+    session->register_read_cbk([&](NetCallBack::SessionID, const char* const msg, size_t bytes_transferred) {
+        size_t used = 0;
+        std::string_view body;
+        long long frame_len;
+        while ((frame_len = decoder(msg + used, bytes_transferred - used, body)) > 0) {
+            std::string ack(msg + used, (size_t)frame_len);
+            ack[sizeof(uint32_t)] = 'a';
+            if (!session->write(ack.data(), ack.size()))
+                ++write_fail;
+            ++echoes;
+            used += (size_t)frame_len;
+        }
+        session->consume_read_buf(used);
+    });
+    session->connect("127.0.0.1", port);
+    TEST_CHECK(WaitFor([&] { return opened.load(); }));
+    TEST_CHECK(session->is_shm());
+
+    uint32_t len = body_size;
+    std::string frame((const char*)&len, sizeof(len));
+    frame.append(body_size, 'd');
+    for (uint32_t i = 0; i < count; ++i)
+        TEST_CHECK(session->write(frame.data(), frame.size()));
+    TEST_CHECK(WaitFor([&] { return acks.load() == count; }, 10000));
+    TEST_CHECK(echoes == count && write_fail == 0);
+
+    session->shutdown();
+    session.reset();
+    server.stop();
+    return true;
+}
+
+int main() {
+    bool (*cases[])() = {
+        TestGatherWrite,
+        TestConcurrentWriteBuffer,
+        TestConcurrentWrite,
+        TestLengthFrameDecoder,
+        TestDelimiterFrameDecoder,
+        TestMirrorReadBuffer,
+        TestFrameSession,
+        TestUringBackend,
+        TestUringCrossThreadPost,
+        TestBusyPoll,
+        TestShmChannel,
+        TestShmSession,
+        TestShmInlineWrite,
+    };
+    int failed = 0;
+    for (auto test_case : cases) {
+        if (!test_case())
+            ++failed;
+    }
+    std::cout << (failed == 0 ? "all passed" : "failed") << std::endl;
+    return failed == 0 ? 0 : 1;
+}
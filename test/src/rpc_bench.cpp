@@ -0,0 +1,360 @@
+// RPC回环压测, N个连接各保持M个在途调用, 覆盖future/callback/bind三种调用模式及多种消息体大小
+// 用法: rpc_bench [每场景调用数] [连接数] [每连接在途数] [消息体大小列表, 逗号分隔, 取16/256/4096] [传输层 tcp|shm]
+// 每个场景输出一行JSON, 字段: model/transport/payload/conns/inflight/calls/errors/calls_per_sec/p50_us/p99_us/p999_us/max_us/allocs_per_call/alloc_target/alloc_target_met
+// allocs_per_call为压测期间进程内(含客户端及服务端)堆分配次数除以调用数, 目标为0(alloc_target)
+// 压测线程本身不产生分配: 消息体为定长平凡类型, 时延槽位预先分配, 回调仅捕获单个指针以置于std::function内部缓存, 故计数均来自库
+// 目标尚未完全达成, 现存分配均与调用数无关或仅发生于预热期: 回调超时扫描定时器按周期(10ms)分配, future模式各等待槽位首次使用时分配应答缓存(每连接至多1024次)
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "boost_net/tcp_server.hpp"
+#include "boost_net/tcp_session.hpp"
+#include "boost_net/shm_server.hpp"
+#include "boost_net/shm_session.hpp"
+#include "boost_net/rpc_base.hpp"
+
+using namespace BTool;
+using namespace BTool::BoostNet;
+
+// 统计堆分配次数
+// 禁止内联, 否则编译器可见malloc与free配对而误报-Wmismatched-new-delete
+static std::atomic<unsigned long long> g_alloc_count(0);
+
+__attribute__((noinline)) void* operator new(size_t size) {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+__attribute__((noinline)) void* operator new[](size_t size) {
+    return operator new(size);
+}
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+__attribute__((noinline)) void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+__attribute__((noinline)) void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+typedef std::chrono::steady_clock bench_clock;
+
+enum { RPC_TIMEOUT = 10000, MAX_RBUFFER_SIZE = 1024 * 1024 };
+
+// 每次调用的堆分配目标
+static const double ALLOC_TARGET = 0;
+
+static size_t g_call_count = 200000;
+static size_t g_conn_count = 4;
+static size_t g_inflight = 16;
+static std::vector<size_t> g_payloads = { 16, 256, 4096 };
+static std::string g_transport = "tcp";
+
+// 定长消息体, 平凡类型整体拷贝序列化, 收发均不产生堆分配
+template<size_t N>
+struct BenchPayload {
+    char data_[N];
+};
+
+static unsigned long long NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now().time_since_epoch()).count();
+}
+
+// 单场景结果
+struct BenchResult {
+    std::vector<unsigned long long> latencys;   // 纳秒
+    size_t errors = 0;
+    double seconds = 0;
+    unsigned long long allocs = 0;
+
+    void merge(const std::vector<std::vector<unsigned long long>>& items, size_t error_count) {
+        for (auto& item : items)
+            latencys.insert(latencys.end(), item.begin(), item.end());
+        errors = error_count;
+    }
+
+    void print(const char* model, size_t payload) {
+        std::sort(latencys.begin(), latencys.end());
+        size_t calls = latencys.size();
+        double allocs_per_call = calls == 0 ? 0 : double(allocs) / calls;
+        auto percentile = [&](size_t permille) {
+            return calls == 0 ? 0 : latencys[std::min(calls - 1, calls * permille / 1000)] / 1000.0;
+        };
+        std::cout << "{\"model\":\"" << model << "\""
+            << ",\"transport\":\"" << g_transport << "\""
+            << ",\"payload\":" << payload
+            << ",\"conns\":" << g_conn_count
+            << ",\"inflight\":" << g_inflight
+            << ",\"calls\":" << calls
+            << ",\"errors\":" << errors
+            << ",\"calls_per_sec\":" << (unsigned long long)(seconds > 0 ? calls / seconds : 0)
+            << ",\"p50_us\":" << percentile(500)
+            << ",\"p99_us\":" << percentile(990)
+            << ",\"p999_us\":" << percentile(999)
+            << ",\"max_us\":" << (calls == 0 ? 0 : latencys.back() / 1000.0)
+            << ",\"allocs_per_call\":" << allocs_per_call
+            << ",\"alloc_target\":" << ALLOC_TARGET
+            << ",\"alloc_target_met\":" << (allocs_per_call <= ALLOC_TARGET ? "true" : "false")
+            << "}" << std::endl;
+    }
+};
+
+// 在途窗口, 发送前占用, 应答后归还
+class InflightWindow {
+public:
+    explicit InflightWindow(size_t limit) : m_limit(limit), m_count(0) {}
+
+    void acquire() {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_cv.wait(lock, [this] { return m_count < m_limit; });
+        ++m_count;
+    }
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            --m_count;
+        }
+        m_cv.notify_one();
+    }
+    void wait_empty() {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_cv.wait(lock, [this] { return m_count == 0; });
+    }
+
+private:
+    std::mutex              m_mtx;
+    std::condition_variable m_cv;
+    size_t                  m_limit;
+    size_t                  m_count;
+};
+
+template<typename TServer, typename TSession>
+class RpcBench {
+    typedef RpcService<TServer, IdProxyPkgHandle, DefaultProxyMsgHandle, RPC_TIMEOUT>   service_type;
+    typedef RpcClient<TSession, IdProxyPkgHandle, DefaultProxyMsgHandle, RPC_TIMEOUT>   client_type;
+
+    // 单次异步调用上下文, 预先分配, 回调仅捕获其指针
+    struct CallContext {
+        unsigned long long*     latency = nullptr;
+        unsigned long long      start = 0;
+        std::atomic<size_t>*    errors = nullptr;
+        InflightWindow*         window = nullptr;
+    };
+
+public:
+    explicit RpcBench(unsigned short port)
+        : m_service(0, 0, MAX_RBUFFER_SIZE)
+        , m_port(port)
+    {
+        bind_echo<16>();
+        bind_echo<256>();
+        bind_echo<4096>();
+    }
+
+    bool start() {
+        if (!m_service.listen("127.0.0.1", m_port))
+            return false;
+
+        for (size_t i = 0; i < g_conn_count; ++i) {
+            auto client = std::make_unique<client_type>(0, MAX_RBUFFER_SIZE);
+            std::promise<void> opened;
+            client->register_open_cbk([&opened](NetCallBack::SessionID) { opened.set_value(); });
+            client->connect("127.0.0.1", m_port, false);
+            if (opened.get_future().wait_for(std::chrono::seconds(5)) != std::future_status::ready)
+                return false;
+            client->register_open_cbk(nullptr);
+            m_clients.push_back(std::move(client));
+        }
+        // 等待协商完成
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return true;
+    }
+
+    // future模式: 每个连接M个线程各自同步调用
+    template<size_t N>
+    BenchResult run_future() {
+        BenchPayload<N> payload;
+        memset(payload.data_, 'x', N);
+        std::string rpc_name = EchoName("echo", N);
+        size_t thread_count = g_conn_count * g_inflight;
+        size_t per_thread = std::max<size_t>(1, g_call_count / thread_count);
+        std::vector<std::vector<unsigned long long>> latencys(thread_count, std::vector<unsigned long long>(per_thread));
+        std::atomic<size_t> errors(0);
+
+        BenchResult rslt = measure(thread_count, [&](size_t i) {
+            client_type& client = *m_clients[i % g_conn_count];
+            for (size_t n = 0; n < per_thread; ++n) {
+                unsigned long long start = NowNs();
+                auto [status, rsp] = client.template call<BenchPayload<N>>(rpc_name, payload);
+                latencys[i][n] = NowNs() - start;
+                if (status != msg_status::ok || rsp.data_[N - 1] != 'x')
+                    ++errors;
+            }
+        });
+        rslt.merge(latencys, errors);
+        return rslt;
+    }
+
+    // callback模式: 每个连接由发送线程保持M个在途异步调用
+    // rpc_name: echo由服务端自动应答, echo_bind由服务端主动调用rsp_bind应答
+    template<size_t N>
+    BenchResult run_callback(const char* rpc_name) {
+        BenchPayload<N> payload;
+        memset(payload.data_, 'x', N);
+        std::string name = EchoName(rpc_name, N);
+        RpcMethod method(name);
+        size_t per_conn = std::max<size_t>(1, g_call_count / g_conn_count);
+        std::vector<std::vector<unsigned long long>> latencys(g_conn_count, std::vector<unsigned long long>(per_conn));
+        std::vector<std::vector<CallContext>> contexts(g_conn_count, std::vector<CallContext>(per_conn));
+        std::vector<std::unique_ptr<InflightWindow>> windows;
+        for (size_t i = 0; i < g_conn_count; ++i)
+            windows.push_back(std::make_unique<InflightWindow>(g_inflight));
+        std::atomic<size_t> errors(0);
+
+        BenchResult rslt = measure(g_conn_count, [&](size_t i) {
+            client_type& client = *m_clients[i];
+            InflightWindow& window = *windows[i];
+            for (size_t n = 0; n < per_conn; ++n) {
+                window.acquire();
+                CallContext* ctx = &contexts[i][n];
+                ctx->latency = &latencys[i][n];
+                ctx->errors = &errors;
+                ctx->window = &window;
+                ctx->start = NowNs();
+                auto cbk = [ctx](NetCallBack::SessionID, msg_status status, BenchPayload<N>&& rsp) {
+                    *ctx->latency = NowNs() - ctx->start;
+                    if (status != msg_status::ok || rsp.data_[N - 1] != 'x')
+                        ++*ctx->errors;
+                    ctx->window->release();
+                };
+                static_assert(sizeof(cbk) <= 2 * sizeof(void*), "callback must fit std::function small buffer");
+                client.call_back(method, payload)(std::move(cbk));
+            }
+            window.wait_empty();
+        });
+        rslt.merge(latencys, errors);
+        return rslt;
+    }
+
+    // 按消息体大小分派至对应定长类型
+    BenchResult run(const char* model, size_t payload_size) {
+        switch (payload_size) {
+        case 16:    return run_model<16>(model);
+        case 256:   return run_model<256>(model);
+        default:    return run_model<4096>(model);
+        }
+    }
+
+private:
+    static std::string EchoName(const char* rpc_name, size_t payload_size) {
+        return std::string(rpc_name) + "_" + std::to_string(payload_size);
+    }
+
+    template<size_t N>
+    void bind_echo() {
+        std::string bind_name = EchoName("echo_bind", N);
+        // 自动应答
+        m_service.bind_auto(EchoName("echo", N), [](NetCallBack::SessionID, BenchPayload<N> payload) { return payload; });
+        // 主动应答
+        m_service.bind(bind_name, [this, bind_name](NetCallBack::SessionID session_id, const message_head& head, BenchPayload<N> payload) {
+            m_service.rsp_bind(bind_name, session_id, head.req_id_, head.rpc_model_, msg_status::ok, payload);
+        });
+    }
+
+    template<size_t N>
+    BenchResult run_model(const char* model) {
+        if (strcmp(model, "future") == 0)
+            return run_future<N>();
+        return run_callback<N>(strcmp(model, "bind") == 0 ? "echo_bind" : "echo");
+    }
+
+    // 以thread_count个线程并发执行func(线程序号), 计时及分配统计自全部线程就绪后开始, 不含线程创建
+    template<typename TFunc>
+    BenchResult measure(size_t thread_count, TFunc&& func) {
+        std::atomic<size_t> ready(0);
+        std::atomic<bool> go(false);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < thread_count; ++i) {
+            threads.emplace_back([&, i]() {
+                ++ready;
+                while (!go.load())
+                    std::this_thread::yield();
+                func(i);
+            });
+        }
+        while (ready.load() != thread_count)
+            std::this_thread::yield();
+
+        BenchResult rslt;
+        unsigned long long allocs = g_alloc_count.load();
+        auto start = bench_clock::now();
+        go.store(true);
+        for (auto& thread : threads)
+            thread.join();
+        rslt.seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        rslt.allocs = g_alloc_count.load() - allocs;
+        return rslt;
+    }
+
+private:
+    service_type                                m_service;
+    unsigned short                              m_port;
+    std::vector<std::unique_ptr<client_type>>   m_clients;
+};
+
+template<typename TServer, typename TSession>
+int bench(unsigned short port) {
+    RpcBench<TServer, TSession> bench(port);
+    if (!bench.start()) {
+        std::cout << "{\"error\":\"connect failed\",\"transport\":\"" << g_transport << "\"}" << std::endl;
+        return 1;
+    }
+
+    size_t errors = 0;
+    for (size_t payload : g_payloads) {
+        for (const char* model : { "future", "callback", "bind" }) {
+            BenchResult rslt = bench.run(model, payload);
+            rslt.print(model, payload);
+            errors += rslt.errors;
+        }
+    }
+    return errors == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1)
+        g_call_count = std::max(1ul, strtoul(argv[1], nullptr, 10));
+    if (argc > 2)
+        g_conn_count = std::max(1ul, strtoul(argv[2], nullptr, 10));
+    if (argc > 3)
+        g_inflight = std::max(1ul, strtoul(argv[3], nullptr, 10));
+    if (argc > 4) {
+        g_payloads.clear();
+        std::stringstream ss(argv[4]);
+        std::string item;
+        // 消息体为定长类型, 就近取16/256/4096
+        while (std::getline(ss, item, ',')) {
+            size_t payload = strtoul(item.c_str(), nullptr, 10);
+            g_payloads.push_back(payload <= 16 ? 16 : payload <= 256 ? 256 : 4096);
+        }
+    }
+    if (argc > 5)
+        g_transport = argv[5];
+
+    if (g_transport == "shm")
+        return bench<ShmServer, ShmSession>(45603);
+    return bench<TcpServer, TcpSession>(45604);
+}
@@ -0,0 +1,677 @@
+// RPC功能自检, 各用例依次执行, 失败时输出用例名及原因并返回非0
+// 覆盖方法ID完美哈希表及ID模式调用, 超时扫描及槽位代数复用, 流水线/批量调用, 协程调用, ID模式结构校验, 工作线程投递及overload, 共享内存传输及tcp回落, 流式额度
+#include <iostream>
+#include <future>
+#include "boost_net/tcp_server.hpp"
+#include "boost_net/tcp_session.hpp"
+#include "boost_net/shm_server.hpp"
+#include "boost_net/shm_session.hpp"
+#include "boost_net/rpc_base.hpp"
+
+using namespace BTool;
+using namespace BTool::BoostNet;
+
+#define TEST_CHECK(cond) do { if (!(cond)) { std::cout << __FUNCTION__ << " failed at line " << __LINE__ << ": " #cond << std::endl; return false; } } while (0)
+
+typedef std::chrono::steady_clock steady_clock;
+
+static unsigned short NextPort() {
+    static unsigned short port = 46100;
+    return port++;
+}
+
+static long long ElapsedMs(steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(steady_clock::now() - start).count();
+}
+
+// 连接并等待ID模式方法表协商完成
+template<typename TClient>
+static bool Connect(TClient& client, unsigned short port) {
+    auto opened = std::make_shared<std::atomic<bool>>(false);
+    client.register_open_cbk([opened](NetCallBack::SessionID) { opened->store(true); });
+    client.connect("127.0.0.1", port, false);
+    auto start = steady_clock::now();
+    while (!opened->load()) {
+        if (ElapsedMs(start) > 5000)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    return true;
+}
+
+// 方法ID哈希于编译期求得, 完美哈希表插入/查找/覆盖, 不同方法名ID冲突时插入失败
+static bool TestMethodTable() {
+    static_assert(RpcMethod("add").id_ == RpcMethodID("add"), "method id must be constexpr");
+    static_assert(sizeof(message_id_head) == 13, "id head must stay packed");
+    TEST_CHECK(RpcMethodID("add") != RpcMethodID("sub"));
+
+    RpcMethodTable<int> table;
+    TEST_CHECK(table.find(RpcMethodID("add")) == nullptr);
+    const int count = 500;
+    std::vector<std::string> names;
+    for (int i = 0; i < count; ++i)
+        names.push_back("method_" + std::to_string(i));
+    for (int i = 0; i < count; ++i)
+        TEST_CHECK(table.insert(RpcMethodID(names[i]), names[i], i));
+    TEST_CHECK(table.entries().size() == count);
+    for (int i = 0; i < count; ++i) {
+        auto item = table.find(RpcMethodID(names[i]));
+        TEST_CHECK(item && item->value_ == i && item->name_ == names[i]);
+    }
+    TEST_CHECK(table.find(RpcMethodID("missing")) == nullptr);
+
+    TEST_CHECK(table.insert(RpcMethodID(names[0]), names[0], -1));
+    TEST_CHECK(table.find(RpcMethodID(names[0]))->value_ == -1);
+    TEST_CHECK(table.entries().size() == count);
+    TEST_CHECK(!table.insert(RpcMethodID(names[1]), "other name", 0));
+    return true;
+}
+
+// 同步调用按方法名(默认模式)或方法ID(ID模式)分发, 未绑定方法返回no_bind
+template<template<typename> typename TPkg>
+static bool TestIdCall() {
+    unsigned short port = NextPort();
+    RpcService<TcpServer, TPkg, DefaultProxyMsgHandle, 3000> service;
+    service.bind_auto("add", [](NetCallBack::SessionID, int a, int b) { return a + b; });
+    service.bind_auto("echo", [](NetCallBack::SessionID, std::string str) { return str; });
+    TEST_CHECK(service.listen("127.0.0.1", port));
+    RpcClient<TcpSession, TPkg, DefaultProxyMsgHandle, 3000> client;
+    TEST_CHECK(Connect(client, port));
+
+    constexpr RpcMethod add_method("add");
+    for (int i = 0; i < 100; ++i) {
+        auto [status, rslt] = client.template call<int>(add_method, i, 1);
+        TEST_CHECK(status == msg_status::ok && rslt == i + 1);
+    }
+    auto [echo_status, echo] = client.template call<std::string>("echo", std::string("hello"));
+    TEST_CHECK(echo_status == msg_status::ok && echo == "hello");
+    auto [missing_status, missing] = client.template call<int>("missing", 1, 2);
+    TEST_CHECK(missing_status == msg_status::no_bind);
+    (void)missing;
+    return true;
+}
+
+// 超时扫描: 同步及回调调用于超时后约一个扫描间隔内以timeout结束, 迟到的应答被丢弃
+template<template<typename> typename TPkg>
+static bool TestDeadlineSweep() {
+    unsigned short port = NextPort();
+    RpcService<TcpServer, TPkg, DefaultProxyMsgHandle, 200> service;
+    std::mutex mtx;
+    std::vector<std::pair<NetCallBack::SessionID, message_head>> held;
+    service.bind_auto("add", [](NetCallBack::SessionID, int a, int b) { return a + b; });
+    service.bind("hold", [&](NetCallBack::SessionID session_id, const message_head& head, int) {
+        std::lock_guard<std::mutex> lock(mtx);
+        held.emplace_back(session_id, head);
+    });
+    TEST_CHECK(service.listen("127.0.0.1", port));
+    RpcClient<TcpSession, TPkg, DefaultProxyMsgHandle, 200> client;
+    TEST_CHECK(Connect(client, port));
+
+    auto start = steady_clock::now();
+    auto [status, rslt] = client.template call<int>("hold", 1);
+    long long elapsed = ElapsedMs(start);
+    TEST_CHECK(status == msg_status::timeout);
+    TEST_CHECK(elapsed >= 190 && elapsed < 1000);
+
+    std::promise<long long> cb_elapsed;
+    start = steady_clock::now();
+    client.call_back("hold", 1)([&](NetCallBack::SessionID, msg_status cb_status, int) {
+        cb_elapsed.set_value(cb_status == msg_status::timeout ? ElapsedMs(start) : -1);
+    });
+    elapsed = cb_elapsed.get_future().get();
+    TEST_CHECK(elapsed >= 190 && elapsed < 1000);
+
+    // 迟到的应答不得被归属至复用同一槽位的新请求
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        TEST_CHECK(held.size() == 2);
+        for (auto& item : held)
+            service.rsp_bind("hold", item.first, item.second.req_id_, item.second.rpc_model_, msg_status::ok, 999);
+        held.clear();
+    }
+    for (int i = 0; i < 100; ++i) {
+        auto [add_status, sum] = client.template call<int>("add", i, 1);
+        TEST_CHECK(add_status == msg_status::ok && sum == i + 1);
+    }
+
+    // 断开时在途请求立即以wait_error结束, 不等待超时
+    std::promise<msg_status> closed;
+    client.call_back("hold", 1)([&](NetCallBack::SessionID, msg_status cb_status, int) { closed.set_value(cb_status); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    client.shutdown();
+    auto closed_future = closed.get_future();
+    TEST_CHECK(closed_future.wait_for(std::chrono::milliseconds(150)) == std::future_status::ready);
+    TEST_CHECK(closed_future.get() == msg_status::wait_error);
+    return true;
+}
+
+// 槽位复用时代数递增, 旧req_id无法再认领, 已满时申请失败
+static bool TestSlotGeneration() {
+    struct empty_slot_st {};
+    typedef RpcSlotTable<empty_slot_st, 2> SlotTable;
+    SlotTable slots;
+
+    SlotTable::slot_st* owned[SlotTable::capacity];
+    uint32_t req_ids[SlotTable::capacity];
+    for (uint32_t i = 0; i < SlotTable::capacity; ++i) {
+        owned[i] = slots.acquire();
+        TEST_CHECK(owned[i] != nullptr);
+        req_ids[i] = slots.publish(owned[i]);
+        TEST_CHECK(req_ids[i] != 0 && slots.pending(req_ids[i]));
+    }
+    TEST_CHECK(slots.acquire() == nullptr);
+
+    // 同一req_id仅可认领一次
+    TEST_CHECK(slots.claim(req_ids[0]) == owned[0]);
+    TEST_CHECK(slots.claim(req_ids[0]) == nullptr);
+    TEST_CHECK(slots.claim(0) == nullptr);
+    slots.release(owned[0]);
+
+    auto reused = slots.acquire();
+    TEST_CHECK(reused == owned[0]);
+    uint32_t new_id = slots.publish(reused);
+    TEST_CHECK(new_id != req_ids[0]);
+    TEST_CHECK((new_id & SlotTable::slot_mask) == (req_ids[0] & SlotTable::slot_mask));
+    TEST_CHECK(!slots.pending(req_ids[0]) && slots.pending(new_id));
+    TEST_CHECK(slots.claim(req_ids[0]) == nullptr);
+    TEST_CHECK(slots.claim(new_id) == reused);
+    slots.release(reused);
+
+    for (uint32_t i = 1; i < SlotTable::capacity; ++i) {
+        TEST_CHECK(slots.claim(req_ids[i]) == owned[i]);
+        slots.release(owned[i]);
+    }
+
+    // 反复复用, req_id不为0且同一槽位连续两次不重复
+    uint32_t last_ids[SlotTable::capacity] = { 0 };
+    for (int round = 0; round < 1000; ++round) {
+        auto slot = slots.acquire();
+        TEST_CHECK(slot != nullptr);
+        uint32_t req_id = slots.publish(slot);
+        uint32_t index = req_id & SlotTable::slot_mask;
+        TEST_CHECK(req_id != 0 && req_id != last_ids[index]);
+        last_ids[index] = req_id;
+        TEST_CHECK(slots.claim(req_id) == slot);
+        slots.release(slot);
+    }
+    return true;
+}
+
+// 流水线及批量调用, 应答按提交顺序一一对应, 未绑定方法返回no_bind
+template<template<typename> typename TPkg>
+static bool TestPipelineBatch() {
+    unsigned short port = NextPort();
+    RpcService<TcpServer, TPkg, DefaultProxyMsgHandle, 3000> service;
+    service.bind_auto("add", [](NetCallBack::SessionID, int a, int b) { return a + b; });
+    service.bind_auto("nop", [](NetCallBack::SessionID, int) {});
+    TEST_CHECK(service.listen("127.0.0.1", port));
+    RpcClient<TcpSession, TPkg, DefaultProxyMsgHandle, 3000> client;
+    TEST_CHECK(Connect(client, port));
+
+    const int count = 2000;
+    {
+        auto pipe = client.template pipeline<int>();
+        for (int i = 0; i < count; ++i)
+            pipe.call("add", i, 2);
+        auto& rslts = pipe.wait();
+        TEST_CHECK(rslts.size() == count);
+        for (int i = 0; i < count; ++i)
+            TEST_CHECK(std::get<0>(rslts[i]) == msg_status::ok && std::get<1>(rslts[i]) == i + 2);
+    }
+    {
+        auto pipe = client.pipeline();
+        pipe.call("nop", 1);
+        pipe.call("missing", 1);
+        auto& rslts = pipe.wait();
+        TEST_CHECK(rslts.size() == 2 && rslts[0] == msg_status::ok && rslts[1] == msg_status::no_bind);
+    }
+    {
+        std::vector<std::tuple<int, int>> params;
+        for (int i = 0; i < count; ++i)
+            params.emplace_back(i, 3);
+        auto rslts = client.template call_batch<int>("add", params);
+        TEST_CHECK(rslts.size() == count);
+        for (int i = 0; i < count; ++i)
+            TEST_CHECK(std::get<0>(rslts[i]) == msg_status::ok && std::get<1>(rslts[i]) == i + 3);
+    }
+    {
+        std::vector<int> params{ 1, 2, 3 };
+        auto rslts = client.call_batch("nop", params);
+        TEST_CHECK(rslts.size() == 3);
+        for (auto status : rslts)
+            TEST_CHECK(status == msg_status::ok);
+        auto missing = client.template call_batch<int>("missing", params);
+        for (auto& rslt : missing)
+            TEST_CHECK(std::get<0>(rslt) == msg_status::no_bind);
+    }
+    return true;
+}
+
+#ifdef BTOOL_RPC_COROUTINE
+// 协程应答及co_call, 挂起中的请求于超时/断开时分别以timeout/wait_error恢复
+template<template<typename> typename TPkg>
+static bool TestCoroutine() {
+    unsigned short port = NextPort();
+    boost::asio::io_context worker;
+    auto guard = boost::asio::make_work_guard(worker);
+    std::thread worker_thread([&] { worker.run(); });
+
+    // 切换至worker线程后继续执行
+    struct switch_to {
+        boost::asio::io_context& ioc_;
+        bool await_ready() { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { boost::asio::post(ioc_, [handle] { handle.resume(); }); }
+        void await_resume() {}
+    };
+
+    bool rslt = [&]() {
+        RpcService<TcpServer, TPkg, DefaultProxyMsgHandle, 2000> service;
+        service.bind_co("add", [&](NetCallBack::SessionID, int a, int b) -> rpc_task<int> {
+            co_await switch_to{ worker };
+            co_return a + b;
+        });
+        service.bind_co("str", [](NetCallBack::SessionID, std::string s) -> rpc_task<std::string> { co_return s + "!"; });
+        service.bind_co("void", [](NetCallBack::SessionID) -> rpc_task<> { co_return; });
+        service.bind_co("throw", [](NetCallBack::SessionID) -> rpc_task<int> { throw std::runtime_error("throw"); co_return 0; });
+        service.bind_auto("slow", [](NetCallBack::SessionID) { std::this_thread::sleep_for(std::chrono::milliseconds(300)); return 1; });
+        TEST_CHECK(service.listen("127.0.0.1", port));
+        RpcClient<TcpSession, TPkg, DefaultProxyMsgHandle, 2000> client;
+        TEST_CHECK(Connect(client, port));
+
+        const int count = 1000;
+        std::atomic<int> done{ 0 }, bad{ 0 };
+        auto add = [&](int i) -> rpc_task<> {
+            auto [status, sum] = co_await client.template co_call<int>("add", i, 1);
+            if (status != msg_status::ok || sum != i + 1)
+                ++bad;
+            ++done;
+        };
+        for (int i = 0; i < count; ++i)
+            add(i).start();
+        auto start = steady_clock::now();
+        while (done < count && ElapsedMs(start) < 5000)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        TEST_CHECK(done == count && bad == 0);
+
+        std::promise<int> errors;
+        auto seq = [&]() -> rpc_task<int> {
+            int err = 0;
+            auto [str_status, str] = co_await client.template co_call<std::string>("str", std::string("hi")).resume_on(worker.get_executor());
+            if (str_status != msg_status::ok || str != "hi!")
+                err |= 1;
+            if (co_await client.co_call("void") != msg_status::ok)
+                err |= 2;
+            if (co_await client.co_call("missing") != msg_status::no_bind)
+                err |= 4;
+            auto [throw_status, throw_rslt] = co_await client.template co_call<int>("throw");
+            if (throw_status != msg_status::fail)
+                err |= 8;
+            auto [slow_status, slow_rslt] = co_await client.template co_call<100, int>("slow");
+            if (slow_status != msg_status::timeout)
+                err |= 16;
+            co_return err;
+        };
+        seq().start([&](msg_status status, int err) { errors.set_value(status == msg_status::ok ? err : -1); });
+        TEST_CHECK(errors.get_future().get() == 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+
+        std::promise<msg_status> closed;
+        auto pending = [&]() -> rpc_task<> {
+            auto [status, rslt] = co_await client.template co_call<int>("slow");
+            closed.set_value(status);
+        };
+        pending().start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        client.shutdown();
+        TEST_CHECK(closed.get_future().get() == msg_status::wait_error);
+        return true;
+    }();
+
+    guard.reset();
+    worker_thread.join();
+    return rslt;
+}
+#endif
+
+struct order_st {
+    int                 id_;
+    double              price_;
+    std::string         symbol_;
+    std::vector<int>    volumes_;
+    BTOOL_MEMORY_FIELDS(id_, price_, symbol_, volumes_)
+};
+struct ack_st {
+    int                 id_;
+    std::string         msg_;
+    BTOOL_MEMORY_FIELDS(id_, msg_)
+};
+
+// ID模式协商后依据对端结构哈希校验, 参数或返回值不一致时直接返回schema_error
+static bool TestSchemaMismatch() {
+    unsigned short port = NextPort();
+    RpcService<TcpServer, IdProxyPkgHandle, DefaultProxyMsgHandle, 2000> service;
+    std::atomic<int> invoked{ 0 };
+    service.bind_auto("order", [](NetCallBack::SessionID, order_st order) {
+        int total = 0;
+        for (int volume : order.volumes_)
+            total += volume;
+        return ack_st{ order.id_, order.symbol_ + ":" + std::to_string(total) };
+    });
+    service.bind_auto("add", [&](NetCallBack::SessionID, int a, int b) { ++invoked; return a + b; });
+    TEST_CHECK(service.listen("127.0.0.1", port));
+    RpcClient<TcpSession, IdProxyPkgHandle, DefaultProxyMsgHandle, 2000> client;
+    TEST_CHECK(Connect(client, port));
+
+    {
+        auto [status, ack] = client.call<ack_st>("order", order_st{ 7, 1.5, "AB", { 1, 2, 3 } });
+        TEST_CHECK(status == msg_status::ok && ack.id_ == 7 && ack.msg_ == "AB:6");
+    }
+    {
+        auto [status, rslt] = client.call<int>("add", 1, 2);
+        TEST_CHECK(status == msg_status::ok && rslt == 3);
+    }
+    TEST_CHECK(client.call("add", 1, 2) == msg_status::ok);
+    TEST_CHECK(invoked == 2);
+    {
+        auto [status, rslt] = client.call<int>("add", 1.0, 2);
+        TEST_CHECK(status == msg_status::schema_error);
+    }
+    {
+        auto [status, rslt] = client.call<double>("add", 1, 2);
+        TEST_CHECK(status == msg_status::schema_error);
+    }
+    std::promise<msg_status> cb_status;
+    client.call_back("add", 1, 2L)([&](NetCallBack::SessionID, msg_status status, int) { cb_status.set_value(status); });
+    TEST_CHECK(cb_status.get_future().get() == msg_status::schema_error);
+    // 不一致的调用未发送至对端
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    TEST_CHECK(invoked == 2);
+    return true;
+}
+
+// 工作线程投递: session_serial保序, shared_pool并发, 超出max_pending时应答overload
+template<template<typename> typename TPkg>
+static bool TestDispatchOverload() {
+    unsigned short port = NextPort();
+    std::mutex mtx;
+    std::vector<int> order;
+    std::atomic<int> running{ 0 }, max_running{ 0 };
+    RpcService<TcpServer, TPkg, DefaultProxyMsgHandle, 5000> service;
+    service.bind_auto("serial", [&](NetCallBack::SessionID, int i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        std::lock_guard<std::mutex> lock(mtx);
+        order.push_back(i);
+        return i;
+    });
+    service.bind_auto("parallel", [&](NetCallBack::SessionID, int i) {
+        int cur = ++running;
+        int prev = max_running;
+        while (cur > prev && !max_running.compare_exchange_weak(prev, cur));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        --running;
+        return i * 2;
+    });
+    service.bind_auto("limited", [](NetCallBack::SessionID, int i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        return i;
+    });
+    service.set_dispatch_threads(4);
+    TEST_CHECK(service.set_dispatch("serial", rpc_dispatch::session_serial));
+    TEST_CHECK(service.set_dispatch("parallel", rpc_dispatch::shared_pool));
+    TEST_CHECK(service.set_dispatch("limited", rpc_dispatch::shared_pool, 2));
+    TEST_CHECK(!service.set_dispatch("missing", rpc_dispatch::shared_pool));
+    TEST_CHECK(service.listen("127.0.0.1", port));
+    RpcClient<TcpSession, TPkg, DefaultProxyMsgHandle, 5000> client;
+    TEST_CHECK(Connect(client, port));
+
+    std::atomic<int> done{ 0 }, bad{ 0 }, overload{ 0 }, ok{ 0 };
+    for (int i = 0; i < 50; ++i) {
+        client.call_back("serial", i)([&, i](NetCallBack::SessionID, msg_status status, int rslt) {
+            if (status != msg_status::ok || rslt != i)
+                ++bad;
+            ++done;
+        });
+    }
+    for (int i = 0; i < 8; ++i) {
+        client.call_back("parallel", i)([&, i](NetCallBack::SessionID, msg_status status, int rslt) {
+            if (status != msg_status::ok || rslt != i * 2)
+                ++bad;
+            ++done;
+        });
+    }
+    for (int i = 0; i < 10; ++i) {
+        client.call_back("limited", i)([&, i](NetCallBack::SessionID, msg_status status, int rslt) {
+            if (status == msg_status::overload)
+                ++overload;
+            else if (status == msg_status::ok && rslt == i)
+                ++ok;
+            else
+                ++bad;
+            ++done;
+        });
+    }
+    auto start = steady_clock::now();
+    while (done < 68 && ElapsedMs(start) < 5000)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    TEST_CHECK(done == 68 && bad == 0);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        TEST_CHECK(order.size() == 50);
+        for (int i = 0; i < 50; ++i)
+            TEST_CHECK(order[i] == i);
+    }
+    TEST_CHECK(max_running >= 2);
+    TEST_CHECK(overload > 0 && ok >= 2 && overload + ok == 10);
+    return true;
+}
+
+// 共享内存传输: RpcClient<ShmSession>连接RpcService<ShmServer>时经共享内存调用, 连接普通tcp服务时回落为tcp, 接口一致
+template<typename TServer>
+static bool ShmRpcCall(bool expect_shm) {
+    unsigned short port = NextPort();
+    RpcService<TServer, IdProxyPkgHandle, DefaultProxyMsgHandle, 3000> service;
+    service.bind_auto("add", [](NetCallBack::SessionID, int a, int b) { return a + b; });
+    TEST_CHECK(service.listen("127.0.0.1", port));
+    RpcClient<ShmSession, IdProxyPkgHandle, DefaultProxyMsgHandle, 3000> client;
+    auto open_id = std::make_shared<std::atomic<NetCallBack::SessionID>>(0);
+    client.register_open_cbk([open_id](NetCallBack::SessionID session_id) { open_id->store(session_id); });
+    client.connect("127.0.0.1", port, false);
+    auto start = steady_clock::now();
+    while (open_id->load() == 0) {
+        TEST_CHECK(ElapsedMs(start) < 5000);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    TEST_CHECK(IsShmSessionID(open_id->load()) == expect_shm);
+
+    for (int i = 0; i < 1000; ++i) {
+        auto [status, rslt] = client.template call<int>("add", i, 1);
+        TEST_CHECK(status == msg_status::ok && rslt == i + 1);
+    }
+    auto pipe = client.template pipeline<int>();
+    for (int i = 0; i < 1000; ++i)
+        pipe.call("add", i, 2);
+    auto& rslts = pipe.wait();
+    TEST_CHECK(rslts.size() == 1000);
+    for (int i = 0; i < 1000; ++i)
+        TEST_CHECK(std::get<0>(rslts[i]) == msg_status::ok && std::get<1>(rslts[i]) == i + 2);
+    return true;
+}
+
+static bool TestShmTransport() {
+    TEST_CHECK(ShmRpcCall<ShmServer>(true));
+    TEST_CHECK(ShmRpcCall<TcpServer>(false));
+    return true;
+}
+
+// 流式应答额度: 在途元素不超过窗口, 额度恢复时on_credit续写, 取消及断开时应答端可感知
+template<template<typename> typename TPkg>
+static bool TestStreamCredit() {
+    unsigned short port = NextPort();
+    std::vector<std::thread> writers;
+    std::mutex writers_mtx;
+    std::atomic<int> sent{ 0 }, received{ 0 }, max_lead{ 0 };
+    std::atomic<bool> forever_closed{ false };
+    std::shared_ptr<rpc_stream<int>> held;
+    std::atomic<int> next{ 0 };
+
+    bool rslt = [&]() {
+        RpcService<TcpServer, TPkg, DefaultProxyMsgHandle, 5000> service;
+        service.bind_stream("count", [&](NetCallBack::SessionID, rpc_stream<int, std::string> stream, int n) {
+            std::lock_guard<std::mutex> lock(writers_mtx);
+            writers.emplace_back([&, stream, n]() mutable {
+                for (int i = 0; i < n; ++i) {
+                    while (!stream.write(i, std::to_string(i))) {
+                        if (stream.is_closed())
+                            return;
+                        stream.wait_credit(100);
+                    }
+                    int lead = ++sent - received.load();
+                    int prev = max_lead;
+                    while (lead > prev && !max_lead.compare_exchange_weak(prev, lead));
+                }
+                stream.finish(msg_status::ok);
+            });
+        });
+        service.bind_stream("forever", [&](NetCallBack::SessionID, rpc_stream<int> stream) {
+            std::lock_guard<std::mutex> lock(writers_mtx);
+            writers.emplace_back([&, stream]() mutable {
+                int i = 0;
+                while (!stream.is_closed()) {
+                    if (stream.write(i))
+                        ++i;
+                    else
+                        stream.wait_credit(50);
+                }
+                forever_closed = true;
+            });
+        });
+        service.bind_stream("on_credit", [&](NetCallBack::SessionID, rpc_stream<int> stream, int n) {
+            held = std::make_shared<rpc_stream<int>>(stream);
+            auto pump = [&, n]() {
+                while (next < n && held->write(next))
+                    ++next;
+                if (next == n)
+                    held->finish();
+            };
+            held->on_credit(pump);
+            pump();
+        });
+        service.bind_stream("fail", [](NetCallBack::SessionID, rpc_stream<int> stream) {
+            stream.write(7);
+            stream.finish(msg_status::fail);
+        });
+        TEST_CHECK(service.listen("127.0.0.1", port));
+        RpcClient<TcpSession, TPkg, DefaultProxyMsgHandle, 5000> client;
+        TEST_CHECK(Connect(client, port));
+
+        // 慢速请求端, 应答端领先不超过窗口
+        {
+            std::promise<msg_status> end;
+            int expect = 0, bad = 0;
+            uint32_t stream_id = client.template call_stream<8>("count", 300)([&](NetCallBack::SessionID, int i, std::string s) {
+                if (i != expect++ || s != std::to_string(i))
+                    ++bad;
+                if (i < 40)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                ++received;
+            }, [&](NetCallBack::SessionID, msg_status status) { end.set_value(status); });
+            TEST_CHECK(stream_id != 0);
+            TEST_CHECK(end.get_future().get() == msg_status::ok);
+            TEST_CHECK(expect == 300 && bad == 0);
+            TEST_CHECK(max_lead <= 8);
+        }
+        // 额度恢复时回调续写
+        {
+            std::promise<msg_status> end;
+            int got = 0;
+            client.template call_stream<4>("on_credit", 100)([&](NetCallBack::SessionID, int v) {
+                if (v == got)
+                    ++got;
+            }, [&](NetCallBack::SessionID, msg_status status) { end.set_value(status); });
+            TEST_CHECK(end.get_future().get() == msg_status::ok);
+            TEST_CHECK(got == 100);
+            held.reset();
+        }
+        // 以失败结束
+        {
+            std::promise<msg_status> end;
+            int items = 0;
+            client.call_stream("fail")([&](NetCallBack::SessionID, int v) {
+                if (v == 7)
+                    ++items;
+            }, [&](NetCallBack::SessionID, msg_status status) { end.set_value(status); });
+            TEST_CHECK(end.get_future().get() == msg_status::fail);
+            TEST_CHECK(items == 1);
+        }
+        // 请求端取消, 应答端写入方感知关闭
+        {
+            std::promise<msg_status> end;
+            std::atomic<int> items{ 0 };
+            uint32_t stream_id = client.call_stream("forever")([&](NetCallBack::SessionID, int) { ++items; },
+                [&](NetCallBack::SessionID, msg_status status) { end.set_value(status); });
+            auto start = steady_clock::now();
+            while (items < 500 && ElapsedMs(start) < 5000)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            TEST_CHECK(items >= 500);
+            TEST_CHECK(client.cancel_stream(stream_id));
+            TEST_CHECK(!client.cancel_stream(stream_id));
+            TEST_CHECK(end.get_future().get() == msg_status::fail);
+            for (int i = 0; i < 200 && !forever_closed; ++i)
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            TEST_CHECK(forever_closed);
+        }
+        // 会话断开时请求端以wait_error结束
+        {
+            forever_closed = false;
+            std::promise<msg_status> end;
+            std::atomic<int> items{ 0 };
+            client.call_stream("forever")([&](NetCallBack::SessionID, int) { ++items; },
+                [&](NetCallBack::SessionID, msg_status status) { end.set_value(status); });
+            auto start = steady_clock::now();
+            while (items < 10 && ElapsedMs(start) < 5000)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            client.shutdown();
+            TEST_CHECK(end.get_future().get() == msg_status::wait_error);
+            for (int i = 0; i < 200 && !forever_closed; ++i)
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            TEST_CHECK(forever_closed);
+        }
+        return true;
+    }();
+
+    for (auto& writer : writers)
+        writer.join();
+    return rslt;
+}
+
+int main() {
+    bool (*cases[])() = {
+        TestMethodTable,
+        TestIdCall<DefaultProxyPkgHandle>,
+        TestIdCall<IdProxyPkgHandle>,
+        TestDeadlineSweep<DefaultProxyPkgHandle>,
+        TestDeadlineSweep<IdProxyPkgHandle>,
+        TestSlotGeneration,
+        TestPipelineBatch<DefaultProxyPkgHandle>,
+        TestPipelineBatch<IdProxyPkgHandle>,
+#ifdef BTOOL_RPC_COROUTINE
+        TestCoroutine<DefaultProxyPkgHandle>,
+        TestCoroutine<IdProxyPkgHandle>,
+#endif
+        TestSchemaMismatch,
+        TestDispatchOverload<DefaultProxyPkgHandle>,
+        TestDispatchOverload<IdProxyPkgHandle>,
+        TestShmTransport,
+        TestStreamCredit<DefaultProxyPkgHandle>,
+        TestStreamCredit<IdProxyPkgHandle>,
+    };
+    int failed = 0;
+    for (auto test_case : cases) {
+        if (!test_case())
+            ++failed;
+    }
+    std::cout << (failed == 0 ? "all passed" : "failed") << std::endl;
+    return failed == 0 ? 0 : 1;
+}
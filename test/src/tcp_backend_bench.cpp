@@ -0,0 +1,144 @@
+// TCP后端回环压测, 对比asio(epoll)与io_uring后端的吞吐及延迟
+// 用法: tcp_backend_bench [消息数] [消息体大小] [在途窗口] [是否启用SQPOLL]
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <future>
+#include <algorithm>
+#include <cstring>
+#include "boost_net/tcp_backend.hpp"
+
+using namespace BTool;
+using namespace BTool::BoostNet;
+
+typedef std::chrono::steady_clock bench_clock;
+
+static size_t g_msg_count = 200000;
+static size_t g_body_size = 64;
+static size_t g_window = 64;
+static bool g_sqpoll = false;
+
+static unsigned long long NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now().time_since_epoch()).count();
+}
+
+template<typename PoolType>
+std::unique_ptr<PoolType> CreatePool(int pool_size);
+
+template<>
+std::unique_ptr<AsioContextPool> CreatePool<AsioContextPool>(int pool_size) {
+    return std::make_unique<AsioContextPool>(pool_size);
+}
+
+template<>
+std::unique_ptr<UringContextPool> CreatePool<UringContextPool>(int pool_size) {
+    UringOption option;
+    option.sqpoll_ = g_sqpoll;
+    return std::make_unique<UringContextPool>(pool_size, true, std::vector<int>(), option);
+}
+
+template<typename Backend>
+void bench(const std::string& title, unsigned short port) {
+    typedef typename Backend::session_type session_type;
+
+    auto server_pool = CreatePool<typename Backend::context_pool_type>(1);
+    auto client_pool = CreatePool<typename Backend::context_pool_type>(1);
+
+    // 服务端: 按帧原样回显
+    typename Backend::server_type server(*server_pool);
+    server.register_frame_cbk(LengthFrameDecoder<uint32_t>(), [&server](const NetCallBack::SessionID& session_id, std::string_view frame) {
+        char reply[4096];
+        uint32_t len = (uint32_t)frame.size();
+        memcpy(reply, &len, sizeof(len));
+        memcpy(reply + sizeof(len), frame.data(), frame.size());
+        server.write(session_id, reply, sizeof(len) + frame.size());
+    });
+    if (!server.start("127.0.0.1", port)) {
+        std::cout << title << " listen failed" << std::endl;
+        return;
+    }
+
+    // 客户端: 保持g_window条在途消息, 收到回显后记录延迟并补发
+    std::vector<unsigned long long> latencys(g_msg_count);
+    std::vector<char> msg(sizeof(uint32_t) + std::max(g_body_size, sizeof(unsigned long long)));
+    uint32_t body_len = (uint32_t)(msg.size() - sizeof(uint32_t));
+    memcpy(msg.data(), &body_len, sizeof(body_len));
+
+    size_t sent = 0;
+    size_t recved = 0;
+    std::promise<void> done;
+    auto session = std::make_shared<session_type>(client_pool->get_io_context());
+    session_type* sess = session.get();
+    auto send_one = [&]() {
+        unsigned long long now = NowNs();
+        memcpy(msg.data() + sizeof(uint32_t), &now, sizeof(now));
+        sess->write(msg.data(), msg.size());
+        ++sent;
+    };
+
+    session->register_open_cbk([&](const NetCallBack::SessionID&) {
+        for (size_t i = 0; i < g_window && sent < g_msg_count; ++i)
+            send_one();
+    });
+    session->register_frame_cbk(LengthFrameDecoder<uint32_t>(), [&](const NetCallBack::SessionID&, std::string_view frame) {
+        unsigned long long send_time;
+        memcpy(&send_time, frame.data(), sizeof(send_time));
+        latencys[recved] = NowNs() - send_time;
+        if (++recved == g_msg_count) {
+            done.set_value();
+            return;
+        }
+        if (sent < g_msg_count)
+            send_one();
+    });
+
+    auto start = bench_clock::now();
+    session->connect("127.0.0.1", port);
+    if (done.get_future().wait_for(std::chrono::seconds(60)) != std::future_status::ready) {
+        std::cout << title << " timeout, recved:" << recved << std::endl;
+        session->shutdown();
+        session.reset();
+        server.stop();
+        client_pool->stop();
+        return;
+    }
+    auto end = bench_clock::now();
+
+    // 连接对象需先于其io服务释放
+    session->shutdown();
+    session.reset();
+    client_pool->stop();
+    server.stop();
+
+    std::sort(latencys.begin(), latencys.end());
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << title
+        << " msgs:" << g_msg_count
+        << " msgs/sec:" << (unsigned long long)(g_msg_count / seconds)
+        << " p50:" << latencys[g_msg_count / 2] / 1000.0 << "us"
+        << " p99:" << latencys[g_msg_count * 99 / 100] / 1000.0 << "us"
+        << " max:" << latencys.back() / 1000.0 << "us"
+        << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1)
+        g_msg_count = std::max(1ul, strtoul(argv[1], nullptr, 10));
+    if (argc > 2)
+        g_body_size = std::min(4000ul, strtoul(argv[2], nullptr, 10));
+    if (argc > 3)
+        g_window = std::max(1ul, strtoul(argv[3], nullptr, 10));
+    if (argc > 4)
+        g_sqpoll = atoi(argv[4]) != 0;
+
+    std::cout << "body:" << g_body_size << " window:" << g_window << " sqpoll:" << g_sqpoll << std::endl;
+
+    bench<AsioTcpBackend>("asio ", 45601);
+    try {
+        bench<UringTcpBackend>("uring", 45602);
+    }
+    catch (std::exception& e) {
+        std::cout << "uring unavailable: " << e.what() << std::endl;
+    }
+    return 0;
+}
@@ -265,6 +265,11 @@ namespace BTool {
                 return;
 
             clear();
+            // ʱio_context, ͷ; ʱֹͣ־, صвٴʹ
+            {
+                std::lock_guard<std::mutex> locker(m_queue_mtx);
+                m_timer.reset();
+            }
             m_ioc_pool.stop();
 
             m_atomic_switch.reset();
@@ -350,7 +355,7 @@ namespace BTool {
                 m_cur_task = pItem;
                 start(pItem);
             }
-            else if (m_cur_task != m_timer_queue.front()) {
+            else if (m_timer && m_cur_task != m_timer_queue.front()) {
                 m_timer->cancel();
             }
 
@@ -398,7 +403,7 @@ namespace BTool {
         void erase(TimerId timer_id) {
             std::lock_guard<std::mutex> locker(m_queue_mtx);
             TimerTaskPtr erase_task = m_timer_queue.erase(timer_id);
-            if (erase_task && erase_task == m_cur_task)
+            if (m_timer && erase_task && erase_task == m_cur_task)
                 m_timer->cancel();
         }
 
@@ -414,13 +419,14 @@ namespace BTool {
         void clear_point_timer(const system_time_point& time_point) {
             std::lock_guard<std::mutex> locker(m_queue_mtx);
             std::set<TimerTaskPtr> erase_set = m_timer_queue.clear_point_timer(time_point);
-            if (erase_set.find(m_cur_task) != erase_set.end())
+            if (m_timer && erase_set.find(m_cur_task) != erase_set.end())
                 m_timer->cancel();
         }
 
     private:
         void start(const TimerTaskPtr& timer_task) {
-            if (!m_atomic_switch.has_started())
+            // stop()ʱͷ
+            if (!m_atomic_switch.has_started() || !m_timer)
                 return;
 
             // ǰ,Ϊexpires_from_now